@@ -0,0 +1,64 @@
+################################################################################
+#  Copyright 2012-2018 Esri
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+################################################################################
+
+TARGET = DSA_Benchmarks_Qt
+TEMPLATE = app
+
+QT += core gui positioning
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+ARCGIS_RUNTIME_VERSION = 100.4
+include($$PWD/../Shared/build/arcgisruntime.pri)
+include($$PWD/../Shared/build/arcgisruntimecpptoolkit.pri)
+
+INCLUDEPATH += $$PWD/../Shared/ \
+    $$PWD/../Shared/alerts \
+    $$PWD/../Shared/analysis \
+    $$PWD/../Shared/utilities
+
+HEADERS += \
+    CoordinateNotationChecks.h \
+    CumulativeViewshedBenchmark.h \
+    $$PWD/../Shared/analysis/CumulativeViewshed.h \
+    $$PWD/../Shared/analysis/ViewshedEngine.h \
+    $$PWD/../Shared/utilities/CoordinateNotation.h \
+    $$PWD/../Shared/utilities/DemRaster.h \
+    $$PWD/../Shared/utilities/DtedRaster.h \
+    $$PWD/../Shared/utilities/ElevationGrid.h \
+    $$PWD/../Shared/utilities/ElevationSampler.h \
+    $$PWD/../Shared/utilities/GeoTiffRaster.h \
+    $$PWD/../Shared/utilities/GeoTiffWriter.h \
+    $$PWD/../Shared/utilities/ParallelFor.h \
+    $$PWD/../Shared/utilities/TiffTags.h
+
+SOURCES += \
+    main.cpp \
+    CoordinateNotationChecks.cpp \
+    CumulativeViewshedBenchmark.cpp \
+    $$PWD/../Shared/analysis/CumulativeViewshed.cpp \
+    $$PWD/../Shared/analysis/ViewshedEngine.cpp \
+    $$PWD/../Shared/utilities/CoordinateNotation.cpp \
+    $$PWD/../Shared/utilities/DemRaster.cpp \
+    $$PWD/../Shared/utilities/DtedRaster.cpp \
+    $$PWD/../Shared/utilities/ElevationGrid.cpp \
+    $$PWD/../Shared/utilities/ElevationSampler.cpp \
+    $$PWD/../Shared/utilities/GeoTiffRaster.cpp \
+    $$PWD/../Shared/utilities/GeoTiffWriter.cpp \
+    $$PWD/../Shared/utilities/ParallelFor.cpp
+
+PRECOMPILED_HEADER = $$PWD/../Shared/pch.hpp
+CONFIG += precompile_header
@@ -0,0 +1,187 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "CoordinateNotationChecks.h"
+
+// C++ API headers
+#include "CoordinateFormatter.h"
+#include "Point.h"
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QVector>
+#include <QtDebug>
+
+// STL headers
+#include <algorithm>
+#include <random>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace Dsa {
+
+namespace
+{
+// the CoordinateFormatter call that LocationTextController has always made for each format
+QString referenceString(CoordinateNotation::Format format, const Point& point)
+{
+  switch (format)
+  {
+  case CoordinateNotation::Format::DecimalDegrees:
+    return CoordinateFormatter::toLatitudeLongitude(point, LatitudeLongitudeFormat::DecimalDegrees, 5);
+  case CoordinateNotation::Format::DegreesDecimalMinutes:
+    return CoordinateFormatter::toLatitudeLongitude(point, LatitudeLongitudeFormat::DegreesDecimalMinutes, 5);
+  case CoordinateNotation::Format::DegreesMinutesSeconds:
+    return CoordinateFormatter::toLatitudeLongitude(point, LatitudeLongitudeFormat::DegreesMinutesSeconds, 3);
+  case CoordinateNotation::Format::Utm:
+    return CoordinateFormatter::toUtm(point, UtmConversionMode::NorthSouthIndicators, true);
+  case CoordinateNotation::Format::Mgrs:
+    return CoordinateFormatter::toMgrs(point, MgrsConversionMode::Automatic, 5, true);
+  case CoordinateNotation::Format::Usng:
+    return CoordinateFormatter::toUsng(point, 5, true);
+  case CoordinateNotation::Format::Gars:
+    return CoordinateFormatter::toGars(point);
+  }
+
+  return QString();
+}
+
+void randomPoints(CoordinateNotation::Format format, int count, unsigned int seed, QVector<double>& x, QVector<double>& y)
+{
+  // UTM is only defined between 80S and 84N
+  const bool utm = format == CoordinateNotation::Format::Utm;
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> longitudes(-180.0, 180.0);
+  std::uniform_real_distribution<double> latitudes(utm ? -80.0 : -90.0, utm ? 84.0 : 90.0);
+
+  x.resize(count);
+  y.resize(count);
+  for (int i = 0; i < count; ++i)
+  {
+    x[i] = longitudes(generator);
+    y[i] = latitudes(generator);
+  }
+}
+
+const CoordinateNotation::Format allFormats[] =
+{
+  CoordinateNotation::Format::DecimalDegrees,
+  CoordinateNotation::Format::DegreesDecimalMinutes,
+  CoordinateNotation::Format::DegreesMinutesSeconds,
+  CoordinateNotation::Format::Utm,
+  CoordinateNotation::Format::Mgrs,
+  CoordinateNotation::Format::Usng,
+  CoordinateNotation::Format::Gars
+};
+}
+
+/*!
+  \class Dsa::CoordinateNotationChecks
+  \inmodule Dsa
+  \brief Checks \l CoordinateNotation against \c CoordinateFormatter and
+  times it.
+
+  These are run by the \c --check-coordinates option of the benchmarks app,
+  so that they are not built into the DSA apps.
+ */
+
+/*!
+  \brief Compares \l CoordinateNotation::format with \c CoordinateFormatter
+  for \a count random locations generated from \a seed.
+
+  Returns the number of locations where the two differ. If \a mismatches is
+  set, the first few differences are appended to it.
+ */
+int CoordinateNotationChecks::validate(CoordinateNotation::Format format, int count, unsigned int seed, QStringList* mismatches)
+{
+  QVector<double> x;
+  QVector<double> y;
+  randomPoints(format, count, seed, x, y);
+
+  QByteArray buffer(count * CoordinateNotation::MaximumLength, Qt::Uninitialized);
+  CoordinateNotation::format(format, x.constData(), y.constData(), count, buffer.data());
+
+  const int maximumReported = 10;
+  int failures = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    const QString expected = referenceString(format, Point(x[i], y[i], SpatialReference::wgs84()));
+    const QString actual = QString::fromLatin1(buffer.constData() + i * CoordinateNotation::MaximumLength);
+    if (actual == expected)
+      continue;
+
+    ++failures;
+    if (mismatches && failures <= maximumReported)
+    {
+      mismatches->append(QString("%1 %2, %3: expected \"%4\", got \"%5\"")
+                         .arg(CoordinateNotation::formatName(format), QString::number(x[i], 'f', 8), QString::number(y[i], 'f', 8), expected, actual));
+    }
+  }
+
+  return failures;
+}
+
+/*!
+  \brief Returns how many locations per second \l CoordinateNotation::format
+  converts to \a format, timed over \a count random locations generated
+  from \a seed.
+ */
+double CoordinateNotationChecks::benchmark(CoordinateNotation::Format format, int count, unsigned int seed)
+{
+  QVector<double> x;
+  QVector<double> y;
+  randomPoints(format, count, seed, x, y);
+
+  QByteArray buffer(count * CoordinateNotation::MaximumLength, Qt::Uninitialized);
+
+  QElapsedTimer timer;
+  timer.start();
+  CoordinateNotation::format(format, x.constData(), y.constData(), count, buffer.data());
+  const qint64 elapsed = std::max<qint64>(timer.nsecsElapsed(), 1);
+
+  return count * 1.0e9 / elapsed;
+}
+
+/*!
+  \brief Validates and benchmarks every format on \a count random locations,
+  logging the results.
+
+  Returns \c true if every format matched \c CoordinateFormatter.
+ */
+bool CoordinateNotationChecks::run(int count)
+{
+  bool passed = true;
+  for (CoordinateNotation::Format format : allFormats)
+  {
+    QStringList mismatches;
+    const int failures = validate(format, count, 1, &mismatches);
+    const double rate = benchmark(format, count, 2);
+
+    qInfo().noquote() << QString("%1: %2 of %3 match, %4 points per second")
+                         .arg(CoordinateNotation::formatName(format)).arg(count - failures).arg(count).arg(rate, 0, 'f', 0);
+    for (const QString& mismatch : mismatches)
+      qInfo().noquote() << "  " << mismatch;
+
+    passed = passed && failures == 0;
+  }
+
+  return passed;
+}
+
+} // Dsa
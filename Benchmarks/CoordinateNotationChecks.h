@@ -0,0 +1,41 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef COORDINATENOTATIONCHECKS_H
+#define COORDINATENOTATIONCHECKS_H
+
+// example app headers
+#include "CoordinateNotation.h"
+
+// Qt headers
+#include <QStringList>
+
+namespace Dsa {
+
+class CoordinateNotationChecks
+{
+public:
+  static int validate(CoordinateNotation::Format format, int count, unsigned int seed = 1, QStringList* mismatches = nullptr);
+  static double benchmark(CoordinateNotation::Format format, int count, unsigned int seed = 1);
+  static bool run(int count);
+
+private:
+  CoordinateNotationChecks() = delete;
+};
+
+} // Dsa
+
+#endif // COORDINATENOTATIONCHECKS_H
@@ -0,0 +1,172 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "CumulativeViewshedBenchmark.h"
+
+// example app headers
+#include "CumulativeViewshed.h"
+#include "ElevationGrid.h"
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QtDebug>
+
+// STL headers
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace Dsa {
+
+namespace
+{
+// the benchmark terrain is a third of a degree of 1 arc second posts
+const int benchmarkGridSize = 1201;
+const double benchmarkMaxDistance = 5000.0;
+
+ElevationGrid benchmarkGrid(std::mt19937& generator)
+{
+  ElevationGrid grid;
+  grid.width = benchmarkGridSize;
+  grid.height = benchmarkGridSize;
+  grid.spacingX = 1.0 / 3600.0;
+  grid.spacingY = 1.0 / 3600.0;
+  grid.originX = 0.0;
+  grid.originY = 45.0;
+  grid.values.resize(grid.width * grid.height);
+
+  // rolling hills from a few random waves
+  std::uniform_real_distribution<double> phase(0.0, 2.0 * M_PI);
+  std::uniform_real_distribution<double> frequency(0.005, 0.05);
+  double waves[6][3];
+  for (auto& wave : waves)
+  {
+    wave[0] = frequency(generator);
+    wave[1] = frequency(generator);
+    wave[2] = phase(generator);
+  }
+
+  float* values = grid.values.data();
+  for (int row = 0; row < grid.height; ++row)
+  {
+    for (int column = 0; column < grid.width; ++column)
+    {
+      double z = 200.0;
+      for (const auto& wave : waves)
+        z += 40.0 * std::sin(column * wave[0] + row * wave[1] + wave[2]);
+
+      *values++ = static_cast<float>(z);
+    }
+  }
+
+  return grid;
+}
+}
+
+/*!
+  \class Dsa::CumulativeViewshedBenchmark
+  \inmodule Dsa
+  \brief Times \l CumulativeViewshed on synthetic terrain with different
+  numbers of observers and threads.
+
+  This is run by the \c --benchmark-viewsheds option of the benchmarks app,
+  so that it is not built into the DSA apps.
+ */
+
+/*!
+  \brief Returns the number of observers per second for a
+  \l CumulativeViewshed of \a observerCount observers using \a threadCount threads.
+
+  The observers are placed at random, from \a seed, on synthetic terrain and
+  look \c 5 km in every direction.
+ */
+double CumulativeViewshedBenchmark::benchmark(int observerCount, int threadCount, unsigned int seed)
+{
+  std::mt19937 generator(seed);
+  const ElevationGrid grid = benchmarkGrid(generator);
+
+  std::uniform_real_distribution<double> column(0.0, grid.width - 1);
+  std::uniform_real_distribution<double> row(0.0, grid.height - 1);
+  QList<ViewshedParameters> observers;
+  for (int i = 0; i < observerCount; ++i)
+  {
+    ViewshedParameters observer;
+    observer.x = grid.x(0) + column(generator) * grid.spacingX;
+    observer.y = grid.y(0) - row(generator) * grid.spacingY;
+    observer.offsetZ = 2.0;
+    observer.maxDistance = benchmarkMaxDistance;
+    observers.append(observer);
+  }
+
+  QThreadPool* pool = QThreadPool::globalInstance();
+  const int maxThreadCount = pool->maxThreadCount();
+  pool->setMaxThreadCount(qMax(1, threadCount));
+
+  QElapsedTimer timer;
+  timer.start();
+  CumulativeViewshed::compute(grid, observers);
+  const qint64 elapsed = std::max<qint64>(timer.nsecsElapsed(), 1);
+
+  pool->setMaxThreadCount(maxThreadCount);
+
+  return observerCount * 1.0e9 / elapsed;
+}
+
+/*!
+  \brief Benchmarks cumulative viewsheds of up to \a maximumObservers
+  observers on up to every core, logging the rate and the speed up over a
+  single thread.
+
+  Returns \c false if \a maximumObservers is less than one.
+ */
+bool CumulativeViewshedBenchmark::run(int maximumObservers)
+{
+  if (maximumObservers < 1)
+    return false;
+
+  const int cores = qMax(1, QThread::idealThreadCount());
+  for (int observers = 1; ; observers = qMin(observers * 2, maximumObservers))
+  {
+    const double singleThreaded = benchmark(observers, 1, 1);
+    qInfo().noquote() << QString("%1 observers, 1 thread: %2 observers per second")
+                         .arg(observers).arg(singleThreaded, 0, 'f', 1);
+
+    for (int threads = 2; ; threads = qMin(threads * 2, cores))
+    {
+      if (threads > cores)
+        break;
+
+      const double rate = benchmark(observers, threads, 1);
+      qInfo().noquote() << QString("%1 observers, %2 threads: %3 observers per second, %4x")
+                           .arg(observers).arg(threads).arg(rate, 0, 'f', 1).arg(rate / singleThreaded, 0, 'f', 2);
+
+      if (threads == cores)
+        break;
+    }
+
+    if (observers == maximumObservers)
+      break;
+  }
+
+  return true;
+}
+
+} // Dsa
@@ -0,0 +1,34 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef CUMULATIVEVIEWSHEDBENCHMARK_H
+#define CUMULATIVEVIEWSHEDBENCHMARK_H
+
+namespace Dsa {
+
+class CumulativeViewshedBenchmark
+{
+public:
+  static double benchmark(int observerCount, int threadCount, unsigned int seed);
+  static bool run(int maximumObservers);
+
+private:
+  CumulativeViewshedBenchmark() = delete;
+};
+
+} // Dsa
+
+#endif // CUMULATIVEVIEWSHEDBENCHMARK_H
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+// example app headers
+#include "CoordinateNotationChecks.h"
+#include "CumulativeViewshedBenchmark.h"
+
+// Qt headers
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+//------------------------------------------------------------------------------
+
+#define kApplicationName                "DSA_Benchmarks_Qt"
+#define kApplicationDescription         "Dynamic Situational Awareness - checks and benchmarks"
+
+#define kArgCheckCoordinatesName        "check-coordinates"
+#define kArgCheckCoordinatesValueName   "count"
+#define kArgCheckCoordinatesDescription "Validate and benchmark the coordinate notation formats on count random points"
+
+#define kArgBenchmarkViewshedsName        "benchmark-viewsheds"
+#define kArgBenchmarkViewshedsValueName   "observers"
+#define kArgBenchmarkViewshedsDescription "Benchmark cumulative viewsheds of up to observers observers on up to every core"
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName(kApplicationName);
+
+  // Process command line
+  QCommandLineOption checkCoordinatesOption(kArgCheckCoordinatesName, kArgCheckCoordinatesDescription, kArgCheckCoordinatesValueName);
+  QCommandLineOption benchmarkViewshedsOption(kArgBenchmarkViewshedsName, kArgBenchmarkViewshedsDescription, kArgBenchmarkViewshedsValueName);
+
+  QCommandLineParser commandLineParser;
+
+  commandLineParser.setApplicationDescription(kApplicationDescription);
+  commandLineParser.addOption(checkCoordinatesOption);
+  commandLineParser.addOption(benchmarkViewshedsOption);
+  commandLineParser.addHelpOption();
+  commandLineParser.process(app);
+
+  bool passed = true;
+  bool ran = false;
+
+  if (commandLineParser.isSet(checkCoordinatesOption))
+  {
+    passed = Dsa::CoordinateNotationChecks::run(commandLineParser.value(checkCoordinatesOption).toInt()) && passed;
+    ran = true;
+  }
+
+  if (commandLineParser.isSet(benchmarkViewshedsOption))
+  {
+    passed = Dsa::CumulativeViewshedBenchmark::run(commandLineParser.value(benchmarkViewshedsOption).toInt()) && passed;
+    ran = true;
+  }
+
+  if (!ran)
+    commandLineParser.showHelp(1);
+
+  return passed ? 0 : 1;
+}
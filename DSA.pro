@@ -35,5 +35,6 @@ SUBDIRS += \
 
 !android:!ios {
 SUBDIRS += \
-  MessageSimulator
+  MessageSimulator \
+  Benchmarks
 }
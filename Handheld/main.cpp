@@ -40,6 +40,8 @@
 #include "NavigationController.h"
 #include "OptionsController.h"
 #include "TableOfContentsController.h"
+#include "TerrainProfileChart.h"
+#include "TerrainProfileController.h"
 #include "ViewedAlertsController.h"
 #include "ViewshedController.h"
 
@@ -134,6 +136,8 @@ int main(int argc, char *argv[])
   qmlRegisterType<Dsa::LocationTextController>("Esri.DSA", 1, 0, "LocationTextController");
   qmlRegisterType<Dsa::AlertConditionsController>("Esri.DSA", 1, 0, "AlertConditionsController");
   qmlRegisterType<Dsa::LineOfSightController>("Esri.DSA", 1, 0, "LineOfSightController");
+  qmlRegisterType<Dsa::TerrainProfileController>("Esri.DSA", 1, 0, "TerrainProfileController");
+  qmlRegisterType<Dsa::TerrainProfileChart>("Esri.DSA", 1, 0, "TerrainProfileChart");
   qmlRegisterType<Dsa::ContextMenuController>("Esri.DSA", 1, 0, "ContextMenuController");
   qmlRegisterType<Dsa::AnalysisListController>("Esri.DSA", 1, 0, "AnalysisListController");
   qmlRegisterType<Dsa::ObservationReportController>("Esri.DSA", 1, 0, "ObservationReportController");
@@ -18,6 +18,8 @@
 #include "CoTMessageParser.h"
 #include "GeoMessageParser.h"
 #include "SimulatedMessage.h"
+#include "SyntheticPayloadGenerator.h"
+#include "SyntheticTrackGenerator.h"
 
 #include <QFile>
 #include <QXmlStreamReader>
@@ -62,6 +64,35 @@ AbstractMessageParser* AbstractMessageParser::createMessageParser(const QString&
   return nullptr;
 }
 
+AbstractMessageParser* AbstractMessageParser::createMessageParser(const QUrl& source, QObject* parent)
+{
+  // synthetic tracks and payloads are described by a URL rather than a file
+  if (SyntheticTrackGenerator::isGeneratorUrl(source))
+    return new SyntheticTrackGenerator(SyntheticTrackGenerator::parametersFromUrl(source), parent);
+
+  if (SyntheticPayloadGenerator::isPayloadUrl(source))
+    return new SyntheticPayloadGenerator(SyntheticPayloadGenerator::parametersFromUrl(source), parent);
+
+  return createMessageParser(source.toLocalFile(), parent);
+}
+
+qint64 AbstractMessageParser::startTime()
+{
+  // sources without recorded message times cannot be replayed
+  return -1;
+}
+
+qint64 AbstractMessageParser::nextMessageTime() const
+{
+  return -1;
+}
+
+bool AbstractMessageParser::seek(qint64 time)
+{
+  Q_UNUSED(time)
+  return false;
+}
+
 QString AbstractMessageParser::filePath() const
 {
   return m_filePath;
@@ -18,6 +18,7 @@
 #define ABSTRACTMESSAGEPARSER_H
 
 #include <QObject>
+#include <QUrl>
 
 class AbstractMessageParser : public QObject
 {
@@ -27,6 +28,7 @@ public:
   ~AbstractMessageParser();
 
   static AbstractMessageParser* createMessageParser(const QString& filePath, QObject* parent = nullptr);
+  static AbstractMessageParser* createMessageParser(const QUrl& source, QObject* parent = nullptr);
 
   virtual QByteArray nextMessage() = 0;
 
@@ -34,6 +36,10 @@ public:
 
   virtual bool atEnd() const = 0;
 
+  virtual qint64 startTime();
+  virtual qint64 nextMessageTime() const;
+  virtual bool seek(qint64 time);
+
   QString filePath() const;
 
 signals:
@@ -17,12 +17,9 @@
 #ifndef COTMESSAGEPARSER_H
 #define COTMESSAGEPARSER_H
 
-#include "AbstractMessageParser.h"
+#include "IndexedMessageParser.h"
 
-#include <QXmlStreamReader>
-#include <QFile>
-
-class CoTMessageParser : public AbstractMessageParser
+class CoTMessageParser : public IndexedMessageParser
 {
   Q_OBJECT
 
@@ -30,19 +27,9 @@ public:
   explicit CoTMessageParser(const QString& filePath, QObject* parent = nullptr);
   ~CoTMessageParser();
 
-  QByteArray nextMessage() override;
-
-  void reset() override;
-
-  bool atEnd() const override;
-
 private:
   Q_DISABLE_COPY(CoTMessageParser)
   CoTMessageParser() = delete;
-
-  QFile m_device;
-  QXmlStreamReader m_reader;
-  bool m_isParsing = false;
 };
 
 #endif // COTMESSAGEPARSER_H
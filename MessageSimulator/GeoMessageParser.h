@@ -17,12 +17,9 @@
 #ifndef GEOMESSAGEPARSER_H
 #define GEOMESSAGEPARSER_H
 
-#include "AbstractMessageParser.h"
+#include "IndexedMessageParser.h"
 
-#include <QFile>
-#include <QXmlStreamReader>
-
-class GeoMessageParser : public AbstractMessageParser
+class GeoMessageParser : public IndexedMessageParser
 {
   Q_OBJECT
 
@@ -30,19 +27,9 @@ public:
   explicit GeoMessageParser(const QString& filePath, QObject* parent = nullptr);
   ~GeoMessageParser();
 
-  QByteArray nextMessage() override;
-
-  void reset() override;
-
-  bool atEnd() const override;
-
 private:
   Q_DISABLE_COPY(GeoMessageParser)
   GeoMessageParser() = delete;
-
-  QFile m_device;
-  QXmlStreamReader m_reader;
-  bool m_isParsing = false;
 };
 
 #endif // GEOMESSAGEPARSER_H
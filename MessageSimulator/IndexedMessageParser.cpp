@@ -0,0 +1,107 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#include "IndexedMessageParser.h"
+
+IndexedMessageParser::IndexedMessageParser(const QString& filePath, const QString& elementName, QObject* parent) :
+  AbstractMessageParser(filePath, parent),
+  m_index(filePath, elementName)
+{
+}
+
+IndexedMessageParser::~IndexedMessageParser()
+{
+  // unmap and close the file
+  m_index.close();
+}
+
+QByteArray IndexedMessageParser::nextMessage()
+{
+  if (!openIndex())
+    return QByteArray();
+
+  if (atEnd())
+  {
+    emit errorOccurred(tr("Finished parsing messages to end of file"));
+    return QByteArray();
+  }
+
+  // the message is usually a slice of the mapped file; see MessageFileIndex::message
+  return m_index.message(m_nextIndex++);
+}
+
+void IndexedMessageParser::reset()
+{
+  // rewind to the first message without re-reading the file
+  m_nextIndex = 0;
+}
+
+bool IndexedMessageParser::atEnd() const
+{
+  // a file that cannot be opened has no messages to send
+  return m_openFailed || (m_index.isOpen() && m_nextIndex >= m_index.count());
+}
+
+qint64 IndexedMessageParser::startTime()
+{
+  if (!openIndex())
+    return -1;
+
+  for (int i = 0; i < m_index.count(); ++i)
+  {
+    if (m_index.messageTime(i) >= 0)
+      return m_index.messageTime(i);
+  }
+
+  return -1;
+}
+
+qint64 IndexedMessageParser::nextMessageTime() const
+{
+  if (!m_index.isOpen() || atEnd())
+    return -1;
+
+  return m_index.messageTime(m_nextIndex);
+}
+
+bool IndexedMessageParser::seek(qint64 time)
+{
+  if (!openIndex())
+    return false;
+
+  m_nextIndex = m_index.indexAtTime(time);
+  return true;
+}
+
+bool IndexedMessageParser::openIndex()
+{
+  if (m_index.isOpen())
+    return true;
+
+  if (m_openFailed)
+    return false;
+
+  // if not indexed yet, map the file and locate every message
+  // element; this only happens once per parser
+  if (!m_index.open())
+  {
+    m_openFailed = true;
+    emit errorOccurred(m_index.errorString());
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,56 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef INDEXEDMESSAGEPARSER_H
+#define INDEXEDMESSAGEPARSER_H
+
+#include "AbstractMessageParser.h"
+#include "MessageFileIndex.h"
+
+// reads the messages of an XML file through a MessageFileIndex, so
+// that they can be sent, rewound and replayed without parsing the file
+class IndexedMessageParser : public AbstractMessageParser
+{
+  Q_OBJECT
+
+public:
+  ~IndexedMessageParser();
+
+  QByteArray nextMessage() override;
+
+  void reset() override;
+
+  bool atEnd() const override;
+
+  qint64 startTime() override;
+  qint64 nextMessageTime() const override;
+  bool seek(qint64 time) override;
+
+protected:
+  IndexedMessageParser(const QString& filePath, const QString& elementName, QObject* parent = nullptr);
+
+private:
+  Q_DISABLE_COPY(IndexedMessageParser)
+  IndexedMessageParser() = delete;
+
+  bool openIndex();
+
+  MessageFileIndex m_index;
+  int m_nextIndex = 0;
+  bool m_openFailed = false;
+};
+
+#endif // INDEXEDMESSAGEPARSER_H
@@ -0,0 +1,129 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#include "MessageDestination.h"
+#include "SimulatedMessage.h"
+
+// Qt headers
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace
+{
+const QString destinationsKey{QStringLiteral("destinations")};
+const QString nameKey{QStringLiteral("name")};
+const QString addressKey{QStringLiteral("address")};
+const QString portKey{QStringLiteral("port")};
+const QString rateKey{QStringLiteral("rate")};
+const QString messageTypesKey{QStringLiteral("messageTypes")};
+const QString affiliationsKey{QStringLiteral("affiliations")};
+const QString broadcastAddress{QStringLiteral("broadcast")};
+
+bool matchesType(const QString& pattern, const QString& messageType)
+{
+  if (pattern.endsWith(QLatin1Char('*')))
+    return messageType.startsWith(pattern.leftRef(pattern.size() - 1), Qt::CaseInsensitive);
+
+  return messageType.compare(pattern, Qt::CaseInsensitive) == 0;
+}
+}
+
+bool MessageDestination::isFiltered() const
+{
+  return !messageTypes.isEmpty() || !affiliations.isEmpty();
+}
+
+bool MessageDestination::matches(const QByteArray& message) const
+{
+  // an unfiltered destination takes every message without looking at it
+  if (!isFiltered())
+    return true;
+
+  if (!affiliations.isEmpty())
+  {
+    const QChar affiliation = SimulatedMessage::messageAffiliation(message);
+    if (affiliation.isNull() || !affiliations.contains(affiliation, Qt::CaseInsensitive))
+      return false;
+  }
+
+  if (messageTypes.isEmpty())
+    return true;
+
+  const QString messageType = SimulatedMessage::messageType(message);
+  for (const QString& pattern : messageTypes)
+  {
+    if (matchesType(pattern, messageType))
+      return true;
+  }
+
+  return false;
+}
+
+MessageDestination MessageDestination::fromJson(const QJsonObject& json, int defaultPort, QString& errorString)
+{
+  MessageDestination destination;
+  destination.name = json.value(nameKey).toString();
+  destination.port = json.value(portKey).toInt(defaultPort);
+  destination.messagesPerSecond = json.value(rateKey).toDouble(0.0);
+  destination.affiliations = json.value(affiliationsKey).toString();
+
+  for (const QJsonValue& messageType : json.value(messageTypesKey).toArray())
+    destination.messageTypes.append(messageType.toString());
+
+  const QString address = json.value(addressKey).toString(broadcastAddress);
+  if (address.compare(broadcastAddress, Qt::CaseInsensitive) != 0 && !destination.address.setAddress(address))
+    errorString = QObject::tr("Destination ") + destination.name + QObject::tr(" has an invalid address ") + address;
+
+  if (destination.port <= 0 || destination.port > 65535)
+    errorString = QObject::tr("Destination ") + destination.name + QObject::tr(" has no valid port");
+
+  return destination;
+}
+
+QList<MessageDestination> MessageDestination::loadDestinations(const QString& filePath, int defaultPort, QString& errorString)
+{
+  QFile file(filePath);
+  if (!file.open(QFile::ReadOnly))
+  {
+    errorString = QObject::tr("Could not open ") + filePath + QObject::tr(" for reading");
+    return QList<MessageDestination>();
+  }
+
+  QJsonParseError parseError;
+  const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (document.isNull())
+  {
+    errorString = QObject::tr("Could not parse ") + filePath + QStringLiteral(": ") + parseError.errorString();
+    return QList<MessageDestination>();
+  }
+
+  QList<MessageDestination> destinations;
+  for (const QJsonValue& value : document.object().value(destinationsKey).toArray())
+  {
+    const MessageDestination destination = fromJson(value.toObject(), defaultPort, errorString);
+    if (!errorString.isEmpty())
+      return QList<MessageDestination>();
+
+    destinations.append(destination);
+  }
+
+  if (destinations.isEmpty())
+    errorString = filePath + QObject::tr(" defines no destinations");
+
+  return destinations;
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef MESSAGEDESTINATION_H
+#define MESSAGEDESTINATION_H
+
+// Qt headers
+#include <QHostAddress>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+
+class QJsonObject;
+
+// Where a share of the simulated messages is sent. A destinations file is a
+// JSON document of the form
+//
+// { "destinations": [
+//   { "name": "friendly", "port": 45678, "affiliations": "F" },
+//   { "name": "hostile", "address": "239.1.1.1", "port": 45679, "affiliations": "HS" },
+//   { "name": "reports", "port": 45680, "messageTypes": ["spotrep", "sitrep"], "rate": 50 } ] }
+//
+// "address" defaults to broadcast, "port" to the simulator port and "rate" (messages
+// per second) to the simulation frequency. Message types are GeoMessage _type values
+// or CoT types, where a trailing * matches any suffix. A message is sent to every
+// destination that it matches.
+struct MessageDestination
+{
+  QString name;
+  QHostAddress address{QHostAddress::Broadcast};
+  int port = -1;
+  double messagesPerSecond = 0.0; // 0 follows the simulation frequency
+  QStringList messageTypes; // empty matches every type
+  QString affiliations; // empty matches every affiliation
+
+  bool isFiltered() const;
+  bool matches(const QByteArray& message) const;
+
+  static MessageDestination fromJson(const QJsonObject& json, int defaultPort, QString& errorString);
+  static QList<MessageDestination> loadDestinations(const QString& filePath, int defaultPort, QString& errorString);
+};
+
+Q_DECLARE_METATYPE(MessageDestination)
+
+#endif // MESSAGEDESTINATION_H
@@ -0,0 +1,477 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#include "MessageFileIndex.h"
+#include "SimulatedMessage.h"
+
+// Qt headers
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// C++ headers
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+const quint32 cacheMagic = 0x44534149; // "DSAI"
+const quint32 cacheVersion = 4;
+
+bool isNameTerminator(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '>' || c == '/';
+}
+
+qint64 find(const char* data, qint64 size, qint64 from, const char* needle)
+{
+  const size_t needleLength = std::strlen(needle);
+  while (from < size)
+  {
+    const char* candidate = static_cast<const char*>(std::memchr(data + from, needle[0], size - from));
+    if (!candidate)
+      return -1;
+
+    from = candidate - data;
+    if (static_cast<size_t>(size - from) >= needleLength && std::memcmp(candidate, needle, needleLength) == 0)
+      return from;
+
+    from++;
+  }
+
+  return -1;
+}
+}
+
+MessageFileIndex::MessageFileIndex(const QString& filePath, const QString& elementName) :
+  m_filePath(filePath),
+  m_elementName(elementName.toLatin1())
+{
+}
+
+MessageFileIndex::~MessageFileIndex()
+{
+  close();
+}
+
+bool MessageFileIndex::open()
+{
+  close();
+
+  m_file.setFileName(m_filePath);
+  if (!m_file.open(QFile::ReadOnly))
+  {
+    m_errorString = QObject::tr("Could not open ") + m_filePath + QObject::tr(" for reading");
+    return false;
+  }
+
+  m_size = m_file.size();
+
+  // an empty file maps to nothing but is still a valid, empty simulation
+  if (m_size > 0)
+  {
+    uchar* mapped = m_file.map(0, m_size);
+    if (!mapped)
+    {
+      m_errorString = QObject::tr("Could not map ") + m_filePath + QObject::tr(" into memory");
+      m_file.close();
+      m_size = 0;
+      return false;
+    }
+
+    m_data = reinterpret_cast<const char*>(mapped);
+  }
+
+  // needed before the times are read, as they are parsed from the messages
+  readNamespaceDeclarations();
+
+  // the scan only has to happen once per version of the file
+  if (!readCache())
+  {
+    scan();
+    readTimes();
+    writeCache();
+  }
+
+  indexTimes();
+  return true;
+}
+
+void MessageFileIndex::close()
+{
+  if (!m_file.isOpen())
+    return;
+
+  if (m_data)
+    m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+
+  m_file.close();
+  m_data = nullptr;
+  m_size = 0;
+  m_entries.clear();
+  m_timedEntries.clear();
+  m_namespaceDeclarations.clear();
+  m_namespacePrefixes.clear();
+}
+
+bool MessageFileIndex::isOpen() const
+{
+  return m_file.isOpen();
+}
+
+QString MessageFileIndex::errorString() const
+{
+  return m_errorString;
+}
+
+int MessageFileIndex::count() const
+{
+  return m_entries.size();
+}
+
+MessageFileIndex::Entry MessageFileIndex::entry(int index) const
+{
+  return m_entries.at(index);
+}
+
+QByteArray MessageFileIndex::message(int index) const
+{
+  // the returned bytes reference the mapped file directly and
+  // are only valid for as long as the index stays open
+  const Entry& e = m_entries.at(index);
+  const QByteArray slice = QByteArray::fromRawData(m_data + e.offset, static_cast<int>(e.length));
+  if (m_namespaceDeclarations.isEmpty())
+    return slice;
+
+  // a message cut from the file loses the namespaces declared on the root
+  // element, so those it uses are declared on the message itself instead
+  const QByteArray startTag = QByteArray::fromRawData(m_data + e.offset, static_cast<int>(findTagEnd(e.offset) - e.offset));
+  QByteArray declarations;
+  for (int i = 0; i < m_namespaceDeclarations.size(); ++i)
+  {
+    const QByteArray& prefix = m_namespacePrefixes.at(i);
+    if (!slice.contains(prefix + ':') || startTag.contains("xmlns:" + prefix))
+      continue;
+
+    declarations += ' ' + m_namespaceDeclarations.at(i);
+  }
+
+  if (declarations.isEmpty())
+    return slice;
+
+  qint64 nameEnd = e.offset + 1;
+  while (nameEnd < e.offset + e.length && !isNameTerminator(m_data[nameEnd]))
+    nameEnd++;
+
+  QByteArray result;
+  result.reserve(static_cast<int>(e.length) + declarations.size());
+  result.append(m_data + e.offset, static_cast<int>(nameEnd - e.offset));
+  result.append(declarations);
+  result.append(m_data + nameEnd, static_cast<int>(e.offset + e.length - nameEnd));
+  return result;
+}
+
+qint64 MessageFileIndex::messageTime(int index) const
+{
+  return m_entries.at(index).time;
+}
+
+int MessageFileIndex::indexAtTime(qint64 time) const
+{
+  // the first message at or after the requested time; messages without
+  // a time never stop the search
+  const auto it = std::lower_bound(m_timedEntries.cbegin(), m_timedEntries.cend(), time, [this](int index, qint64 value)
+  {
+    return m_entries.at(index).time < value;
+  });
+
+  return it == m_timedEntries.cend() ? m_entries.size() : *it;
+}
+
+QString MessageFileIndex::cacheFilePath(const QString& filePath)
+{
+  const QString absolutePath = QFileInfo(filePath).absoluteFilePath();
+  const QByteArray hash = QCryptographicHash::hash(absolutePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+  const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+  return QDir(cacheDir).filePath(QStringLiteral("messageindex/") + QString::fromLatin1(hash) + QStringLiteral(".idx"));
+}
+
+void MessageFileIndex::scan()
+{
+  m_entries.clear();
+
+  qint64 position = 0;
+
+  while (position < m_size)
+  {
+    const char* start = static_cast<const char*>(std::memchr(m_data + position, '<', m_size - position));
+    if (!start)
+      break;
+
+    position = start - m_data;
+
+    // skip comments so that commented-out messages are not indexed
+    if (m_size - position >= 4 && std::memcmp(start, "<!--", 4) == 0)
+    {
+      const qint64 commentEnd = find(m_data, m_size, position + 4, "-->");
+      if (commentEnd == -1)
+        break;
+
+      position = commentEnd + 3;
+      continue;
+    }
+
+    if (!matchesElementName(position + 1))
+    {
+      position++;
+      continue;
+    }
+
+    const qint64 startTagEnd = findTagEnd(position);
+    if (startTagEnd == -1)
+      break;
+
+    // self-closing message element
+    if (m_data[startTagEnd - 1] == '/')
+    {
+      m_entries.append(Entry{position, startTagEnd + 1 - position, -1});
+      position = startTagEnd + 1;
+      continue;
+    }
+
+    // find the matching end element
+    qint64 search = find(m_data, m_size, startTagEnd + 1, "</");
+    while (search != -1 && !matchesElementName(search + 2))
+      search = find(m_data, m_size, search + 2, "</");
+
+    const qint64 endTagEnd = search == -1 ? -1 : findTagEnd(search);
+
+    if (endTagEnd == -1)
+      break;
+
+    m_entries.append(Entry{position, endTagEnd + 1 - position, -1});
+    position = endTagEnd + 1;
+  }
+}
+
+void MessageFileIndex::readTimes()
+{
+  // recorded times are extracted once so that replay never has to parse
+  for (int i = 0; i < m_entries.size(); ++i)
+  {
+    const QDateTime time = SimulatedMessage::messageTime(message(i));
+    m_entries[i].time = time.isValid() ? time.toMSecsSinceEpoch() : -1;
+  }
+}
+
+void MessageFileIndex::indexTimes()
+{
+  // recordings are in time order, so the messages with a time can be searched
+  m_timedEntries.clear();
+  for (int i = 0; i < m_entries.size(); ++i)
+  {
+    if (m_entries.at(i).time >= 0)
+      m_timedEntries.append(i);
+  }
+}
+
+void MessageFileIndex::readNamespaceDeclarations()
+{
+  m_namespaceDeclarations.clear();
+  m_namespacePrefixes.clear();
+
+  // the root is the first element, after any declaration, comments or doctype
+  qint64 position = 0;
+  while (true)
+  {
+    const char* start = m_size > position ? static_cast<const char*>(std::memchr(m_data + position, '<', m_size - position)) : nullptr;
+    if (!start)
+      return;
+
+    position = start - m_data;
+    if (m_size - position >= 4 && std::memcmp(start, "<!--", 4) == 0)
+    {
+      const qint64 commentEnd = find(m_data, m_size, position + 4, "-->");
+      if (commentEnd == -1)
+        return;
+
+      position = commentEnd + 3;
+    }
+    else if (m_size - position >= 2 && (start[1] == '?' || start[1] == '!'))
+    {
+      const qint64 tagEnd = findTagEnd(position);
+      if (tagEnd == -1)
+        return;
+
+      position = tagEnd + 1;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  // a file holding a single message has nothing to carry over
+  if (matchesElementName(position + 1))
+    return;
+
+  const qint64 rootEnd = findTagEnd(position);
+  if (rootEnd == -1)
+    return;
+
+  qint64 declaration = find(m_data, rootEnd, position, "xmlns:");
+  while (declaration != -1)
+  {
+    const qint64 equals = find(m_data, rootEnd, declaration, "=");
+    qint64 valueStart = equals + 1;
+    while (equals != -1 && valueStart < rootEnd && (m_data[valueStart] == ' ' || m_data[valueStart] == '\t'))
+      valueStart++;
+
+    if (equals == -1 || valueStart >= rootEnd || (m_data[valueStart] != '"' && m_data[valueStart] != '\''))
+      return;
+
+    const char* valueEnd = static_cast<const char*>(std::memchr(m_data + valueStart + 1, m_data[valueStart], rootEnd - valueStart - 1));
+    if (!valueEnd)
+      return;
+
+    const qint64 declarationEnd = valueEnd - m_data + 1;
+    m_namespaceDeclarations.append(QByteArray(m_data + declaration, static_cast<int>(declarationEnd - declaration)));
+    m_namespacePrefixes.append(QByteArray(m_data + declaration + 6, static_cast<int>(equals - declaration - 6)).trimmed());
+
+    declaration = find(m_data, rootEnd, declarationEnd, "xmlns:");
+  }
+}
+
+bool MessageFileIndex::readCache()
+{
+  QFile cacheFile(cacheFilePath(m_filePath));
+  if (!cacheFile.open(QFile::ReadOnly))
+    return false;
+
+  QDataStream stream(&cacheFile);
+
+  quint32 magic = 0;
+  quint32 version = 0;
+  qint64 sourceSize = 0;
+  qint64 sourceModified = 0;
+  QByteArray elementName;
+  quint32 entryCount = 0;
+  stream >> magic >> version >> sourceSize >> sourceModified >> elementName >> entryCount;
+
+  // the cache is only valid for the exact version of the file it was built from
+  const QFileInfo sourceInfo(m_filePath);
+  if (stream.status() != QDataStream::Ok ||
+      magic != cacheMagic ||
+      version != cacheVersion ||
+      sourceSize != m_size ||
+      sourceModified != sourceInfo.lastModified().toMSecsSinceEpoch() ||
+      elementName != m_elementName ||
+      entryCount > static_cast<quint64>(m_size))
+  {
+    return false;
+  }
+
+  QVector<Entry> entries;
+  entries.reserve(static_cast<int>(entryCount));
+  for (quint32 i = 0; i < entryCount; ++i)
+  {
+    Entry e;
+    stream >> e.offset >> e.length >> e.time;
+    if (e.offset < 0 || e.length <= 0 || e.offset + e.length > m_size)
+      return false;
+
+    entries.append(e);
+  }
+
+  if (stream.status() != QDataStream::Ok)
+    return false;
+
+  m_entries = entries;
+  return true;
+}
+
+void MessageFileIndex::writeCache() const
+{
+  const QString path = cacheFilePath(m_filePath);
+  if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+    return;
+
+  // a failure to write the cache is not an error; the file is
+  // simply scanned again next time
+  QSaveFile cacheFile(path);
+  if (!cacheFile.open(QFile::WriteOnly))
+    return;
+
+  QDataStream stream(&cacheFile);
+  stream << cacheMagic << cacheVersion << m_size
+         << QFileInfo(m_filePath).lastModified().toMSecsSinceEpoch()
+         << m_elementName << static_cast<quint32>(m_entries.size());
+
+  for (const Entry& e : m_entries)
+    stream << e.offset << e.length << e.time;
+
+  cacheFile.commit();
+}
+
+qint64 MessageFileIndex::findTagEnd(qint64 position) const
+{
+  // attribute values may legally contain '>' so quotes are honoured
+  char quote = 0;
+  for (qint64 i = position; i < m_size; ++i)
+  {
+    const char c = m_data[i];
+    if (quote)
+    {
+      if (c == quote)
+        quote = 0;
+    }
+    else if (c == '"' || c == '\'')
+    {
+      quote = c;
+    }
+    else if (c == '>')
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+bool MessageFileIndex::matchesElementName(qint64 position) const
+{
+  // skip an optional namespace prefix, as in <ns:geomessage> or <cot:event>
+  for (qint64 i = position; i < m_size && !isNameTerminator(m_data[i]); ++i)
+  {
+    if (m_data[i] == ':')
+    {
+      position = i + 1;
+      break;
+    }
+  }
+
+  const int nameLength = m_elementName.size();
+  if (m_size - position <= nameLength)
+    return false;
+
+  return qstrnicmp(m_data + position, m_elementName.constData(), static_cast<uint>(nameLength)) == 0 &&
+         isNameTerminator(m_data[position + nameLength]);
+}
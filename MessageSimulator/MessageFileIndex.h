@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef MESSAGEFILEINDEX_H
+#define MESSAGEFILEINDEX_H
+
+// Qt headers
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+class MessageFileIndex
+{
+public:
+  struct Entry
+  {
+    qint64 offset;
+    qint64 length;
+    qint64 time; // msecs since epoch, or -1 if the message has no time
+  };
+
+  MessageFileIndex(const QString& filePath, const QString& elementName);
+  ~MessageFileIndex();
+
+  bool open();
+  void close();
+
+  bool isOpen() const;
+
+  QString errorString() const;
+
+  int count() const;
+  Entry entry(int index) const;
+  QByteArray message(int index) const;
+
+  qint64 messageTime(int index) const;
+  int indexAtTime(qint64 time) const;
+
+  static QString cacheFilePath(const QString& filePath);
+
+private:
+  Q_DISABLE_COPY(MessageFileIndex)
+
+  void scan();
+  void readTimes();
+  void indexTimes();
+  void readNamespaceDeclarations();
+  bool readCache();
+  void writeCache() const;
+
+  qint64 findTagEnd(qint64 position) const;
+  bool matchesElementName(qint64 position) const;
+
+  QString m_filePath;
+  QByteArray m_elementName;
+  QFile m_file;
+  const char* m_data = nullptr;
+  qint64 m_size = 0;
+  QVector<Entry> m_entries;
+  QVector<int> m_timedEntries;
+  QVector<QByteArray> m_namespaceDeclarations;
+  QVector<QByteArray> m_namespacePrefixes;
+  QString m_errorString;
+};
+
+#endif // MESSAGEFILEINDEX_H
@@ -0,0 +1,387 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#include "MessageSenderWorker.h"
+
+// example app headers
+#include "AbstractMessageParser.h"
+#include "DataSender.h"
+#include "SimulatedMessage.h"
+
+// Qt headers
+#include <QTimer>
+#include <QUdpSocket>
+
+namespace
+{
+// how often the achieved rate is reported
+const int statisticsIntervalMs = 1000;
+
+// how often a sent message is handed on for the message history, which
+// could not keep up with every message at high rates
+const int historySampleIntervalMs = 100;
+
+// the bucket holds at most this many seconds worth of messages so that a late
+// tick can catch up without producing an unbounded burst
+const double bucketDurationSeconds = 0.1;
+
+// a large send buffer absorbs bursts without the OS dropping datagrams
+const int sendBufferSize = 4 * 1024 * 1024;
+
+const double nanosecondsPerSecond = 1e9;
+const double nanosecondsPerMillisecond = 1e6;
+
+// the longest the replay scheduler sleeps before checking again
+const int maxReplayWaitMs = 100;
+
+// how many messages meant for other destinations are skipped in one tick
+// before yielding to the event loop
+const int maxSkippedPerTick = 10000;
+}
+
+MessageSenderWorker::MessageSenderWorker(QObject* parent) :
+  QObject(parent)
+{
+}
+
+MessageSenderWorker::~MessageSenderWorker()
+{
+}
+
+void MessageSenderWorker::start(const QUrl& source, const MessageDestination& destination, double messagesPerSecond, bool looped, double replaySpeed,
+                                bool latencyTagging)
+{
+  // first stop the previous run if it was still active
+  stop();
+
+  // the socket, parser and timers are created here so that they
+  // live on the sender thread rather than on the thread that owns the worker
+  m_messageParser = AbstractMessageParser::createMessageParser(source, this);
+  if (!m_messageParser)
+  {
+    emit errorOccurred(tr("Failed to create message parser with input file"));
+    emit finished();
+    return;
+  }
+
+  connect(m_messageParser, &AbstractMessageParser::errorOccurred, this, &MessageSenderWorker::errorOccurred);
+
+  m_udpSocket = new QUdpSocket(this);
+  m_udpSocket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, sendBufferSize);
+  m_udpSocket->connectToHost(destination.address, destination.port, QIODevice::WriteOnly);
+
+  if (!m_dataSender)
+    m_dataSender = new Dsa::DataSender(this);
+
+  m_dataSender->setDevice(m_udpSocket);
+
+  if (!m_sendTimer)
+  {
+    m_sendTimer = new QTimer(this);
+    m_sendTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_sendTimer, &QTimer::timeout, this, &MessageSenderWorker::sendBatch);
+  }
+
+  if (!m_statisticsTimer)
+  {
+    m_statisticsTimer = new QTimer(this);
+    m_statisticsTimer->setInterval(statisticsIntervalMs);
+    connect(m_statisticsTimer, &QTimer::timeout, this, &MessageSenderWorker::reportStatistics);
+  }
+
+  m_destination = destination;
+  m_looped = looped;
+  m_latencyTagging = latencyTagging;
+  m_senderId = SimulatedMessage::createSenderId();
+  m_sequence = 0;
+  m_messagesRead = 0;
+  m_messagesSent = 0;
+  m_sendErrors = 0;
+  m_lastReportedMessagesSent = 0;
+  m_sampleClock.invalidate();
+
+  // replay needs recorded message times to schedule against
+  m_replaySpeed = replaySpeed;
+  m_replayStartTime = m_replaySpeed > 0.0 ? m_messageParser->startTime() : -1;
+  if (m_replaySpeed > 0.0 && m_replayStartTime < 0)
+  {
+    emit errorOccurred(tr("Simulation file has no message times; sending at the message frequency instead"));
+    m_replaySpeed = 0.0;
+  }
+
+  setMessagesPerSecond(messagesPerSecond);
+  resume();
+}
+
+void MessageSenderWorker::pause()
+{
+  if (m_sendTimer)
+    m_sendTimer->stop();
+
+  if (m_statisticsTimer)
+    m_statisticsTimer->stop();
+}
+
+void MessageSenderWorker::resume()
+{
+  if (!m_messageParser)
+    return;
+
+  restartPacing();
+  m_statisticsClock.start();
+  m_lastReportedMessagesSent = m_messagesSent;
+
+  m_sendTimer->start();
+  m_statisticsTimer->start();
+}
+
+void MessageSenderWorker::stop()
+{
+  if (!m_messageParser)
+    return;
+
+  pause();
+  reportStatistics();
+
+  delete m_messageParser;
+  m_messageParser = nullptr;
+
+  if (m_udpSocket)
+  {
+    if (m_udpSocket->isOpen())
+      m_udpSocket->close();
+
+    delete m_udpSocket;
+    m_udpSocket = nullptr;
+  }
+}
+
+void MessageSenderWorker::setMessagesPerSecond(double messagesPerSecond)
+{
+  if (messagesPerSecond <= 0.0)
+    return;
+
+  m_messagesPerSecond = messagesPerSecond;
+  m_bucketCapacity = qMax(1.0, m_messagesPerSecond * bucketDurationSeconds);
+  m_tokens = qMin(m_tokens, m_bucketCapacity);
+
+  // tick often enough to keep batches small at high rates, but do not
+  // spin when only a few messages per second are required
+  const int intervalMs = qBound(1, qRound(1000.0 / m_messagesPerSecond), 100);
+  if (m_sendTimer)
+    m_sendTimer->setInterval(intervalMs);
+}
+
+void MessageSenderWorker::setReplaySpeed(double replaySpeed)
+{
+  if (replaySpeed <= 0.0 || m_replaySpeed <= 0.0)
+    return;
+
+  // continue from the current position at the new speed
+  m_replaySpeed = replaySpeed;
+  if (m_sendTimer && m_sendTimer->isActive())
+    restartPacing();
+}
+
+void MessageSenderWorker::seek(qint64 offsetMs)
+{
+  if (!m_messageParser || m_replayStartTime < 0)
+  {
+    emit errorOccurred(tr("Seeking requires a simulation file with message times"));
+    return;
+  }
+
+  if (!m_messageParser->seek(m_replayStartTime + offsetMs))
+    return;
+
+  restartPacing();
+  m_replayOffsetMs = offsetMs;
+}
+
+void MessageSenderWorker::sendBatch()
+{
+  if (m_replaySpeed > 0.0)
+  {
+    sendDueMessages();
+    return;
+  }
+
+  // refill the token bucket with the time elapsed since the previous tick
+  const qint64 nowNs = m_bucketClock.nsecsElapsed();
+  const double earnedTokens = (nowNs - m_lastRefillNs) * m_messagesPerSecond / nanosecondsPerSecond;
+  m_tokens = qMin(m_bucketCapacity, m_tokens + earnedTokens);
+  m_lastRefillNs = nowNs;
+
+  int skipped = 0;
+  while (m_tokens >= 1.0)
+  {
+    if (!sendNextMessage(skipped))
+      return;
+
+    m_tokens -= 1.0;
+  }
+}
+
+void MessageSenderWorker::sendBurst(int count)
+{
+  if (!m_messageParser)
+    return;
+
+  // a burst is sent all at once regardless of the pacing, so it
+  // neither uses nor earns tokens
+  int skipped = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    if (!sendNextMessage(skipped))
+      break;
+  }
+
+  if (m_messageParser)
+    reportStatistics();
+}
+
+bool MessageSenderWorker::sendNextMessage(int& skipped)
+{
+  while (true)
+  {
+    if (m_messageParser->atEnd() && !rewindAtEnd())
+      return false;
+
+    // messages for other destinations do not count as sent
+    const auto messageBytes = m_messageParser->nextMessage();
+    if (m_destination.matches(messageBytes))
+    {
+      send(messageBytes);
+      return true;
+    }
+
+    if (++skipped >= maxSkippedPerTick)
+      return false;
+  }
+}
+
+void MessageSenderWorker::sendDueMessages()
+{
+  // position in the recording that has been reached, on the monotonic clock
+  const qint64 replayedMs = m_replayOffsetMs + static_cast<qint64>(m_bucketClock.nsecsElapsed() * m_replaySpeed / nanosecondsPerMillisecond);
+
+  while (true)
+  {
+    if (m_messageParser->atEnd())
+    {
+      if (!rewindAtEnd())
+        return;
+
+      // a loop starts the recording over from its beginning
+      restartPacing();
+      m_sendTimer->start(0);
+      return;
+    }
+
+    // messages without a time are sent straight away
+    const qint64 messageTime = m_messageParser->nextMessageTime();
+    const qint64 messageOffsetMs = messageTime < 0 ? replayedMs : messageTime - m_replayStartTime;
+    if (messageOffsetMs > replayedMs)
+    {
+      // sleep until the next message is due, converted to wall clock time
+      const qint64 waitMs = static_cast<qint64>((messageOffsetMs - replayedMs) / m_replaySpeed);
+      m_sendTimer->start(static_cast<int>(qBound<qint64>(0, waitMs, maxReplayWaitMs)));
+      return;
+    }
+
+    // the recorded times are moved to the present so receivers do not
+    // discard the messages as stale
+    const auto messageBytes = m_messageParser->nextMessage();
+    if (!messageBytes.isEmpty() && m_destination.matches(messageBytes))
+      send(SimulatedMessage::retimeMessage(messageBytes, QDateTime::currentDateTimeUtc()));
+  }
+}
+
+bool MessageSenderWorker::rewindAtEnd()
+{
+  // reached end of the message parser
+  // check if simulation is looped, if not end the simulation
+  if (m_looped && m_messagesRead > 0)
+  {
+    m_messageParser->reset();
+    return true;
+  }
+
+  // if no messages have been read and we've reached the end of the parser
+  // then the simulation contains no messages
+  if (m_messagesRead == 0)
+  {
+    if (m_destination.isFiltered())
+      emit errorOccurred(tr("Simulation file contains no messages for destination ") + m_destination.name);
+    else
+      emit errorOccurred(tr("Simulation file contains no messages"));
+  }
+
+  stop();
+  emit finished();
+  return false;
+}
+
+void MessageSenderWorker::send(const QByteArray& message)
+{
+  // a parser that failed to read yields an empty message; skip it
+  if (message.isEmpty())
+    return;
+
+  m_messagesRead++;
+
+  // the tag is added last so that nothing before it has to skip over it
+  const QByteArray messageBytes = m_latencyTagging ? SimulatedMessage::tagMessage(message, m_senderId, m_sequence++) : message;
+
+  // failures are only counted; reporting each one would flood
+  // the receiving thread at high rates
+  if (m_dataSender->sendData(messageBytes) == -1)
+  {
+    m_sendErrors++;
+    return;
+  }
+
+  m_messagesSent++;
+
+  if (!m_sampleClock.isValid() || m_sampleClock.elapsed() >= historySampleIntervalMs)
+  {
+    m_sampleClock.start();
+    emit messageSampled(messageBytes);
+  }
+}
+
+void MessageSenderWorker::reportStatistics()
+{
+  const qint64 elapsedNs = m_statisticsClock.nsecsElapsed();
+  const qint64 sentSinceLastReport = m_messagesSent - m_lastReportedMessagesSent;
+  const double achievedRate = elapsedNs > 0 ? sentSinceLastReport * nanosecondsPerSecond / elapsedNs : 0.0;
+
+  m_statisticsClock.restart();
+  m_lastReportedMessagesSent = m_messagesSent;
+
+  emit statisticsUpdated(m_messagesSent, m_sendErrors, achievedRate);
+}
+
+void MessageSenderWorker::restartPacing()
+{
+  m_tokens = 0.0;
+  m_bucketClock.start();
+  m_lastRefillNs = 0;
+
+  // replay continues from the next message that is due
+  const qint64 nextMessageTime = m_messageParser ? m_messageParser->nextMessageTime() : -1;
+  m_replayOffsetMs = (m_replayStartTime >= 0 && nextMessageTime >= 0) ? nextMessageTime - m_replayStartTime : 0;
+}
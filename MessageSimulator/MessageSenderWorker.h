@@ -0,0 +1,107 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef MESSAGESENDERWORKER_H
+#define MESSAGESENDERWORKER_H
+
+#include "MessageDestination.h"
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QObject>
+#include <QUrl>
+
+namespace Dsa {
+class DataSender;
+}
+
+class AbstractMessageParser;
+class QTimer;
+class QUdpSocket;
+
+class MessageSenderWorker : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit MessageSenderWorker(QObject* parent = nullptr);
+  ~MessageSenderWorker();
+
+public slots:
+  void start(const QUrl& source, const MessageDestination& destination, double messagesPerSecond, bool looped, double replaySpeed,
+             bool latencyTagging);
+  void pause();
+  void resume();
+  void stop();
+  void setMessagesPerSecond(double messagesPerSecond);
+  void setReplaySpeed(double replaySpeed);
+  void seek(qint64 offsetMs);
+  void sendBurst(int count);
+
+signals:
+  void statisticsUpdated(qint64 messagesSent, qint64 sendErrors, double achievedRate);
+  void messageSampled(const QByteArray& message);
+  void errorOccurred(const QString& error);
+  void finished();
+
+private:
+  Q_DISABLE_COPY(MessageSenderWorker)
+
+  void sendBatch();
+  void sendDueMessages();
+  bool sendNextMessage(int& skipped);
+  bool rewindAtEnd();
+  void send(const QByteArray& message);
+  void reportStatistics();
+  void restartPacing();
+
+  Dsa::DataSender* m_dataSender = nullptr;
+  AbstractMessageParser* m_messageParser = nullptr;
+  QUdpSocket* m_udpSocket = nullptr;
+  QTimer* m_sendTimer = nullptr;
+  QTimer* m_statisticsTimer = nullptr;
+
+  MessageDestination m_destination;
+
+  QElapsedTimer m_bucketClock;
+  QElapsedTimer m_statisticsClock;
+  QElapsedTimer m_sampleClock;
+
+  double m_messagesPerSecond = 1.0;
+  double m_bucketCapacity = 1.0;
+  double m_tokens = 0.0;
+  qint64 m_lastRefillNs = 0;
+
+  // replay of recorded message times; a speed of 0 paces by rate instead
+  double m_replaySpeed = 0.0;
+  qint64 m_replayStartTime = -1;
+  qint64 m_replayOffsetMs = 0;
+
+  // messages read for this destination, whether or not they could be sent
+  qint64 m_messagesRead = 0;
+  qint64 m_messagesSent = 0;
+  qint64 m_sendErrors = 0;
+  qint64 m_lastReportedMessagesSent = 0;
+
+  // latency tags carry a per-run sender id and sequence number
+  bool m_latencyTagging = false;
+  quint32 m_senderId = 0;
+  qint64 m_sequence = 0;
+
+  bool m_looped = true;
+};
+
+#endif // MESSAGESENDERWORKER_H
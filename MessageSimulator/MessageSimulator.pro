@@ -25,21 +25,36 @@ INCLUDEPATH += \
     $$PWD/../Shared/utilities
 
 HEADERS += \
+    $$PWD/../Shared/messages/MessageLatencyTracker.h \
     $$PWD/../Shared/utilities/DataSender.h \
+    MessageDestination.h \
+    MessageFileIndex.h \
+    MessageSenderWorker.h \
     MessageSimulatorController.h \
+    ScenarioRunner.h \
     AbstractMessageParser.h \
     CoTMessageParser.h \
+    IndexedMessageParser.h \
     SimulatedMessage.h \
     SimulatedMessageListModel.h \
+    SyntheticPayloadGenerator.h \
+    SyntheticTrackGenerator.h \
     GeoMessageParser.h
 
 SOURCES += main.cpp \
     $$PWD/../Shared/utilities/DataSender.cpp \
     AbstractMessageParser.cpp \
     CoTMessageParser.cpp \
+    IndexedMessageParser.cpp \
+    MessageDestination.cpp \
+    MessageFileIndex.cpp \
+    MessageSenderWorker.cpp \
     MessageSimulatorController.cpp \
+    ScenarioRunner.cpp \
     SimulatedMessage.cpp \
     SimulatedMessageListModel.cpp \
+    SyntheticPayloadGenerator.cpp \
+    SyntheticTrackGenerator.cpp \
     GeoMessageParser.cpp
 
 RESOURCES += qml/qml.qrc \
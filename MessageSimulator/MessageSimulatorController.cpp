@@ -19,11 +19,16 @@
 // example app headers
 #include "AbstractMessageParser.h"
 #include "DataSender.h"
+#include "MessageSenderWorker.h"
 #include "SimulatedMessage.h"
 #include "SimulatedMessageListModel.h"
 
 // Qt headers
 #include <QSettings>
+#include <QVariantMap>
+
+const double MessageSimulatorController::MIN_REPLAY_SPEED = 0.1;
+const double MessageSimulatorController::MAX_REPLAY_SPEED = 100.0;
 
 MessageSimulatorController::MessageSimulatorController(QObject* parent) :
   QObject(parent),
@@ -58,15 +63,19 @@ MessageSimulatorController::MessageSimulatorController(QObject* parent) :
       }
     }
 
-    const auto messageBytes = m_messageParser->nextMessage();
+    auto messageBytes = m_messageParser->nextMessage();
     if (messageBytes.isEmpty())
     {
       emit errorOccurred(tr("Message is empty"));
       return;
     }
 
+    if (m_latencyTagging)
+      messageBytes = SimulatedMessage::tagMessage(messageBytes, m_senderId, m_sequence++);
+
     if (m_dataSender->sendData(messageBytes) == -1)
     {
+      m_sendErrors++;
       emit errorOccurred(tr("Failed to send message"));
       return;
     }
@@ -76,17 +85,18 @@ MessageSimulatorController::MessageSimulatorController(QObject* parent) :
 
   connect(m_dataSender, &Dsa::DataSender::dataSent, this, [this](const QByteArray& data)
   {
-    // create a simulated message to be added to the messages model
-    SimulatedMessage* simulatedMessage = SimulatedMessage::create(data, this);
-    if (!simulatedMessage)
-    {
-      emit errorOccurred(tr("Failed to create simulated message"));
-      return;
-    }
-
-    m_messages->append(simulatedMessage);
+    // the model keeps the raw bytes of the most recent messages
+    // and only decodes the rows that are displayed
+    m_messages->append(data);
   });
 
+  // destinations are handed to the sender threads through queued calls
+  qRegisterMetaType<MessageDestination>("MessageDestination");
+
+  // in normal mode the statistics are sampled from the send timer counters
+  m_statisticsTimer.setInterval(1000);
+  connect(&m_statisticsTimer, &QTimer::timeout, this, &MessageSimulatorController::updateStatistics);
+
   // load settings for the app if they exist
   loadSettings();
 }
@@ -95,6 +105,7 @@ MessageSimulatorController::~MessageSimulatorController()
 {
   // stop active simulation
   stopSimulation();
+  releaseSenders();
 }
 
 QUrl MessageSimulatorController::simulationFile() const
@@ -137,7 +148,15 @@ void MessageSimulatorController::setMessageFrequency(float messageFrequency)
     if (m_timer.isActive())
       m_timer.stop();
 
-    if (m_simulationState == SimulationState::Running)
+    if (usesSenderWorker())
+    {
+      for (const Sender& sender : m_senders)
+      {
+        QMetaObject::invokeMethod(sender.worker, "setMessagesPerSecond", Qt::QueuedConnection,
+                                  Q_ARG(double, senderMessagesPerSecond(sender)));
+      }
+    }
+    else if (m_simulationState == SimulationState::Running)
     {
       float messageFrequencyInSeconds = (timeUnitToSeconds(m_timeUnit) / messageFrequency);
       constexpr float millisecondsMultiplier = 1000.0f;
@@ -194,11 +213,202 @@ QAbstractListModel* MessageSimulatorController::messages() const
   return m_messages;
 }
 
+bool MessageSimulatorController::isHighRateMode() const
+{
+  return m_highRateMode;
+}
+
+void MessageSimulatorController::setHighRateMode(bool highRateMode)
+{
+  if (m_highRateMode == highRateMode)
+    return;
+
+  // the sending mode cannot be swapped while a simulation is active
+  if (m_simulationState != SimulationState::Stopped)
+  {
+    emit errorOccurred(tr("Stop the simulation before changing the high-rate mode"));
+    return;
+  }
+
+  m_highRateMode = highRateMode;
+
+  emit highRateModeChanged();
+}
+
+bool MessageSimulatorController::isReplayMode() const
+{
+  return m_replayMode;
+}
+
+void MessageSimulatorController::setReplayMode(bool replayMode)
+{
+  if (m_replayMode == replayMode)
+    return;
+
+  // the sending mode cannot be swapped while a simulation is active
+  if (m_simulationState != SimulationState::Stopped)
+  {
+    emit errorOccurred(tr("Stop the simulation before changing the replay mode"));
+    return;
+  }
+
+  m_replayMode = replayMode;
+
+  emit replayModeChanged();
+}
+
+double MessageSimulatorController::replaySpeed() const
+{
+  return m_replaySpeed;
+}
+
+void MessageSimulatorController::setReplaySpeed(double replaySpeed)
+{
+  replaySpeed = qBound(MIN_REPLAY_SPEED, replaySpeed, MAX_REPLAY_SPEED);
+  if (qFuzzyCompare(m_replaySpeed, replaySpeed))
+    return;
+
+  m_replaySpeed = replaySpeed;
+
+  if (m_replayMode)
+  {
+    for (const Sender& sender : m_senders)
+      QMetaObject::invokeMethod(sender.worker, "setReplaySpeed", Qt::QueuedConnection, Q_ARG(double, m_replaySpeed));
+  }
+
+  emit replaySpeedChanged();
+}
+
+qint64 MessageSimulatorController::messagesSent() const
+{
+  return m_messagesSent;
+}
+
+qint64 MessageSimulatorController::sendErrors() const
+{
+  return m_sendErrors;
+}
+
+double MessageSimulatorController::achievedRate() const
+{
+  return m_achievedRate;
+}
+
+int MessageSimulatorController::messageHistoryCapacity() const
+{
+  return m_messages->capacity();
+}
+
+void MessageSimulatorController::setMessageHistoryCapacity(int messageHistoryCapacity)
+{
+  if (m_messages->capacity() == messageHistoryCapacity)
+    return;
+
+  // a capacity of 0 turns the message history off
+  m_messages->setCapacity(messageHistoryCapacity);
+
+  emit messageHistoryCapacityChanged();
+}
+
+QUrl MessageSimulatorController::destinationsFile() const
+{
+  return m_destinationsFile;
+}
+
+void MessageSimulatorController::setDestinationsFile(const QUrl& destinationsFile)
+{
+  if (m_destinationsFile == destinationsFile)
+    return;
+
+  // the sending mode cannot be swapped while a simulation is active
+  if (m_simulationState != SimulationState::Stopped)
+  {
+    emit errorOccurred(tr("Stop the simulation before changing the destinations"));
+    return;
+  }
+
+  m_destinationsFile = destinationsFile;
+
+  emit destinationsFileChanged();
+}
+
+QVariantList MessageSimulatorController::destinationStatistics() const
+{
+  QVariantList statistics;
+  for (const Sender& sender : m_senders)
+  {
+    QVariantMap destinationStatistics;
+    destinationStatistics.insert(QStringLiteral("name"), sender.destination.name);
+    destinationStatistics.insert(QStringLiteral("address"), sender.destination.address == QHostAddress(QHostAddress::Broadcast) ?
+                                   QStringLiteral("broadcast") : sender.destination.address.toString());
+    destinationStatistics.insert(QStringLiteral("port"), sender.destination.port);
+    destinationStatistics.insert(QStringLiteral("messagesSent"), sender.messagesSent);
+    destinationStatistics.insert(QStringLiteral("sendErrors"), sender.sendErrors);
+    destinationStatistics.insert(QStringLiteral("achievedRate"), sender.achievedRate);
+    statistics.append(destinationStatistics);
+  }
+
+  return statistics;
+}
+
+bool MessageSimulatorController::isLatencyTagging() const
+{
+  return m_latencyTagging;
+}
+
+void MessageSimulatorController::setLatencyTagging(bool latencyTagging)
+{
+  if (m_latencyTagging == latencyTagging)
+    return;
+
+  // each message is prefixed with its send time and sequence number so
+  // that the receiving app can measure its latency
+  m_latencyTagging = latencyTagging;
+
+  emit latencyTaggingChanged();
+}
+
 void MessageSimulatorController::startSimulation(const QUrl& file)
 {
   // first stop the simulation if it was already running
   stopSimulation();
 
+  // clear the messages model
+  m_messages->clear();
+  resetStatistics();
+
+  if (m_simulationFile != file)
+  {
+    m_simulationFile = file;
+
+    emit simulationFileChanged();
+  }
+
+  if (usesSenderWorker())
+  {
+    if (!createSenders())
+      return;
+
+    // each worker opens its own socket and parser on its sender thread
+    for (const Sender& sender : m_senders)
+    {
+      QMetaObject::invokeMethod(sender.worker, "start", Qt::QueuedConnection,
+                                Q_ARG(QUrl, file),
+                                Q_ARG(MessageDestination, sender.destination),
+                                Q_ARG(double, senderMessagesPerSecond(sender)),
+                                Q_ARG(bool, m_simulationLooped),
+                                Q_ARG(double, m_replayMode ? m_replaySpeed : 0.0),
+                                Q_ARG(bool, m_latencyTagging));
+    }
+
+    m_simulationState = SimulationState::Running;
+
+    emit simulationStateChanged();
+
+    saveSettings();
+    return;
+  }
+
   // create UDP connection to broadcast address with specified port
   m_udpSocket = new QUdpSocket(this);
   m_udpSocket->connectToHost(QHostAddress::Broadcast, m_port, QIODevice::WriteOnly);
@@ -208,7 +418,7 @@ void MessageSimulatorController::startSimulation(const QUrl& file)
     delete m_messageParser;
 
   // create a message parser with specified input file
-  m_messageParser = AbstractMessageParser::createMessageParser(file.toLocalFile(), this);
+  m_messageParser = AbstractMessageParser::createMessageParser(file, this);
   if (!m_messageParser)
   {
     emit errorOccurred(tr("Failed to create message parser with input file"));
@@ -217,19 +427,13 @@ void MessageSimulatorController::startSimulation(const QUrl& file)
 
   connect(m_messageParser, &AbstractMessageParser::errorOccurred, this, &MessageSimulatorController::errorOccurred);
 
-  // clear the messages model
-  m_messages->clear();
-
-  if (m_simulationFile != file)
-  {
-    m_simulationFile = file;
-
-    emit simulationFileChanged();
-  }
+  m_senderId = SimulatedMessage::createSenderId();
+  m_sequence = 0;
 
   m_simulationState = SimulationState::Running;
   setMessageFrequency(m_messageFrequency);
-  m_messagesSent = 0;
+  m_statisticsClock.start();
+  m_statisticsTimer.start();
 
   emit simulationStateChanged();
 
@@ -241,6 +445,10 @@ void MessageSimulatorController::pauseSimulation()
 {
   m_simulationState = SimulationState::Paused;
   m_timer.stop();
+  m_statisticsTimer.stop();
+
+  for (const Sender& sender : m_senders)
+    QMetaObject::invokeMethod(sender.worker, "pause", Qt::QueuedConnection);
 
   emit simulationStateChanged();
 }
@@ -250,6 +458,18 @@ void MessageSimulatorController::resumeSimulation()
   m_simulationState = SimulationState::Running;
   setMessageFrequency(m_messageFrequency);
 
+  if (usesSenderWorker())
+  {
+    for (const Sender& sender : m_senders)
+      QMetaObject::invokeMethod(sender.worker, "resume", Qt::QueuedConnection);
+  }
+  else
+  {
+    m_lastReportedMessagesSent = m_messagesSent;
+    m_statisticsClock.start();
+    m_statisticsTimer.start();
+  }
+
   emit simulationStateChanged();
 }
 
@@ -262,6 +482,20 @@ void MessageSimulatorController::stopSimulation()
   m_timer.stop();
   m_simulationState = SimulationState::Stopped;
 
+  if (usesSenderWorker())
+  {
+    // block until the workers have released their sockets so a new
+    // simulation can safely be started straight away; the threads are kept
+    // until then so that the final statistics still arrive
+    for (const Sender& sender : m_senders)
+      QMetaObject::invokeMethod(sender.worker, "stop", Qt::BlockingQueuedConnection);
+  }
+  else if (m_statisticsTimer.isActive())
+  {
+    m_statisticsTimer.stop();
+    updateStatistics();
+  }
+
   if (m_udpSocket)
   {
     if (m_udpSocket->isOpen())
@@ -274,6 +508,22 @@ void MessageSimulatorController::stopSimulation()
   emit simulationStateChanged();
 }
 
+void MessageSimulatorController::seekSimulation(double offsetSeconds)
+{
+  if (!m_replayMode || m_simulationState == SimulationState::Stopped)
+  {
+    emit errorOccurred(tr("Seeking is only available while replaying a simulation"));
+    return;
+  }
+
+  constexpr double millisecondsMultiplier = 1000.0;
+  for (const Sender& sender : m_senders)
+  {
+    QMetaObject::invokeMethod(sender.worker, "seek", Qt::QueuedConnection,
+                              Q_ARG(qint64, static_cast<qint64>(qMax(0.0, offsetSeconds) * millisecondsMultiplier)));
+  }
+}
+
 void MessageSimulatorController::sendMessage(const QString& message)
 {
   m_dataSender->sendData(message.toUtf8());
@@ -287,6 +537,13 @@ void MessageSimulatorController::saveSettings()
   settings.setValue("messageFrequency", m_messageFrequency);
   settings.setValue("timeUnit", fromTimeUnit(m_timeUnit));
   settings.setValue("loop", m_simulationLooped);
+  settings.setValue("highRateMode", m_highRateMode);
+  settings.setValue("replayMode", m_replayMode);
+  settings.setValue("replaySpeed", m_replaySpeed);
+  settings.setValue("latencyTagging", m_latencyTagging);
+
+  // destinations are only given on the command line, so they do not carry over to later sessions
+  settings.remove("destinationsFile");
 }
 
 void MessageSimulatorController::loadSettings()
@@ -297,6 +554,159 @@ void MessageSimulatorController::loadSettings()
   setMessageFrequency(settings.value("messageFrequency", 1.0f).toFloat());
   setTimeUnit(toTimeUnit(settings.value("timeUnit", "seconds").toString()));
   setSimulationLooped(settings.value("loop", true).toBool());
+  setHighRateMode(settings.value("highRateMode", false).toBool());
+  setReplayMode(settings.value("replayMode", false).toBool());
+  setReplaySpeed(settings.value("replaySpeed", 1.0).toDouble());
+  setLatencyTagging(settings.value("latencyTagging", false).toBool());
+}
+
+void MessageSimulatorController::updateStatistics()
+{
+  const qint64 elapsedMs = m_statisticsClock.restart();
+  const qint64 sentSinceLastUpdate = m_messagesSent - m_lastReportedMessagesSent;
+  m_achievedRate = elapsedMs > 0 ? (sentSinceLastUpdate * 1000.0) / elapsedMs : 0.0;
+  m_lastReportedMessagesSent = m_messagesSent;
+
+  emit statisticsChanged();
+}
+
+void MessageSimulatorController::resetStatistics()
+{
+  m_messagesSent = 0;
+  m_sendErrors = 0;
+  m_lastReportedMessagesSent = 0;
+  m_achievedRate = 0.0;
+
+  emit statisticsChanged();
+}
+
+bool MessageSimulatorController::usesSenderWorker() const
+{
+  return m_highRateMode || m_replayMode || !m_destinationsFile.isEmpty();
+}
+
+double MessageSimulatorController::messagesPerSecond() const
+{
+  return m_messageFrequency / timeUnitToSeconds(m_timeUnit);
+}
+
+bool MessageSimulatorController::createSenders()
+{
+  releaseSenders();
+
+  // without a destinations file everything is broadcast on the one port
+  QList<MessageDestination> destinations;
+  if (m_destinationsFile.isEmpty())
+  {
+    MessageDestination destination;
+    destination.port = m_port;
+    destinations.append(destination);
+  }
+  else
+  {
+    QString errorString;
+    destinations = MessageDestination::loadDestinations(m_destinationsFile.toLocalFile(), m_port, errorString);
+    if (!errorString.isEmpty())
+    {
+      emit errorOccurred(errorString);
+      return false;
+    }
+  }
+
+  for (const MessageDestination& destination : destinations)
+  {
+    auto thread = new QThread(this);
+    auto worker = new MessageSenderWorker();
+    worker->moveToThread(thread);
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(worker, &MessageSenderWorker::errorOccurred, this, &MessageSimulatorController::errorOccurred);
+
+    connect(worker, &MessageSenderWorker::finished, this, [this, worker]
+    {
+      const int index = senderIndex(worker);
+      if (index == -1)
+        return;
+
+      m_senders[index].finished = true;
+
+      // the simulation ends once every destination has run out of messages
+      for (const Sender& sender : m_senders)
+      {
+        if (!sender.finished)
+          return;
+      }
+
+      stopSimulation();
+    });
+
+    // the workers send too fast to show every message, so the history gets a sample of them
+    connect(worker, &MessageSenderWorker::messageSampled, this, [this, worker](const QByteArray& message)
+    {
+      if (senderIndex(worker) != -1)
+        m_messages->append(message);
+    });
+
+    connect(worker, &MessageSenderWorker::statisticsUpdated, this, [this, worker](qint64 messagesSent, qint64 sendErrors, double achievedRate)
+    {
+      // statistics from the workers of a previous simulation are dropped
+      const int index = senderIndex(worker);
+      if (index == -1)
+        return;
+
+      Sender& sender = m_senders[index];
+      sender.messagesSent = messagesSent;
+      sender.sendErrors = sendErrors;
+      sender.achievedRate = achievedRate;
+
+      m_messagesSent = 0;
+      m_sendErrors = 0;
+      m_achievedRate = 0.0;
+      for (const Sender& s : m_senders)
+      {
+        m_messagesSent += s.messagesSent;
+        m_sendErrors += s.sendErrors;
+        m_achievedRate += s.achievedRate;
+      }
+
+      emit statisticsChanged();
+    });
+
+    thread->start();
+
+    m_senders.append(Sender{destination, thread, worker, 0, 0, 0.0, false});
+  }
+
+  return true;
+}
+
+void MessageSimulatorController::releaseSenders()
+{
+  for (const Sender& sender : m_senders)
+  {
+    // the worker is deleted by the thread as it finishes
+    sender.thread->quit();
+    sender.thread->wait();
+    delete sender.thread;
+  }
+
+  m_senders.clear();
+}
+
+int MessageSimulatorController::senderIndex(const MessageSenderWorker* worker) const
+{
+  for (int i = 0; i < m_senders.size(); ++i)
+  {
+    if (m_senders.at(i).worker == worker)
+      return i;
+  }
+
+  return -1;
+}
+
+double MessageSimulatorController::senderMessagesPerSecond(const Sender& sender) const
+{
+  // a destination with its own rate is paced independently of the frequency
+  return sender.destination.messagesPerSecond > 0.0 ? sender.destination.messagesPerSecond : messagesPerSecond();
 }
 
 QString MessageSimulatorController::fromTimeUnit(TimeUnit timeUnit)
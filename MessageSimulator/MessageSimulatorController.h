@@ -17,19 +17,25 @@
 #ifndef MESSAGESIMULATORCONTROLLER_H
 #define MESSAGESIMULATORCONTROLLER_H
 
+#include "MessageDestination.h"
 
 // Qt headers
 #include <QAbstractListModel>
+#include <QElapsedTimer>
 #include <QObject>
+#include <QThread>
 #include <QTimer>
 #include <QUdpSocket>
 #include <QUrl>
+#include <QVariantList>
+#include <QVector>
 
 namespace Dsa {
 class DataSender;
 }
 
 class AbstractMessageParser;
+class MessageSenderWorker;
 class SimulatedMessageListModel;
 
 class MessageSimulatorController : public QObject
@@ -43,6 +49,15 @@ class MessageSimulatorController : public QObject
   Q_PROPERTY(float messageFrequency READ messageFrequency WRITE setMessageFrequency NOTIFY messageFrequencyChanged)
   Q_PROPERTY(TimeUnit timeUnit READ timeUnit WRITE setTimeUnit NOTIFY timeUnitChanged)
   Q_PROPERTY(QAbstractListModel* messages READ messages NOTIFY messagesChanged)
+  Q_PROPERTY(bool highRateMode READ isHighRateMode WRITE setHighRateMode NOTIFY highRateModeChanged)
+  Q_PROPERTY(bool replayMode READ isReplayMode WRITE setReplayMode NOTIFY replayModeChanged)
+  Q_PROPERTY(double replaySpeed READ replaySpeed WRITE setReplaySpeed NOTIFY replaySpeedChanged)
+  Q_PROPERTY(qint64 messagesSent READ messagesSent NOTIFY statisticsChanged)
+  Q_PROPERTY(qint64 sendErrors READ sendErrors NOTIFY statisticsChanged)
+  Q_PROPERTY(double achievedRate READ achievedRate NOTIFY statisticsChanged)
+  Q_PROPERTY(int messageHistoryCapacity READ messageHistoryCapacity WRITE setMessageHistoryCapacity NOTIFY messageHistoryCapacityChanged)
+  Q_PROPERTY(QUrl destinationsFile READ destinationsFile WRITE setDestinationsFile NOTIFY destinationsFileChanged)
+  Q_PROPERTY(bool latencyTagging READ isLatencyTagging WRITE setLatencyTagging NOTIFY latencyTaggingChanged)
 
 public:
   enum class TimeUnit
@@ -62,6 +77,9 @@ public:
   Q_ENUM(TimeUnit)
   Q_ENUM(SimulationState)
 
+  static const double MIN_REPLAY_SPEED;
+  static const double MAX_REPLAY_SPEED;
+
   explicit MessageSimulatorController(QObject* parent = nullptr);
   ~MessageSimulatorController();
 
@@ -84,10 +102,35 @@ public:
 
   QAbstractListModel* messages() const;
 
+  bool isHighRateMode() const;
+  void setHighRateMode(bool highRateMode);
+
+  bool isReplayMode() const;
+  void setReplayMode(bool replayMode);
+
+  double replaySpeed() const;
+  void setReplaySpeed(double replaySpeed);
+
+  qint64 messagesSent() const;
+  qint64 sendErrors() const;
+  double achievedRate() const;
+
+  int messageHistoryCapacity() const;
+  void setMessageHistoryCapacity(int messageHistoryCapacity);
+
+  QUrl destinationsFile() const;
+  void setDestinationsFile(const QUrl& destinationsFile);
+
+  Q_INVOKABLE QVariantList destinationStatistics() const;
+
+  bool isLatencyTagging() const;
+  void setLatencyTagging(bool latencyTagging);
+
   Q_INVOKABLE void startSimulation(const QUrl& file);
   Q_INVOKABLE void pauseSimulation();
   Q_INVOKABLE void resumeSimulation();
   Q_INVOKABLE void stopSimulation();
+  Q_INVOKABLE void seekSimulation(double offsetSeconds);
 
   Q_INVOKABLE void sendMessage(const QString& message);
 
@@ -102,6 +145,13 @@ signals:
   void messageFrequencyChanged();
   void timeUnitChanged();
   void messagesChanged();
+  void highRateModeChanged();
+  void replayModeChanged();
+  void replaySpeedChanged();
+  void statisticsChanged();
+  void messageHistoryCapacityChanged();
+  void destinationsFileChanged();
+  void latencyTaggingChanged();
   void errorOccurred(const QString& error);
 
 private:
@@ -110,6 +160,27 @@ private:
   void saveSettings();
   void loadSettings();
 
+  void updateStatistics();
+  void resetStatistics();
+  bool usesSenderWorker() const;
+  double messagesPerSecond() const;
+
+  struct Sender
+  {
+    MessageDestination destination;
+    QThread* thread;
+    MessageSenderWorker* worker;
+    qint64 messagesSent;
+    qint64 sendErrors;
+    double achievedRate;
+    bool finished;
+  };
+
+  bool createSenders();
+  void releaseSenders();
+  int senderIndex(const MessageSenderWorker* worker) const;
+  double senderMessagesPerSecond(const Sender& sender) const;
+
   static float timeUnitToSeconds(TimeUnit timeUnit);
 
   Dsa::DataSender* m_dataSender = nullptr;
@@ -119,13 +190,29 @@ private:
   QUdpSocket* m_udpSocket = nullptr;
   QTimer m_timer;
 
+  // one sender worker, each on its own thread, per destination
+  QVector<Sender> m_senders;
+
+  QTimer m_statisticsTimer;
+  QElapsedTimer m_statisticsClock;
+
   QUrl m_simulationFile;
+  QUrl m_destinationsFile;
 
   int m_port = -1;
   float m_messageFrequency = 1;
   qint64 m_messagesSent = 0;
+  qint64 m_sendErrors = 0;
+  qint64 m_lastReportedMessagesSent = 0;
+  double m_achievedRate = 0.0;
 
   bool m_simulationLooped = true;
+  bool m_highRateMode = false;
+  bool m_replayMode = false;
+  bool m_latencyTagging = false;
+  quint32 m_senderId = 0;
+  qint64 m_sequence = 0;
+  double m_replaySpeed = 1.0;
   SimulationState m_simulationState = SimulationState::Stopped;
 
   TimeUnit m_timeUnit = TimeUnit::Seconds;
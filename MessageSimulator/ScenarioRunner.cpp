@@ -0,0 +1,511 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#include "ScenarioRunner.h"
+
+// example app headers
+#include "MessageSenderWorker.h"
+#include "SyntheticPayloadGenerator.h"
+#include "SyntheticTrackGenerator.h"
+
+// Qt headers
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QThread>
+#include <QUrlQuery>
+
+namespace
+{
+const QString nameKey{QStringLiteral("name")};
+const QString portKey{QStringLiteral("port")};
+const QString resultsKey{QStringLiteral("results")};
+const QString latencyTaggingKey{QStringLiteral("latencyTagging")};
+const QString phasesKey{QStringLiteral("phases")};
+const QString durationKey{QStringLiteral("duration")};
+const QString streamsKey{QStringLiteral("streams")};
+const QString sourceKey{QStringLiteral("source")};
+const QString fileKey{QStringLiteral("file")};
+const QString rampToKey{QStringLiteral("rampTo")};
+const QString burstKey{QStringLiteral("burst")};
+const QString everyKey{QStringLiteral("every")};
+
+const QString tracksSource{QStringLiteral("tracks")};
+const QString fileSource{QStringLiteral("file")};
+const QString markupSource{QStringLiteral("markup")};
+const QString reportSource{QStringLiteral("report")};
+
+// scenario options that are passed through to the generators
+const QStringList trackOptions{ QStringLiteral("tracks"), QStringLiteral("speed"), QStringLiteral("motion"),
+                                QStringLiteral("format"), QStringLiteral("seed"), QStringLiteral("bbox") };
+const QStringList payloadOptions{ QStringLiteral("size"), QStringLiteral("type"), QStringLiteral("seed"), QStringLiteral("bbox") };
+
+// how often ramped rates are adjusted and bursts are checked
+const int updateIntervalMs = 250;
+
+const double millisecondsPerSecond = 1000.0;
+
+QUrlQuery optionsQuery(const QJsonObject& json, const QStringList& options)
+{
+  QUrlQuery query;
+  for (const QString& option : options)
+  {
+    if (json.contains(option))
+      query.addQueryItem(option, json.value(option).toVariant().toString());
+  }
+
+  return query;
+}
+}
+
+ScenarioRunner::ScenarioRunner(QObject* parent) :
+  QObject(parent)
+{
+  m_phaseTimer.setSingleShot(true);
+  m_phaseTimer.setTimerType(Qt::PreciseTimer);
+  connect(&m_phaseTimer, &QTimer::timeout, this, &ScenarioRunner::finishPhase);
+
+  m_updateTimer.setInterval(updateIntervalMs);
+  connect(&m_updateTimer, &QTimer::timeout, this, &ScenarioRunner::updateStreams);
+}
+
+ScenarioRunner::~ScenarioRunner()
+{
+  for (const RunningStream& stream : m_runningStreams)
+    QMetaObject::invokeMethod(stream.worker, "stop", Qt::BlockingQueuedConnection);
+
+  releaseStreams();
+}
+
+bool ScenarioRunner::load(const QString& filePath)
+{
+  m_errorString.clear();
+  m_phases.clear();
+
+  QFile file(filePath);
+  if (!file.open(QFile::ReadOnly))
+  {
+    m_errorString = tr("Could not open ") + filePath + tr(" for reading");
+    return false;
+  }
+
+  QJsonParseError parseError;
+  const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (document.isNull())
+  {
+    m_errorString = tr("Could not parse ") + filePath + QStringLiteral(": ") + parseError.errorString();
+    return false;
+  }
+
+  // files named in the scenario are relative to the scenario itself
+  const QJsonObject scenario = document.object();
+  const QString scenarioDir = QFileInfo(filePath).absolutePath();
+  const int defaultPort = scenario.value(portKey).toInt(-1);
+
+  m_name = scenario.value(nameKey).toString(QFileInfo(filePath).baseName());
+  m_latencyTagging = scenario.value(latencyTaggingKey).toBool(false);
+  m_resultsFilePath.clear();
+  if (scenario.contains(resultsKey))
+    m_resultsFilePath = QDir(scenarioDir).absoluteFilePath(scenario.value(resultsKey).toString());
+
+  QVector<Phase> phases;
+  for (const QJsonValue& phaseValue : scenario.value(phasesKey).toArray())
+  {
+    const QJsonObject phaseJson = phaseValue.toObject();
+
+    Phase phase;
+    phase.name = phaseJson.value(nameKey).toString(tr("Phase ") + QString::number(phases.size() + 1));
+    phase.durationMs = static_cast<qint64>(phaseJson.value(durationKey).toDouble(0.0) * millisecondsPerSecond);
+    if (phase.durationMs <= 0)
+    {
+      m_errorString = tr("Phase ") + phase.name + tr(" has no duration");
+      return false;
+    }
+
+    for (const QJsonValue& streamValue : phaseJson.value(streamsKey).toArray())
+    {
+      Stream stream;
+      if (!readStream(streamValue.toObject(), scenarioDir, defaultPort, stream))
+      {
+        m_errorString = tr("Phase ") + phase.name + QStringLiteral(": ") + m_errorString;
+        return false;
+      }
+
+      phase.streams.append(stream);
+    }
+
+    if (phase.streams.isEmpty())
+    {
+      m_errorString = tr("Phase ") + phase.name + tr(" has no streams");
+      return false;
+    }
+
+    phases.append(phase);
+  }
+
+  if (phases.isEmpty())
+  {
+    m_errorString = filePath + tr(" defines no phases");
+    return false;
+  }
+
+  m_phases = phases;
+  return true;
+}
+
+QString ScenarioRunner::errorString() const
+{
+  return m_errorString;
+}
+
+QString ScenarioRunner::name() const
+{
+  return m_name;
+}
+
+int ScenarioRunner::phaseCount() const
+{
+  return m_phases.size();
+}
+
+QString ScenarioRunner::resultsFilePath() const
+{
+  return m_resultsFilePath;
+}
+
+void ScenarioRunner::setLatencyTagging(bool latencyTagging)
+{
+  m_latencyTagging = latencyTagging;
+}
+
+bool ScenarioRunner::isRunning() const
+{
+  return m_phaseIndex != -1;
+}
+
+void ScenarioRunner::start()
+{
+  if (isRunning())
+    return;
+
+  if (m_phases.isEmpty())
+  {
+    emit errorOccurred(tr("No scenario has been loaded"));
+    return;
+  }
+
+  m_stopRequested = false;
+  startPhase(0);
+}
+
+void ScenarioRunner::stop()
+{
+  if (!isRunning())
+    return;
+
+  // the current phase is cut short and still reported
+  m_stopRequested = true;
+  if (!m_phaseFinishing)
+    finishPhase();
+}
+
+bool ScenarioRunner::readStream(const QJsonObject& json, const QString& scenarioDir, int defaultPort, Stream& stream)
+{
+  // the address, port, rate and filters are read as for a destination
+  QString errorString;
+  stream.destination = MessageDestination::fromJson(json, defaultPort, errorString);
+  if (!errorString.isEmpty())
+  {
+    m_errorString = errorString;
+    return false;
+  }
+
+  const QString name = stream.destination.name;
+  stream.messagesPerSecond = stream.destination.messagesPerSecond;
+  stream.rampToMessagesPerSecond = json.value(rampToKey).toDouble(-1.0);
+  stream.burstCount = json.value(burstKey).toInt(0);
+  stream.burstIntervalMs = static_cast<qint64>(json.value(everyKey).toDouble(0.0) * millisecondsPerSecond);
+
+  if (stream.burstCount > 0 && stream.burstIntervalMs <= 0)
+  {
+    m_errorString = tr("Stream ") + name + tr(" has a burst but no interval");
+    return false;
+  }
+
+  if (stream.burstCount <= 0 && stream.messagesPerSecond <= 0.0)
+  {
+    m_errorString = tr("Stream ") + name + tr(" has no rate");
+    return false;
+  }
+
+  const QString source = json.value(sourceKey).toString();
+  if (source.compare(tracksSource, Qt::CaseInsensitive) == 0)
+  {
+    // normalise the options through the generator's own parameters
+    QUrl url;
+    url.setScheme(SyntheticTrackGenerator::URL_SCHEME);
+    url.setQuery(optionsQuery(json, trackOptions));
+    stream.source = SyntheticTrackGenerator::urlFromParameters(SyntheticTrackGenerator::parametersFromUrl(url));
+  }
+  else if (source.compare(markupSource, Qt::CaseInsensitive) == 0 || source.compare(reportSource, Qt::CaseInsensitive) == 0)
+  {
+    QUrl url;
+    url.setScheme(SyntheticPayloadGenerator::URL_SCHEME);
+    url.setPath(source.toLower());
+    url.setQuery(optionsQuery(json, payloadOptions));
+    stream.source = SyntheticPayloadGenerator::urlFromParameters(SyntheticPayloadGenerator::parametersFromUrl(url));
+  }
+  else if (source.compare(fileSource, Qt::CaseInsensitive) == 0)
+  {
+    const QString filePath = QDir(scenarioDir).absoluteFilePath(json.value(fileKey).toString());
+    if (!QFileInfo(filePath).isFile())
+    {
+      m_errorString = tr("Stream ") + name + tr(" names a simulation file that does not exist: ") + filePath;
+      return false;
+    }
+
+    stream.source = QUrl::fromLocalFile(filePath);
+  }
+  else
+  {
+    m_errorString = tr("Stream ") + name + tr(" has an unknown source ") + source;
+    return false;
+  }
+
+  return true;
+}
+
+void ScenarioRunner::startPhase(int index)
+{
+  m_phaseIndex = index;
+  m_phaseFinishing = false;
+
+  const Phase& phase = m_phases.at(index);
+  for (const Stream& stream : phase.streams)
+  {
+    auto thread = new QThread(this);
+    auto worker = new MessageSenderWorker();
+    worker->moveToThread(thread);
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(worker, &MessageSenderWorker::errorOccurred, this, &ScenarioRunner::errorOccurred);
+
+    connect(worker, &MessageSenderWorker::statisticsUpdated, this, [this, worker](qint64 messagesSent, qint64 sendErrors, double)
+    {
+      // the runner works out the rates itself over the whole phase
+      const int streamIndex = runningStreamIndex(worker);
+      if (streamIndex == -1)
+        return;
+
+      m_runningStreams[streamIndex].messagesSent = messagesSent;
+      m_runningStreams[streamIndex].sendErrors = sendErrors;
+    });
+
+    thread->start();
+
+    // every stream loops for as long as the phase lasts
+    QMetaObject::invokeMethod(worker, "start", Qt::QueuedConnection,
+                              Q_ARG(QUrl, stream.source),
+                              Q_ARG(MessageDestination, stream.destination),
+                              Q_ARG(double, stream.burstCount > 0 ? 1.0 : stream.messagesPerSecond),
+                              Q_ARG(bool, true),
+                              Q_ARG(double, 0.0),
+                              Q_ARG(bool, m_latencyTagging));
+
+    // a burst stream only sends when it is told to
+    if (stream.burstCount > 0)
+      QMetaObject::invokeMethod(worker, "pause", Qt::QueuedConnection);
+
+    m_runningStreams.append(RunningStream{thread, worker, 0, 0, 0, 0});
+  }
+
+  m_phaseClock.start();
+  m_phaseTimer.start(static_cast<int>(phase.durationMs));
+  m_updateTimer.start();
+
+  emit phaseStarted(index, phase.name);
+
+  // the first bursts go out as the phase begins
+  updateStreams();
+}
+
+void ScenarioRunner::finishPhase()
+{
+  m_phaseFinishing = true;
+  m_phaseTimer.stop();
+  m_updateTimer.stop();
+  m_phaseElapsedMs = m_phaseClock.elapsed();
+
+  // stopping makes each worker report its final statistics
+  for (const RunningStream& stream : m_runningStreams)
+    QMetaObject::invokeMethod(stream.worker, "stop", Qt::BlockingQueuedConnection);
+
+  // the final statistics are queued to this thread, so the
+  // phase is completed only once they have been delivered
+  QMetaObject::invokeMethod(this, "completePhase", Qt::QueuedConnection);
+}
+
+void ScenarioRunner::completePhase()
+{
+  const Phase& phase = m_phases.at(m_phaseIndex);
+  const double durationSeconds = m_phaseElapsedMs / millisecondsPerSecond;
+
+  qint64 totalSent = 0;
+  qint64 totalErrors = 0;
+  QJsonArray streams;
+  for (int i = 0; i < phase.streams.size(); ++i)
+  {
+    const Stream& stream = phase.streams.at(i);
+    const RunningStream& runningStream = m_runningStreams.at(i);
+
+    QJsonObject streamResult;
+    streamResult.insert(QStringLiteral("name"), stream.destination.name);
+    streamResult.insert(QStringLiteral("source"), stream.source.toString());
+    streamResult.insert(QStringLiteral("address"), stream.destination.address.toString());
+    streamResult.insert(QStringLiteral("port"), stream.destination.port);
+    streamResult.insert(QStringLiteral("messagesSent"), runningStream.messagesSent);
+    streamResult.insert(QStringLiteral("sendErrors"), runningStream.sendErrors);
+    streamResult.insert(QStringLiteral("achievedRate"), durationSeconds > 0.0 ? runningStream.messagesSent / durationSeconds : 0.0);
+
+    if (stream.burstCount > 0)
+    {
+      streamResult.insert(QStringLiteral("burst"), stream.burstCount);
+      streamResult.insert(QStringLiteral("bursts"), runningStream.burstsSent);
+    }
+    else
+    {
+      // a ramp is planned to average the rates at either end
+      const double endRate = streamMessagesPerSecond(stream, m_phaseElapsedMs);
+      streamResult.insert(QStringLiteral("targetRate"), (stream.messagesPerSecond + endRate) / 2.0);
+    }
+
+    streams.append(streamResult);
+    totalSent += runningStream.messagesSent;
+    totalErrors += runningStream.sendErrors;
+  }
+
+  QJsonObject result;
+  result.insert(QStringLiteral("scenario"), m_name);
+  result.insert(QStringLiteral("phase"), phase.name);
+  result.insert(QStringLiteral("index"), m_phaseIndex);
+  result.insert(QStringLiteral("completed"), !m_stopRequested);
+  result.insert(QStringLiteral("finishedAt"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+  result.insert(QStringLiteral("plannedDuration"), phase.durationMs / millisecondsPerSecond);
+  result.insert(QStringLiteral("duration"), durationSeconds);
+  result.insert(QStringLiteral("messagesSent"), totalSent);
+  result.insert(QStringLiteral("sendErrors"), totalErrors);
+  result.insert(QStringLiteral("achievedRate"), durationSeconds > 0.0 ? totalSent / durationSeconds : 0.0);
+  result.insert(QStringLiteral("streams"), streams);
+
+  releaseStreams();
+  writeResult(result);
+
+  emit phaseFinished(result);
+
+  const int nextIndex = m_phaseIndex + 1;
+  if (m_stopRequested || nextIndex >= m_phases.size())
+  {
+    m_phaseIndex = -1;
+    m_phaseFinishing = false;
+    emit finished();
+    return;
+  }
+
+  startPhase(nextIndex);
+}
+
+void ScenarioRunner::updateStreams()
+{
+  const qint64 elapsedMs = m_phaseClock.elapsed();
+  const Phase& phase = m_phases.at(m_phaseIndex);
+
+  for (int i = 0; i < phase.streams.size(); ++i)
+  {
+    const Stream& stream = phase.streams.at(i);
+    RunningStream& runningStream = m_runningStreams[i];
+
+    if (stream.burstCount > 0)
+    {
+      // a late update sends a single burst rather than catching up
+      if (elapsedMs < runningStream.nextBurstMs)
+        continue;
+
+      QMetaObject::invokeMethod(runningStream.worker, "sendBurst", Qt::QueuedConnection, Q_ARG(int, stream.burstCount));
+      runningStream.burstsSent++;
+      runningStream.nextBurstMs = (elapsedMs / stream.burstIntervalMs + 1) * stream.burstIntervalMs;
+    }
+    else if (stream.rampToMessagesPerSecond >= 0.0)
+    {
+      QMetaObject::invokeMethod(runningStream.worker, "setMessagesPerSecond", Qt::QueuedConnection,
+                                Q_ARG(double, streamMessagesPerSecond(stream, elapsedMs)));
+    }
+  }
+}
+
+void ScenarioRunner::releaseStreams()
+{
+  for (const RunningStream& stream : m_runningStreams)
+  {
+    // the worker is deleted by the thread as it finishes
+    stream.thread->quit();
+    stream.thread->wait();
+    delete stream.thread;
+  }
+
+  m_runningStreams.clear();
+}
+
+void ScenarioRunner::writeResult(const QJsonObject& result)
+{
+  if (m_resultsFilePath.isEmpty())
+    return;
+
+  // one line per phase so that results of several runs can be appended
+  QFile file(m_resultsFilePath);
+  if (!file.open(QFile::WriteOnly | QFile::Append))
+  {
+    emit errorOccurred(tr("Could not open ") + m_resultsFilePath + tr(" for writing"));
+    return;
+  }
+
+  file.write(QJsonDocument(result).toJson(QJsonDocument::Compact));
+  file.write("\n");
+}
+
+double ScenarioRunner::streamMessagesPerSecond(const Stream& stream, qint64 elapsedMs) const
+{
+  if (stream.rampToMessagesPerSecond < 0.0)
+    return stream.messagesPerSecond;
+
+  const qint64 durationMs = m_phases.at(m_phaseIndex).durationMs;
+  const double progress = qBound(0.0, static_cast<double>(elapsedMs) / durationMs, 1.0);
+
+  // the worker ignores a rate of zero, so a ramp down ends just above it
+  return qMax(0.1, stream.messagesPerSecond + (stream.rampToMessagesPerSecond - stream.messagesPerSecond) * progress);
+}
+
+int ScenarioRunner::runningStreamIndex(const MessageSenderWorker* worker) const
+{
+  for (int i = 0; i < m_runningStreams.size(); ++i)
+  {
+    if (m_runningStreams.at(i).worker == worker)
+      return i;
+  }
+
+  return -1;
+}
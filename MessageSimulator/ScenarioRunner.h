@@ -0,0 +1,144 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef SCENARIORUNNER_H
+#define SCENARIORUNNER_H
+
+#include "MessageDestination.h"
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+
+class MessageSenderWorker;
+class QThread;
+
+// Runs a stress test scenario: a JSON document of consecutive phases, each of
+// which sends several streams of messages at once. For example
+//
+// { "name": "peak load", "port": 45678, "results": "results.jsonl",
+//   "phases": [
+//   { "name": "warm up", "duration": 30, "streams": [
+//     { "name": "tracks", "source": "tracks", "tracks": 1000, "rate": 100, "rampTo": 2000 } ] },
+//   { "name": "peak", "duration": 60, "streams": [
+//     { "name": "tracks", "source": "tracks", "tracks": 1000, "rate": 2000, "rampTo": 200 },
+//     { "name": "replay", "source": "file", "file": "sample.xml", "port": 45679, "rate": 50 },
+//     { "name": "markup", "source": "markup", "size": 16384, "port": 12345, "rate": 2 },
+//     { "name": "reports", "source": "report", "type": "spotrep", "burst": 500, "every": 10 } ] } ] }
+//
+// "duration" and "every" are in seconds and "rate" and "rampTo" in messages per
+// second; a stream with "rampTo" changes its rate linearly over the phase. A
+// stream with "burst" sends that many messages at once every "every" seconds,
+// starting at the beginning of the phase, instead of a steady rate. Sources are
+// "tracks" (with the generator's tracks, speed, motion, format, seed and bbox
+// options), "file" (a simulation file, relative to the scenario), "markup"
+// (with size, seed and bbox) and "report" (with type, seed and bbox). Streams
+// also accept the address, port, messageTypes and affiliations of a destination.
+// The result of each phase is emitted as a JSON object and, if "results" names
+// a file, appended to it as one line of JSON.
+class ScenarioRunner : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ScenarioRunner(QObject* parent = nullptr);
+  ~ScenarioRunner();
+
+  bool load(const QString& filePath);
+  QString errorString() const;
+
+  QString name() const;
+  int phaseCount() const;
+  QString resultsFilePath() const;
+
+  void setLatencyTagging(bool latencyTagging);
+
+  bool isRunning() const;
+
+public slots:
+  void start();
+  void stop();
+
+signals:
+  void phaseStarted(int index, const QString& name);
+  void phaseFinished(const QJsonObject& result);
+  void finished();
+  void errorOccurred(const QString& error);
+
+private slots:
+  void completePhase();
+
+private:
+  Q_DISABLE_COPY(ScenarioRunner)
+
+  struct Stream
+  {
+    MessageDestination destination;
+    QUrl source;
+    double messagesPerSecond;
+    double rampToMessagesPerSecond; // negative for a steady rate
+    int burstCount; // 0 for a paced stream
+    qint64 burstIntervalMs;
+  };
+
+  struct Phase
+  {
+    QString name;
+    qint64 durationMs;
+    QVector<Stream> streams;
+  };
+
+  struct RunningStream
+  {
+    QThread* thread;
+    MessageSenderWorker* worker;
+    qint64 messagesSent;
+    qint64 sendErrors;
+    qint64 burstsSent;
+    qint64 nextBurstMs;
+  };
+
+  bool readStream(const QJsonObject& json, const QString& scenarioDir, int defaultPort, Stream& stream);
+  void startPhase(int index);
+  void finishPhase();
+  void updateStreams();
+  void releaseStreams();
+  void writeResult(const QJsonObject& result);
+
+  double streamMessagesPerSecond(const Stream& stream, qint64 elapsedMs) const;
+  int runningStreamIndex(const MessageSenderWorker* worker) const;
+
+  QString m_name;
+  QString m_resultsFilePath;
+  QString m_errorString;
+  QVector<Phase> m_phases;
+  bool m_latencyTagging = false;
+
+  QVector<RunningStream> m_runningStreams;
+  int m_phaseIndex = -1;
+  bool m_phaseFinishing = false;
+  bool m_stopRequested = false;
+  QElapsedTimer m_phaseClock;
+  qint64 m_phaseElapsedMs = 0;
+  QTimer m_phaseTimer;
+  QTimer m_updateTimer;
+};
+
+#endif // SCENARIORUNNER_H
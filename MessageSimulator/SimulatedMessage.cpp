@@ -16,19 +16,107 @@
 
 #include "SimulatedMessage.h"
 #include "AbstractMessageParser.h"
+#include "MessageLatencyTracker.h"
 
-#include <QDomDocument>
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QList>
 #include <QXmlStreamReader>
 
+// C++ headers
+#include <algorithm>
+
 const QString SimulatedMessage::COT_ROOT_ELEMENT_NAME{QStringLiteral("events")};
 const QString SimulatedMessage::COT_ELEMENT_NAME{QStringLiteral("event")};
 const QString SimulatedMessage::COT_TYPE_NAME{QStringLiteral("type")};
 const QString SimulatedMessage::COT_UID_NAME{QStringLiteral("uid")};
+const QString SimulatedMessage::COT_TIME_NAME{QStringLiteral("time")};
+const QString SimulatedMessage::COT_START_NAME{QStringLiteral("start")};
+const QString SimulatedMessage::COT_STALE_NAME{QStringLiteral("stale")};
 
 const QString SimulatedMessage::GEOMESSAGE_ROOT_ELEMENT_NAME{QStringLiteral("geomessages")};
 const QString SimulatedMessage::GEOMESSAGE_ELEMENT_NAME{QStringLiteral("geomessage")};
 const QString SimulatedMessage::GEOMESSAGE_ID_NAME{QStringLiteral("_id")};
 const QString SimulatedMessage::GEOMESSAGE_SIC_NAME{QStringLiteral("sic")};
+const QString SimulatedMessage::GEOMESSAGE_DATETIMEVALID_NAME{QStringLiteral("datetimevalid")};
+const QString SimulatedMessage::GEOMESSAGE_TYPE_NAME{QStringLiteral("_type")};
+
+namespace
+{
+const QString timeFormat{QStringLiteral("yyyy-MM-dd'T'hh:mm:ss.zzz'Z'")};
+
+bool isXmlSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// locates the value of an attribute on the first start tag of the message
+bool findAttributeValue(const QByteArray& message, const QString& attributeName, int& valueStart, int& valueEnd)
+{
+  const QByteArray name = attributeName.toLatin1();
+  const int tagEnd = message.indexOf('>');
+  if (tagEnd == -1)
+    return false;
+
+  int from = 0;
+  while (true)
+  {
+    const int position = message.indexOf(name, from);
+    if (position <= 0 || position > tagEnd)
+      return false;
+
+    from = position + name.size();
+
+    if (!isXmlSpace(message.at(position - 1)))
+      continue;
+
+    int equals = from;
+    while (equals < tagEnd && isXmlSpace(message.at(equals)))
+      equals++;
+
+    if (equals >= tagEnd || message.at(equals) != '=')
+      continue;
+
+    int quote = equals + 1;
+    while (quote < tagEnd && isXmlSpace(message.at(quote)))
+      quote++;
+
+    if (quote >= tagEnd || (message.at(quote) != '"' && message.at(quote) != '\''))
+      continue;
+
+    const int closingQuote = message.indexOf(message.at(quote), quote + 1);
+    if (closingQuote == -1)
+      return false;
+
+    valueStart = quote + 1;
+    valueEnd = closingQuote;
+    return true;
+  }
+}
+
+// locates the text of a simple child element of the message
+bool findElementText(const QByteArray& message, const QString& elementName, int& textStart, int& textEnd)
+{
+  const QByteArray startTag = '<' + elementName.toLatin1() + '>';
+  const int start = message.indexOf(startTag);
+  if (start == -1)
+    return false;
+
+  const int end = message.indexOf("</" + elementName.toLatin1(), start + startTag.size());
+  if (end == -1)
+    return false;
+
+  textStart = start + startTag.size();
+  textEnd = end;
+  return true;
+}
+
+QDateTime toDateTime(const QByteArray& message, int start, int end)
+{
+  const QDateTime dateTime = QDateTime::fromString(QString::fromLatin1(message.constData() + start, end - start), Qt::ISODate);
+  return dateTime.toUTC();
+}
+}
 
 SimulatedMessage::SimulatedMessage(QObject* parent) :
   QObject(parent)
@@ -50,32 +138,20 @@ SimulatedMessage::~SimulatedMessage()
 
 SimulatedMessage* SimulatedMessage::create(const QByteArray& message, QObject* parent)
 {
-  QDomDocument doc;
-  if (!doc.setContent(message))
+  // only the root element is needed to determine the format, so the
+  // message is streamed rather than built into a DOM
+  QXmlStreamReader reader(message);
+  if (!reader.readNextStartElement())
     return nullptr;
 
-  // check root element name
-  QDomElement parentElement = doc.firstChildElement(COT_ROOT_ELEMENT_NAME);
-  if (!parentElement.isNull())
-  {
-    return createFromCoTMessage(message, parent);
-  }
-
-  parentElement = doc.firstChildElement(GEOMESSAGE_ROOT_ELEMENT_NAME);
-  if (!parentElement.isNull())
-  {
-    return createFromGeoMessage(message, parent);
-  }
-
-  // fall back to individual element name
-  parentElement = doc.firstChildElement(COT_ELEMENT_NAME);
-  if (!parentElement.isNull())
+  // check root element name, falling back to individual element name
+  const QStringRef elementName = reader.name();
+  if (elementName == COT_ROOT_ELEMENT_NAME || elementName == COT_ELEMENT_NAME)
   {
     return createFromCoTMessage(message, parent);
   }
 
-  parentElement = doc.firstChildElement(GEOMESSAGE_ELEMENT_NAME);
-  if (!parentElement.isNull())
+  if (elementName == GEOMESSAGE_ROOT_ELEMENT_NAME || elementName == GEOMESSAGE_ELEMENT_NAME)
   {
     return createFromGeoMessage(message, parent);
   }
@@ -169,6 +245,130 @@ SimulatedMessage* SimulatedMessage::createFromGeoMessage(const QByteArray& messa
   return nullptr;
 }
 
+QDateTime SimulatedMessage::messageTime(const QByteArray& message)
+{
+  int start = 0;
+  int end = 0;
+
+  // CoT events carry the time as an attribute of the event element
+  if (findAttributeValue(message, COT_TIME_NAME, start, end))
+    return toDateTime(message, start, end);
+
+  if (findElementText(message, GEOMESSAGE_DATETIMEVALID_NAME, start, end))
+    return toDateTime(message, start, end);
+
+  return QDateTime();
+}
+
+QByteArray SimulatedMessage::retimeMessage(const QByteArray& message, const QDateTime& time)
+{
+  QByteArray retimed = message;
+  int start = 0;
+  int end = 0;
+
+  if (findElementText(message, GEOMESSAGE_DATETIMEVALID_NAME, start, end))
+  {
+    retimed.replace(start, end - start, time.toString(timeFormat).toLatin1());
+    return retimed;
+  }
+
+  if (!findAttributeValue(message, COT_TIME_NAME, start, end))
+    return retimed;
+
+  // start and stale keep their original distance from the event time
+  const QDateTime originalTime = toDateTime(message, start, end);
+  if (!originalTime.isValid())
+    return retimed;
+
+  struct Replacement
+  {
+    int start;
+    int end;
+    QByteArray value;
+  };
+
+  QList<Replacement> replacements;
+  for (const QString& attributeName : { COT_TIME_NAME, COT_START_NAME, COT_STALE_NAME })
+  {
+    if (!findAttributeValue(message, attributeName, start, end))
+      continue;
+
+    const QDateTime originalValue = toDateTime(message, start, end);
+    if (!originalValue.isValid())
+      continue;
+
+    const QDateTime newValue = time.addMSecs(originalTime.msecsTo(originalValue));
+    replacements.append(Replacement{start, end, newValue.toString(timeFormat).toLatin1()});
+  }
+
+  // replace from the back so the earlier positions stay valid
+  std::sort(replacements.begin(), replacements.end(), [](const Replacement& a, const Replacement& b)
+  {
+    return a.start > b.start;
+  });
+
+  for (const Replacement& replacement : replacements)
+    retimed.replace(replacement.start, replacement.end - replacement.start, replacement.value);
+
+  return retimed;
+}
+
+QString SimulatedMessage::messageType(const QByteArray& message)
+{
+  int start = 0;
+  int end = 0;
+
+  // GeoMessages name their type in a child element, CoT events in the type attribute
+  if (findElementText(message, GEOMESSAGE_TYPE_NAME, start, end))
+    return QString::fromLatin1(message.constData() + start, end - start).trimmed();
+
+  if (findAttributeValue(message, COT_TYPE_NAME, start, end))
+    return QString::fromLatin1(message.constData() + start, end - start);
+
+  return QString();
+}
+
+QChar SimulatedMessage::messageAffiliation(const QByteArray& message)
+{
+  int start = 0;
+  int end = 0;
+
+  // the affiliation is the second character of a symbol id code
+  if (findElementText(message, GEOMESSAGE_SIC_NAME, start, end))
+  {
+    const QByteArray sic = message.mid(start, end - start).trimmed();
+    return sic.size() > 1 ? QChar::fromLatin1(sic.at(1)).toUpper() : QChar();
+  }
+
+  // and the second atom of a CoT type such as a-f-G
+  if (findAttributeValue(message, COT_TYPE_NAME, start, end) && end - start > 2 && message.at(start + 1) == '-')
+    return QChar::fromLatin1(message.at(start + 2)).toUpper();
+
+  return QChar();
+}
+
+QByteArray SimulatedMessage::tagMessage(const QByteArray& message, quint32 senderId, qint64 sequence)
+{
+  // a leading comment leaves the message itself untouched for every
+  // receiver; the send time is in milliseconds since the epoch
+  QByteArray tagged = Dsa::MessageLatencyTracker::tagPrefix();
+  tagged.reserve(tagged.size() + 64 + message.size());
+  tagged += "sender=\"" + QByteArray::number(senderId) +
+            "\" seq=\"" + QByteArray::number(sequence) +
+            "\" sent=\"" + QByteArray::number(QDateTime::currentMSecsSinceEpoch()) + "\"-->";
+  tagged += message;
+  return tagged;
+}
+
+quint32 SimulatedMessage::createSenderId()
+{
+  // each run of each sender numbers its messages from zero, so receivers
+  // need a fresh id to keep the sequences apart
+  static QAtomicInt nextSenderId(0);
+  const auto processId = static_cast<quint32>(QCoreApplication::applicationPid());
+  return (processId << 12) + static_cast<quint32>(nextSenderId.fetchAndAddRelaxed(1));
+}
+
 SimulatedMessage::MessageFormat SimulatedMessage::messageFormat() const
 {
   return m_messageFormat;
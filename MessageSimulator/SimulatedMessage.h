@@ -17,6 +17,7 @@
 #ifndef SIMULATEDMESSAGE_H
 #define SIMULATEDMESSAGE_H
 
+#include <QDateTime>
 #include <QObject>
 
 class SimulatedMessage : public QObject
@@ -28,11 +29,16 @@ public:
   static const QString COT_ELEMENT_NAME;
   static const QString COT_TYPE_NAME;
   static const QString COT_UID_NAME;
+  static const QString COT_TIME_NAME;
+  static const QString COT_START_NAME;
+  static const QString COT_STALE_NAME;
 
   static const QString GEOMESSAGE_ROOT_ELEMENT_NAME;
   static const QString GEOMESSAGE_ELEMENT_NAME;
   static const QString GEOMESSAGE_ID_NAME;
   static const QString GEOMESSAGE_SIC_NAME;
+  static const QString GEOMESSAGE_DATETIMEVALID_NAME;
+  static const QString GEOMESSAGE_TYPE_NAME;
 
   enum class MessageFormat
   {
@@ -49,6 +55,13 @@ public:
   static SimulatedMessage* createFromCoTMessage(const QByteArray& message, QObject* parent = nullptr);
   static SimulatedMessage* createFromGeoMessage(const QByteArray& message, QObject* parent = nullptr);
 
+  static QDateTime messageTime(const QByteArray& message);
+  static QByteArray retimeMessage(const QByteArray& message, const QDateTime& time);
+  static QString messageType(const QByteArray& message);
+  static QChar messageAffiliation(const QByteArray& message);
+  static QByteArray tagMessage(const QByteArray& message, quint32 senderId, qint64 sequence);
+  static quint32 createSenderId();
+
   MessageFormat messageFormat() const;
   void setMessageFormat(MessageFormat messageFormat);
 
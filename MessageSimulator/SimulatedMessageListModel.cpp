@@ -17,8 +17,14 @@
 #include "SimulatedMessageListModel.h"
 #include "SimulatedMessage.h"
 
+// Qt headers
+#include <QScopedPointer>
+
+const int SimulatedMessageListModel::DEFAULT_CAPACITY = 1000;
+
 SimulatedMessageListModel::SimulatedMessageListModel(QObject* parent) :
-  QAbstractListModel(parent)
+  QAbstractListModel(parent),
+  m_entries(DEFAULT_CAPACITY)
 {
   setupRoles();
 }
@@ -35,14 +41,31 @@ void SimulatedMessageListModel::setupRoles()
   m_roles[SymbolIdRole] = "symbolId";
 }
 
-void SimulatedMessageListModel::append(SimulatedMessage* message)
+void SimulatedMessageListModel::append(const QByteArray& message)
 {
-  if (!message)
+  const int messageCapacity = capacity();
+  if (messageCapacity == 0 || message.isEmpty())
     return;
 
-  beginInsertRows(QModelIndex(), rowCount(), rowCount());
+  // when full, the oldest message makes room for the new one
+  if (m_count == messageCapacity)
+  {
+    beginRemoveRows(QModelIndex(), 0, 0);
+
+    m_first = (m_first + 1) % messageCapacity;
+    m_count--;
+
+    endRemoveRows();
+  }
+
+  beginInsertRows(QModelIndex(), m_count, m_count);
 
-  m_messages.append(message);
+  // only the raw bytes are stored; the message is decoded on demand.
+  // The bytes are copied since they may reference a memory-mapped file.
+  Entry& entry = m_entries[entryIndex(m_count)];
+  entry = Entry();
+  entry.bytes = QByteArray(message.constData(), message.size());
+  m_count++;
 
   endInsertRows();
 }
@@ -53,13 +76,42 @@ void SimulatedMessageListModel::clear()
   {
     beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
 
-    qDeleteAll(m_messages);
-    m_messages.clear();
+    for (Entry& entry : m_entries)
+      entry = Entry();
+
+    m_first = 0;
+    m_count = 0;
 
     endRemoveRows();
   }
 }
 
+int SimulatedMessageListModel::capacity() const
+{
+  return m_entries.size();
+}
+
+void SimulatedMessageListModel::setCapacity(int capacity)
+{
+  capacity = qMax(0, capacity);
+  if (capacity == this->capacity())
+    return;
+
+  beginResetModel();
+
+  // keep the most recent messages that still fit
+  const int keepCount = qMin(m_count, capacity);
+  QVector<Entry> entries(capacity);
+  for (int i = 0; i < keepCount; ++i)
+    entries[i] = m_entries[entryIndex(m_count - keepCount + i)];
+
+  m_entries = entries;
+  m_first = 0;
+  m_count = keepCount;
+
+  endResetModel();
+}
+
 Qt::ItemFlags SimulatedMessageListModel::flags(const QModelIndex& index) const
 {
   if (!index.isValid())
@@ -73,7 +125,7 @@ int SimulatedMessageListModel::rowCount(const QModelIndex& parent) const
   if (parent.isValid())
     return 0;
 
-  return m_messages.size();
+  return m_count;
 }
 
 QVariant SimulatedMessageListModel::data(const QModelIndex& index, int role) const
@@ -83,26 +135,27 @@ QVariant SimulatedMessageListModel::data(const QModelIndex& index, int role) con
 
   QVariant retVal;
 
-  SimulatedMessage* message = m_messages.at(index.row());
-  if (message)
+  // rows are only decoded once they are requested by a view
+  Entry& entry = m_entries[entryIndex(index.row())];
+  if (!entry.decoded)
+    decode(entry);
+
+  switch (role)
   {
-    switch (role)
-    {
-    case FormatRole:
-      retVal = message->messageFormatString();
-      break;
-    case IdRole:
-      retVal = message->messageId();
-      break;
-    case ActionRole:
-      retVal = message->messageAction();
-      break;
-    case SymbolIdRole:
-      retVal = message->symbolId();
-      break;
-    default:
-      break;
-    }
+  case FormatRole:
+    retVal = entry.format;
+    break;
+  case IdRole:
+    retVal = entry.messageId;
+    break;
+  case ActionRole:
+    retVal = entry.messageAction;
+    break;
+  case SymbolIdRole:
+    retVal = entry.symbolId;
+    break;
+  default:
+    break;
   }
 
   return retVal;
@@ -115,13 +168,14 @@ bool SimulatedMessageListModel::removeRows(int row, int count, const QModelIndex
 
   beginRemoveRows(QModelIndex(), row, row + count - 1);
 
-  for (int r = row; r < row + count; ++r)
-  {
-    SimulatedMessage* message = m_messages.at(r);
-    m_messages.removeAt(r);
-    if (message)
-      delete message;
-  }
+  // close the gap by shifting the following rows towards the front
+  for (int r = row; r < m_count - count; ++r)
+    m_entries[entryIndex(r)] = m_entries[entryIndex(r + count)];
+
+  for (int r = m_count - count; r < m_count; ++r)
+    m_entries[entryIndex(r)] = Entry();
+
+  m_count -= count;
 
   endRemoveRows();
 
@@ -132,3 +186,22 @@ QHash<int, QByteArray> SimulatedMessageListModel::roleNames() const
 {
   return m_roles;
 }
+
+void SimulatedMessageListModel::decode(Entry& entry) const
+{
+  entry.decoded = true;
+
+  QScopedPointer<SimulatedMessage> message(SimulatedMessage::create(entry.bytes));
+  if (!message)
+    return;
+
+  entry.format = message->messageFormatString();
+  entry.messageId = message->messageId();
+  entry.messageAction = message->messageAction();
+  entry.symbolId = message->symbolId();
+}
+
+int SimulatedMessageListModel::entryIndex(int row) const
+{
+  return (m_first + row) % m_entries.size();
+}
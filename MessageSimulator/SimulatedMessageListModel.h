@@ -18,8 +18,7 @@
 #define SIMULATEDMESSAGELISTMODEL_H
 
 #include <QAbstractListModel>
-
-class SimulatedMessage;
+#include <QVector>
 
 class SimulatedMessageListModel : public QAbstractListModel
 {
@@ -34,13 +33,18 @@ public:
     SymbolIdRole = Qt::UserRole + 4
   };
 
+  static const int DEFAULT_CAPACITY;
+
   explicit SimulatedMessageListModel(QObject* parent = nullptr);
   ~SimulatedMessageListModel();
 
-  void append(SimulatedMessage* message);
+  void append(const QByteArray& message);
 
   void clear();
 
+  int capacity() const;
+  void setCapacity(int capacity);
+
   Qt::ItemFlags flags(const QModelIndex& index) const override;
 
   int rowCount(const QModelIndex& parent = QModelIndex()) const override;
@@ -55,10 +59,26 @@ protected:
 private:
   Q_DISABLE_COPY(SimulatedMessageListModel)
 
+  struct Entry
+  {
+    QByteArray bytes;
+    bool decoded = false;
+    QString format;
+    QString messageId;
+    QString messageAction;
+    QString symbolId;
+  };
+
   void setupRoles();
+  void decode(Entry& entry) const;
+  int entryIndex(int row) const;
 
   QHash<int, QByteArray> m_roles;
-  QList<SimulatedMessage*> m_messages;
+
+  // fixed-capacity ring buffer; the oldest message is at m_first
+  mutable QVector<Entry> m_entries;
+  int m_first = 0;
+  int m_count = 0;
 };
 
 #endif // SIMULATEDMESSAGELISTMODEL_H
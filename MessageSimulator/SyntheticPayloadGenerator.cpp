@@ -0,0 +1,197 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#include "SyntheticPayloadGenerator.h"
+
+// Qt headers
+#include <QDateTime>
+#include <QStringList>
+#include <QUrlQuery>
+
+const QString SyntheticPayloadGenerator::URL_SCHEME{QStringLiteral("payload")};
+const int SyntheticPayloadGenerator::MIN_MARKUP_SIZE = 256;
+const int SyntheticPayloadGenerator::MAX_MARKUP_SIZE = 60000; // fits in one UDP datagram
+
+namespace
+{
+// report sizes and activities as used by spot reports
+const char* const reportSizes[] = { "Team", "Squad", "Section", "Platoon", "Company" };
+const char* const reportActivities[] = { "Moving", "Stationary", "Attacking", "Defending", "Observing" };
+const int reportChoiceCount = 5;
+
+// the number of characters each additional markup vertex adds
+const int markupVertexSize = 28;
+}
+
+SyntheticPayloadGenerator::SyntheticPayloadGenerator(const Parameters& parameters, QObject* parent) :
+  AbstractMessageParser(urlFromParameters(parameters).toString(), parent),
+  m_parameters(parameters)
+{
+  m_parameters.markupSize = qBound(MIN_MARKUP_SIZE, m_parameters.markupSize, MAX_MARKUP_SIZE);
+
+  reset();
+}
+
+SyntheticPayloadGenerator::~SyntheticPayloadGenerator()
+{
+}
+
+bool SyntheticPayloadGenerator::isPayloadUrl(const QUrl& url)
+{
+  return url.scheme().compare(URL_SCHEME, Qt::CaseInsensitive) == 0;
+}
+
+SyntheticPayloadGenerator::Parameters SyntheticPayloadGenerator::parametersFromUrl(const QUrl& url)
+{
+  // e.g. payload:markup?size=16384&seed=3 or payload:report?type=spotrep
+  Parameters parameters;
+  const QUrlQuery query(url);
+
+  parameters.kind = url.path().compare("markup", Qt::CaseInsensitive) == 0 ? Kind::Markup : Kind::Report;
+
+  if (query.hasQueryItem("size"))
+    parameters.markupSize = qBound(MIN_MARKUP_SIZE, query.queryItemValue("size").toInt(), MAX_MARKUP_SIZE);
+
+  if (query.hasQueryItem("type"))
+    parameters.reportType = query.queryItemValue("type");
+
+  if (query.hasQueryItem("seed"))
+    parameters.seed = query.queryItemValue("seed").toUInt();
+
+  if (query.hasQueryItem("bbox"))
+  {
+    const QStringList bbox = query.queryItemValue("bbox").split(",");
+    if (bbox.size() == 4)
+    {
+      parameters.xMin = qMin(bbox[0].toDouble(), bbox[2].toDouble());
+      parameters.yMin = qMin(bbox[1].toDouble(), bbox[3].toDouble());
+      parameters.xMax = qMax(bbox[0].toDouble(), bbox[2].toDouble());
+      parameters.yMax = qMax(bbox[1].toDouble(), bbox[3].toDouble());
+    }
+  }
+
+  return parameters;
+}
+
+QUrl SyntheticPayloadGenerator::urlFromParameters(const Parameters& parameters)
+{
+  QUrlQuery query;
+  if (parameters.kind == Kind::Markup)
+    query.addQueryItem("size", QString::number(parameters.markupSize));
+  else
+    query.addQueryItem("type", parameters.reportType);
+
+  query.addQueryItem("seed", QString::number(parameters.seed));
+  query.addQueryItem("bbox", QStringList{ QString::number(parameters.xMin, 'g', 9), QString::number(parameters.yMin, 'g', 9),
+                                          QString::number(parameters.xMax, 'g', 9), QString::number(parameters.yMax, 'g', 9) }.join(","));
+
+  QUrl url;
+  url.setScheme(URL_SCHEME);
+  url.setPath(parameters.kind == Kind::Markup ? QStringLiteral("markup") : QStringLiteral("report"));
+  url.setQuery(query);
+  return url;
+}
+
+QByteArray SyntheticPayloadGenerator::nextMessage()
+{
+  m_payloadCount++;
+
+  return m_parameters.kind == Kind::Markup ? createMarkup() : createReport();
+}
+
+void SyntheticPayloadGenerator::reset()
+{
+  // reseeding reproduces exactly the same payloads
+  m_random.seed(m_parameters.seed);
+  m_payloadCount = 0;
+}
+
+bool SyntheticPayloadGenerator::atEnd() const
+{
+  // the generator never runs out of payloads
+  return false;
+}
+
+SyntheticPayloadGenerator::Parameters SyntheticPayloadGenerator::parameters() const
+{
+  return m_parameters;
+}
+
+QByteArray SyntheticPayloadGenerator::createMarkup()
+{
+  // a shared markup as written by MarkupLayer, with a single polyline whose
+  // vertex count brings the payload to roughly the requested size
+  QByteArray markup;
+  markup.reserve(m_parameters.markupSize + 256);
+  markup.append("{\"center\":-1,\"markup\":{\"elements\":[{\"arrow\":false,\"color\":");
+  markup.append(QByteArray::number(static_cast<int>(nextRandom() * 8)));
+  markup.append(",\"filled\":false,\"geometry\":{\"paths\":[[");
+
+  const int vertexCount = qMax(2, (m_parameters.markupSize - 256) / markupVertexSize);
+  for (int i = 0; i < vertexCount; ++i)
+  {
+    if (i > 0)
+      markup.append(',');
+
+    markup.append(randomCoordinates());
+  }
+
+  markup.append("]],\"spatialReference\":{\"wkid\":4326}}}],\"name\":\"Synthetic markup ");
+  markup.append(QByteArray::number(m_payloadCount));
+  markup.append("\",\"version\":\"1.0\"},\"scale\":-1,\"sharedBy\":\"MessageSimulator\",\"version\":\"1.0\"}");
+
+  return markup;
+}
+
+QByteArray SyntheticPayloadGenerator::createReport()
+{
+  const int size = static_cast<int>(nextRandom() * reportChoiceCount) % reportChoiceCount;
+  const int activity = static_cast<int>(nextRandom() * reportChoiceCount) % reportChoiceCount;
+  const QByteArray coordinates = randomCoordinates();
+
+  QByteArray report;
+  report.reserve(512);
+  report.append("<geomessage v=\"1.0\"><_type>");
+  report.append(m_parameters.reportType.toLatin1());
+  report.append("</_type><_action>update</_action><_id>synthetic-report-");
+  report.append(QByteArray::number(m_payloadCount));
+  report.append("</_id><_control_points>");
+  report.append(coordinates.mid(1, coordinates.size() - 2));
+  report.append("</_control_points><_wkid>4326</_wkid><sic>SHGPUCI--------</sic><size>");
+  report.append(reportSizes[size]);
+  report.append("</size><activity>");
+  report.append(reportActivities[activity]);
+  report.append("</activity><datetimevalid>");
+  report.append(QDateTime::currentDateTimeUtc().toString(QStringLiteral("yyyy-MM-dd'T'hh:mm:ss.zzz'Z'")).toLatin1());
+  report.append("</datetimevalid></geomessage>");
+
+  return report;
+}
+
+QByteArray SyntheticPayloadGenerator::randomCoordinates()
+{
+  const double x = m_parameters.xMin + nextRandom() * (m_parameters.xMax - m_parameters.xMin);
+  const double y = m_parameters.yMin + nextRandom() * (m_parameters.yMax - m_parameters.yMin);
+
+  return '[' + QByteArray::number(x, 'f', 7) + ',' + QByteArray::number(y, 'f', 7) + ']';
+}
+
+double SyntheticPayloadGenerator::nextRandom()
+{
+  // std::mt19937 output is fully specified by the standard, so the same
+  // seed yields the same payloads on every platform
+  return m_random() / 4294967296.0;
+}
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef SYNTHETICPAYLOADGENERATOR_H
+#define SYNTHETICPAYLOADGENERATOR_H
+
+#include "AbstractMessageParser.h"
+
+// Qt headers
+#include <QUrl>
+
+// C++ headers
+#include <random>
+
+class SyntheticPayloadGenerator : public AbstractMessageParser
+{
+  Q_OBJECT
+
+public:
+  static const QString URL_SCHEME;
+  static const int MIN_MARKUP_SIZE;
+  static const int MAX_MARKUP_SIZE;
+
+  enum class Kind
+  {
+    Markup = 0,
+    Report = 1
+  };
+
+  struct Parameters
+  {
+    Kind kind = Kind::Report;
+    int markupSize = 4096; // approximate bytes per markup payload
+    QString reportType = QStringLiteral("spotrep");
+    quint32 seed = 1;
+    double xMin = -122.0;
+    double yMin = 36.5;
+    double xMax = -121.7;
+    double yMax = 36.75;
+  };
+
+  explicit SyntheticPayloadGenerator(const Parameters& parameters, QObject* parent = nullptr);
+  ~SyntheticPayloadGenerator();
+
+  static bool isPayloadUrl(const QUrl& url);
+  static Parameters parametersFromUrl(const QUrl& url);
+  static QUrl urlFromParameters(const Parameters& parameters);
+
+  QByteArray nextMessage() override;
+
+  void reset() override;
+
+  bool atEnd() const override;
+
+  Parameters parameters() const;
+
+private:
+  Q_DISABLE_COPY(SyntheticPayloadGenerator)
+  SyntheticPayloadGenerator() = delete;
+
+  QByteArray createMarkup();
+  QByteArray createReport();
+
+  QByteArray randomCoordinates();
+  double nextRandom();
+
+  Parameters m_parameters;
+  std::mt19937 m_random;
+  qint64 m_payloadCount = 0;
+};
+
+#endif // SYNTHETICPAYLOADGENERATOR_H
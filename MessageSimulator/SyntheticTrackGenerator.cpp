@@ -0,0 +1,346 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#include "SyntheticTrackGenerator.h"
+
+// Qt headers
+#include <QStringList>
+#include <QUrlQuery>
+#include <QtMath>
+
+// C++ headers
+#include <cmath>
+
+const QString SyntheticTrackGenerator::URL_SCHEME{QStringLiteral("generator")};
+const int SyntheticTrackGenerator::MIN_TRACK_COUNT = 10;
+const int SyntheticTrackGenerator::MAX_TRACK_COUNT = 100000;
+
+namespace
+{
+const double metersPerDegree = 111320.0;
+
+// friendly, hostile, neutral and unknown affiliations with their cumulative weights
+const char affiliations[] = { 'F', 'H', 'N', 'U' };
+const char cotAffiliations[] = { 'f', 'h', 'n', 'u' };
+const double affiliationWeights[] = { 0.5, 0.8, 0.9, 1.0 };
+
+// land unit symbols as SIDC function IDs and their matching CoT type suffixes
+struct SymbolType
+{
+  const char* sidcFunction;
+  const char* cotSuffix;
+};
+
+const SymbolType symbolTypes[] =
+{
+  { "UCI---", "U-C-I" }, // infantry
+  { "UCA---", "U-C-A" }, // armor
+  { "UCR---", "U-C-R" }, // reconnaissance
+  { "UCF---", "U-C-F" }, // field artillery
+  { "UCE---", "U-C-E" }  // engineer
+};
+
+const int symbolTypeCount = sizeof(symbolTypes) / sizeof(symbolTypes[0]);
+
+double normalizeHeading(double heading)
+{
+  heading = std::fmod(heading, 360.0);
+  return heading < 0.0 ? heading + 360.0 : heading;
+}
+}
+
+SyntheticTrackGenerator::SyntheticTrackGenerator(const Parameters& parameters, QObject* parent) :
+  AbstractMessageParser(urlFromParameters(parameters).toString(), parent),
+  m_parameters(parameters)
+{
+  m_parameters.trackCount = qBound(MIN_TRACK_COUNT, m_parameters.trackCount, MAX_TRACK_COUNT);
+  if (m_parameters.updateRate <= 0.0)
+    m_parameters.updateRate = Parameters().updateRate;
+
+  reset();
+}
+
+SyntheticTrackGenerator::~SyntheticTrackGenerator()
+{
+}
+
+bool SyntheticTrackGenerator::isGeneratorUrl(const QUrl& url)
+{
+  return url.scheme().compare(URL_SCHEME, Qt::CaseInsensitive) == 0;
+}
+
+SyntheticTrackGenerator::Parameters SyntheticTrackGenerator::parametersFromUrl(const QUrl& url)
+{
+  // e.g. generator:?tracks=1000&rate=2&motion=waypoint&format=cot&seed=7&bbox=-122,36.5,-121.7,36.75
+  Parameters parameters;
+  const QUrlQuery query(url);
+
+  if (query.hasQueryItem("tracks"))
+    parameters.trackCount = qBound(MIN_TRACK_COUNT, query.queryItemValue("tracks").toInt(), MAX_TRACK_COUNT);
+
+  if (query.hasQueryItem("rate"))
+  {
+    const double rate = query.queryItemValue("rate").toDouble();
+    if (rate > 0.0)
+      parameters.updateRate = rate;
+  }
+
+  if (query.hasQueryItem("speed"))
+    parameters.speed = qMax(0.0, query.queryItemValue("speed").toDouble());
+
+  if (query.hasQueryItem("motion"))
+  {
+    parameters.motion = query.queryItemValue("motion").compare("waypoint", Qt::CaseInsensitive) == 0 ?
+          Motion::Waypoint : Motion::RandomWalk;
+  }
+
+  if (query.hasQueryItem("format"))
+  {
+    parameters.format = query.queryItemValue("format").compare("cot", Qt::CaseInsensitive) == 0 ?
+          Format::CoT : Format::GeoMessage;
+  }
+
+  if (query.hasQueryItem("seed"))
+    parameters.seed = query.queryItemValue("seed").toUInt();
+
+  if (query.hasQueryItem("bbox"))
+  {
+    const QStringList bbox = query.queryItemValue("bbox").split(",");
+    if (bbox.size() == 4)
+    {
+      parameters.xMin = qMin(bbox[0].toDouble(), bbox[2].toDouble());
+      parameters.yMin = qMin(bbox[1].toDouble(), bbox[3].toDouble());
+      parameters.xMax = qMax(bbox[0].toDouble(), bbox[2].toDouble());
+      parameters.yMax = qMax(bbox[1].toDouble(), bbox[3].toDouble());
+    }
+  }
+
+  return parameters;
+}
+
+QUrl SyntheticTrackGenerator::urlFromParameters(const Parameters& parameters)
+{
+  QUrlQuery query;
+  query.addQueryItem("tracks", QString::number(parameters.trackCount));
+  query.addQueryItem("rate", QString::number(parameters.updateRate));
+  query.addQueryItem("speed", QString::number(parameters.speed));
+  query.addQueryItem("motion", parameters.motion == Motion::Waypoint ? QStringLiteral("waypoint") : QStringLiteral("randomwalk"));
+  query.addQueryItem("format", parameters.format == Format::CoT ? QStringLiteral("cot") : QStringLiteral("geomessage"));
+  query.addQueryItem("seed", QString::number(parameters.seed));
+  query.addQueryItem("bbox", QStringList{ QString::number(parameters.xMin, 'g', 9), QString::number(parameters.yMin, 'g', 9),
+                                          QString::number(parameters.xMax, 'g', 9), QString::number(parameters.yMax, 'g', 9) }.join(","));
+
+  QUrl url;
+  url.setScheme(URL_SCHEME);
+  url.setQuery(query);
+  return url;
+}
+
+QByteArray SyntheticTrackGenerator::nextMessage()
+{
+  Track& track = m_tracks[m_nextTrack];
+
+  // the first sweep reports the initial positions
+  if (m_sweeps > 0)
+    advance(track);
+
+  const QByteArray message = m_parameters.format == Format::CoT ? toCoT(track, m_nextTrack) : toGeoMessage(track, m_nextTrack);
+
+  if (++m_nextTrack == m_tracks.size())
+  {
+    m_nextTrack = 0;
+    m_sweeps++;
+  }
+
+  return message;
+}
+
+void SyntheticTrackGenerator::reset()
+{
+  // reseeding reproduces exactly the same tracks and motion
+  m_random.seed(m_parameters.seed);
+  m_nextTrack = 0;
+  m_sweeps = 0;
+  m_startTime = QDateTime::currentDateTimeUtc();
+
+  initializeTracks();
+}
+
+bool SyntheticTrackGenerator::atEnd() const
+{
+  // the generator never runs out of messages
+  return false;
+}
+
+SyntheticTrackGenerator::Parameters SyntheticTrackGenerator::parameters() const
+{
+  return m_parameters;
+}
+
+double SyntheticTrackGenerator::messagesPerSecond() const
+{
+  return m_parameters.trackCount * m_parameters.updateRate;
+}
+
+void SyntheticTrackGenerator::initializeTracks()
+{
+  m_tracks.resize(m_parameters.trackCount);
+
+  for (Track& track : m_tracks)
+  {
+    track.x = m_parameters.xMin + nextRandom() * (m_parameters.xMax - m_parameters.xMin);
+    track.y = m_parameters.yMin + nextRandom() * (m_parameters.yMax - m_parameters.yMin);
+    track.heading = nextRandom() * 360.0;
+
+    const double affiliationValue = nextRandom();
+    track.affiliation = 0;
+    while (affiliationWeights[track.affiliation] < affiliationValue)
+      track.affiliation++;
+
+    track.symbol = static_cast<int>(nextRandom() * symbolTypeCount) % symbolTypeCount;
+
+    track.targetX = track.x;
+    track.targetY = track.y;
+    if (m_parameters.motion == Motion::Waypoint)
+      chooseWaypoint(track);
+  }
+}
+
+void SyntheticTrackGenerator::advance(Track& track)
+{
+  const double stepMeters = m_parameters.speed / m_parameters.updateRate;
+  const double metersPerDegreeX = metersPerDegree * std::cos(qDegreesToRadians(track.y));
+
+  if (m_parameters.motion == Motion::Waypoint)
+  {
+    const double dxMeters = (track.targetX - track.x) * metersPerDegreeX;
+    const double dyMeters = (track.targetY - track.y) * metersPerDegree;
+    const double remainingMeters = std::sqrt(dxMeters * dxMeters + dyMeters * dyMeters);
+
+    if (remainingMeters <= stepMeters)
+    {
+      // arrived; head for the next waypoint from here
+      track.x = track.targetX;
+      track.y = track.targetY;
+      chooseWaypoint(track);
+      return;
+    }
+
+    track.heading = normalizeHeading(qRadiansToDegrees(std::atan2(dxMeters, dyMeters)));
+  }
+  else
+  {
+    // random walk: wander up to 15 degrees either side of the current heading
+    track.heading = normalizeHeading(track.heading + (nextRandom() - 0.5) * 30.0);
+  }
+
+  const double headingRadians = qDegreesToRadians(track.heading);
+  track.x += stepMeters * std::sin(headingRadians) / metersPerDegreeX;
+  track.y += stepMeters * std::cos(headingRadians) / metersPerDegree;
+
+  // bounce off the edges of the bounding box
+  if (track.x < m_parameters.xMin || track.x > m_parameters.xMax)
+  {
+    track.x = track.x < m_parameters.xMin ? 2.0 * m_parameters.xMin - track.x : 2.0 * m_parameters.xMax - track.x;
+    track.heading = normalizeHeading(360.0 - track.heading);
+  }
+
+  if (track.y < m_parameters.yMin || track.y > m_parameters.yMax)
+  {
+    track.y = track.y < m_parameters.yMin ? 2.0 * m_parameters.yMin - track.y : 2.0 * m_parameters.yMax - track.y;
+    track.heading = normalizeHeading(180.0 - track.heading);
+  }
+}
+
+void SyntheticTrackGenerator::chooseWaypoint(Track& track)
+{
+  track.targetX = m_parameters.xMin + nextRandom() * (m_parameters.xMax - m_parameters.xMin);
+  track.targetY = m_parameters.yMin + nextRandom() * (m_parameters.yMax - m_parameters.yMin);
+}
+
+QByteArray SyntheticTrackGenerator::toGeoMessage(const Track& track, int trackIndex) const
+{
+  const SymbolType& symbolType = symbolTypes[track.symbol];
+
+  // messages are assembled directly rather than through an XML writer
+  // since the generator has to keep up with the high-rate sender
+  QByteArray message;
+  message.reserve(384);
+  message.append("<geomessage v=\"1.0\"><_type>position_report_land</_type><_action>update</_action><_id>synthetic-");
+  message.append(QByteArray::number(trackIndex));
+  message.append("</_id><_control_points>");
+  message.append(QByteArray::number(track.x, 'f', 7));
+  message.append(',');
+  message.append(QByteArray::number(track.y, 'f', 7));
+  message.append("</_control_points><_wkid>4326</_wkid><sic>S");
+  message.append(affiliations[track.affiliation]);
+  message.append("GP");
+  message.append(symbolType.sidcFunction);
+  message.append("-----</sic><uniquedesignation>SYN ");
+  message.append(QByteArray::number(trackIndex));
+  message.append("</uniquedesignation><direction>");
+  message.append(QByteArray::number(track.heading, 'f', 1));
+  message.append("</direction></geomessage>");
+
+  return message;
+}
+
+QByteArray SyntheticTrackGenerator::toCoT(const Track& track, int trackIndex) const
+{
+  const SymbolType& symbolType = symbolTypes[track.symbol];
+
+  // timestamps follow the simulated clock rather than the wall clock
+  const double elapsedSeconds = (m_sweeps + static_cast<double>(trackIndex) / m_tracks.size()) / m_parameters.updateRate;
+  const QDateTime time = m_startTime.addMSecs(static_cast<qint64>(elapsedSeconds * 1000.0));
+  const QDateTime stale = time.addMSecs(static_cast<qint64>(qMax(60.0, 5.0 / m_parameters.updateRate) * 1000.0));
+  const QString timeFormat = QStringLiteral("yyyy-MM-dd'T'hh:mm:ss.zzz'Z'");
+  const QByteArray timeText = time.toString(timeFormat).toLatin1();
+
+  QByteArray message;
+  message.reserve(384);
+  message.append("<event version=\"2.0\" uid=\"synthetic-");
+  message.append(QByteArray::number(trackIndex));
+  message.append("\" type=\"a-");
+  message.append(cotAffiliations[track.affiliation]);
+  message.append("-G-");
+  message.append(symbolType.cotSuffix);
+  message.append("\" how=\"m-s\" time=\"");
+  message.append(timeText);
+  message.append("\" start=\"");
+  message.append(timeText);
+  message.append("\" stale=\"");
+  message.append(stale.toString(timeFormat).toLatin1());
+  message.append("\"><point lat=\"");
+  message.append(QByteArray::number(track.y, 'f', 7));
+  message.append("\" lon=\"");
+  message.append(QByteArray::number(track.x, 'f', 7));
+  message.append("\" hae=\"0\" ce=\"10\" le=\"10\"/><detail><contact callsign=\"SYN ");
+  message.append(QByteArray::number(trackIndex));
+  message.append("\"/><track course=\"");
+  message.append(QByteArray::number(track.heading, 'f', 1));
+  message.append("\" speed=\"");
+  message.append(QByteArray::number(m_parameters.speed, 'f', 1));
+  message.append("\"/></detail></event>");
+
+  return message;
+}
+
+double SyntheticTrackGenerator::nextRandom()
+{
+  // std::mt19937 output is fully specified by the standard, unlike the
+  // std distributions, so the same seed yields the same tracks on every platform
+  return m_random() / 4294967296.0;
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef SYNTHETICTRACKGENERATOR_H
+#define SYNTHETICTRACKGENERATOR_H
+
+#include "AbstractMessageParser.h"
+
+// Qt headers
+#include <QDateTime>
+#include <QUrl>
+#include <QVector>
+
+// C++ headers
+#include <random>
+
+class SyntheticTrackGenerator : public AbstractMessageParser
+{
+  Q_OBJECT
+
+public:
+  static const QString URL_SCHEME;
+  static const int MIN_TRACK_COUNT;
+  static const int MAX_TRACK_COUNT;
+
+  enum class Motion
+  {
+    RandomWalk = 0,
+    Waypoint = 1
+  };
+
+  enum class Format
+  {
+    GeoMessage = 0,
+    CoT = 1
+  };
+
+  struct Parameters
+  {
+    int trackCount = 100;
+    double updateRate = 1.0; // updates per track per second
+    double speed = 10.0; // meters per second
+    Motion motion = Motion::RandomWalk;
+    Format format = Format::GeoMessage;
+    quint32 seed = 1;
+    double xMin = -122.0;
+    double yMin = 36.5;
+    double xMax = -121.7;
+    double yMax = 36.75;
+  };
+
+  explicit SyntheticTrackGenerator(const Parameters& parameters, QObject* parent = nullptr);
+  ~SyntheticTrackGenerator();
+
+  static bool isGeneratorUrl(const QUrl& url);
+  static Parameters parametersFromUrl(const QUrl& url);
+  static QUrl urlFromParameters(const Parameters& parameters);
+
+  QByteArray nextMessage() override;
+
+  void reset() override;
+
+  bool atEnd() const override;
+
+  Parameters parameters() const;
+
+  double messagesPerSecond() const;
+
+private:
+  Q_DISABLE_COPY(SyntheticTrackGenerator)
+  SyntheticTrackGenerator() = delete;
+
+  struct Track
+  {
+    double x;
+    double y;
+    double heading; // degrees clockwise from north
+    double targetX;
+    double targetY;
+    int affiliation;
+    int symbol;
+  };
+
+  void initializeTracks();
+  void advance(Track& track);
+  void chooseWaypoint(Track& track);
+
+  QByteArray toGeoMessage(const Track& track, int trackIndex) const;
+  QByteArray toCoT(const Track& track, int trackIndex) const;
+
+  double nextRandom();
+
+  Parameters m_parameters;
+  QVector<Track> m_tracks;
+  std::mt19937 m_random;
+  int m_nextTrack = 0;
+  qint64 m_sweeps = 0;
+  QDateTime m_startTime;
+};
+
+#endif // SYNTHETICTRACKGENERATOR_H
@@ -15,9 +15,15 @@
  ******************************************************************************/
 
 #include <QGuiApplication>
+#include <QJsonDocument>
 #include <QQmlApplicationEngine>
+#include <QTimer>
+#include <QUrlQuery>
+#include <QVariantMap>
 
 #include "MessageSimulatorController.h"
+#include "ScenarioRunner.h"
+#include "SyntheticTrackGenerator.h"
 
 #ifdef Q_OS_WIN
 #include <Windows.h>
@@ -30,13 +36,43 @@ void printHelp()
   out << "  -h                     Print help and exit" << endl;
   out << "  -c                     Console mode (no GUI)" << endl;
   out << "Parameters available only in console mode:" << endl;
-  out << "  -p <port number>       Port number: Required" << endl;
+  out << "  -p <port number>       Port number: Required unless every destination in -d" << endl <<
+         "                         names its own port" << endl;
   out << "  -f <filename>          Simulation file: Required" << endl;
   out << "  -q <frequency>         Frequency (messages per time unit); default is 1.0" << endl;
   out << "  -t <time unit>         Time unit for frequency; valid values are seconds," << endl <<
          "                         minute, and hour; default is second" << endl;
   out << "  -l                     Simulation loops through simulation file" << endl;
+  out << "  -b                     High-rate mode; messages are sent in paced batches" << endl <<
+         "                         from a dedicated thread" << endl;
   out << "  -s                     Silent mode; no verbose output" << endl;
+  out << "  -e                     Embed the send time and a sequence number in each" << endl <<
+         "                         message so that the app can measure latency" << endl;
+  out << "  -n                     No message history; sent messages are not kept" << endl;
+  out << "  -r <speed>             Replay mode; messages are sent at their recorded times" << endl <<
+         "                         scaled by speed (0.1 to 100), replacing -q and -t" << endl;
+  out << "  -o <seconds>           Replay mode only; start at this offset into the recording" << endl;
+  out << "  -d <filename>          Destinations file; JSON that maps message types and" << endl <<
+         "                         affiliations to ports or multicast groups, each sent" << endl <<
+         "                         from its own thread at its own rate" << endl;
+  out << "  -x <filename>          Scenario mode; run the phases of a JSON scenario and" << endl <<
+         "                         print the result of each phase as a line of JSON" << endl <<
+         "                         (replaces -f, -p, -q, -t, -l, -b, -r, -d and -g)" << endl;
+  out << "  -g                     Generator mode; synthesise tracks instead of reading" << endl <<
+         "                         a simulation file (replaces -f)" << endl;
+  out << "Parameters available only in generator mode:" << endl;
+  out << "  --tracks <count>       Number of tracks, from 10 to 100000; default is 100" << endl;
+  out << "  --rate <updates>       Updates per track per second; default is 1.0. Unless -q" << endl <<
+         "                         is given, messages are sent at tracks x rate per second" << endl;
+  out << "  --speed <m/s>          Track speed in meters per second; default is 10" << endl;
+  out << "  --motion <motion>      Track motion; valid values are randomwalk and waypoint;" << endl <<
+         "                         default is randomwalk" << endl;
+  out << "  --format <format>      Message format; valid values are geomessage and cot;" << endl <<
+         "                         default is geomessage" << endl;
+  out << "  --seed <seed>          Random seed; the same seed gives the same tracks;" << endl <<
+         "                         default is 1" << endl;
+  out << "  --bbox <xmin,ymin,xmax,ymax>" << endl <<
+         "                         Bounding box in WGS84 degrees" << endl;
 }
 
 int main(int argc, char *argv[])
@@ -47,11 +83,21 @@ int main(int argc, char *argv[])
 
   bool isGui = true;
   QString simulationFile;
+  QString destinationsFile;
+  QString scenarioFile;
   int port = -1;
   float frequency = 1.0f;
   QString timeUnit = "second";
   bool isLoop = false;
+  bool isHighRate = false;
+  bool isLatencyTagging = false;
   bool isVerbose = true;
+  bool isGenerator = false;
+  bool isHistoryEnabled = true;
+  double replaySpeed = 0.0;
+  double replayOffset = 0.0;
+  bool isFrequencySet = false;
+  QUrlQuery generatorQuery;
 
   for (int i = 1; i < argc; i++)
   {
@@ -85,6 +131,20 @@ int main(int argc, char *argv[])
         simulationFile = QString(argv[++i]);
       }
     }
+    else if (!strcmp(argv[i], "-d"))
+    {
+      if ((i + 1) < argc)
+      {
+        destinationsFile = QString(argv[++i]);
+      }
+    }
+    else if (!strcmp(argv[i], "-x"))
+    {
+      if ((i + 1) < argc)
+      {
+        scenarioFile = QString(argv[++i]);
+      }
+    }
     else if (!strcmp(argv[i], "-p"))
     {
       if ((i + 1) < argc)
@@ -97,6 +157,7 @@ int main(int argc, char *argv[])
       if ((i + 1) < argc)
       {
         frequency = atof(argv[++i]);
+        isFrequencySet = true;
       }
     }
     else if (!strcmp(argv[i], "-t"))
@@ -110,10 +171,49 @@ int main(int argc, char *argv[])
     {
       isLoop = true;
     }
+    else if (!strcmp(argv[i], "-b"))
+    {
+      isHighRate = true;
+    }
+    else if (!strcmp(argv[i], "-e"))
+    {
+      isLatencyTagging = true;
+    }
     else if (!strcmp(argv[i], "-s"))
     {
       isVerbose = false;
     }
+    else if (!strcmp(argv[i], "-g"))
+    {
+      isGenerator = true;
+    }
+    else if (!strcmp(argv[i], "-n"))
+    {
+      isHistoryEnabled = false;
+    }
+    else if (!strcmp(argv[i], "-r"))
+    {
+      if ((i + 1) < argc)
+      {
+        replaySpeed = atof(argv[++i]);
+      }
+    }
+    else if (!strcmp(argv[i], "-o"))
+    {
+      if ((i + 1) < argc)
+      {
+        replayOffset = atof(argv[++i]);
+      }
+    }
+    else if (!strncmp(argv[i], "--", 2))
+    {
+      // generator options are passed through to the generator URL
+      if ((i + 1) < argc)
+      {
+        const QString option = QString(argv[i] + 2);
+        generatorQuery.addQueryItem(option, QString(argv[++i]));
+      }
+    }
   }
 
   if (!isGui)
@@ -124,15 +224,77 @@ int main(int argc, char *argv[])
     freopen("CON", "w", stdout);
 #endif
 
-    if (simulationFile.isEmpty() || port == -1)
+    if (!scenarioFile.isEmpty())
+    {
+      QCoreApplication app(argc, argv);
+
+      ScenarioRunner runner;
+      if (!runner.load(scenarioFile))
+      {
+        qDebug() << runner.errorString();
+        return 1;
+      }
+
+      if (isLatencyTagging)
+        runner.setLatencyTagging(true);
+
+      // stdout only carries the results so that it can be piped
+      // straight into other tools; progress goes to stderr
+      if (isVerbose)
+      {
+        QObject::connect(&runner, &ScenarioRunner::errorOccurred, &app, [](const QString& error)
+        {
+          qDebug() << error;
+        });
+
+        QObject::connect(&runner, &ScenarioRunner::phaseStarted, &app, [&runner](int index, const QString& name)
+        {
+          qDebug().noquote() << "Phase" << (index + 1) << "of" << runner.phaseCount() << "started:" << name;
+        });
+      }
+
+      QObject::connect(&runner, &ScenarioRunner::phaseFinished, &app, [](const QJsonObject& result)
+      {
+        QTextStream out(stdout);
+        out << QJsonDocument(result).toJson(QJsonDocument::Compact) << endl;
+      });
+
+      QObject::connect(&runner, &ScenarioRunner::finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+
+      runner.start();
+
+      return app.exec();
+    }
+
+    if ((simulationFile.isEmpty() && !isGenerator) || (port == -1 && destinationsFile.isEmpty()))
     {
       printHelp();
       return 0;
     }
 
+    QUrl simulationSource = QUrl::fromLocalFile(simulationFile);
+    if (isGenerator)
+    {
+      // normalise the options through the generator's own parameters
+      QUrl generatorUrl;
+      generatorUrl.setScheme(SyntheticTrackGenerator::URL_SCHEME);
+      generatorUrl.setQuery(generatorQuery);
+
+      const auto parameters = SyntheticTrackGenerator::parametersFromUrl(generatorUrl);
+      simulationSource = SyntheticTrackGenerator::urlFromParameters(parameters);
+
+      // by default every track is updated at the requested rate
+      if (!isFrequencySet)
+      {
+        frequency = parameters.trackCount * parameters.updateRate;
+        timeUnit = "second";
+      }
+    }
+
     QCoreApplication app(argc, argv);
 
     MessageSimulatorController controller;
+    QTimer statisticsTimer;
 
     if (isVerbose)
     {
@@ -140,23 +302,67 @@ int main(int argc, char *argv[])
       {
         qDebug() << error;
       });
+
+      // the statistics are printed once a second rather than on every update,
+      // as updates arrive from each destination separately
+      QObject::connect(&statisticsTimer, &QTimer::timeout, &app, [&controller]()
+      {
+        QTextStream out(stdout);
+        out << "Sent " << controller.messagesSent() << " messages; achieved rate " <<
+               QString::number(controller.achievedRate(), 'f', 1) << " messages per second; " <<
+               controller.sendErrors() << " send errors\n";
+
+        const auto destinations = controller.destinationStatistics();
+        if (destinations.size() < 2)
+          return;
+
+        for (const QVariant& destination : destinations)
+        {
+          const auto statistics = destination.toMap();
+          out << "  " << statistics.value("name").toString() << " (" <<
+                 statistics.value("address").toString() << ":" << statistics.value("port").toInt() << "): " <<
+                 statistics.value("messagesSent").toLongLong() << " messages; " <<
+                 QString::number(statistics.value("achievedRate").toDouble(), 'f', 1) << " per second; " <<
+                 statistics.value("sendErrors").toLongLong() << " send errors\n";
+        }
+      });
+      statisticsTimer.start(1000);
     }
 
     controller.setMessageFrequency(frequency);
     controller.setTimeUnit(MessageSimulatorController::toTimeUnit(timeUnit));
     controller.setPort(port);
+    controller.setDestinationsFile(destinationsFile.isEmpty() ? QUrl() : QUrl::fromLocalFile(destinationsFile));
     controller.setSimulationLooped(isLoop);
-    controller.startSimulation(QUrl::fromLocalFile(simulationFile));
+    controller.setHighRateMode(isHighRate);
+    controller.setLatencyTagging(isLatencyTagging);
+    controller.setReplayMode(replaySpeed > 0.0);
+    if (replaySpeed > 0.0)
+      controller.setReplaySpeed(replaySpeed);
+    if (!isHistoryEnabled)
+      controller.setMessageHistoryCapacity(0);
+    controller.startSimulation(simulationSource);
+    if (replaySpeed > 0.0 && replayOffset > 0.0)
+      controller.seekSimulation(replayOffset);
 
     if (isVerbose)
     {
       QTextStream out(stdout);
       out << "Simulation started with file: " << controller.simulationFile().toString() << "\n";
-      out << "UDP port: " << controller.port() << "\n";
+      if (controller.destinationsFile().isEmpty())
+        out << "UDP port: " << controller.port() << "\n";
+      else
+        out << "Destinations file: " << controller.destinationsFile().toLocalFile() << "\n";
       out << "Sending " << controller.messageFrequency() << " message per " <<
                   MessageSimulatorController::fromTimeUnit(controller.timeUnit()) << "\n";
       if (isLoop)
         out << "Simulation loop mode enabled\n";
+      if (isHighRate)
+        out << "High-rate mode enabled\n";
+      if (isLatencyTagging)
+        out << "Messages are tagged for latency measurement\n";
+      if (controller.isReplayMode())
+        out << "Replaying recorded message times at " << controller.replaySpeed() << "x\n";
     }
 
     return app.exec();
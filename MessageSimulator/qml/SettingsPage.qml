@@ -136,7 +136,7 @@ Rectangle {
                 enabled: messageSimulatorController.simulationState !== MessageSimulatorController.Running
                 orientation: Qt.Horizontal
                 from: 1
-                to: 500
+                to: messageSimulatorController.highRateMode ? 100000 : 500
                 value: messageSimulatorController.messageFrequency
                 stepSize: 1
                 snapMode: Slider.SnapAlways
@@ -242,6 +242,129 @@ Rectangle {
                 }
             }
         }
+
+        Rectangle {
+            width: settingsPage.width
+            height: 50 * scaleFactor
+            color: "steelblue"
+            radius: 4 * scaleFactor
+
+            Label {
+                id: highRateLabel
+                anchors {
+                    top: parent.top
+                    bottom: parent.bottom
+                    left: parent.left
+                    margins: 8 * scaleFactor
+                }
+                width: 64 * scaleFactor
+
+                text: "high\nrate"
+                font.bold: true
+                color: "white"
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+            }
+
+            CheckBox {
+                id: highRateCheckBox
+                anchors {
+                    top: parent.top
+                    bottom: parent.bottom
+                    left: highRateLabel.right
+                    margins: 8 * scaleFactor
+                }
+
+                enabled: messageSimulatorController.simulationState === MessageSimulatorController.Stopped
+                font.bold: true
+                checked: messageSimulatorController.highRateMode
+
+                onCheckedChanged: {
+                    messageSimulatorController.highRateMode = checked;
+                }
+            }
+
+            Label {
+                anchors {
+                    top: parent.top
+                    bottom: parent.bottom
+                    left: highRateCheckBox.right
+                    right: parent.right
+                    margins: 8 * scaleFactor
+                }
+
+                font.bold: true
+                color: "white"
+                text: messageSimulatorController.achievedRate.toFixed(1) + qsTr(" messages per second, ") +
+                      messageSimulatorController.sendErrors + qsTr(" send errors")
+                horizontalAlignment: Text.AlignRight
+                verticalAlignment: Text.AlignVCenter
+            }
+        }
+        Rectangle {
+            width: settingsPage.width
+            height: 50 * scaleFactor
+            color: "steelblue"
+            radius: 4 * scaleFactor
+
+            Label {
+                id: replayLabel
+                anchors {
+                    top: parent.top
+                    bottom: parent.bottom
+                    left: parent.left
+                    margins: 8 * scaleFactor
+                }
+                width: 64 * scaleFactor
+
+                text: "replay"
+                font.bold: true
+                color: "white"
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+            }
+
+            CheckBox {
+                id: replayCheckBox
+                anchors {
+                    top: parent.top
+                    bottom: parent.bottom
+                    left: replayLabel.right
+                    margins: 8 * scaleFactor
+                }
+
+                enabled: messageSimulatorController.simulationState === MessageSimulatorController.Stopped
+                font.bold: true
+                checked: messageSimulatorController.replayMode
+
+                onCheckedChanged: {
+                    messageSimulatorController.replayMode = checked;
+                }
+            }
+
+            ComboBox {
+                id: replaySpeedOptions
+                anchors {
+                    right: parent.right
+                    verticalCenter: parent.verticalCenter
+                    margins: 8 * scaleFactor
+                }
+                height: 30 * scaleFactor
+                width: 100 * scaleFactor
+                enabled: replayCheckBox.checked
+                model: [0.5, 1, 2, 5, 10]
+                displayText: currentText + "x"
+
+                onActivated: {
+                    messageSimulatorController.replaySpeed = model[index];
+                }
+
+                Component.onCompleted: {
+                    var speedIndex = model.indexOf(messageSimulatorController.replaySpeed);
+                    currentIndex = speedIndex !== -1 ? speedIndex : 1;
+                }
+            }
+        }
     }
 
     XmlLoader {
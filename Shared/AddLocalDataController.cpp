@@ -23,7 +23,9 @@
 // example app headers
 #include "DataItemListModel.h"
 #include "DsaUtility.h"
+#include "ElevationSampler.h"
 #include "MarkupLayer.h"
+#include "TerrainDerivativeEngine.h"
 
 // toolkit headers
 #include "ToolManager.h"
@@ -58,9 +60,14 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QTextStream>
+#include <QtConcurrent/QtConcurrentRun>
+
+// STL headers
+#include <memory>
 
 using namespace Esri::ArcGISRuntime;
 
@@ -230,6 +237,68 @@ void AddLocalDataController::addItemAsElevationSource(const QList<int>& indices)
   emit propertyChanged(DEFAULT_ELEVATION_PROPERTYNAME, dataPaths);
 }
 
+/*!
+ \brief Derives the terrain \a product from the provided \a indices from the list model
+ and adds the results as raster layers.
+
+ \a product is an index into \l terrainProductList. Each elevation raster is
+ processed by the \l TerrainDerivativeEngine into the \c Terrain folder of the
+ app's data path, where a product already made for the same raster is reused.
+ The products are made on worker threads and each layer is added when its
+ product is ready.
+ */
+void AddLocalDataController::addItemAsTerrainLayer(const QList<int>& indices, int product)
+{
+  if (product < TerrainDerivativeParameters::Slope || product > TerrainDerivativeParameters::Roughness)
+    return;
+
+  TerrainDerivativeParameters parameters;
+  parameters.product = static_cast<TerrainDerivativeParameters::Product>(product);
+  const QString directory = DsaUtility::dataPath() + QStringLiteral("/Terrain");
+
+  for (const int index : indices)
+  {
+    if (m_localDataModel->getDataItemType(index) != DataType::Raster)
+      continue;
+
+    // the product is made on a worker thread and the layer is added once it is done;
+    // the watcher is a child of this tool, so the result is dropped if the tool goes first
+    const QString sourcePath = m_localDataModel->getDataItemPath(index);
+    auto errorString = std::make_shared<QString>();
+    auto watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, errorString, parameters]()
+    {
+      const QString path = watcher->result();
+      watcher->deleteLater();
+
+      if (path.isEmpty())
+      {
+        emit toolErrorOccurred(QStringLiteral("Failed to create ") + TerrainDerivativeEngine::productName(parameters.product), *errorString);
+        return;
+      }
+
+      createRasterLayer(path);
+    });
+
+    watcher->setFuture(QtConcurrent::run([sourcePath, parameters, directory, errorString]()
+    {
+      return TerrainDerivativeEngine::create(sourcePath, parameters, directory, errorString.get());
+    }));
+  }
+}
+
+/*!
+ \brief Returns the names of the products which can be derived from elevation rasters.
+ */
+QStringList AddLocalDataController::terrainProductList() const
+{
+  QStringList products;
+  for (int product = TerrainDerivativeParameters::Slope; product <= TerrainDerivativeParameters::Roughness; ++product)
+    products.append(TerrainDerivativeEngine::productName(static_cast<TerrainDerivativeParameters::Product>(product)));
+
+  return products;
+}
+
 /*!
  \brief Adds the provided TPK \a path as an elevation source.
 */
@@ -267,6 +336,9 @@ void AddLocalDataController::createElevationSourceFromTpk(const QString& path)
 */
 void AddLocalDataController::createElevationSourceFromRasters(const QStringList& paths)
 {
+  // the rasters that can be read directly are also sampled on the CPU for immediate elevation lookups
+  ElevationSampler::instance()->addRasters(paths);
+
   RasterElevationSource* source = new RasterElevationSource(paths, this);
 
   connect(source, &RasterElevationSource::errorOccurred, this, &AddLocalDataController::errorOccurred);
@@ -41,6 +41,7 @@ class AddLocalDataController : public Esri::ArcGISRuntime::Toolkit::AbstractTool
 
   Q_PROPERTY(QAbstractListModel* localDataModel READ localDataModel NOTIFY localDataModelChanged)
   Q_PROPERTY(QStringList fileFilterList READ fileFilterList NOTIFY fileFilterListChanged)
+  Q_PROPERTY(QStringList terrainProductList READ terrainProductList CONSTANT)
 
 public:
   explicit AddLocalDataController(QObject* parent = nullptr);
@@ -51,6 +52,7 @@ public:
   Q_INVOKABLE void addItemAsLayer(const QList<int>& index);
   Q_INVOKABLE void addLayerFromPath(const QString& path, int layerIndex = -1, bool visible = true, bool autoAdd = true);
   Q_INVOKABLE void addItemAsElevationSource(const QList<int>& indices);
+  Q_INVOKABLE void addItemAsTerrainLayer(const QList<int>& indices, int product);
   QAbstractListModel* localDataModel() const;
 
   QString toolName() const override;
@@ -84,6 +86,7 @@ signals:
 private:
   QStringList determineFileFilters(const QString& fileType);
   QStringList fileFilterList() const { return m_fileFilterList; }
+  QStringList terrainProductList() const;
   static const QString allData() { return s_allData; }
   static const QString rasterData() { return s_rasterData; }
   static const QString geodatabaseData() { return s_geodatabaseData; }
@@ -0,0 +1,284 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "CameraFollowSmoother.h"
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+namespace
+{
+const double metersPerDegree = 111320.0;
+const double degreesToRadians = 3.14159265358979323846 / 180.0;
+
+// how quickly the camera closes on the predicted position
+const double smoothingTimeMs = 200.0;
+
+// predictions stop this far past the last fix, so that the camera does not
+// run on when fixes stop arriving
+const double maximumExtrapolationMs = 2000.0;
+
+// a jump this large, or a gap this long, restarts the track rather than gliding to it
+const double snapDistance = 1000.0; // meters
+const qint64 staleFixMs = 10000;
+
+// the course is only updated when moving, since it is noise when stationary
+const double minimumCourseSpeed = 0.5; // meters per second
+
+// smaller changes are not worth a camera update
+const double minimumMovement = 0.05; // meters
+const double minimumTurn = 0.1; // degrees
+
+double wrapLongitude(double dx)
+{
+  if (dx > 180.0)
+    return dx - 360.0;
+  if (dx < -180.0)
+    return dx + 360.0;
+
+  return dx;
+}
+
+double normalizeLongitude(double x)
+{
+  x = std::fmod(x + 180.0, 360.0);
+  return (x < 0.0 ? x + 360.0 : x) - 180.0;
+}
+
+double wrapAngle(double angle)
+{
+  angle = std::fmod(angle, 360.0);
+  if (angle > 180.0)
+    return angle - 360.0;
+  if (angle < -180.0)
+    return angle + 360.0;
+
+  return angle;
+}
+
+double distance(double x1, double y1, double x2, double y2)
+{
+  const double dx = wrapLongitude(x2 - x1) * std::cos((y1 + y2) * 0.5 * degreesToRadians);
+  const double dy = y2 - y1;
+
+  return std::sqrt(dx * dx + dy * dy) * metersPerDegree;
+}
+}
+
+/*!
+  \class Dsa::CameraFollowSmoother
+  \inmodule Dsa
+  \brief Smooths a camera target that follows a series of location fixes.
+
+  Fixes arrive at whatever rate the position source delivers them, while the
+  camera should move at the display's cadence. The smoother estimates
+  velocity and course from the most recent fixes, predicts where the target
+  is at each \l advance and eases the camera target towards that prediction,
+  so that the camera glides between sparse fixes and settles noise from
+  frequent ones.
+
+  Locations are WGS84 longitudes and latitudes in degrees; times are in
+  milliseconds from any fixed origin.
+ */
+
+/*!
+  \brief Constructor.
+ */
+CameraFollowSmoother::CameraFollowSmoother()
+{
+}
+
+/*!
+  \brief Forgets every fix; the next \l advance jumps straight to the first new fix.
+ */
+void CameraFollowSmoother::reset()
+{
+  m_fixCount = 0;
+  m_velocityX = 0.0;
+  m_velocityY = 0.0;
+  m_velocityZ = 0.0;
+  m_moving = false;
+  m_snap = true;
+  m_valid = false;
+}
+
+/*!
+  \brief Adds a fix at \a x, \a y and \a z received at \a timeMs.
+ */
+void CameraFollowSmoother::addFix(double x, double y, double z, qint64 timeMs)
+{
+  if (m_fixCount > 0)
+  {
+    const Fix& last = m_fixes[m_fixCount - 1];
+    if (timeMs <= last.timeMs)
+      return;
+
+    if (timeMs - last.timeMs > staleFixMs || distance(last.x, last.y, x, y) > snapDistance)
+    {
+      reset();
+    }
+    else if (m_fixCount == maximumFixes)
+    {
+      for (int i = 1; i < maximumFixes; ++i)
+        m_fixes[i - 1] = m_fixes[i];
+
+      --m_fixCount;
+    }
+  }
+
+  m_fixes[m_fixCount++] = Fix{x, y, z, timeMs};
+
+  if (m_fixCount < 2)
+    return;
+
+  // the velocity across all of the retained fixes is steadier than between the last two
+  const Fix& first = m_fixes[0];
+  const Fix& last = m_fixes[m_fixCount - 1];
+  const double seconds = (last.timeMs - first.timeMs) / 1000.0;
+  m_velocityX = wrapLongitude(last.x - first.x) / seconds;
+  m_velocityY = (last.y - first.y) / seconds;
+  m_velocityZ = (last.z - first.z) / seconds;
+  m_fixIntervalMs = (last.timeMs - first.timeMs) / (m_fixCount - 1);
+
+  const double east = m_velocityX * std::cos(last.y * degreesToRadians);
+  const double north = m_velocityY;
+  m_moving = std::sqrt(east * east + north * north) * metersPerDegree >= minimumCourseSpeed;
+  if (m_moving)
+    m_course = std::fmod(std::atan2(east, north) / degreesToRadians + 360.0, 360.0);
+  else if (m_hasSourceHeading)
+    m_course = m_sourceHeading;
+}
+
+/*!
+  \brief Sets the \a heading, in degrees clockwise from north, reported by
+  the position source.
+
+  The course over ground is noise when moving slowly, so below walking pace
+  the camera faces this heading instead.
+ */
+void CameraFollowSmoother::setSourceHeading(double heading)
+{
+  if (std::isnan(heading))
+    return;
+
+  m_sourceHeading = std::fmod(std::fmod(heading, 360.0) + 360.0, 360.0);
+  m_hasSourceHeading = true;
+
+  if (!m_moving)
+    m_course = m_sourceHeading;
+}
+
+/*!
+  \brief Moves the camera target on to \a timeMs.
+
+  Returns \c true if the target has moved or turned enough since the last
+  time \c true was returned to be worth updating the camera.
+ */
+bool CameraFollowSmoother::advance(qint64 timeMs)
+{
+  if (m_fixCount == 0)
+    return false;
+
+  const Fix& last = m_fixes[m_fixCount - 1];
+  const double extrapolationMs = qBound(0.0, static_cast<double>(timeMs - last.timeMs),
+                                        qMin(maximumExtrapolationMs, 1.5 * m_fixIntervalMs));
+  const double seconds = extrapolationMs / 1000.0;
+  const double predictedX = normalizeLongitude(last.x + m_velocityX * seconds);
+  const double predictedY = qBound(-90.0, last.y + m_velocityY * seconds, 90.0);
+  const double predictedZ = last.z + m_velocityZ * seconds;
+
+  if (m_snap)
+  {
+    m_x = predictedX;
+    m_y = predictedY;
+    m_z = predictedZ;
+    m_heading = m_course;
+    m_snap = false;
+  }
+  else
+  {
+    const double elapsedMs = qMax<qint64>(0, timeMs - m_lastAdvanceMs);
+    const double blend = 1.0 - std::exp(-elapsedMs / smoothingTimeMs);
+    m_x = normalizeLongitude(m_x + wrapLongitude(predictedX - m_x) * blend);
+    m_y += (predictedY - m_y) * blend;
+    m_z += (predictedZ - m_z) * blend;
+    m_heading = std::fmod(m_heading + wrapAngle(m_course - m_heading) * blend + 360.0, 360.0);
+  }
+
+  m_lastAdvanceMs = timeMs;
+
+  if (m_valid &&
+      distance(m_reportedX, m_reportedY, m_x, m_y) < minimumMovement &&
+      std::fabs(m_z - m_reportedZ) < minimumMovement &&
+      std::fabs(wrapAngle(m_heading - m_reportedHeading)) < minimumTurn)
+  {
+    return false;
+  }
+
+  m_reportedX = m_x;
+  m_reportedY = m_y;
+  m_reportedZ = m_z;
+  m_reportedHeading = m_heading;
+  m_valid = true;
+  return true;
+}
+
+/*!
+  \brief Returns whether the smoother has a camera target.
+ */
+bool CameraFollowSmoother::isValid() const
+{
+  return m_valid;
+}
+
+/*!
+  \brief Returns the longitude of the camera target.
+ */
+double CameraFollowSmoother::x() const
+{
+  return m_reportedX;
+}
+
+/*!
+  \brief Returns the latitude of the camera target.
+ */
+double CameraFollowSmoother::y() const
+{
+  return m_reportedY;
+}
+
+/*!
+  \brief Returns the height of the camera target.
+ */
+double CameraFollowSmoother::z() const
+{
+  return m_reportedZ;
+}
+
+/*!
+  \brief Returns the course, in degrees clockwise from north, that the camera should face.
+ */
+double CameraFollowSmoother::heading() const
+{
+  return m_reportedHeading;
+}
+
+} // Dsa
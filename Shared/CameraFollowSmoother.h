@@ -0,0 +1,80 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef CAMERAFOLLOWSMOOTHER_H
+#define CAMERAFOLLOWSMOOTHER_H
+
+// Qt headers
+#include <QtGlobal>
+
+namespace Dsa {
+
+class CameraFollowSmoother
+{
+public:
+  CameraFollowSmoother();
+
+  void reset();
+  void addFix(double x, double y, double z, qint64 timeMs);
+  void setSourceHeading(double heading);
+  bool advance(qint64 timeMs);
+
+  bool isValid() const;
+  double x() const;
+  double y() const;
+  double z() const;
+  double heading() const;
+
+private:
+  struct Fix
+  {
+    double x;
+    double y;
+    double z;
+    qint64 timeMs;
+  };
+
+  static const int maximumFixes = 4;
+
+  Fix m_fixes[maximumFixes];
+  int m_fixCount = 0;
+  double m_velocityX = 0.0;
+  double m_velocityY = 0.0;
+  double m_velocityZ = 0.0;
+  double m_course = 0.0;
+  double m_sourceHeading = 0.0;
+  bool m_hasSourceHeading = false;
+  bool m_moving = false;
+  qint64 m_fixIntervalMs = 1000;
+  bool m_snap = true;
+
+  double m_x = 0.0;
+  double m_y = 0.0;
+  double m_z = 0.0;
+  double m_heading = 0.0;
+  qint64 m_lastAdvanceMs = 0;
+
+  double m_reportedX = 0.0;
+  double m_reportedY = 0.0;
+  double m_reportedZ = 0.0;
+  double m_reportedHeading = 0.0;
+  bool m_valid = false;
+};
+
+} // Dsa
+
+#endif // CAMERAFOLLOWSMOOTHER_H
@@ -27,6 +27,7 @@
 #include "IdentifyController.h"
 #include "LayerResultsManager.h"
 #include "LineOfSightController.h"
+#include "TerrainProfileController.h"
 #include "ViewshedController.h"
 #include "GeoElementUtils.h"
 
@@ -52,6 +53,7 @@ const QString ContextMenuController::FOLLOW_OPTION = "Follow";
 const QString ContextMenuController::IDENTIFY_OPTION = "Identify";
 const QString ContextMenuController::LINE_OF_SIGHT_OPTION = "Line of sight";
 const QString ContextMenuController::VIEWSHED_OPTION = "Viewshed";
+const QString ContextMenuController::TERRAIN_PROFILE_OPTION = "Elevation profile";
 const QString ContextMenuController::OBSERVATION_REPORT_OPTION = "Observation";
 
 /*!
@@ -72,12 +74,14 @@ const QString ContextMenuController::OBSERVATION_REPORT_OPTION = "Observation";
     \li Observation Report.
     \li Viewshed.
     \li Line of sight.
+    \li Elevation profile.
   \endlist
 
   \sa ObservationReportController
   \sa IdentifyController
   \sa ViewshedController
   \sa LineOfSightController
+  \sa TerrainProfileController
   \sa Esri::ArcGISRuntime::Toolkit::CoordinateConversionController
  */
 
@@ -314,6 +318,7 @@ void ContextMenuController::setContextLocation(const Point& location)
 
   addOption(ELEVATION_OPTION);
   addOption(VIEWSHED_OPTION);
+  addOption(TERRAIN_PROFILE_OPTION);
   addOption(OBSERVATION_REPORT_OPTION);
 }
 
@@ -409,6 +414,20 @@ void ContextMenuController::processGeoElements()
   // if we have at least 1 GeoElement, we can identify
   addOption(IDENTIFY_OPTION);
 
+  // if we have a line or a point GeoElement, we can profile the terrain along or to it
+  for (const auto& geoElementsByTitle : { m_contextGraphics, m_contextFeatures })
+  {
+    for (const auto& geoElements : geoElementsByTitle)
+    {
+      for (GeoElement* geoElement : geoElements)
+      {
+        const GeometryType geometryType = geoElement ? geoElement->geometry().geometryType() : GeometryType::Unknown;
+        if (geometryType == GeometryType::Polyline || geometryType == GeometryType::Point)
+          addOption(TERRAIN_PROFILE_OPTION);
+      }
+    }
+  }
+
   int pointGraphicsCount = 0;
   for (const auto& geoElements : qAsConst(m_contextGraphics))
   {
@@ -568,6 +587,37 @@ void ContextMenuController::selectOption(const QString& option)
     losFunc(m_contextGraphics);
     losFunc(m_contextFeatures);
   }
+  else if (option == TERRAIN_PROFILE_OPTION)
+  {
+    TerrainProfileController* terrainProfileTool = Toolkit::ToolManager::instance().tool<TerrainProfileController>();
+    if (!terrainProfileTool)
+      return;
+
+    // profile along the first line found, else to the first point, else to the context location
+    auto findGeoElement = [this](GeometryType geometryType) -> GeoElement*
+    {
+      for (const auto& geoElementsByTitle : { m_contextGraphics, m_contextFeatures })
+      {
+        for (const auto& geoElements : geoElementsByTitle)
+        {
+          for (GeoElement* geoElement : geoElements)
+          {
+            if (geoElement && geoElement->geometry().geometryType() == geometryType)
+              return geoElement;
+          }
+        }
+      }
+
+      return nullptr;
+    };
+
+    if (GeoElement* line = findGeoElement(GeometryType::Polyline))
+      terrainProfileTool->profileAlongGeometry(line->geometry());
+    else if (GeoElement* point = findGeoElement(GeometryType::Point))
+      terrainProfileTool->profileFromLocationToGeoElement(point);
+    else
+      terrainProfileTool->profileAlongGeometry(m_contextBaseSurfaceLocation);
+  }
   else if (option == OBSERVATION_REPORT_OPTION)
   {
     Dsa::ObservationReportController* observationReportTool = Toolkit::ToolManager::instance().tool<Dsa::ObservationReportController>();
@@ -55,6 +55,7 @@ public:
   static const QString IDENTIFY_OPTION;
   static const QString LINE_OF_SIGHT_OPTION;
   static const QString VIEWSHED_OPTION;
+  static const QString TERRAIN_PROFILE_OPTION;
   static const QString OBSERVATION_REPORT_OPTION;
 
   explicit ContextMenuController(QObject* parent = nullptr);
@@ -405,6 +405,15 @@ void DsaController::writeDefaultMessageFeeds()
   QJsonObject observationReportJson;
   observationReportJson.insert(MessageFeedConstants::OBSERVATION_REPORT_CONFIG_PORT, 45679);
   m_dsaSettings[MessageFeedConstants::OBSERVATION_REPORT_CONFIG_PROPERTYNAME] = observationReportJson;
+
+  // simulated entities are off by default; relative GPX paths are in the SimulationDirectory
+  QJsonObject entitySimulationJson;
+  entitySimulationJson.insert(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_ENABLED, false);
+  entitySimulationJson.insert(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_GPX_FILES, QJsonArray{QStringLiteral("MontereyMounted.gpx")});
+  entitySimulationJson.insert(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_OUTPUT, MessageFeedConstants::ENTITY_SIMULATION_OUTPUT_INBOUND);
+  entitySimulationJson.insert(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_PORT, 45678);
+  entitySimulationJson.insert(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_UPDATE_INTERVAL, 1000);
+  m_dsaSettings[MessageFeedConstants::ENTITY_SIMULATION_CONFIG_PROPERTYNAME] = entitySimulationJson;
 }
 
 /*! \brief internal
@@ -438,6 +447,8 @@ void DsaController::createDefaultSettings()
   m_dsaSettings["DefaultElevationSource"] = QString("%1/CaDEM.tpk").arg(m_dsaSettings["ElevationDirectory"].toString());
   m_dsaSettings["GpxFile"] = QString("%1/MontereyMounted.gpx").arg(m_dsaSettings["SimulationDirectory"].toString());
   m_dsaSettings["SimulateLocation"] = QStringLiteral("true");
+  m_dsaSettings["NmeaSource"] = QString();
+  m_dsaSettings["NmeaMaximumRate"] = 10;
   writeDefaultMessageFeeds();
   writeDefaultInitialLocation();
   m_dsaSettings[Toolkit::CoordinateConversionConstants::COORDINATE_FORMAT_PROPERTY] = Toolkit::CoordinateConversionConstants::MGRS_FORMAT;
@@ -0,0 +1,536 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "EntitySimulator.h"
+
+// example app headers
+#include "DataListener.h"
+#include "DataSender.h"
+#include "Message.h"
+#include "MessageFeedDevice.h"
+#include "MessageFeedsController.h"
+
+// Qt headers
+#include <QFileInfo>
+#include <QUdpSocket>
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+namespace
+{
+// entities that share a track are spread along it by the golden ratio
+// so that they never bunch up, however many there are
+const double entitySpacing = 0.6180339887498949;
+
+const QString defaultMessageType{QStringLiteral("position_report_land")};
+const QString defaultSymbolId{QStringLiteral("SFGPUC---------")};
+const QString directionName{QStringLiteral("direction")};
+
+QByteArray element(const QString& name, const QString& value)
+{
+  return '<' + name.toUtf8() + '>' + value.toHtmlEscaped().toUtf8() + "</" + name.toUtf8() + '>';
+}
+}
+
+/*!
+  \class Dsa::EntitySimulator
+  \inmodule Dsa
+  \inherits QObject
+  \brief Simulates many entities moving along GPX tracks at once.
+
+  Each track in the loaded GPX files becomes an entity. Entities are advanced
+  together in one pass over compact arrays, using the same interpolation as
+  \l GPXLocationSimulator, and their positions are published as GeoMessages on
+  every update.
+
+  Messages are either handed straight to a \l MessageFeedsController as if they
+  had been received, or broadcast over UDP for other devices to receive.
+
+  \sa GPXTrack
+ */
+
+/*!
+  \enum Dsa::EntitySimulator::Output
+  \value InboundMessages Messages are delivered to the \l messageFeedsController.
+  \value OutboundBroadcast Messages are broadcast on the \l udpPort.
+ */
+
+/*!
+  \brief Constructor taking an optional \a parent.
+ */
+EntitySimulator::EntitySimulator(QObject* parent) :
+  QObject(parent),
+  m_messageType(defaultMessageType),
+  m_symbolId(defaultSymbolId)
+{
+  m_timer.setTimerType(Qt::PreciseTimer);
+  m_timer.setInterval(1000);
+  connect(&m_timer, &QTimer::timeout, this, &EntitySimulator::tick);
+
+  updateMessageTemplates();
+}
+
+/*!
+  \brief Destructor.
+ */
+EntitySimulator::~EntitySimulator()
+{
+  releaseOutput();
+}
+
+/*!
+  \brief Adds an entity for every track in the GPX files \a fileNames.
+
+  A file with several \c trk elements adds several entities. Returns the
+  number of entities added.
+ */
+int EntitySimulator::loadGpxFiles(const QStringList& fileNames)
+{
+  int added = 0;
+  for (const QString& fileName : fileNames)
+  {
+    QString errorString;
+    const QList<GPXTrack> tracks = GPXTrack::readFile(fileName, &errorString);
+    if (!errorString.isEmpty())
+      emit errorOccurred(fileName + QStringLiteral(": ") + errorString);
+
+    const QString baseName = QFileInfo(fileName).completeBaseName();
+    for (int i = 0; i < tracks.size(); ++i)
+    {
+      const QString trackName = tracks.at(i).name();
+      addTrack(tracks.at(i), trackName.isEmpty() ? QString("%1 %2").arg(baseName).arg(i + 1) : trackName);
+      added++;
+    }
+  }
+
+  return added;
+}
+
+/*!
+  \brief Adds an entity that moves along \a track, reported with \a name.
+
+  The same track can be added many times; each copy starts at a different
+  point along it.
+ */
+void EntitySimulator::addTrack(const GPXTrack& track, const QString& name)
+{
+  if (!track.isValid())
+    return;
+
+  const int index = m_tracks.size();
+  const double spacing = std::fmod(index * entitySpacing, 1.0);
+
+  m_tracks.append(track);
+  m_names.append(name.isEmpty() ? QString("Entity %1").arg(index + 1) : name);
+  m_offsets.append(static_cast<qint64>(spacing * track.duration()));
+  m_segmentHints.append(-1);
+  m_positions.append(track.positionAtTime(track.startTime()));
+  m_messagePrefixes.append(messagePrefix(index));
+}
+
+/*!
+  \brief Removes every entity.
+ */
+void EntitySimulator::clear()
+{
+  stop();
+
+  m_tracks.clear();
+  m_names.clear();
+  m_offsets.clear();
+  m_segmentHints.clear();
+  m_positions.clear();
+  m_messagePrefixes.clear();
+}
+
+/*!
+  \brief Returns the number of simulated entities.
+ */
+int EntitySimulator::entityCount() const
+{
+  return m_tracks.size();
+}
+
+/*!
+  \brief Returns the name of the entity at \a index.
+ */
+QString EntitySimulator::entityName(int index) const
+{
+  return m_names.at(index);
+}
+
+/*!
+  \brief Returns the position of the entity at \a index as of the last update.
+ */
+GPXTrack::Position EntitySimulator::entityPosition(int index) const
+{
+  return m_positions.at(index);
+}
+
+/*!
+  \brief Returns where the simulated messages are published.
+ */
+EntitySimulator::Output EntitySimulator::output() const
+{
+  return m_output;
+}
+
+/*!
+  \brief Sets where the simulated messages are published to \a output.
+
+  This takes effect the next time the simulation is started.
+ */
+void EntitySimulator::setOutput(Output output)
+{
+  m_output = output;
+}
+
+/*!
+  \brief Returns the controller that receives inbound messages.
+ */
+MessageFeedsController* EntitySimulator::messageFeedsController() const
+{
+  return m_messageFeedsController;
+}
+
+/*!
+  \brief Sets the controller that receives inbound messages to \a messageFeedsController.
+ */
+void EntitySimulator::setMessageFeedsController(MessageFeedsController* messageFeedsController)
+{
+  m_messageFeedsController = messageFeedsController;
+}
+
+/*!
+  \brief Returns the UDP port that outbound messages are broadcast on.
+ */
+int EntitySimulator::udpPort() const
+{
+  return m_udpPort;
+}
+
+/*!
+  \brief Sets the UDP port that outbound messages are broadcast on to \a port.
+ */
+void EntitySimulator::setUdpPort(int port)
+{
+  m_udpPort = port;
+}
+
+/*!
+  \brief Returns the message type of the simulated messages.
+
+  The default is \c position_report_land.
+ */
+QString EntitySimulator::messageType() const
+{
+  return m_messageType;
+}
+
+/*!
+  \brief Sets the message type of the simulated messages to \a messageType.
+ */
+void EntitySimulator::setMessageType(const QString& messageType)
+{
+  m_messageType = messageType;
+  updateMessageTemplates();
+}
+
+/*!
+  \brief Returns the symbol ID of the simulated entities.
+ */
+QString EntitySimulator::symbolId() const
+{
+  return m_symbolId;
+}
+
+/*!
+  \brief Sets the symbol ID of the simulated entities to \a symbolId.
+ */
+void EntitySimulator::setSymbolId(const QString& symbolId)
+{
+  m_symbolId = symbolId;
+  updateMessageTemplates();
+}
+
+/*!
+  \brief Returns the interval between updates in milliseconds.
+ */
+int EntitySimulator::updateInterval() const
+{
+  return m_timer.interval();
+}
+
+/*!
+  \brief Sets the interval between updates to \a msecs.
+
+  The default is one second.
+ */
+void EntitySimulator::setUpdateInterval(int msecs)
+{
+  m_timer.setInterval(qMax(1, msecs));
+}
+
+/*!
+  \brief Returns how much faster than real time the tracks are played.
+ */
+double EntitySimulator::playbackMultiplier() const
+{
+  return m_playbackMultiplier;
+}
+
+/*!
+  \brief Sets how much faster than real time the tracks are played to \a multiplier.
+ */
+void EntitySimulator::setPlaybackMultiplier(double multiplier)
+{
+  if (multiplier <= 0.0)
+    return;
+
+  // continue from the current time at the new speed
+  m_startPlaybackTime = m_playbackTime;
+  m_clock.restart();
+  m_playbackMultiplier = multiplier;
+}
+
+/*!
+  \brief Returns whether the simulation is running.
+ */
+bool EntitySimulator::isRunning() const
+{
+  return m_timer.isActive();
+}
+
+/*!
+  \brief Returns the simulated time in msecs since the simulation was first started.
+ */
+qint64 EntitySimulator::playbackTime() const
+{
+  return m_playbackTime;
+}
+
+/*!
+  \brief Moves every entity to \a playbackTime msecs into the simulation.
+
+  Each entity loops along its own track.
+ */
+void EntitySimulator::advance(qint64 playbackTime)
+{
+  m_playbackTime = playbackTime;
+
+  const int count = m_tracks.size();
+  const GPXTrack* tracks = m_tracks.constData();
+  const qint64* offsets = m_offsets.constData();
+  int* hints = m_segmentHints.data();
+  GPXTrack::Position* positions = m_positions.data();
+
+  for (int i = 0; i < count; ++i)
+  {
+    const qint64 duration = tracks[i].duration();
+    const qint64 trackTime = duration > 0 ? (playbackTime + offsets[i]) % duration : 0;
+    positions[i] = tracks[i].positionAtTime(tracks[i].startTime() + trackTime, &hints[i]);
+  }
+}
+
+/*!
+  \brief Returns a GeoMessage for each entity at its current position.
+ */
+QList<QByteArray> EntitySimulator::createMessages() const
+{
+  QList<QByteArray> messages;
+  messages.reserve(m_tracks.size());
+
+  for (int i = 0; i < m_tracks.size(); ++i)
+  {
+    const GPXTrack::Position& position = m_positions.at(i);
+    QByteArray message = m_messagePrefixes.at(i);
+    message.reserve(message.size() + m_messageSuffix.size() + 64);
+    message.append(QByteArray::number(position.longitude, 'f', 7));
+    message.append(',');
+    message.append(QByteArray::number(position.latitude, 'f', 7));
+    message.append(m_messageSuffix);
+    message.append(QByteArray::number(position.heading, 'f', 1));
+    message.append("</" + directionName.toUtf8() + "></" + Message::GEOMESSAGE_ELEMENT_NAME.toUtf8() + '>');
+    messages.append(message);
+  }
+
+  return messages;
+}
+
+/*!
+  \brief Starts publishing entity positions on every update interval.
+ */
+void EntitySimulator::start()
+{
+  if (isRunning())
+    return;
+
+  if (m_tracks.isEmpty())
+  {
+    emit errorOccurred(tr("No GPX tracks have been loaded for the simulation"));
+    return;
+  }
+
+  releaseOutput();
+
+  if (m_output == Output::InboundMessages)
+  {
+    if (!m_messageFeedsController)
+    {
+      emit errorOccurred(tr("Inbound simulation requires a message feeds controller"));
+      return;
+    }
+
+    // messages take the same path as those received from the network
+    m_feedDevice = new MessageFeedDevice(this);
+    m_feedListener = new DataListener(m_feedDevice, this);
+    m_messageFeedsController->addDataListener(m_feedListener);
+  }
+  else
+  {
+    if (m_udpPort == -1)
+    {
+      emit errorOccurred(tr("Outbound simulation requires a UDP port"));
+      return;
+    }
+
+    m_dataSender = new DataSender(this);
+
+    QUdpSocket* udpSocket = new QUdpSocket(m_dataSender);
+    udpSocket->connectToHost(QHostAddress::Broadcast, m_udpPort, QIODevice::WriteOnly);
+    m_dataSender->setDevice(udpSocket);
+  }
+
+  m_startPlaybackTime = m_playbackTime;
+  m_clock.start();
+  m_timer.start();
+
+  tick();
+}
+
+/*!
+  \brief Stops publishing entity positions.
+ */
+void EntitySimulator::stop()
+{
+  m_timer.stop();
+  releaseOutput();
+}
+
+/*!
+  \internal
+ */
+void EntitySimulator::tick()
+{
+  // the time follows the clock rather than counting intervals,
+  // so late updates do not slow the entities down
+  advance(m_startPlaybackTime + static_cast<qint64>(m_clock.elapsed() * m_playbackMultiplier));
+  publish(createMessages());
+
+  emit updated(m_playbackTime);
+}
+
+/*!
+  \internal
+ */
+void EntitySimulator::publish(const QList<QByteArray>& messages)
+{
+  if (m_feedDevice)
+  {
+    m_feedDevice->setMessages(messages);
+    m_feedDevice->deliverAll();
+    return;
+  }
+
+  if (!m_dataSender)
+    return;
+
+  for (const QByteArray& message : messages)
+    m_dataSender->sendData(message);
+}
+
+/*!
+  \internal
+ */
+void EntitySimulator::updateMessageTemplates()
+{
+  for (int i = 0; i < m_messagePrefixes.size(); ++i)
+    m_messagePrefixes[i] = messagePrefix(i);
+
+  m_messageSuffix = "</" + Message::GEOMESSAGE_CONTROL_POINTS_NAME.toUtf8() + "><" + directionName.toUtf8() + '>';
+}
+
+/*!
+  \internal
+
+  Everything but the position and heading is fixed for an entity,
+  so it is encoded once rather than on every update.
+ */
+QByteArray EntitySimulator::messagePrefix(int index) const
+{
+  return '<' + Message::GEOMESSAGE_ELEMENT_NAME.toUtf8() + '>' +
+         element(Message::GEOMESSAGE_TYPE_NAME, m_messageType) +
+         element(Message::GEOMESSAGE_ACTION_NAME, Message::fromMessageAction(Message::MessageAction::Update)) +
+         element(Message::GEOMESSAGE_ID_NAME, QString("entity-simulator-%1").arg(index)) +
+         element(Message::GEOMESSAGE_WKID_NAME, QStringLiteral("4326")) +
+         element(Message::GEOMESSAGE_SIC_NAME, m_symbolId) +
+         element(Message::GEOMESSAGE_UNIQUE_DESIGNATION_NAME, m_names.at(index)) +
+         '<' + Message::GEOMESSAGE_CONTROL_POINTS_NAME.toUtf8() + '>';
+}
+
+/*!
+  \internal
+ */
+void EntitySimulator::releaseOutput()
+{
+  if (m_feedListener)
+  {
+    if (m_messageFeedsController)
+      m_messageFeedsController->removeDataListener(m_feedListener);
+
+    delete m_feedListener;
+    m_feedListener = nullptr;
+  }
+
+  delete m_feedDevice;
+  m_feedDevice = nullptr;
+
+  delete m_dataSender;
+  m_dataSender = nullptr;
+}
+
+} // Dsa
+
+// Signal Documentation
+
+/*!
+  \fn void EntitySimulator::updated(qint64 playbackTime);
+
+  \brief Signal emitted after every entity has been moved to \a playbackTime
+  msecs into the simulation and published.
+ */
+
+/*!
+  \fn void EntitySimulator::errorOccurred(const QString& error);
+
+  \brief Signal emitted when an \a error occurs.
+ */
@@ -0,0 +1,129 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef ENTITYSIMULATOR_H
+#define ENTITYSIMULATOR_H
+
+#include "GPXTrack.h"
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+
+namespace Dsa {
+
+class DataListener;
+class DataSender;
+class MessageFeedDevice;
+class MessageFeedsController;
+
+class EntitySimulator : public QObject
+{
+  Q_OBJECT
+
+public:
+  enum class Output
+  {
+    InboundMessages = 0,
+    OutboundBroadcast = 1
+  };
+
+  explicit EntitySimulator(QObject* parent = nullptr);
+  ~EntitySimulator();
+
+  int loadGpxFiles(const QStringList& fileNames);
+  void addTrack(const GPXTrack& track, const QString& name = QString());
+  void clear();
+
+  int entityCount() const;
+  QString entityName(int index) const;
+  GPXTrack::Position entityPosition(int index) const;
+
+  Output output() const;
+  void setOutput(Output output);
+
+  MessageFeedsController* messageFeedsController() const;
+  void setMessageFeedsController(MessageFeedsController* messageFeedsController);
+
+  int udpPort() const;
+  void setUdpPort(int port);
+
+  QString messageType() const;
+  void setMessageType(const QString& messageType);
+
+  QString symbolId() const;
+  void setSymbolId(const QString& symbolId);
+
+  int updateInterval() const;
+  void setUpdateInterval(int msecs);
+
+  double playbackMultiplier() const;
+  void setPlaybackMultiplier(double multiplier);
+
+  bool isRunning() const;
+
+  qint64 playbackTime() const;
+  void advance(qint64 playbackTime);
+  QList<QByteArray> createMessages() const;
+
+public slots:
+  void start();
+  void stop();
+
+signals:
+  void updated(qint64 playbackTime);
+  void errorOccurred(const QString& error);
+
+private:
+  Q_DISABLE_COPY(EntitySimulator)
+
+  void tick();
+  void publish(const QList<QByteArray>& messages);
+  void updateMessageTemplates();
+  QByteArray messagePrefix(int index) const;
+  void releaseOutput();
+
+  // entities are kept as parallel arrays so that a tick is a single pass
+  QVector<GPXTrack> m_tracks;
+  QVector<QString> m_names;
+  QVector<qint64> m_offsets;
+  QVector<int> m_segmentHints;
+  QVector<GPXTrack::Position> m_positions;
+  QVector<QByteArray> m_messagePrefixes;
+  QByteArray m_messageSuffix;
+
+  Output m_output = Output::InboundMessages;
+  QPointer<MessageFeedsController> m_messageFeedsController;
+  MessageFeedDevice* m_feedDevice = nullptr;
+  DataListener* m_feedListener = nullptr;
+  DataSender* m_dataSender = nullptr;
+  int m_udpPort = -1;
+  QString m_messageType;
+  QString m_symbolId;
+
+  double m_playbackMultiplier = 1.0;
+  qint64 m_playbackTime = 0;
+  qint64 m_startPlaybackTime = 0;
+  QElapsedTimer m_clock;
+  QTimer m_timer;
+};
+
+} // Dsa
+
+#endif // ENTITYSIMULATOR_H
@@ -20,25 +20,48 @@
 
 #include "FollowPositionController.h"
 
+// example app headers
+#include "LocationController.h"
+#include "LocationDispatcher.h"
+
 // toolkit headers
 #include "ToolManager.h"
 #include "ToolResourceProvider.h"
 
 // C++ API headers
+#include "GeometryEngine.h"
 #include "GlobeCameraController.h"
 #include "MapView.h"
 #include "OrbitGeoElementCameraController.h"
 #include "SceneView.h"
 
+// Qt headers
+#include <QQuickItem>
+
 using namespace Esri::ArcGISRuntime;
 
 namespace Dsa {
 
+namespace
+{
+const double followDistance = 2000.0;
+
+// the camera moves on display frames, but no more often than this
+const double maximumCameraRate = 30.0; // per second
+}
+
 /*!
   \class Dsa::FollowPositionController
   \inmodule Dsa
   \inherits Toolkit::AbstractTool
   \brief Tool controller for managing the follow navigation modes.
+
+  When following the location in a scene, the camera is not re-targeted on
+  every location fix. Fixes feed a \l CameraFollowSmoother, and the camera is
+  moved from \c QQuickWindow::afterAnimating as the window prepares each
+  frame, so that a fast position source does not flood the view with camera
+  changes and a slow one does not move the camera in steps. Frames are only
+  asked for while the camera target is still moving.
  */
 
 /*!
@@ -51,6 +74,8 @@ FollowPositionController::FollowPositionController(QObject* parent) :
   connect(Toolkit::ToolResourceProvider::instance(), &Toolkit::ToolResourceProvider::geoViewChanged, this,
           &FollowPositionController::updateGeoView);
 
+  m_clock.start();
+
   updateGeoView();
 
   Toolkit::ToolManager::instance().addTool(this);
@@ -94,6 +119,24 @@ FollowPositionController::FollowMode FollowPositionController::followMode() cons
   return m_mode;
 }
 
+/*!
+  \property FollowPositionController::fixRate
+  \brief Returns the number of location fixes received per second while following in a scene.
+ */
+double FollowPositionController::fixRate() const
+{
+  return m_fixRate;
+}
+
+/*!
+  \property FollowPositionController::cameraUpdateRate
+  \brief Returns the number of times per second the camera moved while following in a scene.
+ */
+double FollowPositionController::cameraUpdateRate() const
+{
+  return m_cameraUpdateRate;
+}
+
 /*!
   \brief Returns the name of the tool - c "follow position".
  */
@@ -115,8 +158,9 @@ void FollowPositionController::followGeoElement(GeoElement* elementToFollow)
     return;
 
   m_mode = FollowMode::TrackUp;
+  stopSmoothFollow();
 
-  OrbitGeoElementCameraController* followController = new OrbitGeoElementCameraController(elementToFollow, 2000.0, this);
+  OrbitGeoElementCameraController* followController = new OrbitGeoElementCameraController(elementToFollow, followDistance, this);
   sceneView->setCameraController(followController);
 }
 
@@ -153,6 +197,8 @@ bool FollowPositionController::handleFollowInMap()
   if (!mapView)
     return false;
 
+  stopSmoothFollow();
+
   mapView->locationDisplay()->setAutoPanMode(m_mode == FollowMode::Disabled ?
                                                LocationDisplayAutoPanMode::Off :
                                                LocationDisplayAutoPanMode::Navigation );
@@ -170,32 +216,196 @@ bool FollowPositionController::handleFollowInScene()
 
   if (m_mode == FollowMode::Disabled)
   {
+    stopSmoothFollow();
     sceneView->setCameraController(new GlobeCameraController(this));
   }
   else
   {
+    // start from the location graphic, or the last known location if it has not been drawn yet
+    Point location = LocationDispatcher::instance()->location();
     GraphicListModel* graphics = locationGraphicsModel();
-    if (!graphics || graphics->rowCount() != 1)
-      return true;
+    if (graphics && graphics->rowCount() == 1 && graphics->at(0))
+      location = geometry_cast<Point>(graphics->at(0)->geometry());
 
-    Graphic* locationGraphic = graphics->at(0);
-    if (!locationGraphic)
+    if (location.isEmpty())
       return true;
 
-    OrbitGeoElementCameraController* followController = new OrbitGeoElementCameraController(locationGraphic, 2000., this);
+    stopSmoothFollow();
+    startSmoothFollow(location);
 
+    // the heading is driven by the smoother's course, or the source's heading when slow, in track up mode
+    m_followCamera->setAutoHeadingEnabled(false);
     if (m_mode == FollowMode::NorthUp)
-    {
-      followController->setAutoHeadingEnabled(false);
-      followController->setCameraPitchOffset(0.);
-    }
+      m_followCamera->setCameraPitchOffset(0.);
 
-    sceneView->setCameraController(followController);
+    sceneView->setCameraController(m_followCamera);
   }
 
   return true;
 }
 
+/*!
+  \internal
+ */
+void FollowPositionController::startSmoothFollow(const Point& location)
+{
+  m_smoother.reset();
+  handleFix(location);
+  m_smoother.advance(m_clock.elapsed());
+
+  if (!m_followTarget)
+    m_followTarget = new Graphic(this);
+
+  m_followTarget->setGeometry(location);
+  m_followCamera = new OrbitGeoElementCameraController(m_followTarget, followDistance, this);
+
+  m_fixCount = 0;
+  m_cameraUpdateCount = 0;
+  m_statisticsStartMs = m_clock.elapsed();
+
+  if (m_locationSubscription == -1)
+  {
+    m_locationSubscription = LocationDispatcher::instance()->subscribe(this, 0.0, 0.0, [this](const Point& fix)
+    {
+      handleFix(fix);
+    });
+  }
+
+  LocationController* locationController = Toolkit::ToolManager::instance().tool<LocationController>();
+  if (locationController && !m_headingConnection)
+  {
+    m_headingConnection = connect(locationController, &LocationController::headingChanged, this, [this](double heading)
+    {
+      m_smoother.setSourceHeading(heading);
+      requestCameraUpdate();
+    });
+  }
+
+  requestCameraUpdate();
+}
+
+/*!
+  \internal
+ */
+void FollowPositionController::stopSmoothFollow()
+{
+  disconnect(m_headingConnection);
+  m_headingConnection = QMetaObject::Connection();
+
+  if (m_locationSubscription != -1)
+  {
+    LocationDispatcher::instance()->unsubscribe(m_locationSubscription);
+    m_locationSubscription = -1;
+  }
+
+  // the scene view may still be using the old controller until it is given a new one
+  if (m_followCamera)
+  {
+    m_followCamera->deleteLater();
+    m_followCamera = nullptr;
+  }
+}
+
+/*!
+  \internal
+ */
+void FollowPositionController::handleFix(const Point& location)
+{
+  if (location.isEmpty())
+    return;
+
+  const Point fix = location.spatialReference() == SpatialReference::wgs84() ?
+                      location :
+                      geometry_cast<Point>(GeometryEngine::project(location, SpatialReference::wgs84()));
+
+  ++m_fixCount;
+  m_fixesHaveZ = fix.hasZ();
+  m_smoother.addFix(fix.x(), fix.y(), m_fixesHaveZ ? fix.z() : 0.0, m_clock.elapsed());
+  requestCameraUpdate();
+}
+
+/*!
+  \internal
+
+  Asks the window for a frame, so that \l updateCamera runs as it is prepared.
+ */
+void FollowPositionController::requestCameraUpdate()
+{
+  QQuickWindow* quickWindow = window();
+  if (quickWindow)
+    quickWindow->update();
+}
+
+/*!
+  \internal
+
+  Returns the window showing the current geo view, connecting to its frames
+  the first time it is seen.
+ */
+QQuickWindow* FollowPositionController::window()
+{
+  auto item = dynamic_cast<QQuickItem*>(m_geoView);
+  QQuickWindow* quickWindow = item ? item->window() : nullptr;
+
+  if (quickWindow != m_window)
+  {
+    if (m_window)
+      disconnect(m_window, &QQuickWindow::afterAnimating, this, &FollowPositionController::updateCamera);
+
+    m_window = quickWindow;
+
+    if (m_window)
+      connect(m_window, &QQuickWindow::afterAnimating, this, &FollowPositionController::updateCamera);
+  }
+
+  return quickWindow;
+}
+
+/*!
+  \internal
+
+  Moves the follow target on to the smoothed location as the window
+  prepares a frame, and asks for another while it is still moving.
+ */
+void FollowPositionController::updateCamera()
+{
+  if (!m_followCamera || !m_followTarget)
+    return;
+
+  const qint64 now = m_clock.elapsed();
+  if (now - m_lastCameraUpdateMs < 1000.0 / maximumCameraRate)
+  {
+    requestCameraUpdate();
+    return;
+  }
+
+  m_lastCameraUpdateMs = now;
+  if (m_smoother.advance(now))
+  {
+    m_followTarget->setGeometry(m_fixesHaveZ ?
+                                  Point(m_smoother.x(), m_smoother.y(), m_smoother.z(), SpatialReference::wgs84()) :
+                                  Point(m_smoother.x(), m_smoother.y(), SpatialReference::wgs84()));
+
+    if (m_mode == FollowMode::TrackUp)
+      m_followCamera->setCameraHeadingOffset(m_smoother.heading());
+
+    ++m_cameraUpdateCount;
+    requestCameraUpdate();
+  }
+
+  const qint64 elapsed = now - m_statisticsStartMs;
+  if (elapsed < 1000)
+    return;
+
+  m_fixRate = m_fixCount * 1000.0 / elapsed;
+  m_cameraUpdateRate = m_cameraUpdateCount * 1000.0 / elapsed;
+  m_fixCount = 0;
+  m_cameraUpdateCount = 0;
+  m_statisticsStartMs = now;
+
+  emit followStatisticsChanged();
+}
+
 /*!
   \internal
  */
@@ -233,3 +443,10 @@ GraphicListModel* FollowPositionController::locationGraphicsModel() const
 
   \brief Signal emitted when the follow mode changes.
  */
+
+/*!
+  \fn void FollowPositionController::followStatisticsChanged();
+
+  \brief Signal emitted at most once a second, while following in a scene,
+  when \l fixRate and \l cameraUpdateRate are updated.
+ */
@@ -17,15 +17,26 @@
 #ifndef FOLLOWPOSITIONCONTROLLER_H
 #define FOLLOWPOSITIONCONTROLLER_H
 
+// example app headers
+#include "CameraFollowSmoother.h"
+
 // toolkit headers
 #include "AbstractTool.h"
 
+// Qt headers
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QQuickWindow>
+
 namespace Esri {
 namespace ArcGISRuntime {
   class CameraController;
   class GeoElement;
   class GeoView;
+  class Graphic;
   class GraphicListModel;
+  class OrbitGeoElementCameraController;
+  class Point;
 }}
 
 namespace Dsa {
@@ -35,6 +46,8 @@ class FollowPositionController : public Esri::ArcGISRuntime::Toolkit::AbstractTo
   Q_OBJECT
 
   Q_PROPERTY(FollowMode followMode READ followMode WRITE setFollowMode NOTIFY followModeChanged)
+  Q_PROPERTY(double fixRate READ fixRate NOTIFY followStatisticsChanged)
+  Q_PROPERTY(double cameraUpdateRate READ cameraUpdateRate NOTIFY followStatisticsChanged)
 
 public:
 
@@ -55,6 +68,9 @@ public:
   FollowMode followMode() const;
   void setFollowMode(FollowMode followMode);
 
+  double fixRate() const;
+  double cameraUpdateRate() const;
+
   // AbstractTool interface
   QString toolName() const override;
 
@@ -62,9 +78,11 @@ public:
 
 signals:
   void followModeChanged();
+  void followStatisticsChanged();
 
 private slots:
   void updateGeoView();
+  void updateCamera();
 
 private:
 
@@ -72,9 +90,32 @@ private:
   bool handleFollowInMap();
   bool handleFollowInScene();
   Esri::ArcGISRuntime::GraphicListModel* locationGraphicsModel() const;
+  void startSmoothFollow(const Esri::ArcGISRuntime::Point& location);
+  void stopSmoothFollow();
+  void handleFix(const Esri::ArcGISRuntime::Point& location);
+  void requestCameraUpdate();
+  QQuickWindow* window();
 
   FollowMode m_mode = FollowMode::Disabled;
   Esri::ArcGISRuntime::GeoView* m_geoView = nullptr;
+
+  // the camera orbits a graphic of our own, which moves at the camera's cadence
+  // rather than at the rate of the location fixes
+  Esri::ArcGISRuntime::Graphic* m_followTarget = nullptr;
+  Esri::ArcGISRuntime::OrbitGeoElementCameraController* m_followCamera = nullptr;
+  CameraFollowSmoother m_smoother;
+  QPointer<QQuickWindow> m_window;
+  QElapsedTimer m_clock;
+  qint64 m_lastCameraUpdateMs = 0;
+  int m_locationSubscription = -1;
+  QMetaObject::Connection m_headingConnection;
+  bool m_fixesHaveZ = false;
+
+  int m_fixCount = 0;
+  int m_cameraUpdateCount = 0;
+  qint64 m_statisticsStartMs = 0;
+  double m_fixRate = 0.0;
+  double m_cameraUpdateRate = 0.0;
 };
 
 } // Dsa
@@ -20,13 +20,8 @@
 #include "GPXLocationSimulator.h"
 
 // Qt headers
+#include <QFile>
 #include <QTimer>
-#include <QXmlStreamReader>
-
-// STL headers
-#include <cmath>
-
-using namespace Esri::ArcGISRuntime;
 
 namespace Dsa {
 
@@ -35,6 +30,10 @@ namespace Dsa {
   \inmodule Dsa
   \inherits QGeoPositionInfoSource
   \brief Position source simulator that reads from a GPX file.
+
+  The GPX file is decoded once into a \l GPXTrack. Each update interpolates
+  the position and heading along the track, so the simulated position moves
+  smoothly at any update interval.
  */
 
 /*!
@@ -44,9 +43,7 @@ namespace Dsa {
  */
 GPXLocationSimulator::GPXLocationSimulator(QObject* parent) :
   QGeoPositionInfoSource(parent),
-  m_gpxReader(new QXmlStreamReader()),
-  m_timer(new QTimer(this)),
-  m_angleOffset(0.0, -90.0, 0.0, 90.0)
+  m_timer(new QTimer(this))
 {
   connectSignals();
   setUpdateInterval(500);
@@ -63,7 +60,6 @@ GPXLocationSimulator::GPXLocationSimulator(QObject* parent) :
  */
 GPXLocationSimulator::GPXLocationSimulator(const QString& gpxFileName, int updateInterval, QObject* parent) :
   QGeoPositionInfoSource(parent),
-  m_gpxReader(new QXmlStreamReader()),
   m_timer(new QTimer(this))
 {
   connectSignals();
@@ -72,7 +68,7 @@ GPXLocationSimulator::GPXLocationSimulator(const QString& gpxFileName, int updat
   if (!setGpxFile(gpxFileName))
   {
     // raise error
-    m_gpxFile.setFileName("");
+    m_gpxFileName.clear();
   }
 }
 
@@ -88,92 +84,18 @@ GPXLocationSimulator::~GPXLocationSimulator()
  */
 void GPXLocationSimulator::connectSignals()
 {
+  m_timer->setTimerType(Qt::PreciseTimer);
   connect(m_timer, SIGNAL(timeout()), this, SLOT(handleTimerEvent()));
   // internally we emit errorInternal but we cannot emit error due to syntax
   connect(this, &GPXLocationSimulator::errorInternal,
           this, static_cast<void (QGeoPositionInfoSource::*)(QGeoPositionInfoSource::Error)>(&QGeoPositionInfoSource::error));
 }
 
-/*!
-  \internal
- */
-bool GPXLocationSimulator::gotoNextPositionElement()
-{
-  while (!m_gpxReader->atEnd() && !m_gpxReader->hasError())
-  {
-    if (m_gpxReader->isStartElement())
-    {
-      if (m_gpxReader->name().compare(QString("trkpt"), Qt::CaseInsensitive) == 0)
-      {
-        return true;
-      }
-    }
-
-    m_gpxReader->readNext();
-  }
-
-  return false;
-}
-
-/*!
-  \internal
- */
-Point GPXLocationSimulator::getNextPoint(QTime& time)
-{
-  // Convert the current gpx position to Point and QTime parmeters.
-  if (!gotoNextPositionElement())
-  {
-    return Point();
-  }
-
-  // fetch the lat and lon attributes from the trkpt element
-  const QXmlStreamAttributes attrs = m_gpxReader->attributes();
-  const double x = attrs.value("lon").toString().toDouble();
-  const double y = attrs.value("lat").toString().toDouble();
-  double z = NAN;
-  // if the new point is the same as the old point then trash it and try to get another.
-  if (x == m_latestPoint.x() && y == m_latestPoint.y())
-  {
-    m_gpxReader->readNext();
-    return getNextPoint(time);
-  }
-
-  // goto the start of the time child element
-  m_gpxReader->readNextStartElement();
-
-  while (m_gpxReader->name().compare(QString("trkpt"), Qt::CaseInsensitive) != 0 && !m_gpxReader->atEnd())
-  {
-    if (m_gpxReader->isStartElement())
-    {
-      if (m_gpxReader->name().compare(QString("ele"), Qt::CaseInsensitive) == 0)
-      {
-        z = m_gpxReader->readElementText().toDouble();
-      }
-      else if (m_gpxReader->name().compare(QString("time"), Qt::CaseInsensitive) == 0)
-      {
-        const QString timeString = m_gpxReader->readElementText();
-        const int hours = timeString.section(":", 0, 0).right(2).toInt();
-        const int minutes = timeString.section(":", 1, 1).toInt();
-        const int seconds = timeString.section(":", 2, 2).left(2).toInt();
-        time.setHMS(hours ,minutes, seconds, 0);
-      }
-    }
-
-    m_gpxReader->readNext();
-  }
-
-  m_latestPoint = std::isnan(z) ?
-        Point(x, y, SpatialReference::wgs84()) :
-        Point(x, y, z, SpatialReference::wgs84());
-
-  return m_latestPoint;
-}
-
 /*!
   \brief Starts position updates.
 
-  Loads a GPX file into a stream reader, fetches the first 3 coordinates
-  and starts a timer that performs interpolation and position updating.
+  Starts a timer that interpolates along the GPX track and updates the position,
+  continuing from where the simulation was last stopped.
  */
 void GPXLocationSimulator::startUpdates()
 {
@@ -182,7 +104,7 @@ void GPXLocationSimulator::startUpdates()
 
   // if the gpx file does not contain enough information to
   // interpolate on then cancel the simulation.
-  if (!initializeInterpolationValues())
+  if (!m_track.isValid())
   {
     return;
   }
@@ -265,133 +187,41 @@ int GPXLocationSimulator::minimumUpdateInterval() const
 /*!
   \internal
 
- increments the current time
- fetches new positions from the gpx file as necessary
- calculates and sets the current position and orientation
+ advances the simulated time, starting over at the end of the track,
+ and emits the interpolated position and orientation
  */
 void GPXLocationSimulator::handleTimerEvent()
 {
-  // update the current time
-  m_currentTime = m_currentTime.addMSecs(m_timer->interval() * m_playbackMultiplier);
+  m_playbackTime += static_cast<qint64>(m_timer->interval()) * m_playbackMultiplier;
 
-  // determine if a new position needs to be obtained from the gpx
-  if (m_currentTime > m_segmentEndTime)
+  // the simulation loops back to the start of the track
+  if (m_playbackTime > m_track.duration())
   {
-    if (!updateInterpolationParameters())
-    {
-      m_gpxReader->clear();
-      m_gpxReader->addData(m_gpxData);
-      initializeInterpolationValues();
-
-      return;
-    }
+    m_playbackTime = m_track.duration() > 0 ? m_playbackTime % m_track.duration() : 0;
+    m_segmentHint = -1;
   }
 
-  // normalize the time across the current segment
-  const double val1 = static_cast<double>(m_segmentStartTime.msecsTo(m_currentTime));
-  const double val2 = static_cast<double>(m_segmentStartTime.msecsTo(m_segmentEndTime));
-  const double normalizedTime = val1 / val2;
-
-  // get the interpolated position and orientation on the current
-  // segment based on the normalized time.
-  const Point currentPosition = normalizedTime <= 0.5 ? m_currentSegment.startPoint() : m_currentSegment.endPoint();
-  const double currentHeading = getInterpolatedHeading(currentPosition, normalizedTime);
-
-  QGeoPositionInfo qtPosition;
-  auto timeStamp = QDateTime::currentDateTime();
-  timeStamp.setTime(m_currentTime);
-  qtPosition.setTimestamp(timeStamp);
-
-  qtPosition.setCoordinate(QGeoCoordinate(currentPosition.y(), currentPosition.x(), currentPosition.z()));
-
-  m_lastKnownPosition = qtPosition;
-  emit positionUpdated(qtPosition);
-  emit headingChanged(currentHeading);
+  updatePosition();
 }
 
 /*!
   \internal
  */
-bool GPXLocationSimulator::initializeInterpolationValues()
+void GPXLocationSimulator::updatePosition()
 {
-  // fetch the first 3 points from the gpx feed to populate the
-  // initial interpolation components.
-  const Point pt1 = getNextPoint(m_segmentStartTime);
-  const Point pt2 = getNextPoint(m_segmentEndTime);
-  const Point pt3 = getNextPoint(m_nextSegmentEndTime);
-
-  if (pt1.isEmpty() || pt2.isEmpty() || pt3.isEmpty())
-  {
-    return false;
-  }
-
-  // define the interpolation segments
-  m_currentSegment = LineSegment(pt1, pt2, SpatialReference::wgs84());
-  m_nextSegment = LineSegment(pt2, pt3, SpatialReference::wgs84());
-  m_startHeadingDelta = 0;
-  m_endHeadingDelta = heading(m_currentSegment);
-
-  // define the current time as the first timestamp extracted from the gpx file
-  m_currentTime = m_segmentStartTime;
+  const qint64 trackTime = m_track.startTime() + m_playbackTime;
+  const GPXTrack::Position position = m_track.positionAtTime(trackTime, &m_segmentHint);
 
-  return true;
-}
-
-/*!
-  \internal
- */
-double GPXLocationSimulator::getInterpolatedHeading(const Point& currentPosition, double normalizedTime)
-{
-  // implementation for smooth orientation transfer between segments.
-  // the smoothing is spread across the final 10% of the current segment
-  // and the first 10% of the next segment.
-
-  LineSegment segment;
-
-  // interpolation of the first 10% of the segment
-  if (normalizedTime < 0.1)
-  {
-    segment = LineSegment(m_currentSegment.startPoint(), currentPosition, SpatialReference::wgs84());
-    return heading(m_currentSegment);
-  }
-  // interpolation of the last 10% of the segment
-  else if (normalizedTime > 0.9)
-  {
-    segment = LineSegment(m_currentSegment.endPoint(), currentPosition, SpatialReference::wgs84());
-    return heading(m_currentSegment);
-  }
-
-  // no orientation interpolation needed, use the current segments angle
-  return heading(m_currentSegment);
-}
-
-/*!
-  \internal
- */
-bool GPXLocationSimulator::updateInterpolationParameters()
-{
-  // fetch the next coordinate in the gpx file and updates all the
-  // internal interpolation vars
-
-  m_segmentStartTime = m_segmentEndTime;
-  m_segmentEndTime = m_nextSegmentEndTime;
-  Point newPt = getNextPoint(m_nextSegmentEndTime);
-
-  // if there are no more points to get then notify simulation to start over
-  if (newPt.isEmpty())
-  {
-    return false;
-  }
-
-  // discard the oldest segment and populate the newest segment.
-  m_currentSegment = m_nextSegment;
-  m_nextSegment = LineSegment(m_currentSegment.endPoint(), newPt, SpatialReference::wgs84());
+  QGeoPositionInfo qtPosition;
+  auto timeStamp = QDateTime::currentDateTime();
+  timeStamp.setTime(QDateTime::fromMSecsSinceEpoch(trackTime, Qt::UTC).time());
+  qtPosition.setTimestamp(timeStamp);
 
-  // discard the oldest orientation delta and populate the newest
-  m_startHeadingDelta = m_endHeadingDelta;
-  m_endHeadingDelta = heading(m_currentSegment);
+  qtPosition.setCoordinate(QGeoCoordinate(position.latitude, position.longitude, position.elevation));
 
-  return true;
+  m_lastKnownPosition = qtPosition;
+  emit positionUpdated(qtPosition);
+  emit headingChanged(position.heading);
 }
 
 /*!
@@ -399,13 +229,14 @@ bool GPXLocationSimulator::updateInterpolationParameters()
  */
 QString GPXLocationSimulator::gpxFile()
 {
-  return m_gpxFile.fileName();
+  return m_gpxFileName;
 }
 
 /*!
   \brief Sets the GPX file location to \a fileName.
 
-  Returns whether the file was succesfully read.
+  The first track in the file is simulated. Returns whether the file was
+  succesfully read and contains a track of at least two points.
  */
 bool GPXLocationSimulator::setGpxFile(const QString& fileName)
 {
@@ -416,18 +247,18 @@ bool GPXLocationSimulator::setGpxFile(const QString& fileName)
     return false;
   }
 
-  if (m_gpxFile.isOpen())
-    m_gpxFile.close();
-
-  m_gpxFile.setFileName(fileName);
-
-  if (!m_gpxFile.open(QFile::ReadOnly | QFile::Text))
+  const QList<GPXTrack> tracks = GPXTrack::readFile(fileName);
+  if (tracks.isEmpty())
+  {
+    m_lastError = QGeoPositionInfoSource::Error::UnknownSourceError;
+    emit this->errorInternal(m_lastError);
     return false;
+  }
 
-  m_gpxData = m_gpxFile.readAll();
-  m_gpxReader->clear();
-  m_gpxReader->addData(m_gpxData);
-  m_gpxFile.close();
+  m_gpxFileName = fileName;
+  m_track = tracks.first();
+  m_playbackTime = 0;
+  m_segmentHint = -1;
 
   m_isStarted = false;
 
@@ -453,13 +284,25 @@ void GPXLocationSimulator::setPlaybackMultiplier(int val)
 }
 
 /*!
-  \brief Returns the heading in degrees of the supplied \a segment.
+  \brief Returns the simulated time in msecs since the start of the track.
  */
-double GPXLocationSimulator::heading(const Esri::ArcGISRuntime::LineSegment& segment) const
+qint64 GPXLocationSimulator::playbackTime() const
 {
-  const auto startPoint = segment.startPoint();
-  const auto endPoint = segment.endPoint();
-  return m_angleOffset.angleTo(QLineF(startPoint.x(), startPoint.y(), endPoint.x(), endPoint.y()));
+  return m_playbackTime;
+}
+
+/*!
+  \brief Moves the simulation to \a msecs since the start of the track.
+
+  The new position is emitted straight away if updates are running.
+ */
+void GPXLocationSimulator::setPlaybackTime(qint64 msecs)
+{
+  m_playbackTime = qBound(0ll, msecs, m_track.duration());
+  m_segmentHint = -1;
+
+  if (m_isStarted)
+    updatePosition();
 }
 
 } // Dsa
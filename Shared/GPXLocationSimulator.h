@@ -17,21 +17,11 @@
 #ifndef GPXLOCATIONSIMULATOR_H
 #define GPXLOCATIONSIMULATOR_H
 
-// C++ API headers
-#include "LineSegment.h"
-#include "Point.h"
+#include "GPXTrack.h"
 
 // Qt headers
-#include <QFile>
 #include <QGeoPositionInfoSource>
-#include <QLineF>
-#include <QPointF>
-#include <QTime>
 
-// STL headers
-#include <memory>
-
-class QXmlStreamReader;
 class QTimer;
 
 namespace Dsa {
@@ -58,6 +48,9 @@ public:
   int playbackMultiplier();
   void setPlaybackMultiplier(int multiplier);
 
+  qint64 playbackTime() const;
+  void setPlaybackTime(qint64 msecs);
+
   QGeoPositionInfoSource::Error error() const override;
 
 public slots:
@@ -72,35 +65,16 @@ signals:
   void errorInternal(QGeoPositionInfoSource::Error);
 
 private:
-  void pauseSimulation();
-  void resumeSimulation();
-
-  bool gotoNextPositionElement();
-  Esri::ArcGISRuntime::Point getNextPoint(QTime& time);
-  bool updateInterpolationParameters();
-  bool initializeInterpolationValues();
-  double heading(const Esri::ArcGISRuntime::LineSegment& segment) const;
-
-  double getInterpolatedHeading(const Esri::ArcGISRuntime::Point& currentPosition, double normalizedTime);
-
   void connectSignals();
+  void updatePosition();
 
-  QFile m_gpxFile;
-  QByteArray m_gpxData;
-  std::unique_ptr<QXmlStreamReader> m_gpxReader;
+  QString m_gpxFileName;
+  GPXTrack m_track;
   QTimer* m_timer = nullptr;
   int m_playbackMultiplier = 1;
-  Esri::ArcGISRuntime::LineSegment m_currentSegment;
-  Esri::ArcGISRuntime::LineSegment m_nextSegment;
-  Esri::ArcGISRuntime::Point m_latestPoint;
-  double m_startHeadingDelta;
-  double m_endHeadingDelta;
-  QTime m_currentTime;
-  QTime m_segmentStartTime;
-  QTime m_segmentEndTime;
-  QTime m_nextSegmentEndTime;
+  qint64 m_playbackTime = 0;
+  int m_segmentHint = -1;
   bool m_isStarted = false;
-  const QLineF m_angleOffset;
   QGeoPositionInfo m_lastKnownPosition;
   QGeoPositionInfoSource::Error m_lastError = QGeoPositionInfoSource::NoError;
 
@@ -0,0 +1,443 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "GPXTrack.h"
+
+// Qt headers
+#include <QDateTime>
+#include <QFile>
+#include <QXmlStreamReader>
+#include <QtMath>
+
+// STL headers
+#include <algorithm>
+#include <cmath>
+
+namespace Dsa {
+
+namespace
+{
+// points without a time are spaced this far apart
+const qint64 defaultSampleIntervalMs = 1000;
+
+// the heading is blended into the neighbouring segment's heading over this
+// fraction at either end of a segment, so that turns are not instantaneous
+const double headingBlendFraction = 0.1;
+
+// segments shorter than this (in radians, about 1 mm) are treated as stationary
+const double minimumSegmentAngle = 1e-10;
+
+bool isElement(const QXmlStreamReader& reader, const char* name)
+{
+  return reader.name().compare(QLatin1String(name), Qt::CaseInsensitive) == 0;
+}
+
+qint64 parseTime(const QString& text)
+{
+  const QDateTime dateTime = QDateTime::fromString(text.trimmed(), Qt::ISODate);
+  if (dateTime.isValid())
+    return dateTime.toMSecsSinceEpoch();
+
+  // fall back to the time of day for files with incomplete dates
+  const int hours = text.section(":", 0, 0).right(2).toInt();
+  const int minutes = text.section(":", 1, 1).toInt();
+  const int seconds = text.section(":", 2, 2).left(2).toInt();
+  return ((hours * 60 + minutes) * 60 + seconds) * 1000ll;
+}
+
+double normalizeHeading(double heading)
+{
+  heading = std::fmod(heading, 360.0);
+  return heading < 0.0 ? heading + 360.0 : heading;
+}
+
+double blendHeading(double from, double to, double weight)
+{
+  // blend along the shorter way round
+  double delta = std::fmod(to - from + 540.0, 360.0) - 180.0;
+  return normalizeHeading(from + delta * weight);
+}
+}
+
+/*!
+  \class Dsa::GPXTrack
+  \inmodule Dsa
+  \brief A GPX track decoded into a compact array of timed positions.
+
+  The GPX is parsed once. Positions and headings at any time are interpolated
+  along great circles, and the segment at a given time is found by binary
+  search, or in constant time when the caller passes back the segment it used
+  for the previous update.
+ */
+
+/*!
+  \brief Constructs an empty track.
+ */
+GPXTrack::GPXTrack()
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+GPXTrack::~GPXTrack()
+{
+}
+
+/*!
+  \brief Decodes every track in \a gpxData.
+
+  Each \c trk element becomes one track, with all of its segments joined
+  together. Track points outside a \c trk element form a track of their own.
+  Only tracks with at least two points are returned. If the data cannot be
+  parsed and \a errorString is set, it receives the reason.
+ */
+QList<GPXTrack> GPXTrack::read(const QByteArray& gpxData, QString* errorString)
+{
+  QList<GPXTrack> tracks;
+  GPXTrack track;
+  bool inTrack = false;
+  bool inPoint = false;
+  Sample sample{-1, 0.0, 0.0, NAN};
+
+  QXmlStreamReader reader(gpxData);
+  while (!reader.atEnd())
+  {
+    reader.readNext();
+
+    if (reader.isStartElement())
+    {
+      if (isElement(reader, "trk"))
+      {
+        inTrack = true;
+        track = GPXTrack();
+      }
+      else if (isElement(reader, "trkpt"))
+      {
+        inPoint = true;
+        const QXmlStreamAttributes attributes = reader.attributes();
+        sample = Sample{-1, attributes.value("lon").toDouble(), attributes.value("lat").toDouble(), NAN};
+      }
+      else if (inPoint && isElement(reader, "ele"))
+      {
+        sample.elevation = reader.readElementText().toDouble();
+      }
+      else if (inPoint && isElement(reader, "time"))
+      {
+        sample.time = parseTime(reader.readElementText());
+      }
+      else if (inTrack && !inPoint && isElement(reader, "name"))
+      {
+        track.m_name = reader.readElementText();
+      }
+    }
+    else if (reader.isEndElement())
+    {
+      if (isElement(reader, "trkpt"))
+      {
+        inPoint = false;
+        track.appendSample(sample);
+      }
+      else if (isElement(reader, "trk"))
+      {
+        inTrack = false;
+        track.finish();
+        if (track.isValid())
+          tracks.append(track);
+
+        track = GPXTrack();
+      }
+    }
+  }
+
+  if (reader.hasError() && errorString)
+    *errorString = reader.errorString();
+
+  // points that were not inside a trk element
+  track.finish();
+  if (track.isValid())
+    tracks.append(track);
+
+  return tracks;
+}
+
+/*!
+  \brief Decodes every track in the GPX file \a fileName.
+
+  If the file cannot be read and \a errorString is set, it receives the reason.
+ */
+QList<GPXTrack> GPXTrack::readFile(const QString& fileName, QString* errorString)
+{
+  QFile file(fileName);
+  if (!file.open(QFile::ReadOnly))
+  {
+    if (errorString)
+      *errorString = file.errorString();
+
+    return QList<GPXTrack>();
+  }
+
+  return read(file.readAll(), errorString);
+}
+
+/*!
+  \brief Returns whether the track has enough points to interpolate along.
+ */
+bool GPXTrack::isValid() const
+{
+  return m_segments.size() > 0;
+}
+
+/*!
+  \brief Returns the name of the track, which may be empty.
+ */
+QString GPXTrack::name() const
+{
+  return m_name;
+}
+
+/*!
+  \brief Returns the number of decoded points.
+ */
+int GPXTrack::sampleCount() const
+{
+  return m_samples.size();
+}
+
+/*!
+  \brief Returns the decoded point at \a index.
+ */
+GPXTrack::Sample GPXTrack::sample(int index) const
+{
+  return m_samples.at(index);
+}
+
+/*!
+  \brief Returns the time of the first point in msecs since epoch.
+ */
+qint64 GPXTrack::startTime() const
+{
+  return m_samples.isEmpty() ? 0 : m_samples.first().time;
+}
+
+/*!
+  \brief Returns the time of the last point in msecs since epoch.
+ */
+qint64 GPXTrack::endTime() const
+{
+  return m_samples.isEmpty() ? 0 : m_samples.last().time;
+}
+
+/*!
+  \brief Returns the time the track takes in msecs.
+ */
+qint64 GPXTrack::duration() const
+{
+  return endTime() - startTime();
+}
+
+/*!
+  \brief Returns the index of the segment that contains \a time.
+
+  Times outside the track are clamped to its first or last segment.
+ */
+int GPXTrack::segmentAtTime(qint64 time) const
+{
+  if (!isValid())
+    return -1;
+
+  auto next = std::upper_bound(m_samples.cbegin(), m_samples.cend(), time, [](qint64 t, const Sample& s)
+  {
+    return t < s.time;
+  });
+
+  const int segment = static_cast<int>(next - m_samples.cbegin()) - 1;
+  return qBound(0, segment, m_segments.size() - 1);
+}
+
+/*!
+  \brief Returns the interpolated position and heading at \a time.
+
+  Times outside the track are clamped to its ends. When \a segmentHint is
+  given it should hold the segment returned by the previous call (or -1);
+  it is checked before searching and is updated to the segment used.
+ */
+GPXTrack::Position GPXTrack::positionAtTime(qint64 time, int* segmentHint) const
+{
+  if (!isValid())
+    return Position{NAN, NAN, NAN, 0.0};
+
+  time = qBound(startTime(), time, endTime());
+
+  // successive updates usually stay within a segment or move to the next one
+  int segment = segmentHint ? *segmentHint : -1;
+  const auto containsTime = [this, time](int s)
+  {
+    return s >= 0 && s < m_segments.size() && m_samples.at(s).time <= time && time <= m_samples.at(s + 1).time;
+  };
+
+  if (!containsTime(segment))
+    segment = containsTime(segment + 1) ? segment + 1 : segmentAtTime(time);
+
+  if (segmentHint)
+    *segmentHint = segment;
+
+  const Sample& start = m_samples.at(segment);
+  const Sample& end = m_samples.at(segment + 1);
+  const Segment& s = m_segments.at(segment);
+  const double fraction = static_cast<double>(time - start.time) / (end.time - start.time);
+
+  Position position;
+  if (std::isnan(start.elevation))
+    position.elevation = end.elevation;
+  else if (std::isnan(end.elevation))
+    position.elevation = start.elevation;
+  else
+    position.elevation = start.elevation + (end.elevation - start.elevation) * fraction;
+
+  if (s.angle < minimumSegmentAngle)
+  {
+    position.longitude = start.longitude;
+    position.latitude = start.latitude;
+    position.heading = headingAt(segment, fraction, m_vectors.at(segment));
+    return position;
+  }
+
+  // spherical linear interpolation between the two unit vectors
+  const Vector& a = m_vectors.at(segment);
+  const Vector& b = m_vectors.at(segment + 1);
+  const double wa = std::sin((1.0 - fraction) * s.angle) / s.sinAngle;
+  const double wb = std::sin(fraction * s.angle) / s.sinAngle;
+  const Vector p{wa * a.x + wb * b.x, wa * a.y + wb * b.y, wa * a.z + wb * b.z};
+
+  position.longitude = qRadiansToDegrees(std::atan2(p.y, p.x));
+  position.latitude = qRadiansToDegrees(std::atan2(p.z, std::sqrt(p.x * p.x + p.y * p.y)));
+  position.heading = headingAt(segment, fraction, p);
+  return position;
+}
+
+/*!
+  \internal
+ */
+void GPXTrack::appendSample(const Sample& sample)
+{
+  Sample s = sample;
+
+  // points without a time follow on from the previous point
+  if (s.time < 0)
+    s.time = m_samples.isEmpty() ? 0 : m_samples.last().time + defaultSampleIntervalMs;
+
+  // time has to increase for the track to be searchable
+  if (!m_samples.isEmpty() && s.time <= m_samples.last().time)
+    return;
+
+  m_samples.append(s);
+}
+
+/*!
+  \internal
+
+  Precomputes the unit vectors, central angles and headings used for interpolation.
+ */
+void GPXTrack::finish()
+{
+  m_vectors.clear();
+  m_segments.clear();
+
+  if (m_samples.size() < 2)
+    return;
+
+  m_vectors.reserve(m_samples.size());
+  for (const Sample& s : m_samples)
+  {
+    const double longitude = qDegreesToRadians(s.longitude);
+    const double latitude = qDegreesToRadians(s.latitude);
+    m_vectors.append(Vector{std::cos(latitude) * std::cos(longitude), std::cos(latitude) * std::sin(longitude), std::sin(latitude)});
+  }
+
+  m_segments.reserve(m_samples.size() - 1);
+  int firstMovingSegment = -1;
+  for (int i = 0; i + 1 < m_vectors.size(); ++i)
+  {
+    const Vector& a = m_vectors.at(i);
+    const Vector& b = m_vectors.at(i + 1);
+    const Vector cross{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    const double sinAngle = std::sqrt(cross.x * cross.x + cross.y * cross.y + cross.z * cross.z);
+    const double cosAngle = a.x * b.x + a.y * b.y + a.z * b.z;
+
+    Segment segment;
+    segment.angle = std::atan2(sinAngle, cosAngle);
+    segment.sinAngle = sinAngle;
+    segment.normal = segment.angle < minimumSegmentAngle ? Vector{0.0, 0.0, 0.0} :
+                                                           Vector{cross.x / sinAngle, cross.y / sinAngle, cross.z / sinAngle};
+
+    // a stationary segment keeps the heading it arrived with
+    segment.heading = m_segments.isEmpty() ? 0.0 : m_segments.last().heading;
+    m_segments.append(segment);
+
+    if (segment.angle >= minimumSegmentAngle)
+    {
+      // the heading halfway along stands for the whole segment
+      const Vector middle{a.x + b.x, a.y + b.y, a.z + b.z};
+      const double length = std::sqrt(middle.x * middle.x + middle.y * middle.y + middle.z * middle.z);
+      m_segments.last().heading = headingAt(i, 0.5, Vector{middle.x / length, middle.y / length, middle.z / length});
+      if (firstMovingSegment == -1)
+        firstMovingSegment = i;
+    }
+  }
+
+  // stationary segments at the start take the heading they leave with
+  for (int i = 0; i < firstMovingSegment; ++i)
+    m_segments[i].heading = m_segments.at(firstMovingSegment).heading;
+}
+
+/*!
+  \internal
+
+  Returns the heading along \a segment at \a position, blended with the
+  neighbouring segments near either end.
+ */
+double GPXTrack::headingAt(int segment, double fraction, const Vector& position) const
+{
+  const Segment& s = m_segments.at(segment);
+
+  // the direction of travel is the great circle normal crossed with the position,
+  // resolved into the east and north directions at that position
+  double heading = s.heading;
+  const double horizontal = std::sqrt(position.x * position.x + position.y * position.y);
+  if (s.angle >= minimumSegmentAngle && horizontal > 0.0)
+  {
+    const Vector& n = s.normal;
+    const Vector d{n.y * position.z - n.z * position.y, n.z * position.x - n.x * position.z, n.x * position.y - n.y * position.x};
+    const double east = (-d.x * position.y + d.y * position.x) / horizontal;
+    const double north = (-d.x * position.z * position.x - d.y * position.z * position.y) / horizontal + d.z * horizontal;
+    heading = normalizeHeading(qRadiansToDegrees(std::atan2(east, north)));
+  }
+
+  // meet the neighbouring segment halfway at each shared point
+  if (fraction > 1.0 - headingBlendFraction && segment + 1 < m_segments.size())
+    return blendHeading(heading, m_segments.at(segment + 1).heading, 0.5 * (fraction - (1.0 - headingBlendFraction)) / headingBlendFraction);
+
+  if (fraction < headingBlendFraction && segment > 0)
+    return blendHeading(heading, m_segments.at(segment - 1).heading, 0.5 * (headingBlendFraction - fraction) / headingBlendFraction);
+
+  return heading;
+}
+
+} // Dsa
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef GPXTRACK_H
+#define GPXTRACK_H
+
+// Qt headers
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class QByteArray;
+
+namespace Dsa {
+
+class GPXTrack
+{
+public:
+  struct Sample
+  {
+    qint64 time; // msecs since epoch
+    double longitude;
+    double latitude;
+    double elevation; // NaN if the point has no elevation
+  };
+
+  struct Position
+  {
+    double longitude;
+    double latitude;
+    double elevation;
+    double heading; // degrees clockwise from north
+  };
+
+  GPXTrack();
+  ~GPXTrack();
+
+  static QList<GPXTrack> read(const QByteArray& gpxData, QString* errorString = nullptr);
+  static QList<GPXTrack> readFile(const QString& fileName, QString* errorString = nullptr);
+
+  bool isValid() const;
+
+  QString name() const;
+
+  int sampleCount() const;
+  Sample sample(int index) const;
+
+  qint64 startTime() const;
+  qint64 endTime() const;
+  qint64 duration() const;
+
+  int segmentAtTime(qint64 time) const;
+  Position positionAtTime(qint64 time, int* segmentHint = nullptr) const;
+
+private:
+  struct Vector
+  {
+    double x;
+    double y;
+    double z;
+  };
+
+  struct Segment
+  {
+    double angle; // central angle in radians
+    double sinAngle;
+    Vector normal; // unit normal of the great circle, zero for a stationary segment
+    double heading;
+  };
+
+  void appendSample(const Sample& sample);
+  void finish();
+
+  double headingAt(int segment, double fraction, const Vector& position) const;
+
+  QString m_name;
+  QVector<Sample> m_samples;
+  QVector<Vector> m_vectors;
+  QVector<Segment> m_segments;
+};
+
+} // Dsa
+
+#endif // GPXTRACK_H
@@ -0,0 +1,365 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "GraphicsUpdateBatcher.h"
+
+// toolkit headers
+#include "ToolResourceProvider.h"
+
+// C++ API headers
+#include "AttributeListModel.h"
+#include "GeoView.h"
+#include "Graphic.h"
+
+// Qt headers
+#include <QQuickItem>
+#include <QQuickWindow>
+
+// STL headers
+#include <utility>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace Dsa {
+
+namespace
+{
+// used until the view is in a window, roughly one frame at 60 Hz
+const int fallbackIntervalMs = 16;
+
+// a hidden or minimized window renders no frames, so commit anyway after this long
+const int frameTimeoutMs = 100;
+}
+
+/*!
+  \class Dsa::GraphicsUpdateBatcher
+  \inmodule Dsa
+  \inherits QObject
+  \brief Applies geometry and attribute changes to graphics once per rendered frame.
+
+  Position sources and message feeds can update a graphic many times between
+  two frames, and each \c Graphic::setGeometry or attribute change is a call
+  into the runtime. Changes made through the batcher are held until the
+  window is about to render the next frame, and only the latest geometry and
+  attribute values of each graphic are applied; intermediate states are
+  dropped, as is a geometry equal to the one the graphic already has.
+
+  Changes are committed on the GUI thread from \c QQuickWindow::afterAnimating,
+  and the first pending change requests a frame so that nothing waits for
+  unrelated repaints.
+ */
+
+/*!
+  \brief Returns the singleton instance of the batcher.
+ */
+GraphicsUpdateBatcher* GraphicsUpdateBatcher::instance()
+{
+  static GraphicsUpdateBatcher s_instance;
+
+  return &s_instance;
+}
+
+/*!
+  \internal
+ */
+GraphicsUpdateBatcher::GraphicsUpdateBatcher(QObject* parent) :
+  QObject(parent)
+{
+  m_fallbackTimer.setSingleShot(true);
+  connect(&m_fallbackTimer, &QTimer::timeout, this, &GraphicsUpdateBatcher::commit);
+}
+
+/*!
+  \brief Destructor.
+ */
+GraphicsUpdateBatcher::~GraphicsUpdateBatcher()
+{
+}
+
+/*!
+  \brief Sets the geometry of \a graphic to \a geometry at the next frame.
+
+  A non-zero \a tag is reported by \l updateCommitting and
+  \l updateCommitted as the change is applied, or by \l updateDropped if
+  it never is.
+ */
+void GraphicsUpdateBatcher::setGeometry(Graphic* graphic, const Geometry& geometry, quint64 tag)
+{
+  if (!graphic)
+    return;
+
+  PendingUpdate& update = pendingUpdate(graphic);
+  update.geometry = geometry;
+  update.hasGeometry = true;
+  setTag(update, tag);
+
+  ++m_requestedUpdateCount;
+  scheduleCommit();
+}
+
+/*!
+  \brief Sets the attribute \a name of \a graphic to \a value at the next
+  frame, adding the attribute if the graphic does not have it.
+ */
+void GraphicsUpdateBatcher::setAttribute(Graphic* graphic, const QString& name, const QVariant& value)
+{
+  if (!graphic)
+    return;
+
+  pendingUpdate(graphic).attributes.insert(name, value);
+
+  ++m_requestedUpdateCount;
+  scheduleCommit();
+}
+
+/*!
+  \brief Replaces all of the attributes of \a graphic with \a attributes at the next frame.
+
+  A non-zero \a tag is reported as for \l setGeometry.
+ */
+void GraphicsUpdateBatcher::setAttributes(Graphic* graphic, const QVariantMap& attributes, quint64 tag)
+{
+  if (!graphic)
+    return;
+
+  PendingUpdate& update = pendingUpdate(graphic);
+  update.attributes = attributes;
+  update.replaceAttributes = true;
+  setTag(update, tag);
+
+  ++m_requestedUpdateCount;
+  scheduleCommit();
+}
+
+/*!
+  \brief Discards any pending changes to \a graphic, such as when it is removed.
+ */
+void GraphicsUpdateBatcher::cancel(Graphic* graphic)
+{
+  auto it = m_pending.find(graphic);
+  if (it == m_pending.end())
+    return;
+
+  const quint64 tag = it->tag;
+  m_pending.erase(it);
+  if (tag == 0)
+    return;
+
+  m_pendingTags.remove(tag);
+  emit updateDropped(tag);
+}
+
+/*!
+  \brief Applies every pending change now.
+ */
+void GraphicsUpdateBatcher::commit()
+{
+  m_frameRequested = false;
+  m_fallbackTimer.stop();
+
+  if (m_pending.isEmpty())
+    return;
+
+  // take the pending changes first, since applying them can lead to more being made
+  const QHash<Graphic*, PendingUpdate> pending = std::move(m_pending);
+  m_pending.clear();
+  m_pendingTags.clear();
+
+  for (const PendingUpdate& update : pending)
+  {
+    Graphic* graphic = update.graphic.data();
+    if (!graphic)
+    {
+      if (update.tag != 0)
+        emit updateDropped(update.tag);
+
+      continue;
+    }
+
+    if (update.tag != 0)
+      emit updateCommitting(update.tag);
+
+    // compared here rather than when the change is requested, since a graphic
+    // can move away and back again before the frame
+    if (update.hasGeometry && !(graphic->geometry() == update.geometry))
+    {
+      graphic->setGeometry(update.geometry);
+      ++m_committedUpdateCount;
+    }
+
+    if (update.replaceAttributes)
+    {
+      graphic->attributes()->setAttributesMap(update.attributes);
+      ++m_committedUpdateCount;
+    }
+    else
+    {
+      AttributeListModel* attributes = graphic->attributes();
+      for (auto it = update.attributes.cbegin(); it != update.attributes.cend(); ++it)
+      {
+        if (attributes->containsAttribute(it.key()))
+          attributes->replaceAttribute(it.key(), it.value());
+        else
+          attributes->insertAttribute(it.key(), it.value());
+
+        ++m_committedUpdateCount;
+      }
+    }
+
+    if (update.tag != 0)
+      emit updateCommitted(update.tag);
+  }
+}
+
+/*!
+  \brief Returns the number of changes requested through the batcher.
+ */
+qint64 GraphicsUpdateBatcher::requestedUpdateCount() const
+{
+  return m_requestedUpdateCount;
+}
+
+/*!
+  \brief Returns the number of changes applied to graphics, after
+  intermediate states were dropped.
+ */
+qint64 GraphicsUpdateBatcher::committedUpdateCount() const
+{
+  return m_committedUpdateCount;
+}
+
+/*!
+  \brief Returns whether the change tagged \a tag is waiting for the next frame.
+ */
+bool GraphicsUpdateBatcher::isPending(quint64 tag) const
+{
+  return tag != 0 && m_pendingTags.contains(tag);
+}
+
+/*!
+  \internal
+ */
+GraphicsUpdateBatcher::PendingUpdate& GraphicsUpdateBatcher::pendingUpdate(Graphic* graphic)
+{
+  auto it = m_pending.find(graphic);
+
+  // an entry whose graphic was deleted is stale, even if a new graphic now has its address
+  if (it != m_pending.end() && it->graphic.isNull())
+  {
+    const quint64 tag = it->tag;
+    m_pending.erase(it);
+    it = m_pending.end();
+
+    if (tag != 0)
+    {
+      m_pendingTags.remove(tag);
+      emit updateDropped(tag);
+    }
+  }
+
+  if (it == m_pending.end())
+  {
+    it = m_pending.insert(graphic, PendingUpdate());
+    it->graphic = graphic;
+  }
+
+  return *it;
+}
+
+/*!
+  \internal
+ */
+void GraphicsUpdateBatcher::setTag(PendingUpdate& update, quint64 tag)
+{
+  if (update.tag == tag)
+    return;
+
+  // the change tagged before is overtaken, so it is never drawn
+  if (update.tag != 0)
+  {
+    m_pendingTags.remove(update.tag);
+    emit updateDropped(update.tag);
+  }
+
+  update.tag = tag;
+  if (tag != 0)
+    m_pendingTags.insert(tag);
+}
+
+/*!
+  \internal
+ */
+void GraphicsUpdateBatcher::scheduleCommit()
+{
+  if (m_frameRequested)
+    return;
+
+  m_frameRequested = true;
+
+  QQuickWindow* quickWindow = window();
+  if (quickWindow)
+    quickWindow->update();
+
+  m_fallbackTimer.start(quickWindow ? frameTimeoutMs : fallbackIntervalMs);
+}
+
+/*!
+  \internal
+
+  Returns the window showing the current geo view, connecting to its frames
+  the first time it is seen.
+ */
+QQuickWindow* GraphicsUpdateBatcher::window()
+{
+  auto item = dynamic_cast<QQuickItem*>(Toolkit::ToolResourceProvider::instance()->geoView());
+  QQuickWindow* quickWindow = item ? item->window() : nullptr;
+
+  if (quickWindow != m_window)
+  {
+    if (m_window)
+      disconnect(m_window, &QQuickWindow::afterAnimating, this, &GraphicsUpdateBatcher::commit);
+
+    m_window = quickWindow;
+
+    if (m_window)
+      connect(m_window, &QQuickWindow::afterAnimating, this, &GraphicsUpdateBatcher::commit);
+  }
+
+  return quickWindow;
+}
+
+} // Dsa
+
+// Signal Documentation
+/*!
+  \fn void GraphicsUpdateBatcher::updateCommitting(quint64 tag);
+  \brief Signal emitted just before the change tagged \a tag is applied.
+ */
+
+/*!
+  \fn void GraphicsUpdateBatcher::updateCommitted(quint64 tag);
+  \brief Signal emitted once the change tagged \a tag has been applied.
+ */
+
+/*!
+  \fn void GraphicsUpdateBatcher::updateDropped(quint64 tag);
+  \brief Signal emitted when the change tagged \a tag will not be applied,
+  because a later change to the same graphic replaced it, it was cancelled
+  or the graphic was deleted.
+ */
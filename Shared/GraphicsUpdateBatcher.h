@@ -0,0 +1,99 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef GRAPHICSUPDATEBATCHER_H
+#define GRAPHICSUPDATEBATCHER_H
+
+// C++ API headers
+#include "Geometry.h"
+
+// Qt headers
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <QVariantMap>
+
+class QQuickWindow;
+
+namespace Esri {
+namespace ArcGISRuntime {
+class Graphic;
+}
+}
+
+namespace Dsa {
+
+class GraphicsUpdateBatcher : public QObject
+{
+  Q_OBJECT
+
+public:
+  static GraphicsUpdateBatcher* instance();
+
+  ~GraphicsUpdateBatcher();
+
+  void setGeometry(Esri::ArcGISRuntime::Graphic* graphic, const Esri::ArcGISRuntime::Geometry& geometry, quint64 tag = 0);
+  void setAttribute(Esri::ArcGISRuntime::Graphic* graphic, const QString& name, const QVariant& value);
+  void setAttributes(Esri::ArcGISRuntime::Graphic* graphic, const QVariantMap& attributes, quint64 tag = 0);
+  void cancel(Esri::ArcGISRuntime::Graphic* graphic);
+
+  void commit();
+
+  qint64 requestedUpdateCount() const;
+  qint64 committedUpdateCount() const;
+
+  bool isPending(quint64 tag) const;
+
+signals:
+  void updateCommitting(quint64 tag);
+  void updateCommitted(quint64 tag);
+  void updateDropped(quint64 tag);
+
+private:
+  Q_DISABLE_COPY(GraphicsUpdateBatcher)
+
+  explicit GraphicsUpdateBatcher(QObject* parent = nullptr);
+
+  struct PendingUpdate
+  {
+    QPointer<Esri::ArcGISRuntime::Graphic> graphic;
+    Esri::ArcGISRuntime::Geometry geometry;
+    bool hasGeometry = false;
+    QVariantMap attributes;
+    bool replaceAttributes = false;
+    quint64 tag = 0;
+  };
+
+  PendingUpdate& pendingUpdate(Esri::ArcGISRuntime::Graphic* graphic);
+  void setTag(PendingUpdate& update, quint64 tag);
+  void scheduleCommit();
+  QQuickWindow* window();
+
+  QHash<Esri::ArcGISRuntime::Graphic*, PendingUpdate> m_pending;
+  QSet<quint64> m_pendingTags;
+  QPointer<QQuickWindow> m_window;
+  QTimer m_fallbackTimer;
+  bool m_frameRequested = false;
+  qint64 m_requestedUpdateCount = 0;
+  qint64 m_committedUpdateCount = 0;
+};
+
+} // Dsa
+
+#endif // GRAPHICSUPDATEBATCHER_H
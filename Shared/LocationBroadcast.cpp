@@ -21,9 +21,7 @@
 
 // example app headers
 #include "DataSender.h"
-
-// toolkit headers
-#include "ToolResourceProvider.h"
+#include "LocationDispatcher.h"
 
 // Qt headers
 #include <QHostInfo>
@@ -37,6 +35,9 @@ namespace Dsa {
 // friendly symbol ID for our location broadcast
 static const QString s_locationBroadcastSic{QStringLiteral("SFGPEVAL-------")};
 
+// updates per second taken from the location dispatcher
+static const double s_locationUpdateRate = 1.0;
+
 /*!
   \class Dsa::LocationBroadcast
   \inmodule Dsa
@@ -291,8 +292,11 @@ Message LocationBroadcast::message() const
  */
 void LocationBroadcast::update()
 {
-  if (m_locationChangedConn)
-    disconnect(m_locationChangedConn);
+  if (m_locationSubscription != -1)
+  {
+    LocationDispatcher::instance()->unsubscribe(m_locationSubscription);
+    m_locationSubscription = -1;
+  }
 
   if (m_messageType.isEmpty() || m_udpPort == -1)
     return;
@@ -321,8 +325,9 @@ void LocationBroadcast::update()
 
   if (m_useCurrentLocation)
   {
-    m_locationChangedConn = connect(Toolkit::ToolResourceProvider::instance(), &Toolkit::ToolResourceProvider::locationChanged,
-                                    this, [this](const Point& location)
+    // the location is only sent on the broadcast timer, so
+    // there is no need to store every update
+    m_locationSubscription = LocationDispatcher::instance()->subscribe(this, s_locationUpdateRate, 0.0, [this](const Point& location)
     {
       if (!m_enabled)
         return;
@@ -90,7 +90,7 @@ private:
   Message m_message;
   QTimer* m_timer = nullptr;
 
-  QMetaObject::Connection m_locationChangedConn;
+  int m_locationSubscription = -1;
 };
 
 } // Dsa
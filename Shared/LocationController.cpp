@@ -23,6 +23,7 @@
 // example app headers
 #include "GPXLocationSimulator.h"
 #include "LocationDisplay3d.h"
+#include "NmeaPositionSource.h"
 
 // toolkit headers
 #include "ToolManager.h"
@@ -51,6 +52,10 @@ namespace Dsa {
 const QString LocationController::SIMULATE_LOCATION_PROPERTYNAME = "SimulateLocation";
 const QString LocationController::GPX_FILE_PROPERTYNAME = "GpxFile";
 const QString LocationController::RESOURCE_DIRECTORY_PROPERTYNAME = "ResourceDirectory";
+const QString LocationController::NMEA_SOURCE_PROPERTYNAME = "NmeaSource";
+const QString LocationController::NMEA_MAXIMUM_RATE_PROPERTYNAME = "NmeaMaximumRate";
+
+constexpr double LocationController::DefaultNmeaMaximumRate;
 
 /*!
   \class Dsa::LocationController
@@ -89,6 +94,13 @@ void LocationController::initPositionInfoSource()
   if (isSimulationEnabled() && dynamic_cast<GPXLocationSimulator*>(m_positionSource))
     return;
 
+  if (!isSimulationEnabled() && !m_nmeaSource.isEmpty())
+  {
+    auto nmeaSource = dynamic_cast<NmeaPositionSource*>(m_positionSource);
+    if (nmeaSource && nmeaSource->source() == m_nmeaSource)
+      return;
+  }
+
   clearPositionInfoSource();
 
   if (isSimulationEnabled())
@@ -112,6 +124,30 @@ void LocationController::initPositionInfoSource()
       emit relativeHeadingChanged(heading - m_lastViewHeading);
     });
   }
+  else if (!m_nmeaSource.isEmpty())
+  {
+    auto nmeaSource = new NmeaPositionSource(m_nmeaSource, m_nmeaMaximumRate, this);
+
+    m_positionSource = nmeaSource;
+
+    connect(nmeaSource, &NmeaPositionSource::headingChanged, this,
+    [this](double heading)
+    {
+      if (m_lastKnownHeading == heading)
+        return;
+
+      m_lastKnownHeading = heading;
+
+      emit headingChanged(heading);
+      emit relativeHeadingChanged(heading - m_lastViewHeading);
+    });
+
+    connect(nmeaSource, QOverload<QGeoPositionInfoSource::Error>::of(&QGeoPositionInfoSource::error), this,
+    [this, nmeaSource](QGeoPositionInfoSource::Error)
+    {
+      emit toolErrorOccurred(QStringLiteral("GPS receiver unavailable"), QString("Could not read NMEA from %1").arg(nmeaSource->source()));
+    });
+  }
   else
   {
     m_positionSource = QGeoPositionInfoSource::createDefaultSource(this);
@@ -199,11 +235,18 @@ QString LocationController::toolName() const
  *  \li \c SimulateLocation - Whether the app's location should be simulated.
  *  \li \c GpxFile - The path of the GPX file for simulated positions.
  *  \li \c ResourceDirectory - The directory containing icons for the location display.
+ *  \li \c NmeaSource - The serial port, UDP port or log file of an NMEA GPS receiver
+ *      to use instead of the platform's position source. See \l NmeaReaderWorker.
+ *  \li \c NmeaMaximumRate - The most fixes per second to take from the NMEA receiver.
  * \endlist
  */
 void LocationController::setProperties(const QVariantMap& properties)
 {
   const bool simulate = QString::compare(properties[SIMULATE_LOCATION_PROPERTYNAME].toString(), QString("true"), Qt::CaseInsensitive) == 0;
+  bool rateSet = false;
+  const double nmeaMaximumRate = properties[NMEA_MAXIMUM_RATE_PROPERTYNAME].toDouble(&rateSet);
+  m_nmeaMaximumRate = rateSet && nmeaMaximumRate > 0.0 ? nmeaMaximumRate : DefaultNmeaMaximumRate;
+  setNmeaSource(properties[NMEA_SOURCE_PROPERTYNAME].toString());
   setGpxFilePath(properties[GPX_FILE_PROPERTYNAME].toString());
   setSimulationEnabled(simulate);
   setIconDataPath(properties[RESOURCE_DIRECTORY_PROPERTYNAME].toString());
@@ -359,6 +402,42 @@ void LocationController::setGpxFilePath(const QString& gpxFilePath)
   emit propertyChanged(GPX_FILE_PROPERTYNAME, m_gpxFilePath);
 }
 
+/*!
+  \property LocationController::nmeaSource
+  \brief Returns the source of NMEA sentences used when the location is not
+  simulated, or an empty string to use the platform's position source.
+ */
+QString LocationController::nmeaSource() const
+{
+  return m_nmeaSource;
+}
+
+/*!
+  \brief Sets the source of NMEA sentences to \a nmeaSource.
+ */
+void LocationController::setNmeaSource(const QString& nmeaSource)
+{
+  if (m_nmeaSource == nmeaSource)
+    return;
+
+  m_nmeaSource = nmeaSource;
+
+  if (!isSimulationEnabled() && m_positionSource)
+  {
+    initPositionInfoSource();
+
+    if (isEnabled())
+    {
+      m_positionSource->startUpdates();
+      if (m_compass)
+        m_compass->start();
+    }
+  }
+
+  emit nmeaSourceChanged();
+  emit propertyChanged(NMEA_SOURCE_PROPERTYNAME, m_nmeaSource);
+}
+
 /*!
   \brief Sets the \a sceneView to use for relative heading changes.
  */
@@ -483,6 +562,11 @@ QUrl LocationController::modelSymbolPath() const
   \brief Signal emitted when the location changes to \a newLocation.
  */
 
+/*!
+  \fn void LocationController::nmeaSourceChanged();
+  \brief Signal emitted when the NMEA source changes.
+ */
+
 /*!
   \fn void LocationController::headingChanged(double newHeading);
   \brief Signal emitted when the heading changes to \a newHeading.
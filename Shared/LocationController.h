@@ -48,11 +48,14 @@ class LocationController : public Esri::ArcGISRuntime::Toolkit::AbstractTool
   Q_PROPERTY(bool locationVisible READ isLocationVisible WRITE setLocationVisible NOTIFY locationVisibleChanged)
   Q_PROPERTY(bool simulationEnabled READ isSimulationEnabled WRITE setSimulationEnabled NOTIFY simulationEnabledChanged)
   Q_PROPERTY(QString gpxFilePath READ gpxFilePath WRITE setGpxFilePath NOTIFY gpxFilePathChanged)
+  Q_PROPERTY(QString nmeaSource READ nmeaSource WRITE setNmeaSource NOTIFY nmeaSourceChanged)
 
 public:
   static const QString SIMULATE_LOCATION_PROPERTYNAME;
   static const QString GPX_FILE_PROPERTYNAME;
   static const QString RESOURCE_DIRECTORY_PROPERTYNAME;
+  static const QString NMEA_SOURCE_PROPERTYNAME;
+  static const QString NMEA_MAXIMUM_RATE_PROPERTYNAME;
 
   explicit LocationController(QObject* parent = nullptr);
   ~LocationController();
@@ -76,6 +79,9 @@ public:
   QString gpxFilePath() const;
   void setGpxFilePath(const QString& gpxFilePath);
 
+  QString nmeaSource() const;
+  void setNmeaSource(const QString& nmeaSource);
+
   QString iconDataPath() const { return m_iconDataPath; }
   void setIconDataPath(const QString& dataPath);
 
@@ -91,6 +97,7 @@ signals:
   void locationChanged(const Esri::ArcGISRuntime::Point& newLocation);
   void headingChanged(double newHeading);
   void gpxFilePathChanged();
+  void nmeaSourceChanged();
   void enabledChanged();
   void locationVisibleChanged();
   void simulationEnabledChanged();
@@ -107,6 +114,9 @@ private:
   void clearPositionInfoSource();
   QUrl modelSymbolPath() const;
 
+  // fixes per second from an NMEA receiver, unless configured otherwise
+  static constexpr double DefaultNmeaMaximumRate = 10.0;
+
   QGeoPositionInfoSource* m_positionSource = nullptr;
   QCompass* m_compass = nullptr;
   LocationDisplay3d* m_locationDisplay3d = nullptr;
@@ -116,6 +126,8 @@ private:
   double m_lastKnownHeading = 0.0;
   Esri::ArcGISRuntime::Point m_currentLocation;
   QString m_gpxFilePath;
+  QString m_nmeaSource;
+  double m_nmeaMaximumRate = DefaultNmeaMaximumRate;
   QString m_iconDataPath;
 };
 
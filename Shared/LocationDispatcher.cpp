@@ -0,0 +1,281 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "LocationDispatcher.h"
+
+// toolkit headers
+#include "ToolResourceProvider.h"
+
+// Qt headers
+#include <QtMath>
+
+// STL headers
+#include <cmath>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace Dsa {
+
+namespace
+{
+// meters per degree of latitude, and of longitude at the equator
+const double metersPerDegreeLatitude = 110574.0;
+const double metersPerDegreeLongitude = 111320.0;
+}
+
+/*!
+  \class Dsa::LocationDispatcher
+  \inmodule Dsa
+  \inherits QObject
+  \brief Hands location updates to each consumer at the rate it needs.
+
+  Every update from \l Toolkit::ToolResourceProvider::locationChanged used to
+  run every consumer straight away, so a 10 or 20 Hz position source multiplied
+  its cost by the number of consumers. Instead, each consumer subscribes with a
+  maximum rate and a minimum movement. Updates that arrive faster are coalesced
+  and the consumer receives only the latest location once its interval has
+  passed; updates that move less than the minimum distance from the location
+  it last received are dropped.
+
+  Each consumer picks the rate and the movement from what it does with the
+  location: text that a person reads needs only a couple of updates a second,
+  and analyses over the terrain are only worth making again once the position
+  has moved by a few elevation posts.
+
+  All handlers are called on the thread that owns the dispatcher.
+ */
+
+/*!
+  \brief Returns the singleton instance of the dispatcher.
+ */
+LocationDispatcher* LocationDispatcher::instance()
+{
+  static LocationDispatcher s_instance;
+
+  return &s_instance;
+}
+
+/*!
+  \internal
+ */
+LocationDispatcher::LocationDispatcher(QObject* parent) :
+  QObject(parent)
+{
+  m_clock.start();
+
+  m_timer.setSingleShot(true);
+  m_timer.setTimerType(Qt::PreciseTimer);
+  connect(&m_timer, &QTimer::timeout, this, &LocationDispatcher::dispatchPending);
+
+  connect(Toolkit::ToolResourceProvider::instance(), &Toolkit::ToolResourceProvider::locationChanged,
+          this, &LocationDispatcher::handleLocationChanged);
+}
+
+/*!
+  \brief Destructor.
+ */
+LocationDispatcher::~LocationDispatcher()
+{
+}
+
+/*!
+  \brief Subscribes \a handler to location updates and returns the subscription.
+
+  The handler is called at most \a maximumRate times per second, or on every
+  update if \a maximumRate is 0, and only once the location has moved
+  \a minimumDistance meters from the location it last received. The
+  subscription ends when \a receiver is destroyed.
+
+  If a location is already known, the handler receives it straight away.
+ */
+int LocationDispatcher::subscribe(QObject* receiver, double maximumRate, double minimumDistance, const Handler& handler)
+{
+  const int subscription = m_nextSubscription++;
+
+  Subscription s;
+  s.receiver = receiver;
+  s.minimumIntervalMs = maximumRate > 0.0 ? static_cast<qint64>(1000.0 / maximumRate) : 0;
+  s.minimumDistance = qMax(0.0, minimumDistance);
+  s.handler = handler;
+  s.lastDispatchMs = -1;
+  s.pending = false;
+  m_subscriptions.insert(subscription, s);
+
+  if (receiver)
+  {
+    connect(receiver, &QObject::destroyed, this, [this, subscription]()
+    {
+      unsubscribe(subscription);
+    });
+  }
+
+  if (!m_location.isEmpty())
+    dispatch(subscription, m_clock.elapsed());
+
+  return subscription;
+}
+
+/*!
+  \brief Ends the \a subscription.
+ */
+void LocationDispatcher::unsubscribe(int subscription)
+{
+  m_subscriptions.remove(subscription);
+}
+
+/*!
+  \brief Returns the latest location, which may be newer than the one
+  a subscriber last received.
+ */
+Point LocationDispatcher::location() const
+{
+  return m_location;
+}
+
+/*!
+  \brief Returns the approximate distance in meters between \a from and \a to.
+
+  Geographic locations use a local flat-earth approximation, which is accurate
+  over the short distances between successive updates. Changes in elevation
+  are included when both locations have one.
+ */
+double LocationDispatcher::distance(const Point& from, const Point& to)
+{
+  double dx = to.x() - from.x();
+  double dy = to.y() - from.y();
+
+  if (to.spatialReference().isGeographic())
+  {
+    dx *= metersPerDegreeLongitude * std::cos(qDegreesToRadians(to.y()));
+    dy *= metersPerDegreeLatitude;
+  }
+
+  const double dz = (std::isnan(from.z()) || std::isnan(to.z())) ? 0.0 : to.z() - from.z();
+
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+/*!
+  \internal
+ */
+void LocationDispatcher::handleLocationChanged(const Point& location)
+{
+  m_location = location;
+
+  const qint64 nowMs = m_clock.elapsed();
+
+  // a handler may unsubscribe, so the keys are copied first
+  const QList<int> subscriptions = m_subscriptions.keys();
+  for (int subscription : subscriptions)
+  {
+    auto it = m_subscriptions.find(subscription);
+    if (it == m_subscriptions.end())
+      continue;
+
+    if (it->lastDispatchMs < 0 || nowMs - it->lastDispatchMs >= it->minimumIntervalMs)
+      dispatch(subscription, nowMs);
+    else
+      it->pending = true;
+  }
+
+  scheduleNext(nowMs);
+}
+
+/*!
+  \internal
+ */
+void LocationDispatcher::dispatchPending()
+{
+  const qint64 nowMs = m_clock.elapsed();
+
+  const QList<int> subscriptions = m_subscriptions.keys();
+  for (int subscription : subscriptions)
+  {
+    auto it = m_subscriptions.find(subscription);
+    if (it == m_subscriptions.end() || !it->pending)
+      continue;
+
+    if (nowMs - it->lastDispatchMs >= it->minimumIntervalMs)
+      dispatch(subscription, nowMs);
+  }
+
+  scheduleNext(nowMs);
+}
+
+/*!
+  \internal
+ */
+void LocationDispatcher::dispatch(int subscription, qint64 nowMs)
+{
+  auto it = m_subscriptions.find(subscription);
+  if (it == m_subscriptions.end())
+    return;
+
+  it->pending = false;
+
+  if (!it->receiver)
+  {
+    m_subscriptions.erase(it);
+    return;
+  }
+
+  // small movements are dropped without using up the interval
+  if (!it->lastLocation.isEmpty())
+  {
+    if (it->lastLocation == m_location)
+      return;
+
+    if (it->minimumDistance > 0.0 && distance(it->lastLocation, m_location) < it->minimumDistance)
+      return;
+  }
+
+  it->lastLocation = m_location;
+  it->lastDispatchMs = nowMs;
+
+  // the handler is copied as it may end its own subscription
+  const Handler handler = it->handler;
+  handler(m_location);
+}
+
+/*!
+  \internal
+ */
+void LocationDispatcher::scheduleNext(qint64 nowMs)
+{
+  qint64 nextDueMs = -1;
+  for (const Subscription& s : m_subscriptions)
+  {
+    if (!s.pending)
+      continue;
+
+    const qint64 dueMs = s.lastDispatchMs + s.minimumIntervalMs;
+    if (nextDueMs == -1 || dueMs < nextDueMs)
+      nextDueMs = dueMs;
+  }
+
+  if (nextDueMs == -1)
+  {
+    m_timer.stop();
+    return;
+  }
+
+  m_timer.start(static_cast<int>(qMax<qint64>(0, nextDueMs - nowMs)));
+}
+
+} // Dsa
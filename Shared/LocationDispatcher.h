@@ -0,0 +1,83 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef LOCATIONDISPATCHER_H
+#define LOCATIONDISPATCHER_H
+
+// C++ API headers
+#include "Point.h"
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+// STL headers
+#include <functional>
+
+namespace Dsa {
+
+class LocationDispatcher : public QObject
+{
+  Q_OBJECT
+
+public:
+  using Handler = std::function<void(const Esri::ArcGISRuntime::Point&)>;
+
+  static LocationDispatcher* instance();
+
+  ~LocationDispatcher();
+
+  int subscribe(QObject* receiver, double maximumRate, double minimumDistance, const Handler& handler);
+  void unsubscribe(int subscription);
+
+  Esri::ArcGISRuntime::Point location() const;
+
+  static double distance(const Esri::ArcGISRuntime::Point& from, const Esri::ArcGISRuntime::Point& to);
+
+private:
+  Q_DISABLE_COPY(LocationDispatcher)
+
+  explicit LocationDispatcher(QObject* parent = nullptr);
+
+  struct Subscription
+  {
+    QPointer<QObject> receiver;
+    qint64 minimumIntervalMs;
+    double minimumDistance;
+    Handler handler;
+    Esri::ArcGISRuntime::Point lastLocation;
+    qint64 lastDispatchMs;
+    bool pending;
+  };
+
+  void handleLocationChanged(const Esri::ArcGISRuntime::Point& location);
+  void dispatchPending();
+  void dispatch(int subscription, qint64 nowMs);
+  void scheduleNext(qint64 nowMs);
+
+  QMap<int, Subscription> m_subscriptions;
+  int m_nextSubscription = 0;
+  Esri::ArcGISRuntime::Point m_location;
+  QElapsedTimer m_clock;
+  QTimer m_timer;
+};
+
+} // Dsa
+
+#endif // LOCATIONDISPATCHER_H
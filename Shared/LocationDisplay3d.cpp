@@ -21,6 +21,8 @@
 
 // example app headers
 #include "GPXLocationSimulator.h"
+#include "GraphicsUpdateBatcher.h"
+#include "NmeaPositionSource.h"
 
 // C++ API headers
 #include "GraphicsOverlay.h"
@@ -151,7 +153,7 @@ void LocationDisplay3d::setPositionSource(QGeoPositionInfoSource* positionSource
     // display position 10m off the ground
     constexpr double elevatedZ = 10.0;
     m_lastKnownLocation = Point(pos.longitude(), pos.latitude(), elevatedZ, SpatialReference::wgs84());
-    m_locationGraphic->setGeometry(m_lastKnownLocation);
+    GraphicsUpdateBatcher::instance()->setGeometry(m_locationGraphic, m_lastKnownLocation);
 
     emit locationChanged(m_lastKnownLocation);
   });
@@ -164,7 +166,19 @@ void LocationDisplay3d::setPositionSource(QGeoPositionInfoSource* positionSource
 
     m_headingConnection = connect(gpxLocationSimulator, &GPXLocationSimulator::headingChanged, this, [this](double heading)
     {
-      m_locationGraphic->attributes()->replaceAttribute(s_headingAttribute, heading);
+      GraphicsUpdateBatcher::instance()->setAttribute(m_locationGraphic, s_headingAttribute, heading);
+    });
+  }
+
+  auto* nmeaPositionSource = dynamic_cast<NmeaPositionSource*>(m_geoPositionInfoSource);
+  if (nmeaPositionSource)
+  {
+    if (m_headingConnection)
+      disconnect(m_headingConnection);
+
+    m_headingConnection = connect(nmeaPositionSource, &NmeaPositionSource::headingChanged, this, [this](double heading)
+    {
+      GraphicsUpdateBatcher::instance()->setAttribute(m_locationGraphic, s_headingAttribute, heading);
     });
   }
 
@@ -202,7 +216,7 @@ void LocationDisplay3d::setCompass(QCompass* compass)
     if (!reading)
       return;
 
-    m_locationGraphic->attributes()->replaceAttribute(s_headingAttribute, static_cast<double>(reading->azimuth()));
+    GraphicsUpdateBatcher::instance()->setAttribute(m_locationGraphic, s_headingAttribute, static_cast<double>(reading->azimuth()));
 
     emit headingChanged();
   });
@@ -264,7 +278,7 @@ void LocationDisplay3d::postLastKnownLocationUpdate()
   if (m_lastKnownLocation.isEmpty())
     return;
 
-  m_locationGraphic->setGeometry(m_lastKnownLocation);
+  GraphicsUpdateBatcher::instance()->setGeometry(m_locationGraphic, m_lastKnownLocation);
 
   emit locationChanged(m_lastKnownLocation);
 }
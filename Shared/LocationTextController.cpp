@@ -20,6 +20,11 @@
 
 #include "LocationTextController.h"
 
+// example app headers
+#include "CoordinateNotation.h"
+#include "ElevationSampler.h"
+#include "LocationDispatcher.h"
+
 // toolkit headers
 #include "ToolManager.h"
 #include "ToolResourceProvider.h"
@@ -29,10 +34,16 @@
 #include "Scene.h"
 #include "Surface.h"
 
+// STL headers
+#include <cmath>
+
 using namespace Esri::ArcGISRuntime;
 
 namespace Dsa {
 
+static const double maximumUpdateRate = 2.0; // location text updates per second
+static const double minimumUpdateDistance = 1.0; // meters moved before the text is updated
+
 // constant strings used for properties in the config file
 const QString LocationTextController::COORDINATE_FORMAT_PROPERTYNAME = QStringLiteral("CoordinateFormat");
 const QString LocationTextController::USE_GPS_PROPERTYNAME = QStringLiteral("UseGpsForElevation");
@@ -68,8 +79,11 @@ LocationTextController::LocationTextController(QObject* parent) :
   connect(Toolkit::ToolResourceProvider::instance(), &Toolkit::ToolResourceProvider::geoViewChanged,
           this, &LocationTextController::onGeoViewChanged);
 
-  connect(Toolkit::ToolResourceProvider::instance(), &Toolkit::ToolResourceProvider::locationChanged,
-          this, &LocationTextController::onLocationChanged);
+  // formatting and the elevation query do not need to keep up with the position source
+  LocationDispatcher::instance()->subscribe(this, maximumUpdateRate, minimumUpdateDistance, [this](const Point& location)
+  {
+    onLocationChanged(location);
+  });
 
   Toolkit::ToolManager::instance().addTool(this);
 }
@@ -108,7 +122,7 @@ QString LocationTextController::currentElevationText() const
 }
 
 /*!
- \brief Slot for Toolkit::ToolResourceProvider::locationChanged.
+ \brief Slot for location updates from the LocationDispatcher.
 
  Uses the provided \a pt to update the location and elevation text.
  */
@@ -129,6 +143,14 @@ void LocationTextController::onLocationChanged(const Point& pt)
     formatElevationText(pt.z());
   else
   {
+    // local DTED and GeoTIFF rasters answer immediately, without waiting on the surface query
+    const double elevation = ElevationSampler::instance()->elevation(pt);
+    if (!std::isnan(elevation))
+    {
+      formatElevationText(elevation);
+      return;
+    }
+
     if (!m_surface)
       return;
 
@@ -177,14 +199,17 @@ void LocationTextController::setCoordinateFormat(const QString& format)
   emit propertyChanged(COORDINATE_FORMAT_PROPERTYNAME, format);
   emit coordinateFormatChanged();
 
-  // use std::function to change the lambda that the formatCoordinate member points to
-  // Decimal Degrees
+  // use std::function to change the lambda that the formatCoordinate member points to.
+  // CoordinateNotation produces the same strings as CoordinateFormatter, which is
+  // still used for GEOREF
   const QString currentFormat = coordinateFormat();
+
+  // Decimal Degrees
   if (currentFormat == DD)
   {
     formatCoordinate = [](const Point& p)
     {
-      return CoordinateFormatter::toLatitudeLongitude(p, LatitudeLongitudeFormat::DecimalDegrees, 5);
+      return CoordinateNotation::toString(CoordinateNotation::Format::DecimalDegrees, p);
     };
   }
   // Degrees Decimal Minutes
@@ -192,7 +217,7 @@ void LocationTextController::setCoordinateFormat(const QString& format)
   {
     formatCoordinate = [](const Point& p)
     {
-      return CoordinateFormatter::toLatitudeLongitude(p, LatitudeLongitudeFormat::DegreesDecimalMinutes, 5);
+      return CoordinateNotation::toString(CoordinateNotation::Format::DegreesDecimalMinutes, p);
     };
   }
   // UTM
@@ -200,7 +225,7 @@ void LocationTextController::setCoordinateFormat(const QString& format)
   {
     formatCoordinate = [](const Point& p)
     {
-      return CoordinateFormatter::toUtm(p, UtmConversionMode::NorthSouthIndicators, true);
+      return CoordinateNotation::toString(CoordinateNotation::Format::Utm, p);
     };
   }
   // MGRS
@@ -208,7 +233,7 @@ void LocationTextController::setCoordinateFormat(const QString& format)
   {
     formatCoordinate = [](const Point& p)
     {
-      return CoordinateFormatter::toMgrs(p, MgrsConversionMode::Automatic, 5, true);
+      return CoordinateNotation::toString(CoordinateNotation::Format::Mgrs, p);
     };
   }
   // USNG
@@ -216,7 +241,7 @@ void LocationTextController::setCoordinateFormat(const QString& format)
   {
     formatCoordinate = [](const Point& p)
     {
-      return CoordinateFormatter::toUsng(p, 5, true);
+      return CoordinateNotation::toString(CoordinateNotation::Format::Usng, p);
     };
   }
   // GEOREF
@@ -232,7 +257,7 @@ void LocationTextController::setCoordinateFormat(const QString& format)
   {
     formatCoordinate = [](const Point& p)
     {
-      return CoordinateFormatter::toGars(p);
+      return CoordinateNotation::toString(CoordinateNotation::Format::Gars, p);
     };
   }
   // DMS
@@ -240,7 +265,7 @@ void LocationTextController::setCoordinateFormat(const QString& format)
   {
     formatCoordinate = [](const Point& p)
     {
-      return CoordinateFormatter::toLatitudeLongitude(p, LatitudeLongitudeFormat::DegreesMinutesSeconds, 3);
+      return CoordinateNotation::toString(CoordinateNotation::Format::DegreesMinutesSeconds, p);
     };
   }
 }
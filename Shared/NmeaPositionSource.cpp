@@ -0,0 +1,246 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "NmeaPositionSource.h"
+
+// example app headers
+#include "NmeaReaderWorker.h"
+
+// Qt headers
+#include <QtDebug>
+
+namespace Dsa {
+
+namespace
+{
+const int defaultRequestTimeout = 5000;
+}
+
+/*!
+  \class Dsa::NmeaPositionSource
+  \inmodule Dsa
+  \inherits QGeoPositionInfoSource
+  \brief A position source for GPS receivers that send NMEA 0183 sentences.
+
+  Sentences are read and parsed by a \l NmeaReaderWorker on a thread of its
+  own, so a receiver sending many sentences a second does not load the GUI
+  thread. Fixes are merged on the worker and reach the GUI thread no more
+  than \c maximumRate times a second.
+
+  \a source selects a serial port, a UDP port or a recorded NMEA log; see
+  \l NmeaReaderWorker for its format. Replaying a log makes recorded drives
+  repeatable.
+ */
+
+/*!
+  \brief Constructor taking the \a source to read, the \a maximumRate of
+  fixes per second and an optional \a parent.
+ */
+NmeaPositionSource::NmeaPositionSource(const QString& source, double maximumRate, QObject* parent) :
+  QGeoPositionInfoSource(parent),
+  m_source(source),
+  m_minimumUpdateInterval(maximumRate > 0.0 ? static_cast<int>(1000.0 / maximumRate) : 0),
+  m_worker(new NmeaReaderWorker(source, maximumRate))
+{
+  qRegisterMetaType<QGeoPositionInfo>("QGeoPositionInfo");
+
+  m_thread.setObjectName(QStringLiteral("NmeaReader"));
+  m_worker->moveToThread(&m_thread);
+  connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+  connect(m_worker, &NmeaReaderWorker::positionUpdated, this, &NmeaPositionSource::handlePositionUpdated);
+  connect(m_worker, &NmeaReaderWorker::headingChanged, this, &NmeaPositionSource::headingChanged);
+  connect(m_worker, &NmeaReaderWorker::errorOccurred, this, &NmeaPositionSource::handleError);
+  m_thread.start();
+
+  m_requestTimer.setSingleShot(true);
+  connect(&m_requestTimer, &QTimer::timeout, this, [this]()
+  {
+    m_requested = false;
+    if (!m_running)
+      stopWorker();
+
+    emit updateTimeout();
+  });
+}
+
+/*!
+  \brief Destructor.
+ */
+NmeaPositionSource::~NmeaPositionSource()
+{
+  QMetaObject::invokeMethod(m_worker, "stop", Qt::BlockingQueuedConnection);
+  m_thread.quit();
+  m_thread.wait();
+}
+
+/*!
+  \brief Returns the source of the NMEA sentences.
+ */
+QString NmeaPositionSource::source() const
+{
+  return m_source;
+}
+
+/*!
+  \brief Sets the interval between fixes to \a msec milliseconds.
+
+  Intervals shorter than \l minimumUpdateInterval are raised to it.
+ */
+void NmeaPositionSource::setUpdateInterval(int msec)
+{
+  const int interval = msec > 0 ? qMax(msec, m_minimumUpdateInterval) : 0;
+  QGeoPositionInfoSource::setUpdateInterval(interval);
+
+  QMetaObject::invokeMethod(m_worker, "setUpdateInterval", Qt::QueuedConnection, Q_ARG(int, interval));
+}
+
+/*!
+  \brief Returns the last fix received.
+ */
+QGeoPositionInfo NmeaPositionSource::lastKnownPosition(bool) const
+{
+  return m_lastPosition;
+}
+
+/*!
+  \brief Returns \c SatellitePositioningMethods.
+ */
+QGeoPositionInfoSource::PositioningMethods NmeaPositionSource::supportedPositioningMethods() const
+{
+  return SatellitePositioningMethods;
+}
+
+/*!
+  \brief Returns the interval between fixes at the maximum rate.
+ */
+int NmeaPositionSource::minimumUpdateInterval() const
+{
+  return m_minimumUpdateInterval;
+}
+
+/*!
+  \brief Returns the last error.
+ */
+QGeoPositionInfoSource::Error NmeaPositionSource::error() const
+{
+  return m_error;
+}
+
+/*!
+  \brief Starts reading the source.
+ */
+void NmeaPositionSource::startUpdates()
+{
+  if (m_running)
+    return;
+
+  m_running = true;
+  startWorker();
+}
+
+/*!
+  \brief Stops reading the source.
+ */
+void NmeaPositionSource::stopUpdates()
+{
+  if (!m_running)
+    return;
+
+  m_running = false;
+  if (!m_requested)
+    stopWorker();
+}
+
+/*!
+  \brief Requests a single fix within \a timeout milliseconds.
+ */
+void NmeaPositionSource::requestUpdate(int timeout)
+{
+  if (timeout < 0 || (timeout > 0 && timeout < m_minimumUpdateInterval))
+  {
+    emit updateTimeout();
+    return;
+  }
+
+  m_requested = true;
+  m_requestTimer.start(timeout > 0 ? timeout : defaultRequestTimeout);
+
+  if (!m_running)
+    startWorker();
+}
+
+/*!
+  \internal
+ */
+void NmeaPositionSource::handlePositionUpdated(const QGeoPositionInfo& update)
+{
+  if (!m_running && !m_requested)
+    return;
+
+  m_lastPosition = update;
+
+  if (m_requested)
+  {
+    m_requested = false;
+    m_requestTimer.stop();
+    if (!m_running)
+      stopWorker();
+  }
+
+  emit positionUpdated(update);
+}
+
+/*!
+  \internal
+ */
+void NmeaPositionSource::handleError(const QString& message)
+{
+  qWarning() << message;
+
+  m_error = AccessError;
+  emit QGeoPositionInfoSource::error(m_error);
+}
+
+/*!
+  \internal
+ */
+void NmeaPositionSource::startWorker()
+{
+  m_error = NoError;
+  QMetaObject::invokeMethod(m_worker, "start", Qt::QueuedConnection);
+}
+
+/*!
+  \internal
+ */
+void NmeaPositionSource::stopWorker()
+{
+  QMetaObject::invokeMethod(m_worker, "stop", Qt::QueuedConnection);
+}
+
+} // Dsa
+
+// Signal Documentation
+
+/*!
+  \fn void NmeaPositionSource::headingChanged(double heading);
+
+  \brief Signal emitted when the receiver reports a new true \a heading, or
+  a new course over ground when it has no heading sensor.
+ */
@@ -0,0 +1,73 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef NMEAPOSITIONSOURCE_H
+#define NMEAPOSITIONSOURCE_H
+
+// Qt headers
+#include <QGeoPositionInfoSource>
+#include <QThread>
+#include <QTimer>
+
+namespace Dsa {
+
+class NmeaReaderWorker;
+
+class NmeaPositionSource : public QGeoPositionInfoSource
+{
+  Q_OBJECT
+
+public:
+  NmeaPositionSource(const QString& source, double maximumRate, QObject* parent = nullptr);
+  ~NmeaPositionSource() override;
+
+  QString source() const;
+
+  void setUpdateInterval(int msec) override;
+  QGeoPositionInfo lastKnownPosition(bool fromSatellitePositioningMethodsOnly = false) const override;
+  PositioningMethods supportedPositioningMethods() const override;
+  int minimumUpdateInterval() const override;
+  Error error() const override;
+
+public slots:
+  void startUpdates() override;
+  void stopUpdates() override;
+  void requestUpdate(int timeout = 0) override;
+
+signals:
+  void headingChanged(double heading);
+
+private:
+  void handlePositionUpdated(const QGeoPositionInfo& update);
+  void handleError(const QString& message);
+  void startWorker();
+  void stopWorker();
+
+  QString m_source;
+  int m_minimumUpdateInterval = 0;
+  QThread m_thread;
+  NmeaReaderWorker* m_worker = nullptr;
+  QTimer m_requestTimer;
+  QGeoPositionInfo m_lastPosition;
+  Error m_error = NoError;
+  bool m_running = false;
+  bool m_requested = false;
+};
+
+} // Dsa
+
+#endif // NMEAPOSITIONSOURCE_H
@@ -0,0 +1,438 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "NmeaReaderWorker.h"
+
+// Qt headers
+#include <QFile>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QUrl>
+#include <QUrlQuery>
+
+#ifdef QT_SERIALPORT_LIB
+#include <QSerialPort>
+#endif
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+namespace
+{
+const int maximumLineLength = 1024;
+const int millisecondsPerDay = 24 * 60 * 60 * 1000;
+
+// the hhmmss.ss time of a GGA or RMC sentence in milliseconds since midnight, or -1
+int sentenceTimeMs(const QByteArray& line)
+{
+  if (line.size() < 14 || line.at(0) != '$' || line.at(6) != ',')
+    return -1;
+
+  const QByteArray type = line.mid(3, 3);
+  if (type != "GGA" && type != "RMC")
+    return -1;
+
+  const int end = line.indexOf(',', 7);
+  if (end - 7 < 6)
+    return -1;
+
+  bool ok = false;
+  const double seconds = line.mid(11, end - 11).toDouble(&ok);
+  if (!ok)
+    return -1;
+
+  return (line.mid(7, 2).toInt() * 60 + line.mid(9, 2).toInt()) * 60000 + static_cast<int>(std::lround(seconds * 1000.0));
+}
+}
+
+/*!
+  \class Dsa::NmeaReaderWorker
+  \inmodule Dsa
+  \brief Reads NMEA sentences from a serial port, UDP or a recorded log on a worker thread.
+
+  The worker is moved to its own thread by \l NmeaPositionSource, and
+  publishes fixes back to it no more often than the maximum rate, however
+  fast the receiver sends them. \a source is one of:
+
+  \list
+    \li \c serial:<port>?baud=<rate> - a serial receiver, such as
+        \c serial:COM3?baud=4800 or \c serial:/dev/ttyUSB0?baud=9600.
+    \li \c udp:<port> - sentences broadcast as UDP datagrams, such as \c udp:10110.
+    \li \c file:<path>?speed=<multiplier>&loop=<bool> - a recorded log,
+        replayed at \c speed times the recorded pace (\c 0 for as fast as
+        possible) and looped unless \c loop is \c false. A plain path is
+        replayed the same way.
+  \endlist
+ */
+
+/*!
+  \brief Constructor taking the \a source to read, the \a maximumRate of
+  published fixes per second and an optional \a parent.
+ */
+NmeaReaderWorker::NmeaReaderWorker(const QString& source, double maximumRate, QObject* parent) :
+  QObject(parent),
+  m_replayTimer(new QTimer(this)),
+  m_publishTimer(new QTimer(this)),
+  m_minimumIntervalMs(maximumRate > 0.0 ? static_cast<int>(1000.0 / maximumRate) : 0)
+{
+  const QUrl url(source);
+  const QUrlQuery query(url);
+  const QString scheme = url.scheme().toLower();
+
+  if (scheme == QStringLiteral("serial"))
+  {
+    m_sourceType = SourceType::Serial;
+    m_path = url.path();
+    if (query.hasQueryItem(QStringLiteral("baud")))
+      m_baudRate = query.queryItemValue(QStringLiteral("baud")).toInt();
+  }
+  else if (scheme == QStringLiteral("udp"))
+  {
+    m_sourceType = SourceType::Udp;
+    m_port = url.path().toUShort();
+  }
+  else
+  {
+    m_sourceType = SourceType::File;
+    m_path = scheme == QStringLiteral("file") ? url.path() : source;
+    if (query.hasQueryItem(QStringLiteral("speed")))
+      m_replaySpeed = query.queryItemValue(QStringLiteral("speed")).toDouble();
+    m_loop = query.queryItemValue(QStringLiteral("loop")).compare(QStringLiteral("false"), Qt::CaseInsensitive) != 0;
+  }
+
+  m_replayTimer->setSingleShot(true);
+  connect(m_replayTimer, &QTimer::timeout, this, &NmeaReaderWorker::replayNextEpoch);
+
+  m_publishTimer->setSingleShot(true);
+  connect(m_publishTimer, &QTimer::timeout, this, &NmeaReaderWorker::publish);
+}
+
+/*!
+  \brief Destructor.
+ */
+NmeaReaderWorker::~NmeaReaderWorker()
+{
+  close();
+}
+
+/*!
+  \brief Opens the source and starts reading.
+ */
+void NmeaReaderWorker::start()
+{
+  if (m_running)
+    return;
+
+  if (!open())
+    return;
+
+  m_running = true;
+  m_clock.start();
+  m_lastPublishMs = -1;
+
+  if (m_sourceType == SourceType::File)
+    m_replayTimer->start(0);
+}
+
+/*!
+  \brief Stops reading and closes the source.
+ */
+void NmeaReaderWorker::stop()
+{
+  m_running = false;
+  m_replayTimer->stop();
+  m_publishTimer->stop();
+  m_pending = false;
+  close();
+}
+
+/*!
+  \brief Publishes fixes no more often than every \a msec milliseconds, or
+  at the maximum rate if that is less often.
+ */
+void NmeaReaderWorker::setUpdateInterval(int msec)
+{
+  m_updateIntervalMs = qMax(0, msec);
+}
+
+/*!
+  \internal
+ */
+bool NmeaReaderWorker::open()
+{
+  switch (m_sourceType)
+  {
+  case SourceType::Serial:
+  {
+#ifdef QT_SERIALPORT_LIB
+    auto port = new QSerialPort(m_path, this);
+    port->setBaudRate(m_baudRate);
+    if (!port->open(QIODevice::ReadOnly))
+    {
+      emit errorOccurred(QString("Could not open GPS serial port %1: %2").arg(m_path, port->errorString()));
+      delete port;
+      return false;
+    }
+
+    connect(port, &QSerialPort::readyRead, this, &NmeaReaderWorker::readDevice);
+    m_device = port;
+    return true;
+#else
+    emit errorOccurred(QStringLiteral("Serial GPS receivers are not supported on this platform"));
+    return false;
+#endif
+  }
+  case SourceType::Udp:
+  {
+    m_socket = new QUdpSocket(this);
+    if (!m_socket->bind(QHostAddress::AnyIPv4, m_port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint))
+    {
+      emit errorOccurred(QString("Could not listen for NMEA on UDP port %1: %2").arg(QString::number(m_port), m_socket->errorString()));
+      delete m_socket;
+      m_socket = nullptr;
+      return false;
+    }
+
+    connect(m_socket, &QUdpSocket::readyRead, this, &NmeaReaderWorker::readDatagrams);
+    return true;
+  }
+  case SourceType::File:
+  {
+    m_file = new QFile(m_path, this);
+    if (!m_file->open(QIODevice::ReadOnly))
+    {
+      emit errorOccurred(QString("Could not open NMEA log %1: %2").arg(m_path, m_file->errorString()));
+      delete m_file;
+      m_file = nullptr;
+      return false;
+    }
+
+    m_parser.reset();
+    m_pendingLine.clear();
+    m_epochTimeMs = -1;
+    return true;
+  }
+  }
+
+  return false;
+}
+
+/*!
+  \internal
+ */
+void NmeaReaderWorker::close()
+{
+  delete m_device;
+  m_device = nullptr;
+
+  delete m_socket;
+  m_socket = nullptr;
+
+  delete m_file;
+  m_file = nullptr;
+}
+
+/*!
+  \internal
+ */
+void NmeaReaderWorker::readDevice()
+{
+  if (!m_device)
+    return;
+
+  const QByteArray data = m_device->readAll();
+  handleData(data.constData(), data.size());
+  schedulePublish();
+}
+
+/*!
+  \internal
+ */
+void NmeaReaderWorker::readDatagrams()
+{
+  if (!m_socket)
+    return;
+
+  while (m_socket->hasPendingDatagrams())
+  {
+    QByteArray datagram(static_cast<int>(m_socket->pendingDatagramSize()), Qt::Uninitialized);
+    const qint64 size = m_socket->readDatagram(datagram.data(), datagram.size());
+    if (size <= 0)
+      continue;
+
+    handleData(datagram.constData(), static_cast<int>(size));
+
+    // a datagram holds whole sentences, so its last line is complete even without a line ending
+    if (datagram.at(static_cast<int>(size) - 1) != '\n')
+      handleData("\n", 1);
+  }
+
+  schedulePublish();
+}
+
+/*!
+  \internal
+
+  Reads the log up to the first sentence of the next epoch, publishes the
+  epoch just read, and waits for the time between the two epochs before
+  reading on.
+ */
+void NmeaReaderWorker::replayNextEpoch()
+{
+  if (!m_running || !m_file)
+    return;
+
+  bool restarted = false;
+  for (;;)
+  {
+    if (m_pendingLine.isEmpty())
+    {
+      if (m_file->atEnd())
+      {
+        schedulePublish();
+
+        // a log without a second epoch would otherwise loop forever
+        if (!m_loop || restarted)
+          return;
+
+        m_file->seek(0);
+        m_parser.reset();
+        m_epochTimeMs = -1;
+        restarted = true;
+        continue;
+      }
+
+      m_pendingLine = m_file->readLine(maximumLineLength);
+      if (m_pendingLine.isEmpty())
+      {
+        // a read error rather than the end of the file
+        if (!m_file->atEnd())
+          return;
+
+        continue;
+      }
+    }
+
+    const int timeMs = sentenceTimeMs(m_pendingLine);
+    if (timeMs >= 0 && m_epochTimeMs >= 0 && timeMs != m_epochTimeMs)
+    {
+      int delayMs = timeMs - m_epochTimeMs;
+      if (delayMs < 0)
+        delayMs += millisecondsPerDay;
+
+      m_epochTimeMs = timeMs;
+      schedulePublish();
+      m_replayTimer->start(m_replaySpeed > 0.0 ? static_cast<int>(delayMs / m_replaySpeed) : 0);
+      return;
+    }
+
+    if (timeMs >= 0)
+      m_epochTimeMs = timeMs;
+
+    handleData(m_pendingLine.constData(), m_pendingLine.size());
+    if (!m_pendingLine.endsWith('\n'))
+      handleData("\n", 1);
+
+    m_pendingLine.clear();
+  }
+}
+
+/*!
+  \internal
+ */
+void NmeaReaderWorker::handleData(const char* data, int size)
+{
+  if (m_parser.append(data, size) > 0)
+    m_pending = true;
+
+  if (m_parser.hasHeading() && m_parser.heading() != m_lastHeading)
+    m_pending = true;
+}
+
+/*!
+  \internal
+
+  Publishes straight away if the last publication was at least an interval
+  ago, and otherwise once it is; fixes in between replace one another.
+ */
+void NmeaReaderWorker::schedulePublish()
+{
+  if (!m_pending || m_publishTimer->isActive())
+    return;
+
+  const qint64 intervalMs = qMax(m_minimumIntervalMs, m_updateIntervalMs);
+  const qint64 elapsedMs = m_clock.elapsed() - m_lastPublishMs;
+  if (m_lastPublishMs < 0 || elapsedMs >= intervalMs)
+    publish();
+  else
+    m_publishTimer->start(static_cast<int>(intervalMs - elapsedMs));
+}
+
+/*!
+  \internal
+ */
+void NmeaReaderWorker::publish()
+{
+  if (!m_pending || !m_running)
+    return;
+
+  m_pending = false;
+  m_lastPublishMs = m_clock.elapsed();
+
+  if (m_parser.hasFix())
+    emit positionUpdated(m_parser.fix());
+
+  // receivers without a heading sensor only report the course over ground
+  double heading = -1.0;
+  if (m_parser.hasHeading())
+    heading = m_parser.heading();
+  else if (m_parser.hasFix() && m_parser.fix().hasAttribute(QGeoPositionInfo::Direction))
+    heading = m_parser.fix().attribute(QGeoPositionInfo::Direction);
+
+  if (heading >= 0.0 && heading != m_lastHeading)
+  {
+    m_lastHeading = heading;
+    emit headingChanged(heading);
+  }
+}
+
+} // Dsa
+
+// Signal Documentation
+
+/*!
+  \fn void NmeaReaderWorker::positionUpdated(const QGeoPositionInfo& update);
+
+  \brief Signal emitted with the latest fix, \a update, at most at the maximum rate.
+ */
+
+/*!
+  \fn void NmeaReaderWorker::headingChanged(double heading);
+
+  \brief Signal emitted when the true \a heading, or the course when there is
+  no heading sensor, changes.
+ */
+
+/*!
+  \fn void NmeaReaderWorker::errorOccurred(const QString& message);
+
+  \brief Signal emitted with a \a message when the source cannot be opened.
+ */
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef NMEAREADERWORKER_H
+#define NMEAREADERWORKER_H
+
+// example app headers
+#include "NmeaSentenceParser.h"
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QGeoPositionInfo>
+#include <QObject>
+
+class QFile;
+class QIODevice;
+class QTimer;
+class QUdpSocket;
+
+namespace Dsa {
+
+class NmeaReaderWorker : public QObject
+{
+  Q_OBJECT
+
+public:
+  NmeaReaderWorker(const QString& source, double maximumRate, QObject* parent = nullptr);
+  ~NmeaReaderWorker();
+
+public slots:
+  void start();
+  void stop();
+  void setUpdateInterval(int msec);
+
+signals:
+  void positionUpdated(const QGeoPositionInfo& update);
+  void headingChanged(double heading);
+  void errorOccurred(const QString& message);
+
+private:
+  enum class SourceType
+  {
+    Serial,
+    Udp,
+    File
+  };
+
+  bool open();
+  void close();
+  void readDevice();
+  void readDatagrams();
+  void replayNextEpoch();
+  void handleData(const char* data, int size);
+  void schedulePublish();
+  void publish();
+
+  SourceType m_sourceType = SourceType::File;
+  QString m_path;
+  int m_baudRate = 4800;
+  quint16 m_port = 10110;
+  double m_replaySpeed = 1.0;
+  bool m_loop = true;
+
+  NmeaSentenceParser m_parser;
+  QIODevice* m_device = nullptr;
+  QUdpSocket* m_socket = nullptr;
+  QFile* m_file = nullptr;
+  QByteArray m_pendingLine;
+  int m_epochTimeMs = -1;
+
+  QTimer* m_replayTimer = nullptr;
+  QTimer* m_publishTimer = nullptr;
+  QElapsedTimer m_clock;
+  qint64 m_lastPublishMs = -1;
+  int m_minimumIntervalMs = 0;
+  int m_updateIntervalMs = 0;
+  bool m_pending = false;
+  double m_lastHeading = -1.0;
+  bool m_running = false;
+};
+
+} // Dsa
+
+#endif // NMEAREADERWORKER_H
@@ -0,0 +1,377 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "NmeaSentenceParser.h"
+
+// Qt headers
+#include <QList>
+
+// STL headers
+#include <cmath>
+#include <cstring>
+
+namespace Dsa {
+
+namespace
+{
+// NMEA 0183 sentences are at most 82 characters; anything much longer is line noise
+const int maximumSentenceLength = 256;
+
+const double metersPerSecondPerKnot = 1852.0 / 3600.0;
+
+int hexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+
+  return -1;
+}
+
+// ddmm.mmmm or dddmm.mmmm with a hemisphere letter
+bool parseAngle(const QByteArray& value, const QByteArray& hemisphere, char negative, double& degrees)
+{
+  bool ok = false;
+  const double raw = value.toDouble(&ok);
+  if (!ok || hemisphere.isEmpty())
+    return false;
+
+  const double whole = std::floor(raw / 100.0);
+  degrees = whole + (raw - whole * 100.0) / 60.0;
+  if (hemisphere.at(0) == negative)
+    degrees = -degrees;
+
+  return true;
+}
+}
+
+/*!
+  \class Dsa::NmeaSentenceParser
+  \inmodule Dsa
+  \brief Parses a stream of NMEA 0183 sentences into position fixes.
+
+  Bytes can be appended as they arrive, split anywhere; complete lines are
+  parsed as soon as their line ending is seen. Sentences without a valid
+  checksum are counted and ignored.
+
+  GGA and RMC sentences update the position, RMC and VTG the ground speed and
+  course, and HDT the heading. Fields from different sentences of the same
+  epoch are merged into a single \l fix.
+ */
+
+/*!
+  \brief Constructor.
+ */
+NmeaSentenceParser::NmeaSentenceParser()
+{
+  m_line.reserve(maximumSentenceLength);
+}
+
+/*!
+  \brief Parses the \a size bytes at \a data, continuing any line left
+  incomplete by the previous call.
+
+  Returns the number of sentences that updated the position.
+ */
+int NmeaSentenceParser::append(const char* data, int size)
+{
+  int updates = 0;
+  const char* end = data + size;
+
+  while (data < end)
+  {
+    const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+    const char* lineEnd = newline ? newline : end;
+
+    if (!m_discarding)
+    {
+      m_line.append(data, static_cast<int>(lineEnd - data));
+      if (m_line.size() > maximumSentenceLength)
+      {
+        m_line.clear();
+        m_discarding = true;
+      }
+    }
+
+    if (!newline)
+      break;
+
+    if (!m_discarding && parseSentence(m_line.constData(), m_line.size()))
+      ++updates;
+
+    m_line.clear();
+    m_discarding = false;
+    data = newline + 1;
+  }
+
+  return updates;
+}
+
+/*!
+  \overload
+ */
+int NmeaSentenceParser::append(const QByteArray& data)
+{
+  return append(data.constData(), data.size());
+}
+
+/*!
+  \brief Parses the single sentence of \a size bytes at \a sentence.
+
+  Returns \c true if the sentence updated the position.
+ */
+bool NmeaSentenceParser::parseSentence(const char* sentence, int size)
+{
+  while (size > 0 && (sentence[size - 1] == '\r' || sentence[size - 1] == ' '))
+    --size;
+
+  if (size < 7 || (sentence[0] != '$' && sentence[0] != '!'))
+    return false;
+
+  // the checksum is the exclusive or of everything between the start character and the '*'
+  const int star = size - 3;
+  if (sentence[star] != '*')
+  {
+    ++m_checksumErrorCount;
+    return false;
+  }
+
+  const int high = hexValue(sentence[star + 1]);
+  const int low = hexValue(sentence[star + 2]);
+  unsigned char checksum = 0;
+  for (int i = 1; i < star; ++i)
+    checksum ^= static_cast<unsigned char>(sentence[i]);
+
+  if (high < 0 || low < 0 || checksum != ((high << 4) | low))
+  {
+    ++m_checksumErrorCount;
+    return false;
+  }
+
+  ++m_sentenceCount;
+
+  if (!parseFields(QByteArray(sentence + 1, star - 1)))
+    return false;
+
+  m_hasFix = true;
+  return true;
+}
+
+/*!
+  \brief Forgets the partial line and the current fix.
+ */
+void NmeaSentenceParser::reset()
+{
+  m_line.clear();
+  m_discarding = false;
+  m_fix = QGeoPositionInfo();
+  m_hasFix = false;
+  m_date = QDate();
+  m_time = QTime();
+  m_heading = 0.0;
+  m_hasHeading = false;
+}
+
+/*!
+  \brief Returns whether a GGA or RMC sentence has given a position.
+ */
+bool NmeaSentenceParser::hasFix() const
+{
+  return m_hasFix;
+}
+
+/*!
+  \brief Returns the latest position, with ground speed and direction when known.
+ */
+QGeoPositionInfo NmeaSentenceParser::fix() const
+{
+  return m_fix;
+}
+
+/*!
+  \brief Returns the UTC time of the latest position.
+ */
+QDateTime NmeaSentenceParser::fixTime() const
+{
+  return m_fix.timestamp();
+}
+
+/*!
+  \brief Returns whether an HDT sentence has given a heading.
+ */
+bool NmeaSentenceParser::hasHeading() const
+{
+  return m_hasHeading;
+}
+
+/*!
+  \brief Returns the latest true heading in degrees.
+ */
+double NmeaSentenceParser::heading() const
+{
+  return m_heading;
+}
+
+/*!
+  \brief Returns the number of sentences with a valid checksum.
+ */
+qint64 NmeaSentenceParser::sentenceCount() const
+{
+  return m_sentenceCount;
+}
+
+/*!
+  \brief Returns the number of sentences rejected for a missing or wrong checksum.
+ */
+qint64 NmeaSentenceParser::checksumErrorCount() const
+{
+  return m_checksumErrorCount;
+}
+
+/*!
+  \internal
+ */
+bool NmeaSentenceParser::parseFields(const QByteArray& sentence)
+{
+  const QList<QByteArray> fields = sentence.split(',');
+  const QByteArray& address = fields.at(0);
+  if (address.size() < 5)
+    return false;
+
+  const QByteArray type = address.right(3);
+
+  if (type == "GGA")
+  {
+    // time, latitude, N/S, longitude, E/W, quality, satellites, HDOP, altitude, M, ...
+    if (fields.size() < 10 || fields.at(6).toInt() == 0)
+      return false;
+
+    double latitude = 0.0;
+    double longitude = 0.0;
+    if (!parseAngle(fields.at(2), fields.at(3), 'S', latitude) || !parseAngle(fields.at(4), fields.at(5), 'W', longitude))
+      return false;
+
+    bool hasAltitude = false;
+    const double altitude = fields.at(9).toDouble(&hasAltitude);
+
+    updateTime(fields.at(1));
+    m_fix.setCoordinate(hasAltitude ? QGeoCoordinate(latitude, longitude, altitude) : QGeoCoordinate(latitude, longitude));
+    return true;
+  }
+  else if (type == "RMC")
+  {
+    // time, status, latitude, N/S, longitude, E/W, speed in knots, course, date, ...
+    if (fields.size() < 10 || fields.at(2) != "A")
+      return false;
+
+    double latitude = 0.0;
+    double longitude = 0.0;
+    if (!parseAngle(fields.at(3), fields.at(4), 'S', latitude) || !parseAngle(fields.at(5), fields.at(6), 'W', longitude))
+      return false;
+
+    const QByteArray& date = fields.at(9);
+    if (date.size() == 6)
+    {
+      const QDate parsed(2000 + date.mid(4, 2).toInt(), date.mid(2, 2).toInt(), date.left(2).toInt());
+      if (parsed.isValid())
+        m_date = parsed;
+    }
+
+    // RMC has no altitude, so keep the one from the epoch's GGA
+    const QGeoCoordinate previous = m_fix.coordinate();
+    updateTime(fields.at(1));
+    m_fix.setCoordinate(previous.type() == QGeoCoordinate::Coordinate3D ?
+                          QGeoCoordinate(latitude, longitude, previous.altitude()) :
+                          QGeoCoordinate(latitude, longitude));
+
+    bool ok = false;
+    const double knots = fields.at(7).toDouble(&ok);
+    if (ok)
+      m_fix.setAttribute(QGeoPositionInfo::GroundSpeed, knots * metersPerSecondPerKnot);
+
+    const double course = fields.at(8).toDouble(&ok);
+    if (ok)
+      m_fix.setAttribute(QGeoPositionInfo::Direction, course);
+
+    return true;
+  }
+  else if (type == "VTG")
+  {
+    // course, T, magnetic course, M, knots, N, km/h, K; older receivers leave out the unit letters
+    const bool labelled = fields.size() > 2 && fields.at(2) == "T";
+    const int speedField = labelled ? 5 : 3;
+    if (fields.size() <= speedField)
+      return false;
+
+    bool ok = false;
+    const double course = fields.at(1).toDouble(&ok);
+    if (ok)
+      m_fix.setAttribute(QGeoPositionInfo::Direction, course);
+
+    const double knots = fields.at(speedField).toDouble(&ok);
+    if (ok)
+      m_fix.setAttribute(QGeoPositionInfo::GroundSpeed, knots * metersPerSecondPerKnot);
+  }
+  else if (type == "HDT")
+  {
+    // heading, T
+    if (fields.size() < 2)
+      return false;
+
+    bool ok = false;
+    const double heading = fields.at(1).toDouble(&ok);
+    if (ok)
+    {
+      m_heading = heading;
+      m_hasHeading = true;
+    }
+  }
+
+  // only GGA and RMC carry a position
+  return false;
+}
+
+/*!
+  \internal
+
+  Sets the fix time from the hhmmss.ss \a field and the last RMC date, or
+  today's date until an RMC sentence has been seen.
+ */
+bool NmeaSentenceParser::updateTime(const QByteArray& field)
+{
+  if (field.size() < 6)
+    return false;
+
+  const double seconds = field.mid(4).toDouble();
+  const QTime time(field.left(2).toInt(), field.mid(2, 2).toInt(), static_cast<int>(seconds),
+                   static_cast<int>(std::lround((seconds - std::floor(seconds)) * 1000.0)) % 1000);
+  if (!time.isValid())
+    return false;
+
+  m_time = time;
+  const QDate date = m_date.isValid() ? m_date : QDateTime::currentDateTimeUtc().date();
+  m_fix.setTimestamp(QDateTime(date, m_time, Qt::UTC));
+
+  return true;
+}
+
+} // Dsa
@@ -0,0 +1,69 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef NMEASENTENCEPARSER_H
+#define NMEASENTENCEPARSER_H
+
+// Qt headers
+#include <QByteArray>
+#include <QDate>
+#include <QGeoPositionInfo>
+#include <QTime>
+
+namespace Dsa {
+
+class NmeaSentenceParser
+{
+public:
+  NmeaSentenceParser();
+
+  int append(const char* data, int size);
+  int append(const QByteArray& data);
+  bool parseSentence(const char* sentence, int size);
+  void reset();
+
+  bool hasFix() const;
+  QGeoPositionInfo fix() const;
+  QDateTime fixTime() const;
+
+  bool hasHeading() const;
+  double heading() const;
+
+  qint64 sentenceCount() const;
+  qint64 checksumErrorCount() const;
+
+private:
+  bool parseFields(const QByteArray& sentence);
+  bool updateTime(const QByteArray& field);
+
+  QByteArray m_line;
+  bool m_discarding = false;
+
+  QGeoPositionInfo m_fix;
+  bool m_hasFix = false;
+  QDate m_date;
+  QTime m_time;
+  double m_heading = 0.0;
+  bool m_hasHeading = false;
+
+  qint64 m_sentenceCount = 0;
+  qint64 m_checksumErrorCount = 0;
+};
+
+} // Dsa
+
+#endif // NMEASENTENCEPARSER_H
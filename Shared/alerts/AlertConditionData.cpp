@@ -23,6 +23,7 @@
 #include "AlertCondition.h"
 #include "AlertSource.h"
 #include "AlertTarget.h"
+#include "MessageLatencyTracker.h"
 
 using namespace Esri::ArcGISRuntime;
 
@@ -281,6 +282,7 @@ void AlertConditionData::handleDataChanged()
 
   // update the new active state
   setActive(m_cachedQueryResult);
+  MessageLatencyTracker::instance()->alertTransition();
 
   // if the condition data has newly moved into the active state, reset the viewed flag to false
   if (isActive())
@@ -19,13 +19,16 @@
 
 #include "LocationAlertSource.h"
 
-// toolkit headers
-#include "ToolResourceProvider.h"
+// example app headers
+#include "LocationDispatcher.h"
 
 using namespace Esri::ArcGISRuntime;
 
 namespace Dsa {
 
+static const double maximumUpdateRate = 2.0; // alert checks of the location per second
+static const double minimumUpdateDistance = 1.0; // meters moved before the alerts are checked again
+
 /*!
   \class Dsa::LocationAlertSource
   \inmodule Dsa
@@ -36,7 +39,7 @@ namespace Dsa {
   Changes to the device position will cause the \l AlertSource::locationChanged
   signal to be emitted.
 
-  /sa Toolkit::ToolResourceProvider
+  /sa LocationDispatcher
  */
 
 /*!
@@ -46,7 +49,8 @@ LocationAlertSource::LocationAlertSource(QObject* parent):
   AlertSource(parent),
   m_location(0., 0., SpatialReference::wgs84())
 {
-  connect(Toolkit::ToolResourceProvider::instance(), &Toolkit::ToolResourceProvider::locationChanged, this, [this](const Point& location)
+  // each update re-evaluates every alert condition that uses the location
+  LocationDispatcher::instance()->subscribe(this, maximumUpdateRate, minimumUpdateDistance, [this](const Point& location)
   {
     if (m_location == location)
       return;
@@ -19,8 +19,8 @@
 
 #include "LocationAlertTarget.h"
 
-// toolkit headers
-#include "ToolResourceProvider.h"
+// example app headers
+#include "LocationDispatcher.h"
 
 // C++ API headers
 #include "GeometryEngine.h"
@@ -29,6 +29,9 @@ using namespace Esri::ArcGISRuntime;
 
 namespace Dsa {
 
+static const double maximumUpdateRate = 2.0; // updates of the target location per second
+static const double minimumUpdateDistance = 1.0; // meters moved before the target location is updated
+
 /*!
   \class Dsa::LocationAlertTarget
   \inmodule Dsa
@@ -45,7 +48,8 @@ namespace Dsa {
 LocationAlertTarget::LocationAlertTarget(QObject* parent):
   AlertTarget(parent)
 {
-  connect(Toolkit::ToolResourceProvider::instance(), &Toolkit::ToolResourceProvider::locationChanged, this, [this](const Point& location)
+  // each update re-evaluates every alert condition that uses the location
+  LocationDispatcher::instance()->subscribe(this, maximumUpdateRate, minimumUpdateDistance, [this](const Point& location)
   {
     if (m_location == location)
       return;
@@ -0,0 +1,264 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+// PCH header
+#include "pch.hpp"
+
+#include "CumulativeViewshed.h"
+
+// example app headers
+#include "ElevationGrid.h"
+#include "GeoTiffWriter.h"
+#include "ParallelFor.h"
+
+// Qt headers
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+
+// STL headers
+#include <cmath>
+#include <memory>
+
+namespace Dsa {
+
+constexpr quint16 CumulativeViewshedRaster::NoData;
+
+namespace
+{
+// rows are locked in stripes so that observers adding different rows do not wait on each other
+const int rowLockCount = 64;
+
+// counts stop short of NoData, however many observers there are
+const int maximumCount = CumulativeViewshedRaster::NoData - 1;
+
+// a branch free loop over plain arrays, which the compiler vectorizes
+void accumulateRow(quint16* counts, const quint8* visibility, int length)
+{
+  for (int i = 0; i < length; ++i)
+  {
+    const int count = counts[i] + (visibility[i] == ViewshedRaster::Visible);
+    counts[i] = static_cast<quint16>(count < maximumCount ? count : maximumCount);
+  }
+}
+}
+
+/*!
+  \class Dsa::CumulativeViewshedRaster
+  \inmodule Dsa
+  \brief The number of observers that can see each cell of the terrain.
+
+  The result of a \l CumulativeViewshed computation. \l mask turns the counts
+  into the cells seen by at least a given number of observers.
+ */
+
+/*!
+  \brief Returns whether the raster has no cells.
+ */
+bool CumulativeViewshedRaster::isEmpty() const
+{
+  return width <= 0 || height <= 0 || counts.size() != width * height;
+}
+
+/*!
+  \brief Returns the number of observers that can see \a x, \a y in WGS84 degrees.
+
+  Returns \c -1 outside the raster or where there is no elevation.
+ */
+int CumulativeViewshedRaster::count(double x, double y) const
+{
+  if (isEmpty())
+    return -1;
+
+  const long column = std::lround((x - originX) / spacingX);
+  const long row = std::lround((originY - y) / spacingY);
+  if (column < 0 || row < 0 || column >= width || row >= height)
+    return -1;
+
+  const quint16 value = counts.at(static_cast<int>(row * width + column));
+  return value == NoData ? -1 : value;
+}
+
+/*!
+  \brief Returns a mask that is \c ViewshedRaster::Visible where at least
+  \a threshold observers see a cell and \c ViewshedRaster::NotVisible
+  elsewhere.
+
+  Cells without elevation are \c ViewshedRaster::NotAnalyzed.
+ */
+QVector<quint8> CumulativeViewshedRaster::mask(int threshold) const
+{
+  QVector<quint8> result(counts.size());
+  const quint16* source = counts.constData();
+  quint8* target = result.data();
+
+  for (int i = 0; i < counts.size(); ++i)
+  {
+    if (source[i] == NoData)
+      target[i] = ViewshedRaster::NotAnalyzed;
+    else
+      target[i] = source[i] >= threshold ? ViewshedRaster::Visible : ViewshedRaster::NotVisible;
+  }
+
+  return result;
+}
+
+/*!
+  \brief Writes the counts to the GeoTIFF at \a filePath.
+
+  Returns \c false, with the reason in \a errorString if set, if the file
+  could not be written.
+ */
+bool CumulativeViewshedRaster::writeCountGeoTiff(const QString& filePath, QString* errorString) const
+{
+  if (isEmpty())
+  {
+    if (errorString)
+      *errorString = QObject::tr("The cumulative viewshed is empty");
+
+    return false;
+  }
+
+  return GeoTiffWriter::write(filePath, counts.constData(), width, height, GeoTiffWriter::SampleType::UInt16,
+                              originX, originY, spacingX, spacingY, NoData, errorString);
+}
+
+/*!
+  \brief Writes the \l mask for \a threshold to the GeoTIFF at \a filePath.
+
+  Returns \c false, with the reason in \a errorString if set, if the file
+  could not be written.
+ */
+bool CumulativeViewshedRaster::writeMaskGeoTiff(const QString& filePath, int threshold, QString* errorString) const
+{
+  if (isEmpty())
+  {
+    if (errorString)
+      *errorString = QObject::tr("The cumulative viewshed is empty");
+
+    return false;
+  }
+
+  const QVector<quint8> values = mask(threshold);
+  return GeoTiffWriter::write(filePath, values.constData(), width, height, GeoTiffWriter::SampleType::UInt8,
+                              originX, originY, spacingX, spacingY, ViewshedRaster::NotAnalyzed, errorString);
+}
+
+/*!
+  \class Dsa::CumulativeViewshed
+  \inmodule Dsa
+  \brief Counts how many of a set of observers can see each cell of the terrain.
+
+  Planners use this to find the ground that most of the observation posts
+  cover, or that the fewest known threats can see. Every observer is run
+  through the \l ViewshedEngine against one elevation grid, so each DEM tile
+  is read once however many observers there are.
+
+  Observers are handed to the threads of the global \c QThreadPool one at a
+  time as threads become free, so observers with short and long ranges
+  balance out. Each observer is traced by one thread, so with fewer
+  observers than threads some threads stay idle. Each finished viewshed is
+  added into the counts a row at a time. Counts stop at 65534, one short of
+  \l CumulativeViewshedRaster::NoData.
+
+  \sa ViewshedEngine
+ */
+
+/*!
+  \brief Sets \a west, \a south, \a east and \a north to the extent, in
+  WGS84 degrees, that covers the viewsheds of every one of \a observers.
+
+  The grid for \l compute can be read for this extent from the
+  \l ElevationSampler.
+
+  \sa ViewshedEngine::extent
+ */
+void CumulativeViewshed::extent(const QList<ViewshedParameters>& observers, double& west, double& south, double& east, double& north)
+{
+  west = 180.0;
+  south = 90.0;
+  east = -180.0;
+  north = -90.0;
+  for (const ViewshedParameters& observer : observers)
+  {
+    double observerWest = 0.0;
+    double observerSouth = 0.0;
+    double observerEast = 0.0;
+    double observerNorth = 0.0;
+    ViewshedEngine::extent(observer, observerWest, observerSouth, observerEast, observerNorth);
+
+    west = qMin(west, observerWest);
+    south = qMin(south, observerSouth);
+    east = qMax(east, observerEast);
+    north = qMax(north, observerNorth);
+  }
+}
+
+/*!
+  \brief Returns the cumulative viewshed of \a observers over the elevation
+  posts in \a grid.
+
+  The result covers the whole grid. Only \a grid is read, so this may be
+  called from any thread.
+ */
+CumulativeViewshedRaster CumulativeViewshed::compute(const ElevationGrid& grid, const QList<ViewshedParameters>& observers)
+{
+  CumulativeViewshedRaster result;
+  if (grid.isEmpty())
+    return result;
+
+  result.width = grid.width;
+  result.height = grid.height;
+  result.originX = grid.originX;
+  result.originY = grid.originY;
+  result.spacingX = grid.spacingX;
+  result.spacingY = grid.spacingY;
+  result.observerCount = observers.size();
+  result.counts.fill(0, grid.width * grid.height);
+
+  quint16* counts = result.counts.data();
+  std::unique_ptr<QMutex[]> rowLocks(new QMutex[rowLockCount]);
+
+  parallelFor(0, observers.size(), [&](int index)
+  {
+    const ViewshedRaster viewshed = ViewshedEngine::compute(grid, observers.at(index));
+    if (viewshed.isEmpty())
+      return;
+
+    // the viewshed is lined up with the posts of the grid
+    const int firstColumn = static_cast<int>(std::lround((viewshed.originX - grid.originX) / grid.spacingX));
+    const int firstRow = static_cast<int>(std::lround((grid.originY - viewshed.originY) / grid.spacingY));
+
+    for (int row = 0; row < viewshed.height; ++row)
+    {
+      const int gridRow = firstRow + row;
+      QMutexLocker locker(&rowLocks[gridRow % rowLockCount]);
+      accumulateRow(counts + gridRow * grid.width + firstColumn, viewshed.values.constData() + row * viewshed.width, viewshed.width);
+    }
+  });
+
+  const float* values = grid.values.constData();
+  for (int i = 0; i < result.counts.size(); ++i)
+  {
+    if (std::isnan(values[i]))
+      counts[i] = CumulativeViewshedRaster::NoData;
+  }
+
+  return result;
+}
+
+} // Dsa
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef CUMULATIVEVIEWSHED_H
+#define CUMULATIVEVIEWSHED_H
+
+// example app headers
+#include "ViewshedEngine.h"
+
+// Qt headers
+#include <QList>
+#include <QString>
+#include <QVector>
+
+namespace Dsa {
+
+struct ElevationGrid;
+
+struct CumulativeViewshedRaster
+{
+  static constexpr quint16 NoData = 0xFFFF;
+
+  bool isEmpty() const;
+  int count(double x, double y) const;
+  QVector<quint8> mask(int threshold) const;
+
+  bool writeCountGeoTiff(const QString& filePath, QString* errorString = nullptr) const;
+  bool writeMaskGeoTiff(const QString& filePath, int threshold, QString* errorString = nullptr) const;
+
+  int width = 0;
+  int height = 0;
+
+  // the centre of the north-west cell and the cell spacing in WGS84 degrees
+  double originX = 0.0;
+  double originY = 0.0;
+  double spacingX = 0.0;
+  double spacingY = 0.0;
+
+  // the number of observers that see each cell; NoData where there is no elevation
+  QVector<quint16> counts;
+  int observerCount = 0;
+};
+
+class CumulativeViewshed
+{
+public:
+  static void extent(const QList<ViewshedParameters>& observers, double& west, double& south, double& east, double& north);
+  static CumulativeViewshedRaster compute(const ElevationGrid& grid, const QList<ViewshedParameters>& observers);
+
+private:
+  CumulativeViewshed() = delete;
+};
+
+} // Dsa
+
+#endif // CUMULATIVEVIEWSHED_H
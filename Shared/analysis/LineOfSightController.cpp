@@ -21,8 +21,10 @@
 #include "LineOfSightController.h"
 
 // example app headers
+#include "ElevationSampler.h"
 #include "FeatureQueryResultManager.h"
 #include "LocationController.h"
+#include "LocationDispatcher.h"
 #include "LocationDisplay3d.h"
 
 // toolkit headers
@@ -35,16 +37,47 @@
 #include "GeoElementLineOfSight.h"
 #include "GeoView.h"
 #include "GeometryEngine.h"
+#include "Graphic.h"
+#include "GraphicsOverlay.h"
 #include "LayerListModel.h"
+#include "Part.h"
+#include "PartCollection.h"
+#include "PolylineBuilder.h"
 #include "SceneView.h"
+#include "SimpleLineSymbol.h"
 
 // Qt headers
+#include <QFutureWatcher>
 #include <QStringListModel>
+#include <QtConcurrent/QtConcurrentRun>
 
 using namespace Esri::ArcGISRuntime;
 
 namespace Dsa {
 
+// eye height in meters added at both ends of the rays evaluated on the CPU
+constexpr double c_rayOffsetZ = 2.0;
+
+constexpr double c_batchUpdateRate = 1.0; // evaluations of the rays per second
+constexpr double c_batchUpdateDistance = 5.0; // meters moved before the rays are evaluated again
+
+// the distance in meters the current position can move before the elevation grid is read again
+constexpr double c_gridMargin = 2000.0;
+
+// the most features drawn as a GeoElementLineOfSight each, when there is no local elevation for them
+constexpr int c_maxSceneFeatures = 16;
+
+namespace
+{
+// what an evaluation of the rays on a worker thread hands back
+struct BatchResult
+{
+  ElevationGrid grid;
+  QVector<LineOfSightProfile> profiles;
+  QVector<quint8> visibility;
+};
+}
+
 /*!
   \class Dsa::LineOfSightController
   \inmodule Dsa
@@ -57,6 +90,16 @@ namespace Dsa {
     \li From the objects in a feature layer to the current position.
     \li From the current position to a supplied GeoElement.
   \endlist
+
+  When local elevation rasters cover the features of a layer, they are
+  evaluated together by the \l LineOfSightEngine on a worker thread, so
+  layers with thousands of points can be used. As the current position
+  moves, each ray keeps the terrain profile it was last traced over and is
+  only traced again once it has moved further than the spacing of the
+  elevation posts. The lines of sight that are clear are then drawn as a
+  single graphic, and those that are not as another unless \l visibleOnly
+  is \c true. Otherwise each feature becomes a \c GeoElementLineOfSight in
+  the scene, and layers are limited to a few features.
  */
 
 /*!
@@ -97,8 +140,18 @@ void LineOfSightController::setVisibleByCount(int visibleByCount)
 LineOfSightController::LineOfSightController(QObject* parent):
   Toolkit::AbstractTool(parent),
   m_overlayNames(new QStringListModel(this)),
-  m_lineOfSightOverlay(new AnalysisOverlay(this))
+  m_lineOfSightOverlay(new AnalysisOverlay(this)),
+  m_linesOverlay(new GraphicsOverlay(this))
 {
+  // the lines of sight evaluated from local elevation run between the eyes at both ends
+  m_linesOverlay->setSceneProperties(LayerSceneProperties(SurfacePlacement::Relative));
+  m_visibleLinesGraphic = new Graphic(this);
+  m_visibleLinesGraphic->setSymbol(new SimpleLineSymbol(SimpleLineSymbolStyle::Solid, Qt::green, 2.0f, this));
+  m_obstructedLinesGraphic = new Graphic(this);
+  m_obstructedLinesGraphic->setSymbol(new SimpleLineSymbol(SimpleLineSymbolStyle::Solid, Qt::red, 2.0f, this));
+  m_linesOverlay->graphics()->append(m_visibleLinesGraphic);
+  m_linesOverlay->graphics()->append(m_obstructedLinesGraphic);
+
   // connect to ToolResourceProvider signals
   auto resourecProvider = Toolkit::ToolResourceProvider::instance();
   connect(resourecProvider, &Toolkit::ToolResourceProvider::geoViewChanged, this, [this]()
@@ -120,6 +173,7 @@ LineOfSightController::LineOfSightController(QObject* parent):
   {
     m_geoView = sceneView;
     sceneView->analysisOverlays()->append(m_lineOfSightOverlay);
+    sceneView->graphicsOverlays()->append(m_linesOverlay);
   }
 }
 
@@ -129,6 +183,7 @@ LineOfSightController::LineOfSightController(QObject* parent):
 LineOfSightController::~LineOfSightController()
 {
   cancelTask();
+  stopBatchAnalysis();
 }
 
 /*!
@@ -170,6 +225,7 @@ void LineOfSightController::onGeoViewChanged(GeoView* geoView)
     return;
 
   sceneView->analysisOverlays()->append(m_lineOfSightOverlay);
+  sceneView->graphicsOverlays()->append(m_linesOverlay);
 }
 
 /*!
@@ -271,6 +327,8 @@ void LineOfSightController::onQueryFeaturesCompleted(QUuid taskId, FeatureQueryR
     disconnect(conn);
 
   m_visibleByConnections.clear();
+  m_visibleLinesOfSight.clear();
+  stopBatchAnalysis();
   setVisibleByCount(0);
 
   // clear the QObject used as a parent for Line of Sight results
@@ -281,13 +339,22 @@ void LineOfSightController::onQueryFeaturesCompleted(QUuid taskId, FeatureQueryR
   }
   m_lineOfSightParent = new QObject(this);
 
-  // create a local QObject to as as the parent for returned features
-  // These are only required within the scope of this method
-  QObject localParent;
+  // the features are evaluated from local elevation when it covers all of them
+  QList<Feature*> features = resultsMgr.m_results->iterator().features(m_lineOfSightParent);
+  if (startBatchAnalysis(features))
+    return;
+
+  if (features.size() > c_maxSceneFeatures)
+  {
+    emit toolErrorOccurred(QString("There are too many points in this layer (%1) for the local elevation data.")
+                           .arg(QString::number(features.size())),
+                           QString("Without local elevation covering every point, Line of Sight analysis is limited to %1 features. "
+                                   "Add local elevation data for the whole layer to analyze it.").arg(QString::number(c_maxSceneFeatures)));
+    return;
+  }
 
   // For each feature, obtain a point location and use it as the observer for a new
   // GeoElementLineOfSight which will be added to the overlay.
-  QList<Feature*> features = resultsMgr.m_results->iterator().features(&localParent);
   auto it = features.constBegin();
   auto itEnd = features.constEnd();
   for (; it != itEnd; ++it)
@@ -301,30 +368,20 @@ void LineOfSightController::onQueryFeaturesCompleted(QUuid taskId, FeatureQueryR
     lineOfSight->setVisible(m_analysisVisible);
     m_lineOfSightOverlay->analyses()->append(lineOfSight);
 
-    m_visibleByConnections.append(connect(lineOfSight, &GeoElementLineOfSight::targetVisibilityChanged, this, [this]()
+    // the count follows each analysis as it changes, rather than scanning them all
+    m_visibleLinesOfSight.insert(lineOfSight, false);
+    m_visibleByConnections.append(connect(lineOfSight, &GeoElementLineOfSight::targetVisibilityChanged, this, [this, lineOfSight]()
     {
-      int visibleCount = 0;
-      AnalysisListModel* losList = m_lineOfSightOverlay->analyses();
-      const int count = losList->rowCount();
-      for (int i = 0; i < count; ++i)
-      {
-        Analysis* analysis = losList->at(i);
-        if (!analysis)
-          continue;
+      auto wasVisible = m_visibleLinesOfSight.find(lineOfSight);
+      if (wasVisible == m_visibleLinesOfSight.end())
+        return;
 
-        GeoElementLineOfSight* lineOfSight = qobject_cast<GeoElementLineOfSight*>(analysis);
-        if (!lineOfSight)
-          continue;
-
-        // don't count Line of Sight from the current location
-        if (lineOfSight->observerGeoElement() == m_locationGeoElement)
-          continue;
-
-        if (lineOfSight->targetVisibility() == LineOfSightTargetVisibility::Visible)
-          visibleCount += 1;
-      }
+      const bool visible = lineOfSight->targetVisibility() == LineOfSightTargetVisibility::Visible;
+      if (visible == wasVisible.value())
+        return;
 
-      setVisibleByCount(visibleCount);
+      wasVisible.value() = visible;
+      setVisibleByCount(m_visibleByCount + (visible ? 1 : -1));
     }));
   }
 }
@@ -392,6 +449,7 @@ void LineOfSightController::setAnalysisVisible(bool analysisVisible)
     return;
 
   m_analysisVisible = analysisVisible;
+  m_linesOverlay->setVisible(m_analysisVisible);
 
   AnalysisListModel* model = m_lineOfSightOverlay->analyses();
   if (model == nullptr)
@@ -451,13 +509,15 @@ bool LineOfSightController::selectOverlayIndex(int selectOverlayIndex)
     return false;
   }
 
-  constexpr int maxFeatures = 16; // Due to performance reasons, limit the number of features which can be used in the analysis
+  // Due to performance reasons, limit the number of features which can be used in the analysis, unless
+  // they can be evaluated together from local elevation; whether it covers them is known once they are queried
   const int featuresCount = overlay->featureTable()->numberOfFeatures();
-  if (featuresCount > maxFeatures)
+  if (featuresCount > c_maxSceneFeatures && !ElevationSampler::instance()->hasData())
   {
     emit toolErrorOccurred(QString("There are too many points in this layer (%1).\n Please choose another one with %2 or fewer points.")
-                           .arg(QString::number(featuresCount), QString::number(maxFeatures)),
-                           QStringLiteral("For performance reasons, Line of Sight analysis is limited to a maximum number of features"));
+                           .arg(QString::number(featuresCount), QString::number(c_maxSceneFeatures)),
+                           QStringLiteral("For performance reasons, Line of Sight analysis is limited to a maximum number of features. "
+                                          "Add local elevation data to analyze larger layers."));
     return false;
   }
 
@@ -476,6 +536,8 @@ bool LineOfSightController::selectOverlayIndex(int selectOverlayIndex)
  */
 void LineOfSightController::clearAnalysis()
 {
+  stopBatchAnalysis();
+
   // remove all of the results from the overlay
   m_lineOfSightOverlay->analyses()->clear();
 
@@ -483,6 +545,7 @@ void LineOfSightController::clearAnalysis()
     disconnect(conn);
 
   m_visibleByConnections.clear();
+  m_visibleLinesOfSight.clear();
   setVisibleByCount(0);
 
   // delete the QObject used as the parent for the analysis
@@ -493,9 +556,270 @@ void LineOfSightController::clearAnalysis()
   }
 }
 
+/*!
+  \property LineOfSightController::visibleOnly
+  \brief Returns whether only the lines of sight which are clear are drawn.
+
+  This applies when the features are evaluated from local elevation. The
+  default is \c true.
+ */
+bool LineOfSightController::isVisibleOnly() const
+{
+  return m_visibleOnly;
+}
+
+/*!
+  \brief Sets whether only the lines of sight which are clear are drawn to \a visibleOnly.
+ */
+void LineOfSightController::setVisibleOnly(bool visibleOnly)
+{
+  if (m_visibleOnly == visibleOnly)
+    return;
+
+  m_visibleOnly = visibleOnly;
+  updateDrawnLinesOfSight();
+
+  emit visibleOnlyChanged();
+}
+
+/*!
+  \internal
+
+  Evaluates the lines of sight from each of \a features to the current
+  position with the \l LineOfSightEngine, now and as the position changes.
+
+  Returns \c false, leaving nothing to evaluate, if there is no local
+  elevation at any of \a features.
+ */
+bool LineOfSightController::startBatchAnalysis(const QList<Feature*>& features)
+{
+  stopBatchAnalysis();
+
+  ElevationSampler* sampler = ElevationSampler::instance();
+  if (!sampler->hasData())
+    return false;
+
+  for (Feature* feature : features)
+  {
+    if (!feature)
+      continue;
+
+    Point location = geometry_cast<Point>(feature->geometry());
+    if (location.isEmpty())
+      continue;
+
+    if (location.spatialReference() != SpatialReference::wgs84())
+      location = geometry_cast<Point>(GeometryEngine::project(location, SpatialReference::wgs84()));
+
+    if (!sampler->contains(location.x(), location.y()))
+    {
+      m_rays.clear();
+      return false;
+    }
+
+    LineOfSightRay ray;
+    ray.observerX = location.x();
+    ray.observerY = location.y();
+    ray.observerZ = location.hasZ() ? location.z() : NAN;
+    ray.observerOffsetZ = c_rayOffsetZ;
+    ray.targetOffsetZ = c_rayOffsetZ;
+
+    m_rays.append(ray);
+  }
+
+  m_targetVisibility.fill(LineOfSightEngine::Unknown, m_rays.size());
+  m_profiles.clear();
+  m_grid = ElevationGrid();
+
+  m_locationSubscription = LocationDispatcher::instance()->subscribe(this, c_batchUpdateRate, c_batchUpdateDistance, [this](const Point& location)
+  {
+    updateBatchVisibility(location);
+  });
+
+  const Point location = LocationDispatcher::instance()->location();
+  if (!location.isEmpty())
+    updateBatchVisibility(location);
+
+  return true;
+}
+
+/*!
+  \internal
+ */
+void LineOfSightController::stopBatchAnalysis()
+{
+  if (m_locationSubscription != -1)
+  {
+    LocationDispatcher::instance()->unsubscribe(m_locationSubscription);
+    m_locationSubscription = -1;
+  }
+
+  // an evaluation still running is dropped when it finishes
+  ++m_batchGeneration;
+  m_batchBusy = false;
+  m_pendingLocation = Point();
+
+  m_rays.clear();
+  m_targetVisibility.clear();
+  m_profiles.clear();
+  m_grid = ElevationGrid();
+  updateDrawnLinesOfSight();
+}
+
+/*!
+  \internal
+
+  Evaluates every line of sight to the current \a location on a worker
+  thread. While an evaluation is running only the latest location is kept,
+  and it is evaluated once the running one is done.
+ */
+void LineOfSightController::updateBatchVisibility(const Point& location)
+{
+  if (m_rays.isEmpty() || location.isEmpty())
+    return;
+
+  if (m_batchBusy)
+  {
+    m_pendingLocation = location;
+    return;
+  }
+
+  m_pendingLocation = Point();
+
+  const Point target = location.spatialReference() == SpatialReference::wgs84()
+      ? location : geometry_cast<Point>(GeometryEngine::project(location, SpatialReference::wgs84()));
+
+  for (LineOfSightRay& ray : m_rays)
+  {
+    ray.targetX = target.x();
+    ray.targetY = target.y();
+    ray.targetZ = target.hasZ() ? target.z() : NAN;
+  }
+
+  // the grid and the profiles go to the worker and come back with the result
+  const QVector<LineOfSightRay> rays = m_rays;
+  ElevationGrid grid = m_grid;
+  QVector<LineOfSightProfile> profiles = m_profiles;
+  m_grid = ElevationGrid();
+  m_profiles.clear();
+
+  m_batchBusy = true;
+  const int generation = m_batchGeneration;
+
+  // the watcher is a child of this tool, so the result is dropped if the tool goes first
+  auto watcher = new QFutureWatcher<BatchResult>(this);
+  connect(watcher, &QFutureWatcher<BatchResult>::finished, this, [this, watcher, generation]()
+  {
+    const BatchResult result = watcher->result();
+    watcher->deleteLater();
+
+    if (generation != m_batchGeneration)
+      return;
+
+    m_batchBusy = false;
+    m_grid = result.grid;
+    m_profiles = result.profiles;
+    setBatchVisibility(result.visibility);
+
+    if (!m_pendingLocation.isEmpty())
+      updateBatchVisibility(m_pendingLocation);
+  });
+
+  watcher->setFuture(QtConcurrent::run([rays, grid, profiles]() mutable
+  {
+    BatchResult result;
+
+    // the grid is kept, with room for the position to move, until a ray leaves it
+    const LineOfSightRay& first = rays.first();
+    if (!grid.contains(first.targetX, first.targetY))
+    {
+      double west = 0.0;
+      double south = 0.0;
+      double east = 0.0;
+      double north = 0.0;
+      LineOfSightEngine::extent(rays, west, south, east, north);
+
+      const double marginX = c_gridMargin / ElevationGrid::metersPerDegreeX(first.targetY);
+      const double marginY = c_gridMargin / ElevationGrid::metersPerDegreeY(first.targetY);
+      grid = ElevationSampler::instance()->grid(west - marginX, south - marginY, east + marginX, north + marginY);
+      profiles.clear();
+    }
+
+    result.visibility = LineOfSightEngine::update(grid, rays, profiles);
+    result.grid = grid;
+    result.profiles = profiles;
+    return result;
+  }));
+}
+
+/*!
+  \internal
+
+  Takes the \a visibility of every target from an evaluation, counts those
+  that are visible and redraws the lines of sight.
+ */
+void LineOfSightController::setBatchVisibility(const QVector<quint8>& visibility)
+{
+  // only the targets whose visibility changed are counted
+  int visibleCount = m_visibleByCount;
+  for (int i = 0; i < visibility.size() && i < m_targetVisibility.size(); ++i)
+  {
+    const quint8 previous = m_targetVisibility.at(i);
+    if (visibility.at(i) == previous)
+      continue;
+
+    if (previous == LineOfSightEngine::Visible)
+      --visibleCount;
+    else if (visibility.at(i) == LineOfSightEngine::Visible)
+      ++visibleCount;
+
+    m_targetVisibility[i] = visibility.at(i);
+  }
+
+  setVisibleByCount(visibleCount);
+  updateDrawnLinesOfSight();
+}
+
+/*!
+  \internal
+
+  Sets the graphics of the lines of sight that are clear, and of those that
+  are not unless only the clear ones are shown, to a line from each target
+  to the current position.
+ */
+void LineOfSightController::updateDrawnLinesOfSight()
+{
+  QObject localParent;
+  PolylineBuilder visibleLines(SpatialReference::wgs84(), &localParent);
+  PolylineBuilder obstructedLines(SpatialReference::wgs84(), &localParent);
+
+  for (int i = 0; i < m_rays.size() && i < m_targetVisibility.size(); ++i)
+  {
+    const quint8 visibility = m_targetVisibility.at(i);
+    if (visibility == LineOfSightEngine::Unknown || (m_visibleOnly && visibility != LineOfSightEngine::Visible))
+      continue;
+
+    const LineOfSightRay& ray = m_rays.at(i);
+    Part* part = new Part(SpatialReference::wgs84(), &localParent);
+    part->addPoint(ray.observerX, ray.observerY, ray.observerOffsetZ);
+    part->addPoint(ray.targetX, ray.targetY, ray.targetOffsetZ);
+
+    PolylineBuilder& lines = visibility == LineOfSightEngine::Visible ? visibleLines : obstructedLines;
+    lines.parts()->addPart(part);
+  }
+
+  m_visibleLinesGraphic->setGeometry(visibleLines.toGeometry());
+  m_obstructedLinesGraphic->setGeometry(obstructedLines.toGeometry());
+}
+
 } // Dsa
 
 // Signal Documentation
+/*!
+  \fn void LineOfSightController::visibleOnlyChanged();
+  \brief Signal emitted when the visibleOnly property changes.
+ */
+
 /*!
   \fn void AnalysisListController::visibleByCountChanged();
   \brief Signal emitted when the visibleByCount property changes.
@@ -17,6 +17,10 @@
 #ifndef LINEOFSIGHTCONTROLLER_H
 #define LINEOFSIGHTCONTROLLER_H
 
+// example app headers
+#include "ElevationGrid.h"
+#include "LineOfSightEngine.h"
+
 // toolkit headers
 #include "AbstractTool.h"
 
@@ -26,12 +30,18 @@
 
 // Qt headers
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QVector>
 
 namespace Esri {
 namespace ArcGISRuntime {
   class AnalysisOverlay;
+  class Feature;
   class GeoElement;
+  class GeoElementLineOfSight;
   class GeoView;
+  class Graphic;
+  class GraphicsOverlay;
   class LayerListModel;
   class FeatureLayer;
   class FeatureQueryResult;
@@ -49,6 +59,7 @@ class LineOfSightController : public Esri::ArcGISRuntime::Toolkit::AbstractTool
   Q_PROPERTY(QAbstractItemModel* overlayNames READ overlayNames NOTIFY overlayNamesChanged)
   Q_PROPERTY(bool analysisVisible READ isAnalysisVisible WRITE setAnalysisVisible NOTIFY analysisVisibleChanged)
   Q_PROPERTY(int visibleByCount READ visibleByCount NOTIFY visibleByCountChanged)
+  Q_PROPERTY(bool visibleOnly READ isVisibleOnly WRITE setVisibleOnly NOTIFY visibleOnlyChanged)
 
 public:
 
@@ -72,11 +83,15 @@ public:
 
   int visibleByCount() const;
 
+  bool isVisibleOnly() const;
+  void setVisibleOnly(bool visibleOnly);
+
 signals:
   void toolErrorOccurred(const QString& errorMessage, const QString& additionalMessage);
   void overlayNamesChanged();
   void analysisVisibleChanged();
   void visibleByCountChanged();
+  void visibleOnlyChanged();
 
 public slots:
   void onGeoViewChanged(Esri::ArcGISRuntime::GeoView* geoView);
@@ -89,11 +104,17 @@ private:
   void cancelTask();
   void getLocationGeoElement();
   void setVisibleByCount(int visibleByCount);
+  bool startBatchAnalysis(const QList<Esri::ArcGISRuntime::Feature*>& features);
+  void stopBatchAnalysis();
+  void updateBatchVisibility(const Esri::ArcGISRuntime::Point& location);
+  void setBatchVisibility(const QVector<quint8>& visibility);
+  void updateDrawnLinesOfSight();
 
   QStringListModel* m_overlayNames;
   Esri::ArcGISRuntime::GeoView* m_geoView = nullptr;
   QList<Esri::ArcGISRuntime::FeatureLayer*> m_overlays;
   Esri::ArcGISRuntime::AnalysisOverlay* m_lineOfSightOverlay = nullptr;
+  Esri::ArcGISRuntime::GraphicsOverlay* m_linesOverlay = nullptr;
   QObject* m_lineOfSightParent = nullptr;
   Esri::ArcGISRuntime::TaskWatcher m_featuresTask;
   Esri::ArcGISRuntime::GeoElement* m_locationGeoElement = nullptr;
@@ -101,6 +122,20 @@ private:
   bool m_analysisVisible = true;
   int m_visibleByCount = 0;
   QList<QMetaObject::Connection> m_visibleByConnections;
+  QHash<Esri::ArcGISRuntime::GeoElementLineOfSight*, bool> m_visibleLinesOfSight;
+
+  // targets evaluated by the LineOfSightEngine, when there is local elevation
+  bool m_visibleOnly = true;
+  int m_locationSubscription = -1;
+  QVector<LineOfSightRay> m_rays;
+  QVector<quint8> m_targetVisibility;
+  QVector<LineOfSightProfile> m_profiles;
+  ElevationGrid m_grid;
+  bool m_batchBusy = false;
+  int m_batchGeneration = 0;
+  Esri::ArcGISRuntime::Point m_pendingLocation;
+  Esri::ArcGISRuntime::Graphic* m_visibleLinesGraphic = nullptr;
+  Esri::ArcGISRuntime::Graphic* m_obstructedLinesGraphic = nullptr;
 };
 
 } // Dsa
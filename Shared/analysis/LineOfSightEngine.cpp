@@ -0,0 +1,334 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+// PCH header
+#include "pch.hpp"
+
+#include "LineOfSightEngine.h"
+
+// example app headers
+#include "ElevationGrid.h"
+#include "ElevationSampler.h"
+#include "ParallelFor.h"
+#include "ViewshedEngine.h"
+
+// STL headers
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace Dsa {
+
+namespace
+{
+const double earthRadius = 6371008.8;
+
+// rays are handed to the threads in runs of this many neighbouring rays
+const int raysPerRun = 64;
+
+// interleaves the bits of column and row so that nearby cells get nearby codes
+quint32 mortonCode(int column, int row)
+{
+  auto spread = [](quint32 value)
+  {
+    value &= 0xFFFF;
+    value = (value | (value << 8)) & 0x00FF00FF;
+    value = (value | (value << 4)) & 0x0F0F0F0F;
+    value = (value | (value << 2)) & 0x33333333;
+    value = (value | (value << 1)) & 0x55555555;
+    return value;
+  };
+
+  return spread(static_cast<quint32>(qBound(0, column, 0xFFFF))) | (spread(static_cast<quint32>(qBound(0, row, 0xFFFF))) << 1);
+}
+}
+
+/*!
+  \class Dsa::LineOfSightEngine
+  \inmodule Dsa
+  \brief Finds whether many observer to target rays are clear of the terrain
+  on the CPU, using the local elevation rasters.
+
+  Each \c GeoElementLineOfSight in the scene is evaluated by the GPU and
+  re-evaluated whenever its ends move, which limits a scene to a handful of
+  them. This engine checks thousands of rays at once: the terrain is sampled
+  once per post along each ray, allowing for the curvature of the earth and
+  for refraction, and the ray is given up on at the first sample that rises
+  above it.
+
+  Rays are sorted along a Z-order curve through their midpoints so that rays
+  traced together read the same part of the elevation grid, then traced in
+  parallel in runs of neighbours.
+
+  \sa ViewshedEngine, LineOfSightController
+ */
+
+/*!
+  \brief Returns the visibility of each of \a rays, using elevations from the
+  rasters added to the \l ElevationSampler.
+
+  Every ray is \c Unknown if no raster covers them. This must be called from
+  the GUI thread.
+ */
+QVector<quint8> LineOfSightEngine::compute(const QVector<LineOfSightRay>& rays)
+{
+  ElevationSampler* sampler = ElevationSampler::instance();
+  if (!sampler->hasData() || rays.isEmpty())
+    return QVector<quint8>(rays.size(), Unknown);
+
+  double west = 0.0;
+  double south = 0.0;
+  double east = 0.0;
+  double north = 0.0;
+  extent(rays, west, south, east, north);
+
+  return compute(sampler->grid(west, south, east, north), rays);
+}
+
+/*!
+  \brief Returns the visibility of each of \a rays over the elevation posts in \a grid.
+
+  Rays with an end outside the grid, or over a void, are \c Unknown. Only
+  \a grid is read, so this may be called from any thread.
+ */
+QVector<quint8> LineOfSightEngine::compute(const ElevationGrid& grid, const QVector<LineOfSightRay>& rays)
+{
+  QVector<quint8> results(rays.size(), Unknown);
+  if (grid.isEmpty() || rays.isEmpty())
+    return results;
+
+  const QVector<int> order = localityOrder(grid, rays);
+  quint8* visibility = results.data();
+  const int runs = (rays.size() + raysPerRun - 1) / raysPerRun;
+  parallelFor(0, runs, [&](int run)
+  {
+    const int last = qMin(rays.size(), (run + 1) * raysPerRun);
+    for (int i = run * raysPerRun; i < last; ++i)
+      visibility[order.at(i)] = trace(grid, rays.at(order.at(i)));
+  });
+
+  return results;
+}
+
+/*!
+  \brief Returns the visibility of \a ray over the elevation posts in \a grid.
+
+  An end below the ground is raised up to it.
+ */
+LineOfSightEngine::Visibility LineOfSightEngine::trace(const ElevationGrid& grid, const LineOfSightRay& ray)
+{
+  const double observerGround = grid.elevation(ray.observerX, ray.observerY);
+  const double targetGround = grid.elevation(ray.targetX, ray.targetY);
+  if (std::isnan(observerGround) || std::isnan(targetGround))
+    return Unknown;
+
+  const double observerZ = (std::isnan(ray.observerZ) ? observerGround : qMax(ray.observerZ, observerGround)) + ray.observerOffsetZ;
+  const double targetZ = (std::isnan(ray.targetZ) ? targetGround : qMax(ray.targetZ, targetGround)) + ray.targetOffsetZ;
+
+  // the ray is treated as straight in degrees and measured at its middle latitude
+  const double midY = (ray.observerY + ray.targetY) * 0.5;
+  const double metersX = ElevationGrid::metersPerDegreeX(midY);
+  const double metersY = ElevationGrid::metersPerDegreeY(midY);
+  const double length = std::hypot((ray.targetX - ray.observerX) * metersX, (ray.targetY - ray.observerY) * metersY);
+  const double step = qMin(grid.spacingX * metersX, grid.spacingY * metersY);
+  const int steps = static_cast<int>(std::ceil(length / step));
+
+  // the earth bulges up between the ends by d(D - d) / 2R
+  const double curvature = (1.0 - ViewshedEngine::RefractionCoefficient) / (2.0 * earthRadius);
+
+  for (int i = 1; i < steps; ++i)
+  {
+    const double t = static_cast<double>(i) / steps;
+    const double terrainZ = grid.elevation(ray.observerX + (ray.targetX - ray.observerX) * t,
+                                           ray.observerY + (ray.targetY - ray.observerY) * t);
+    if (std::isnan(terrainZ))
+      continue;
+
+    const double distance = length * t;
+    const double rayZ = observerZ + (targetZ - observerZ) * t;
+    if (terrainZ + distance * (length - distance) * curvature > rayZ)
+      return Obstructed;
+  }
+
+  return Visible;
+}
+
+/*!
+  \brief Returns the visibility of each of \a rays over the elevation posts in
+  \a grid, reusing the \a profiles from the last update where the rays have
+  barely moved.
+
+  \a profiles holds one profile for each ray and is resized to match if it
+  does not. A ray whose ends have each moved less than the spacing of the
+  grid since its profile was made is decided from the profile alone, without
+  sampling the terrain again; other rays are traced afresh and their profiles
+  replaced. Only \a grid is read, so this may be called from any thread.
+ */
+QVector<quint8> LineOfSightEngine::update(const ElevationGrid& grid, const QVector<LineOfSightRay>& rays, QVector<LineOfSightProfile>& profiles)
+{
+  QVector<quint8> results(rays.size(), Unknown);
+  if (profiles.size() != rays.size())
+    profiles = QVector<LineOfSightProfile>(rays.size());
+
+  if (grid.isEmpty() || rays.isEmpty())
+    return results;
+
+  const QVector<int> order = localityOrder(grid, rays);
+  quint8* visibility = results.data();
+  LineOfSightProfile* rayProfiles = profiles.data();
+
+  const int runs = (rays.size() + raysPerRun - 1) / raysPerRun;
+  parallelFor(0, runs, [&](int run)
+  {
+    const int last = qMin(rays.size(), (run + 1) * raysPerRun);
+    for (int i = run * raysPerRun; i < last; ++i)
+    {
+      const int ray = order.at(i);
+      visibility[ray] = update(grid, rays.at(ray), rayProfiles[ray]);
+    }
+  });
+
+  return results;
+}
+
+/*!
+  \brief Returns the visibility of \a ray over the elevation posts in \a grid,
+  reusing \a profile if the ray has barely moved since it was made.
+
+  A line of sight is clear when the slope from the observer to the target is
+  no less than the steepest slope to the terrain in between. That slope, the
+  horizon, is kept in \a profile. While each end of the ray stays within the
+  spacing of the grid of where it was, and the observer's height within a
+  meter, the terrain beneath is taken to be the same and only the slope to
+  the target is worked out. Otherwise the whole ray is sampled and \a profile
+  is replaced.
+ */
+LineOfSightEngine::Visibility LineOfSightEngine::update(const ElevationGrid& grid, const LineOfSightRay& ray, LineOfSightProfile& profile)
+{
+  const double observerGround = grid.elevation(ray.observerX, ray.observerY);
+  const double targetGround = grid.elevation(ray.targetX, ray.targetY);
+  if (std::isnan(observerGround) || std::isnan(targetGround))
+  {
+    profile = LineOfSightProfile();
+    return Unknown;
+  }
+
+  const double observerZ = (std::isnan(ray.observerZ) ? observerGround : qMax(ray.observerZ, observerGround)) + ray.observerOffsetZ;
+  const double targetZ = (std::isnan(ray.targetZ) ? targetGround : qMax(ray.targetZ, targetGround)) + ray.targetOffsetZ;
+
+  const double midY = (ray.observerY + ray.targetY) * 0.5;
+  const double metersX = ElevationGrid::metersPerDegreeX(midY);
+  const double metersY = ElevationGrid::metersPerDegreeY(midY);
+  const double length = std::hypot((ray.targetX - ray.observerX) * metersX, (ray.targetY - ray.observerY) * metersY);
+  const double curvature = (1.0 - ViewshedEngine::RefractionCoefficient) / (2.0 * earthRadius);
+
+  constexpr double maximumHeightChange = 1.0;
+  const bool reusable = !std::isnan(profile.horizonSlope) &&
+      std::abs(ray.observerX - profile.observerX) < grid.spacingX && std::abs(ray.observerY - profile.observerY) < grid.spacingY &&
+      std::abs(ray.targetX - profile.targetX) < grid.spacingX && std::abs(ray.targetY - profile.targetY) < grid.spacingY &&
+      std::abs(observerZ - profile.observerZ) < maximumHeightChange;
+
+  if (!reusable)
+  {
+    // sample the whole ray, as the horizon is wanted even once it is obstructed
+    const double step = qMin(grid.spacingX * metersX, grid.spacingY * metersY);
+    const int steps = static_cast<int>(std::ceil(length / step));
+
+    profile.observerX = ray.observerX;
+    profile.observerY = ray.observerY;
+    profile.observerZ = observerZ;
+    profile.targetX = ray.targetX;
+    profile.targetY = ray.targetY;
+    profile.horizonSlope = -std::numeric_limits<double>::infinity();
+
+    for (int i = 1; i < steps; ++i)
+    {
+      const double t = static_cast<double>(i) / steps;
+      const double terrainZ = grid.elevation(ray.observerX + (ray.targetX - ray.observerX) * t,
+                                             ray.observerY + (ray.targetY - ray.observerY) * t);
+      if (std::isnan(terrainZ))
+        continue;
+
+      const double distance = length * t;
+      profile.horizonSlope = qMax(profile.horizonSlope, (terrainZ - distance * distance * curvature - observerZ) / distance);
+    }
+  }
+
+  if (length <= 0.0)
+    return Visible;
+
+  // the same test as trace(), with the earth's bulge taken out of the terrain and into the target
+  const double targetSlope = (targetZ - length * length * curvature - observerZ) / length;
+  return targetSlope >= profile.horizonSlope ? Visible : Obstructed;
+}
+
+/*!
+  \internal
+
+  Returns the indices of \a rays ordered by where their midpoints fall in
+  \a grid, along a Z-order curve.
+ */
+QVector<int> LineOfSightEngine::localityOrder(const ElevationGrid& grid, const QVector<LineOfSightRay>& rays)
+{
+  QVector<quint32> codes(rays.size());
+  for (int i = 0; i < rays.size(); ++i)
+  {
+    const LineOfSightRay& ray = rays.at(i);
+    if (std::isnan(ray.observerX + ray.observerY + ray.targetX + ray.targetY))
+    {
+      codes[i] = 0;
+      continue;
+    }
+
+    const double midX = (ray.observerX + ray.targetX) * 0.5;
+    const double midY = (ray.observerY + ray.targetY) * 0.5;
+    codes[i] = mortonCode(static_cast<int>((midX - grid.originX) / grid.spacingX), static_cast<int>((grid.originY - midY) / grid.spacingY));
+  }
+
+  QVector<int> order(rays.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&codes](int first, int second)
+  {
+    return codes.at(first) < codes.at(second);
+  });
+
+  return order;
+}
+
+/*!
+  \brief Sets \a west, \a south, \a east and \a north to the WGS84 extent of \a rays.
+ */
+void LineOfSightEngine::extent(const QVector<LineOfSightRay>& rays, double& west, double& south, double& east, double& north)
+{
+  west = 180.0;
+  south = 90.0;
+  east = -180.0;
+  north = -90.0;
+
+  for (const LineOfSightRay& ray : rays)
+  {
+    if (std::isnan(ray.observerX + ray.observerY + ray.targetX + ray.targetY))
+      continue;
+
+    west = qMin(west, qMin(ray.observerX, ray.targetX));
+    east = qMax(east, qMax(ray.observerX, ray.targetX));
+    south = qMin(south, qMin(ray.observerY, ray.targetY));
+    north = qMax(north, qMax(ray.observerY, ray.targetY));
+  }
+}
+
+} // Dsa
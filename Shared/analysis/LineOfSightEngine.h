@@ -0,0 +1,86 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef LINEOFSIGHTENGINE_H
+#define LINEOFSIGHTENGINE_H
+
+// Qt headers
+#include <QVector>
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+struct ElevationGrid;
+
+struct LineOfSightRay
+{
+  // the ends of the ray in WGS84 degrees; a NaN z places an end on the ground
+  double observerX = NAN;
+  double observerY = NAN;
+  double observerZ = NAN;
+  double targetX = NAN;
+  double targetY = NAN;
+  double targetZ = NAN;
+
+  // heights in meters added to each end
+  double observerOffsetZ = 0.0;
+  double targetOffsetZ = 0.0;
+};
+
+struct LineOfSightProfile
+{
+  // the ends of the ray when it was last traced, the observer including its offset
+  double observerX = NAN;
+  double observerY = NAN;
+  double observerZ = NAN;
+  double targetX = NAN;
+  double targetY = NAN;
+
+  // the steepest slope from the observer to the terrain short of the target
+  double horizonSlope = NAN;
+};
+
+class LineOfSightEngine
+{
+public:
+  enum Visibility : quint8
+  {
+    Obstructed = 0,
+    Visible = 1,
+    Unknown = 255
+  };
+
+  static QVector<quint8> compute(const QVector<LineOfSightRay>& rays);
+  static QVector<quint8> compute(const ElevationGrid& grid, const QVector<LineOfSightRay>& rays);
+  static Visibility trace(const ElevationGrid& grid, const LineOfSightRay& ray);
+
+  static QVector<quint8> update(const ElevationGrid& grid, const QVector<LineOfSightRay>& rays, QVector<LineOfSightProfile>& profiles);
+  static Visibility update(const ElevationGrid& grid, const LineOfSightRay& ray, LineOfSightProfile& profile);
+
+  static void extent(const QVector<LineOfSightRay>& rays, double& west, double& south, double& east, double& north);
+
+private:
+  LineOfSightEngine() = delete;
+
+  static QVector<int> localityOrder(const ElevationGrid& grid, const QVector<LineOfSightRay>& rays);
+};
+
+} // Dsa
+
+#endif // LINEOFSIGHTENGINE_H
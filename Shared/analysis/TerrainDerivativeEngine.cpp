@@ -0,0 +1,471 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "TerrainDerivativeEngine.h"
+
+// example app headers
+#include "DemRaster.h"
+#include "ElevationSampler.h"
+#include "GeoTiffWriter.h"
+#include "ParallelFor.h"
+
+// Qt headers
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+// STL headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace Dsa {
+
+namespace
+{
+const double degreesToRadians = M_PI / 180.0;
+const float radiansToDegrees = static_cast<float>(180.0 / M_PI);
+
+// bumped whenever the kernels change, so that older cached rasters are not reused
+const int cacheFormatVersion = 1;
+
+// the value of an aspect over flat ground, which faces no direction
+const float flatAspect = -1.0f;
+}
+
+/*!
+  \class Dsa::TerrainDerivativeEngine
+  \inmodule Dsa
+  \brief Derives slope, aspect, hillshade and roughness rasters from the
+  local elevation rasters on the CPU.
+
+  Each product is a 3 x 3 neighbourhood kernel over the elevation posts:
+  slope and aspect come from Horn's gradients, the hillshade lights those
+  gradients from \l TerrainDerivativeParameters::azimuth and
+  \l TerrainDerivativeParameters::altitude, and roughness is the range of
+  the nine posts.
+
+  The output is cut into the tiles of a \l GeoTiffWriter and made at the
+  full resolution of the source, however large it is. The source is read a
+  band of tile rows at a time, with a halo of one post around the band; the
+  tiles of a band are computed in parallel and written to the file as soon
+  as they are done. A tile with no voids is run through branch-free loops
+  that the compiler can vectorize; voids are otherwise stood in for by the
+  centre post.
+
+  Results are cached on disk under a name derived from the source raster and
+  the parameters, so asking for the same product again opens the raster
+  already made.
+
+  \sa AddLocalDataController, GeoTiffWriter
+ */
+
+/*!
+  \brief Returns the path of a GeoTIFF of the product described by
+  \a parameters, derived from the elevation raster at \a sourcePath.
+
+  The GeoTIFF is made in \a directory unless it is already there. Returns an
+  empty string, with the reason in \a errorString if set, if the source
+  could not be read or the GeoTIFF could not be written. This blocks until
+  the raster is written.
+ */
+QString TerrainDerivativeEngine::create(const QString& sourcePath, const TerrainDerivativeParameters& parameters, const QString& directory,
+                                        QString* errorString)
+{
+  const QString filePath = cachedFilePath(sourcePath, parameters, directory);
+  if (filePath.isEmpty())
+  {
+    if (errorString)
+      *errorString = QObject::tr("Elevation raster not found ") + sourcePath;
+
+    return QString();
+  }
+
+  if (QFileInfo::exists(filePath))
+    return filePath;
+
+  QDir(directory).mkpath(QStringLiteral("."));
+
+  std::unique_ptr<DemRaster> raster(DemRaster::open(sourcePath, errorString));
+  if (!raster)
+    return QString();
+
+  // written under another name first, so that an interrupted raster is never taken from the cache
+  const QString partialPath = filePath + QStringLiteral(".part");
+  if (!compute(*raster, parameters, partialPath, errorString))
+  {
+    QFile::remove(partialPath);
+    return QString();
+  }
+
+  if (!QFile::rename(partialPath, filePath))
+  {
+    QFile::remove(partialPath);
+    if (errorString)
+      *errorString = QObject::tr("Could not write ") + filePath;
+
+    return QString();
+  }
+
+  return filePath;
+}
+
+/*!
+  \brief Returns the path in \a directory at which the product described by
+  \a parameters, derived from the elevation raster at \a sourcePath, is cached.
+
+  The name is made from a hash of the source's path, size and time of last
+  modification and of the parameters that affect the product. Returns an
+  empty string if \a sourcePath does not exist.
+ */
+QString TerrainDerivativeEngine::cachedFilePath(const QString& sourcePath, const TerrainDerivativeParameters& parameters, const QString& directory)
+{
+  const QFileInfo source(sourcePath);
+  if (!source.exists())
+    return QString();
+
+  const bool hillshade = parameters.product == TerrainDerivativeParameters::Hillshade;
+
+  QByteArray key;
+  QDataStream stream(&key, QIODevice::WriteOnly);
+  stream << cacheFormatVersion
+         << source.absoluteFilePath()
+         << source.size()
+         << source.lastModified().toMSecsSinceEpoch()
+         << static_cast<qint32>(parameters.product)
+         << qRound64(parameters.zFactor * 1000.0)
+         << (hillshade ? qRound64(parameters.azimuth * 10.0) : 0)
+         << (hillshade ? qRound64(parameters.altitude * 10.0) : 0);
+
+  const QString hash = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex().left(16));
+
+  return QDir(directory).filePath(source.completeBaseName() + QStringLiteral("_") + productName(parameters.product).toLower() +
+                                  QStringLiteral("_") + hash + QStringLiteral(".tif"));
+}
+
+/*!
+  \brief Writes the product described by \a parameters over \a raster to a
+  Float32 GeoTIFF at \a filePath.
+
+  The GeoTIFF has a pixel for every post of \a raster. Beyond the edges of
+  the raster the ground is taken to be level. Voids and posts with no
+  product are written as NaN. Returns \c false, with the reason in
+  \a errorString if set, if the raster could not be read or the file could
+  not be written. Only the files are used, so this may be called from any
+  thread.
+ */
+bool TerrainDerivativeEngine::compute(DemRaster& raster, const TerrainDerivativeParameters& parameters, const QString& filePath,
+                                      QString* errorString)
+{
+  if (raster.width() < 2 || raster.height() < 2)
+  {
+    if (errorString)
+      *errorString = QObject::tr("The elevation raster is too small");
+
+    return false;
+  }
+
+  GeoTiffWriter writer;
+  if (!writer.open(filePath, raster.width(), raster.height(), GeoTiffWriter::SampleType::Float32,
+                   raster.originX(), raster.originY(), raster.postSpacingX(), raster.postSpacingY()))
+  {
+    if (errorString)
+      *errorString = writer.errorString();
+
+    return false;
+  }
+
+  // as many tile rows a band as keep it to the size of a sampler grid, so
+  // that memory stays bounded and narrow rasters still have tiles to share out
+  constexpr int tileSize = GeoTiffWriter::TileSize;
+  const qint64 bandRowPosts = static_cast<qint64>(raster.width() + 2) * tileSize;
+  const int bandTileRows = static_cast<int>(qBound<qint64>(1, ElevationSampler::DefaultMaximumGridPosts / bandRowPosts, writer.tilesDown()));
+  const int tilesAcross = writer.tilesAcross();
+
+  QHash<int, QVector<QVector<float>>> sourceTiles;
+  ElevationGrid band;
+  for (int firstTileY = 0; firstTileY < writer.tilesDown(); firstTileY += bandTileRows)
+  {
+    const int tileRows = qMin(bandTileRows, writer.tilesDown() - firstTileY);
+    const int firstRow = firstTileY * tileSize;
+    if (!readBand(raster, firstRow, qMin(tileRows * tileSize, raster.height() - firstRow), sourceTiles, band, errorString))
+    {
+      writer.close();
+      return false;
+    }
+
+    parallelFor(0, tilesAcross * tileRows, [&](int index)
+    {
+      const int tileX = index % tilesAcross;
+      const int tileY = index / tilesAcross;
+
+      QVector<float> tile(tileSize * tileSize);
+      computeTile(band, parameters, tileX * tileSize, tileY * tileSize, tile.data());
+      writer.writeTile(tileX, firstTileY + tileY, tile.constData());
+    });
+  }
+
+  if (!writer.close())
+  {
+    if (errorString)
+      *errorString = writer.errorString();
+
+    return false;
+  }
+
+  return true;
+}
+
+/*!
+  \brief Returns the name of \a product, as shown to the user.
+ */
+QString TerrainDerivativeEngine::productName(TerrainDerivativeParameters::Product product)
+{
+  switch (product)
+  {
+  case TerrainDerivativeParameters::Slope:
+    return QStringLiteral("Slope");
+  case TerrainDerivativeParameters::Aspect:
+    return QStringLiteral("Aspect");
+  case TerrainDerivativeParameters::Hillshade:
+    return QStringLiteral("Hillshade");
+  case TerrainDerivativeParameters::Roughness:
+    return QStringLiteral("Roughness");
+  }
+
+  return QString();
+}
+
+/*!
+  \internal
+
+  Sets \a band to the \a rows rows of posts of \a raster from \a firstRow,
+  with a halo of one post on every side. The halo repeats the posts along
+  the edges of the raster. \a sourceTiles holds the rows of tiles already
+  read from \a raster, by their index down the raster; the rows the next
+  band shares are kept and the rest dropped.
+ */
+bool TerrainDerivativeEngine::readBand(DemRaster& raster, int firstRow, int rows, QHash<int, QVector<QVector<float>>>& sourceTiles,
+                                       ElevationGrid& band, QString* errorString)
+{
+  const int width = raster.width();
+  const int tileWidth = raster.tileWidth();
+  const int tileHeight = raster.tileHeight();
+  const int topRow = qMax(0, firstRow - 1);
+  const int bottomRow = qMin(raster.height() - 1, firstRow + rows);
+
+  for (auto it = sourceTiles.begin(); it != sourceTiles.end();)
+    it = it.key() < topRow / tileHeight ? sourceTiles.erase(it) : it + 1;
+
+  for (int tileY = topRow / tileHeight; tileY <= bottomRow / tileHeight; ++tileY)
+  {
+    if (sourceTiles.contains(tileY))
+      continue;
+
+    QVector<QVector<float>> tileRow(raster.tilesAcross());
+    for (int tileX = 0; tileX < raster.tilesAcross(); ++tileX)
+    {
+      if (!raster.readTile(tileX, tileY, tileRow[tileX]))
+      {
+        if (errorString)
+          *errorString = QObject::tr("Could not read ") + raster.filePath();
+
+        return false;
+      }
+    }
+
+    sourceTiles.insert(tileY, tileRow);
+  }
+
+  band.width = width + 2;
+  band.height = rows + 2;
+  band.spacingX = raster.postSpacingX();
+  band.spacingY = raster.postSpacingY();
+  band.originX = raster.originX() - band.spacingX;
+  band.originY = raster.originY() - (firstRow - 1) * band.spacingY;
+  band.values.resize(band.width * band.height);
+
+  for (int row = 0; row < band.height; ++row)
+  {
+    const int rasterRow = qBound(0, firstRow - 1 + row, raster.height() - 1);
+    const QVector<QVector<float>>& tileRow = sourceTiles[rasterRow / tileHeight];
+    float* line = band.values.data() + row * band.width;
+    for (int tileX = 0; tileX < tileRow.size(); ++tileX)
+    {
+      const float* source = tileRow.at(tileX).constData() + (rasterRow % tileHeight) * tileWidth;
+      const int columns = qMin(tileWidth, width - tileX * tileWidth);
+      std::copy(source, source + columns, line + 1 + tileX * tileWidth);
+    }
+
+    line[0] = line[1];
+    line[band.width - 1] = line[band.width - 2];
+  }
+
+  return true;
+}
+
+/*!
+  \internal
+
+  Sets \a tile, \l GeoTiffWriter::TileSize samples square, to the product
+  for the output pixels from \a firstColumn, \a firstRow. Output pixels are
+  offset by the halo from the posts of \a grid.
+ */
+void TerrainDerivativeEngine::computeTile(const ElevationGrid& grid, const TerrainDerivativeParameters& parameters,
+                                          int firstColumn, int firstRow, float* tile)
+{
+  constexpr int tileSize = GeoTiffWriter::TileSize;
+  const float noData = std::numeric_limits<float>::quiet_NaN();
+  std::fill(tile, tile + tileSize * tileSize, noData);
+
+  const int columns = qMin(tileSize, grid.width - 2 - firstColumn);
+  const int rows = qMin(tileSize, grid.height - 2 - firstRow);
+  if (columns <= 0 || rows <= 0)
+    return;
+
+  // the post to the north-west of the tile's first pixel
+  const float* values = grid.values.constData() + firstRow * grid.width + firstColumn;
+
+  bool hasVoids = false;
+  for (int row = 0; row < rows + 2 && !hasVoids; ++row)
+  {
+    const float* line = values + row * grid.width;
+    hasVoids = std::any_of(line, line + columns + 2, [](float value) { return std::isnan(value); });
+  }
+
+  const float zenith = static_cast<float>((90.0 - parameters.altitude) * degreesToRadians);
+  const float cosZenith = std::cos(zenith);
+  const float sinZenith = std::sin(zenith);
+  const float sinAzimuth = static_cast<float>(std::sin(parameters.azimuth * degreesToRadians));
+  const float cosAzimuth = static_cast<float>(std::cos(parameters.azimuth * degreesToRadians));
+  const float zFactor = static_cast<float>(parameters.zFactor);
+
+  QVector<float> gradientsX(columns);
+  QVector<float> gradientsY(columns);
+  float* dzdx = gradientsX.data();
+  float* dzdy = gradientsY.data();
+
+  for (int row = 0; row < rows; ++row)
+  {
+    const float* north = values + row * grid.width;
+    const float* centre = north + grid.width;
+    const float* south = centre + grid.width;
+    float* output = tile + row * tileSize;
+
+    if (parameters.product == TerrainDerivativeParameters::Roughness)
+    {
+      for (int column = 0; column < columns; ++column)
+      {
+        const float posts[9] = { north[column], north[column + 1], north[column + 2],
+                                 centre[column], centre[column + 1], centre[column + 2],
+                                 south[column], south[column + 1], south[column + 2] };
+        float minimum = posts[4];
+        float maximum = posts[4];
+        for (int i = 0; i < 9; ++i)
+        {
+          // a NaN centre stays NaN, and void neighbours drop out
+          minimum = posts[i] < minimum ? posts[i] : minimum;
+          maximum = posts[i] > maximum ? posts[i] : maximum;
+        }
+
+        output[column] = maximum - minimum;
+      }
+
+      continue;
+    }
+
+    // Horn's gradients in meters per meter, x towards the east and y towards the north
+    const double latitude = grid.y(firstRow + row + 1);
+    const float scaleX = static_cast<float>(zFactor / (8.0 * grid.spacingX * ElevationGrid::metersPerDegreeX(latitude)));
+    const float scaleY = static_cast<float>(zFactor / (8.0 * grid.spacingY * ElevationGrid::metersPerDegreeY(latitude)));
+
+    if (!hasVoids)
+    {
+      for (int column = 0; column < columns; ++column)
+      {
+        dzdx[column] = ((north[column + 2] + 2.0f * centre[column + 2] + south[column + 2]) -
+                        (north[column] + 2.0f * centre[column] + south[column])) * scaleX;
+        dzdy[column] = ((north[column] + 2.0f * north[column + 1] + north[column + 2]) -
+                        (south[column] + 2.0f * south[column + 1] + south[column + 2])) * scaleY;
+      }
+    }
+    else
+    {
+      for (int column = 0; column < columns; ++column)
+      {
+        const float e = centre[column + 1];
+        auto post = [e](float value) { return std::isnan(value) ? e : value; };
+        const float a = post(north[column]);
+        const float b = post(north[column + 1]);
+        const float c = post(north[column + 2]);
+        const float d = post(centre[column]);
+        const float f = post(centre[column + 2]);
+        const float g = post(south[column]);
+        const float h = post(south[column + 1]);
+        const float i = post(south[column + 2]);
+
+        // a void centre leaves the gradients NaN
+        dzdx[column] = ((c + 2.0f * f + i) - (a + 2.0f * d + g)) * scaleX + (e - e);
+        dzdy[column] = ((a + 2.0f * b + c) - (g + 2.0f * h + i)) * scaleY + (e - e);
+      }
+    }
+
+    switch (parameters.product)
+    {
+    case TerrainDerivativeParameters::Slope:
+      for (int column = 0; column < columns; ++column)
+        output[column] = std::atan(std::sqrt(dzdx[column] * dzdx[column] + dzdy[column] * dzdy[column])) * radiansToDegrees;
+      break;
+
+    case TerrainDerivativeParameters::Aspect:
+      // the compass bearing of the way downhill
+      for (int column = 0; column < columns; ++column)
+      {
+        if (dzdx[column] == 0.0f && dzdy[column] == 0.0f)
+        {
+          output[column] = flatAspect;
+          continue;
+        }
+
+        const float bearing = std::atan2(-dzdx[column], -dzdy[column]) * radiansToDegrees;
+        output[column] = bearing < 0.0f ? bearing + 360.0f : bearing;
+      }
+      break;
+
+    case TerrainDerivativeParameters::Hillshade:
+      // cos(zenith) cos(slope) + sin(zenith) sin(slope) cos(azimuth - aspect), written with the gradients alone
+      for (int column = 0; column < columns; ++column)
+      {
+        const float shade = 255.0f * (cosZenith - sinZenith * (sinAzimuth * dzdx[column] + cosAzimuth * dzdy[column])) /
+            std::sqrt(1.0f + dzdx[column] * dzdx[column] + dzdy[column] * dzdy[column]);
+        output[column] = shade < 0.0f ? 0.0f : shade;
+      }
+      break;
+
+    case TerrainDerivativeParameters::Roughness:
+      break;
+    }
+  }
+}
+
+} // Dsa
@@ -0,0 +1,77 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef TERRAINDERIVATIVEENGINE_H
+#define TERRAINDERIVATIVEENGINE_H
+
+// example app headers
+#include "ElevationGrid.h"
+
+// Qt headers
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+namespace Dsa {
+
+class DemRaster;
+
+struct TerrainDerivativeParameters
+{
+  enum Product : int
+  {
+    Slope = 0,
+    Aspect = 1,
+    Hillshade = 2,
+    Roughness = 3
+  };
+
+  Product product = Slope;
+
+  // the factor applied to elevations before the derivatives are taken
+  double zFactor = 1.0;
+
+  // the direction and height of the light for a hillshade, in degrees
+  double azimuth = 315.0;
+  double altitude = 45.0;
+};
+
+class TerrainDerivativeEngine
+{
+public:
+  static QString create(const QString& sourcePath, const TerrainDerivativeParameters& parameters, const QString& directory,
+                        QString* errorString = nullptr);
+  static QString cachedFilePath(const QString& sourcePath, const TerrainDerivativeParameters& parameters, const QString& directory);
+
+  static bool compute(DemRaster& raster, const TerrainDerivativeParameters& parameters, const QString& filePath,
+                      QString* errorString = nullptr);
+
+  static QString productName(TerrainDerivativeParameters::Product product);
+
+private:
+  TerrainDerivativeEngine() = delete;
+
+  static bool readBand(DemRaster& raster, int firstRow, int rows, QHash<int, QVector<QVector<float>>>& sourceTiles,
+                       ElevationGrid& band, QString* errorString);
+
+  static void computeTile(const ElevationGrid& grid, const TerrainDerivativeParameters& parameters,
+                          int firstColumn, int firstRow, float* tile);
+};
+
+} // Dsa
+
+#endif // TERRAINDERIVATIVEENGINE_H
@@ -0,0 +1,299 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "TerrainProfileChart.h"
+
+// example app headers
+#include "LineOfSightEngine.h"
+
+// Qt headers
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGVertexColorMaterial>
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+namespace
+{
+// the smallest span of elevation in meters drawn, so that flat ground is not exaggerated
+const double minimumElevationRange = 10.0;
+
+// the fraction of the span of elevation left clear above and below the ground
+const double elevationPadding = 0.1;
+
+void setColor(QSGGeometry::ColoredPoint2D& vertex, float x, float y, const QColor& color)
+{
+  // the vertex color material expects premultiplied colors
+  const int alpha = color.alpha();
+  vertex.set(x, y, static_cast<uchar>(color.red() * alpha / 255), static_cast<uchar>(color.green() * alpha / 255),
+             static_cast<uchar>(color.blue() * alpha / 255), static_cast<uchar>(alpha));
+}
+}
+
+/*!
+  \class Dsa::TerrainProfileChart
+  \inmodule Dsa
+  \brief A QML item which draws the profile of a \l TerrainProfileController.
+
+  The ground is drawn as a line over a filled area that is colored by
+  whether each part of the ground can be seen from the start of the path.
+  The samples are copied straight from the profile into the scene graph
+  when it is next rendered, so profiles of many thousands of samples can be
+  redrawn every frame as the path moves.
+
+  \sa TerrainProfileController
+ */
+
+/*!
+  \brief Constructor accepting an optional \a parent.
+ */
+TerrainProfileChart::TerrainProfileChart(QQuickItem* parent) :
+  QQuickItem(parent)
+{
+  setFlag(ItemHasContents, true);
+}
+
+/*!
+  \brief Destructor.
+ */
+TerrainProfileChart::~TerrainProfileChart()
+{
+}
+
+/*!
+  \property TerrainProfileChart::controller
+  \brief Returns the controller whose profile is drawn.
+ */
+TerrainProfileController* TerrainProfileChart::controller() const
+{
+  return m_controller;
+}
+
+/*!
+  \brief Sets the controller whose profile is drawn to \a controller.
+ */
+void TerrainProfileChart::setController(TerrainProfileController* controller)
+{
+  if (m_controller == controller)
+    return;
+
+  disconnect(m_profileConnection);
+  m_controller = controller;
+
+  if (m_controller)
+    m_profileConnection = connect(m_controller.data(), &TerrainProfileController::profileChanged, this, &QQuickItem::update);
+
+  emit controllerChanged();
+  update();
+}
+
+/*!
+  \property TerrainProfileChart::visibleColor
+  \brief Returns the color of ground that can be seen from the start of the path.
+ */
+QColor TerrainProfileChart::visibleColor() const
+{
+  return m_visibleColor;
+}
+
+/*!
+  \brief Sets the color of ground that can be seen to \a visibleColor.
+ */
+void TerrainProfileChart::setVisibleColor(const QColor& visibleColor)
+{
+  if (m_visibleColor == visibleColor)
+    return;
+
+  m_visibleColor = visibleColor;
+  emit visibleColorChanged();
+  update();
+}
+
+/*!
+  \property TerrainProfileChart::obstructedColor
+  \brief Returns the color of dead ground, which cannot be seen from the start of the path.
+ */
+QColor TerrainProfileChart::obstructedColor() const
+{
+  return m_obstructedColor;
+}
+
+/*!
+  \brief Sets the color of dead ground to \a obstructedColor.
+ */
+void TerrainProfileChart::setObstructedColor(const QColor& obstructedColor)
+{
+  if (m_obstructedColor == obstructedColor)
+    return;
+
+  m_obstructedColor = obstructedColor;
+  emit obstructedColorChanged();
+  update();
+}
+
+/*!
+  \property TerrainProfileChart::lineColor
+  \brief Returns the color of the line along the ground.
+ */
+QColor TerrainProfileChart::lineColor() const
+{
+  return m_lineColor;
+}
+
+/*!
+  \brief Sets the color of the line along the ground to \a lineColor.
+ */
+void TerrainProfileChart::setLineColor(const QColor& lineColor)
+{
+  if (m_lineColor == lineColor)
+    return;
+
+  m_lineColor = lineColor;
+  emit lineColorChanged();
+  update();
+}
+
+/*!
+  \internal
+ */
+void TerrainProfileChart::geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+  QQuickItem::geometryChanged(newGeometry, oldGeometry);
+  update();
+}
+
+/*!
+  \internal
+
+  Fills the chart's nodes from the controller's profile. This runs on the
+  render thread while the GUI thread is blocked, so the profile is read
+  without copying it.
+ */
+QSGNode* TerrainProfileChart::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+  const int count = m_controller ? m_controller->profile().size() : 0;
+  if (count < 2 || width() <= 0.0 || height() <= 0.0 || m_controller->profile().length <= 0.0 ||
+      std::isnan(m_controller->profile().minimumElevation))
+  {
+    delete oldNode;
+    return nullptr;
+  }
+
+  QSGNode* root = oldNode;
+  QSGGeometryNode* fillNode = nullptr;
+  QSGGeometryNode* lineNode = nullptr;
+  if (!root)
+  {
+    root = new QSGNode();
+
+    fillNode = new QSGGeometryNode();
+    QSGGeometry* fillGeometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+    fillGeometry->setDrawingMode(QSGGeometry::DrawTriangleStrip);
+    fillNode->setGeometry(fillGeometry);
+    fillNode->setFlag(QSGNode::OwnsGeometry);
+    fillNode->setMaterial(new QSGVertexColorMaterial());
+    fillNode->setFlag(QSGNode::OwnsMaterial);
+    root->appendChildNode(fillNode);
+
+    lineNode = new QSGGeometryNode();
+    QSGGeometry* lineGeometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+    lineGeometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+    lineGeometry->setLineWidth(2.0f);
+    lineNode->setGeometry(lineGeometry);
+    lineNode->setFlag(QSGNode::OwnsGeometry);
+    lineNode->setMaterial(new QSGFlatColorMaterial());
+    lineNode->setFlag(QSGNode::OwnsMaterial);
+    root->appendChildNode(lineNode);
+  }
+  else
+  {
+    fillNode = static_cast<QSGGeometryNode*>(root->firstChild());
+    lineNode = static_cast<QSGGeometryNode*>(fillNode->nextSibling());
+  }
+
+  const TerrainProfile& profile = m_controller->profile();
+  const double range = qMax(minimumElevationRange, static_cast<double>(profile.maximumElevation - profile.minimumElevation));
+  const double bottomElevation = profile.minimumElevation - range * elevationPadding;
+  const double scaleX = width() / profile.length;
+  const double scaleY = height() / (range * (1.0 + 2.0 * elevationPadding));
+  const float chartHeight = static_cast<float>(height());
+
+  QSGGeometry* fillGeometry = fillNode->geometry();
+  QSGGeometry* lineGeometry = lineNode->geometry();
+  fillGeometry->allocate(count * 2);
+  lineGeometry->allocate(count);
+  QSGGeometry::ColoredPoint2D* fillVertices = fillGeometry->vertexDataAsColoredPoint2D();
+  QSGGeometry::Point2D* lineVertices = lineGeometry->vertexDataAsPoint2D();
+
+  const QColor transparent(Qt::transparent);
+  for (int i = 0; i < count; ++i)
+  {
+    const float elevation = profile.elevation.at(i);
+    const float x = static_cast<float>(profile.distance.at(i) * scaleX);
+
+    // voids sit on the bottom of the chart and are left unfilled
+    const float y = std::isnan(elevation) ? chartHeight : static_cast<float>(chartHeight - (elevation - bottomElevation) * scaleY);
+
+    const quint8 visibility = profile.visibility.at(i);
+    const QColor& color = std::isnan(elevation) || visibility == LineOfSightEngine::Unknown
+        ? transparent : (visibility == LineOfSightEngine::Visible ? m_visibleColor : m_obstructedColor);
+
+    setColor(fillVertices[i * 2], x, y, color);
+    setColor(fillVertices[i * 2 + 1], x, chartHeight, color);
+    lineVertices[i].set(x, y);
+  }
+
+  static_cast<QSGFlatColorMaterial*>(lineNode->material())->setColor(m_lineColor);
+
+  fillNode->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
+  lineNode->markDirty(QSGNode::DirtyGeometry | QSGNode::DirtyMaterial);
+
+  return root;
+}
+
+} // Dsa
+
+// Signal Documentation
+
+/*!
+  \fn void TerrainProfileChart::controllerChanged();
+
+  \brief Signal emitted when the controller changes.
+ */
+
+/*!
+  \fn void TerrainProfileChart::visibleColorChanged();
+
+  \brief Signal emitted when the visible color changes.
+ */
+
+/*!
+  \fn void TerrainProfileChart::obstructedColorChanged();
+
+  \brief Signal emitted when the obstructed color changes.
+ */
+
+/*!
+  \fn void TerrainProfileChart::lineColorChanged();
+
+  \brief Signal emitted when the line color changes.
+ */
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef TERRAINPROFILECHART_H
+#define TERRAINPROFILECHART_H
+
+// example app headers
+#include "TerrainProfileController.h"
+
+// Qt headers
+#include <QColor>
+#include <QPointer>
+#include <QQuickItem>
+
+namespace Dsa {
+
+class TerrainProfileChart : public QQuickItem
+{
+  Q_OBJECT
+
+  Q_PROPERTY(Dsa::TerrainProfileController* controller READ controller WRITE setController NOTIFY controllerChanged)
+  Q_PROPERTY(QColor visibleColor READ visibleColor WRITE setVisibleColor NOTIFY visibleColorChanged)
+  Q_PROPERTY(QColor obstructedColor READ obstructedColor WRITE setObstructedColor NOTIFY obstructedColorChanged)
+  Q_PROPERTY(QColor lineColor READ lineColor WRITE setLineColor NOTIFY lineColorChanged)
+
+public:
+  explicit TerrainProfileChart(QQuickItem* parent = nullptr);
+  ~TerrainProfileChart();
+
+  TerrainProfileController* controller() const;
+  void setController(TerrainProfileController* controller);
+
+  QColor visibleColor() const;
+  void setVisibleColor(const QColor& visibleColor);
+
+  QColor obstructedColor() const;
+  void setObstructedColor(const QColor& obstructedColor);
+
+  QColor lineColor() const;
+  void setLineColor(const QColor& lineColor);
+
+signals:
+  void controllerChanged();
+  void visibleColorChanged();
+  void obstructedColorChanged();
+  void lineColorChanged();
+
+protected:
+  void geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+  QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* updatePaintNodeData) override;
+
+private:
+  QPointer<TerrainProfileController> m_controller;
+  QMetaObject::Connection m_profileConnection;
+  QColor m_visibleColor = QColor(0, 200, 0, 160);
+  QColor m_obstructedColor = QColor(200, 0, 0, 160);
+  QColor m_lineColor = Qt::white;
+};
+
+} // Dsa
+
+#endif // TERRAINPROFILECHART_H
@@ -0,0 +1,416 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "TerrainProfileController.h"
+
+// example app headers
+#include "ElevationSampler.h"
+#include "GeoElementUtils.h"
+#include "LocationDispatcher.h"
+
+// toolkit headers
+#include "ToolManager.h"
+
+// C++ API headers
+#include "Envelope.h"
+#include "GeoElement.h"
+#include "GeometryEngine.h"
+#include "Part.h"
+#include "PartCollection.h"
+#include "Point.h"
+#include "Polyline.h"
+#include "PolylineBuilder.h"
+
+// Qt headers
+#include <QTimer>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace Dsa {
+
+// eye height in meters of the observer at the start of a profile
+constexpr double c_observerOffsetZ = 2.0;
+
+constexpr double c_targetUpdateRate = 1.0; // profiles to a target per second
+constexpr double c_targetUpdateDistance = 5.0; // meters moved before a profile to a target is made again
+
+// moves of a target are gathered for this long before the profile is made again
+constexpr int c_targetUpdateIntervalMs = 250;
+
+// the distance in meters the ends of a profile can move before the elevation grid is read again
+constexpr double c_gridMargin = 2000.0;
+
+/*!
+  \class Dsa::TerrainProfileController
+  \inmodule Dsa
+  \inherits Toolkit::AbstractTool
+  \brief Tool controller for elevation profiles along a path.
+
+  A profile can be made:
+
+  \list
+    \li Along a polyline, such as a route or a markup.
+    \li From the current position to a supplied GeoElement, such as a track.
+      The profile is made again as either end moves.
+  \endlist
+
+  Profiles are made on the CPU by the \l TerrainProfileEngine from the local
+  elevation rasters, and give the ground, the slope and the dead ground
+  along the path. They are drawn by a \l TerrainProfileChart, which reads
+  the samples directly from \l profile.
+
+  \sa TerrainProfileEngine, LineOfSightController
+ */
+
+/*!
+  \brief Constructor accepting an optional \a parent.
+ */
+TerrainProfileController::TerrainProfileController(QObject* parent) :
+  Toolkit::AbstractTool(parent)
+{
+  Toolkit::ToolManager::instance().addTool(this);
+}
+
+/*!
+  \brief Destructor.
+ */
+TerrainProfileController::~TerrainProfileController()
+{
+  stopFollowing();
+}
+
+/*!
+  \brief The name of this tool.
+ */
+QString TerrainProfileController::toolName() const
+{
+  return QStringLiteral("terrain profile");
+}
+
+/*!
+  \brief Makes a profile along \a geometry.
+
+  A polyline is followed from its first vertex to its last. A polyline with
+  several parts is rejected, as the gaps between its parts have no ground to
+  profile. A point is profiled from the current position.
+ */
+void TerrainProfileController::profileAlongGeometry(const Geometry& geometry)
+{
+  stopFollowing();
+  m_grid = ElevationGrid();
+
+  QVector<QPointF> vertices = wgs84Vertices(geometry);
+  if (vertices.size() == 1)
+    vertices = wgs84Vertices(LocationDispatcher::instance()->location()) + vertices;
+
+  if (vertices.size() < 2)
+  {
+    emit toolErrorOccurred(QStringLiteral("Invalid terrain profile path"), QStringLiteral("A profile needs a single part polyline or a current location"));
+    return;
+  }
+
+  updateProfile(vertices);
+}
+
+/*!
+  \brief Makes a profile from the app's current location to the target \a geoElement.
+
+  The profile is made again as the current location or \a geoElement moves,
+  until another profile is made or \l clearProfile is called.
+ */
+void TerrainProfileController::profileFromLocationToGeoElement(GeoElement* geoElement)
+{
+  if (!geoElement)
+  {
+    emit toolErrorOccurred(QStringLiteral("Invalid terrain profile target"), QStringLiteral("Null GeoElement"));
+    return;
+  }
+
+  if (LocationDispatcher::instance()->location().isEmpty())
+  {
+    emit toolErrorOccurred(QStringLiteral("Failed to get location"), QStringLiteral("A terrain profile starts from the current location"));
+    return;
+  }
+
+  stopFollowing();
+  m_grid = ElevationGrid();
+
+  m_target = geoElement;
+  m_targetObject = GeoElementUtils::toQObject(geoElement);
+  m_targetSignaler = new GeoElementSignaler(geoElement, this);
+  connect(m_targetSignaler, &GeoElementSignaler::geometryChanged, this, &TerrainProfileController::scheduleTargetUpdate);
+
+  // the last profile is kept if the target goes away
+  if (m_targetObject)
+    connect(m_targetObject.data(), &QObject::destroyed, this, &TerrainProfileController::stopFollowing);
+
+  m_locationSubscription = LocationDispatcher::instance()->subscribe(this, c_targetUpdateRate, c_targetUpdateDistance, [this](const Point&)
+  {
+    updateTargetProfile();
+  });
+
+  updateTargetProfile();
+}
+
+/*!
+  \brief Removes the current profile and stops following any target.
+ */
+void TerrainProfileController::clearProfile()
+{
+  stopFollowing();
+  m_grid = ElevationGrid();
+
+  if (m_profile.isEmpty())
+    return;
+
+  m_profile = TerrainProfile();
+  m_maximumSlope = NAN;
+  emit profileChanged();
+}
+
+/*!
+  \brief Returns the current profile.
+ */
+const TerrainProfile& TerrainProfileController::profile() const
+{
+  return m_profile;
+}
+
+/*!
+  \property TerrainProfileController::profileAvailable
+  \brief Returns whether there is a profile to show.
+ */
+bool TerrainProfileController::isProfileAvailable() const
+{
+  return !m_profile.isEmpty();
+}
+
+/*!
+  \property TerrainProfileController::sampleCount
+  \brief Returns the number of samples in the profile.
+ */
+int TerrainProfileController::sampleCount() const
+{
+  return m_profile.size();
+}
+
+/*!
+  \property TerrainProfileController::length
+  \brief Returns the length of the profile in meters.
+ */
+double TerrainProfileController::length() const
+{
+  return m_profile.length;
+}
+
+/*!
+  \property TerrainProfileController::visibleLength
+  \brief Returns the length in meters of the profile whose ground can be
+  seen from its start, or NaN if the profile follows more than one segment.
+ */
+double TerrainProfileController::visibleLength() const
+{
+  return m_profile.visibleLength;
+}
+
+/*!
+  \property TerrainProfileController::minimumElevation
+  \brief Returns the lowest ground along the profile in meters, or NaN.
+ */
+double TerrainProfileController::minimumElevation() const
+{
+  return m_profile.minimumElevation;
+}
+
+/*!
+  \property TerrainProfileController::maximumElevation
+  \brief Returns the highest ground along the profile in meters, or NaN.
+ */
+double TerrainProfileController::maximumElevation() const
+{
+  return m_profile.maximumElevation;
+}
+
+/*!
+  \property TerrainProfileController::maximumSlope
+  \brief Returns the steepest slope along the profile in degrees, uphill or
+  downhill, or NaN.
+ */
+double TerrainProfileController::maximumSlope() const
+{
+  return m_maximumSlope;
+}
+
+/*!
+  \internal
+ */
+void TerrainProfileController::stopFollowing()
+{
+  if (m_locationSubscription != -1)
+  {
+    LocationDispatcher::instance()->unsubscribe(m_locationSubscription);
+    m_locationSubscription = -1;
+  }
+
+  if (m_targetObject)
+    disconnect(m_targetObject.data(), &QObject::destroyed, this, &TerrainProfileController::stopFollowing);
+
+  delete m_targetSignaler;
+  m_targetSignaler = nullptr;
+  m_targetObject.clear();
+  m_target = nullptr;
+}
+
+/*!
+  \internal
+
+  Makes the profile to the target again once its moves have settled.
+ */
+void TerrainProfileController::scheduleTargetUpdate()
+{
+  if (m_targetUpdatePending)
+    return;
+
+  m_targetUpdatePending = true;
+  QTimer::singleShot(c_targetUpdateIntervalMs, this, [this]()
+  {
+    m_targetUpdatePending = false;
+    updateTargetProfile();
+  });
+}
+
+/*!
+  \internal
+
+  Makes the profile from the current location to the target.
+ */
+void TerrainProfileController::updateTargetProfile()
+{
+  if (!m_target || !m_targetObject)
+    return;
+
+  const Geometry targetGeometry = m_target->geometry();
+  const Point targetLocation = targetGeometry.geometryType() == GeometryType::Point
+      ? geometry_cast<Point>(targetGeometry) : targetGeometry.extent().center();
+
+  const QVector<QPointF> vertices = wgs84Vertices(LocationDispatcher::instance()->location()) + wgs84Vertices(targetLocation);
+  if (vertices.size() < 2)
+    return;
+
+  updateProfile(vertices);
+}
+
+/*!
+  \internal
+
+  Replaces the profile with one along \a vertices in WGS84 degrees.
+ */
+void TerrainProfileController::updateProfile(const QVector<QPointF>& vertices)
+{
+  ElevationSampler* sampler = ElevationSampler::instance();
+  if (!sampler->hasData())
+  {
+    emit toolErrorOccurred(QStringLiteral("Terrain profile unavailable"), QStringLiteral("No local elevation data has been added"));
+    return;
+  }
+
+  double west = 0.0;
+  double south = 0.0;
+  double east = 0.0;
+  double north = 0.0;
+  TerrainProfileEngine::extent(vertices, west, south, east, north);
+
+  // the grid is kept, with room for the ends to move, until the path leaves it
+  if (!m_grid.contains(west, north) || !m_grid.contains(east, south))
+  {
+    const double middleY = (south + north) * 0.5;
+    const double marginX = c_gridMargin / ElevationGrid::metersPerDegreeX(middleY);
+    const double marginY = c_gridMargin / ElevationGrid::metersPerDegreeY(middleY);
+    m_grid = sampler->grid(west - marginX, south - marginY, east + marginX, north + marginY);
+  }
+
+  m_profile = TerrainProfileEngine::compute(m_grid, vertices, c_observerOffsetZ);
+
+  m_maximumSlope = NAN;
+  for (float slope : qAsConst(m_profile.slope))
+  {
+    if (!std::isnan(slope))
+      m_maximumSlope = std::isnan(m_maximumSlope) ? std::abs(slope) : qMax(m_maximumSlope, static_cast<double>(std::abs(slope)));
+  }
+
+  emit profileChanged();
+}
+
+/*!
+  \internal
+
+  Returns the vertices of \a geometry in WGS84 degrees. Only points and
+  single part polylines have vertices.
+ */
+QVector<QPointF> TerrainProfileController::wgs84Vertices(const Geometry& geometry)
+{
+  QVector<QPointF> vertices;
+  if (geometry.isEmpty())
+    return vertices;
+
+  const Geometry wgs84Geometry = geometry.spatialReference() == SpatialReference::wgs84()
+      ? geometry : GeometryEngine::project(geometry, SpatialReference::wgs84());
+
+  if (wgs84Geometry.geometryType() == GeometryType::Point)
+  {
+    const Point point = geometry_cast<Point>(wgs84Geometry);
+    vertices.append(QPointF(point.x(), point.y()));
+  }
+  else if (wgs84Geometry.geometryType() == GeometryType::Polyline)
+  {
+    QObject localParent;
+    PolylineBuilder builder(geometry_cast<Polyline>(wgs84Geometry), &localParent);
+    PartCollection* parts = builder.parts();
+    if (parts->size() != 1)
+      return vertices;
+
+    Part* part = parts->part(0);
+    for (int i = 0; i < part->pointCount(); ++i)
+    {
+      const Point point = part->point(i);
+      vertices.append(QPointF(point.x(), point.y()));
+    }
+  }
+
+  return vertices;
+}
+
+} // Dsa
+
+// Signal Documentation
+
+/*!
+  \fn void TerrainProfileController::toolErrorOccurred(const QString& errorMessage, const QString& additionalMessage);
+
+  \brief Signal emitted when an error occurs.
+
+  An \a errorMessage and \a additionalMessage are passed through as parameters, describing
+  the error that occurred.
+ */
+
+/*!
+  \fn void TerrainProfileController::profileChanged();
+
+  \brief Signal emitted when the profile changes.
+ */
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef TERRAINPROFILECONTROLLER_H
+#define TERRAINPROFILECONTROLLER_H
+
+// example app headers
+#include "ElevationGrid.h"
+#include "TerrainProfileEngine.h"
+
+// toolkit headers
+#include "AbstractTool.h"
+
+// Qt headers
+#include <QPointer>
+#include <QPointF>
+#include <QVector>
+
+namespace Esri {
+namespace ArcGISRuntime {
+  class GeoElement;
+  class Geometry;
+  class Point;
+}
+}
+
+namespace Dsa {
+
+class GeoElementSignaler;
+
+class TerrainProfileController : public Esri::ArcGISRuntime::Toolkit::AbstractTool
+{
+  Q_OBJECT
+
+  Q_PROPERTY(bool profileAvailable READ isProfileAvailable NOTIFY profileChanged)
+  Q_PROPERTY(int sampleCount READ sampleCount NOTIFY profileChanged)
+  Q_PROPERTY(double length READ length NOTIFY profileChanged)
+  Q_PROPERTY(double visibleLength READ visibleLength NOTIFY profileChanged)
+  Q_PROPERTY(double minimumElevation READ minimumElevation NOTIFY profileChanged)
+  Q_PROPERTY(double maximumElevation READ maximumElevation NOTIFY profileChanged)
+  Q_PROPERTY(double maximumSlope READ maximumSlope NOTIFY profileChanged)
+
+public:
+  explicit TerrainProfileController(QObject* parent = nullptr);
+  ~TerrainProfileController();
+
+  QString toolName() const override;
+
+  void profileAlongGeometry(const Esri::ArcGISRuntime::Geometry& geometry);
+  void profileFromLocationToGeoElement(Esri::ArcGISRuntime::GeoElement* geoElement);
+  Q_INVOKABLE void clearProfile();
+
+  const TerrainProfile& profile() const;
+
+  bool isProfileAvailable() const;
+  int sampleCount() const;
+  double length() const;
+  double visibleLength() const;
+  double minimumElevation() const;
+  double maximumElevation() const;
+  double maximumSlope() const;
+
+signals:
+  void toolErrorOccurred(const QString& errorMessage, const QString& additionalMessage);
+  void profileChanged();
+
+private:
+  void stopFollowing();
+  void scheduleTargetUpdate();
+  void updateTargetProfile();
+  void updateProfile(const QVector<QPointF>& vertices);
+
+  static QVector<QPointF> wgs84Vertices(const Esri::ArcGISRuntime::Geometry& geometry);
+
+  TerrainProfile m_profile;
+  ElevationGrid m_grid;
+  double m_maximumSlope = NAN;
+
+  // the target followed by a profile from the current position
+  Esri::ArcGISRuntime::GeoElement* m_target = nullptr;
+  QPointer<QObject> m_targetObject;
+  GeoElementSignaler* m_targetSignaler = nullptr;
+  int m_locationSubscription = -1;
+  bool m_targetUpdatePending = false;
+};
+
+} // Dsa
+
+#endif // TERRAINPROFILECONTROLLER_H
@@ -0,0 +1,458 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "TerrainProfileEngine.h"
+
+// example app headers
+#include "ElevationGrid.h"
+#include "ElevationSampler.h"
+#include "LineOfSightEngine.h"
+#include "ParallelFor.h"
+#include "ViewshedEngine.h"
+
+// STL headers
+#include <algorithm>
+#include <limits>
+
+namespace Dsa {
+
+namespace
+{
+const double earthRadius = 6371008.8;
+const double degreesToRadians = M_PI / 180.0;
+const double radiansToDegrees = 180.0 / M_PI;
+
+// samples are handed to the threads in blocks of this many
+const int samplesPerBlock = 4096;
+
+// the margin in meters read around the path so that a path along a line of posts still has a grid
+const double gridMargin = 100.0;
+
+// the angle in radians between two WGS84 locations on a sphere
+double centralAngle(const QPointF& from, const QPointF& to)
+{
+  const double sinHalfY = std::sin((to.y() - from.y()) * degreesToRadians * 0.5);
+  const double sinHalfX = std::sin((to.x() - from.x()) * degreesToRadians * 0.5);
+  const double a = sinHalfY * sinHalfY + std::cos(from.y() * degreesToRadians) * std::cos(to.y() * degreesToRadians) * sinHalfX * sinHalfX;
+
+  return 2.0 * std::atan2(std::sqrt(a), std::sqrt(qMax(0.0, 1.0 - a)));
+}
+}
+
+constexpr int TerrainProfileEngine::MaximumSamples;
+
+/*!
+  \class Dsa::TerrainProfile
+  \inmodule Dsa
+  \brief The ground sampled along a path by \l TerrainProfileEngine.
+
+  The samples are held as parallel arrays, so that a chart can read the
+  distances and elevations directly.
+ */
+
+/*!
+  \brief Returns whether the profile has no samples.
+ */
+bool TerrainProfile::isEmpty() const
+{
+  return distance.isEmpty();
+}
+
+/*!
+  \brief Returns the number of samples in the profile.
+ */
+int TerrainProfile::size() const
+{
+  return distance.size();
+}
+
+/*!
+  \class Dsa::TerrainProfileEngine
+  \inmodule Dsa
+  \brief Samples the terrain along a path on the CPU, using the local
+  elevation rasters.
+
+  The path is densified along great circles to about the spacing of the
+  elevation posts, and the samples are read from an \l ElevationGrid in
+  blocks: the posts around each sample are gathered first, then all of the
+  samples in a block are interpolated in one branch-free loop that the
+  compiler can vectorize. Blocks are sampled in parallel.
+
+  For each sample the profile gives the distance along the path, the
+  ground and the slope in the direction of travel. For a path of a single
+  segment it also gives whether the ground can be seen from the start of
+  the path, allowing for the curvature of the earth and for refraction as
+  \l LineOfSightEngine does. Ground that cannot be seen is dead ground.
+
+  \sa TerrainProfileController, LineOfSightEngine
+ */
+
+/*!
+  \brief Returns the profile along the polyline through \a vertices, using
+  elevations from the rasters added to the \l ElevationSampler.
+
+  \a vertices are in WGS84 degrees. The observer at the start of the path is
+  raised \a observerOffsetZ meters above the ground and each sample
+  \a targetOffsetZ meters. The profile is empty if no raster is loaded. This
+  must be called from the GUI thread.
+ */
+TerrainProfile TerrainProfileEngine::compute(const QVector<QPointF>& vertices, double observerOffsetZ, double targetOffsetZ)
+{
+  ElevationSampler* sampler = ElevationSampler::instance();
+  if (!sampler->hasData() || vertices.isEmpty())
+    return TerrainProfile();
+
+  double west = 0.0;
+  double south = 0.0;
+  double east = 0.0;
+  double north = 0.0;
+  extent(vertices, west, south, east, north);
+
+  const double middleY = (south + north) * 0.5;
+  const double marginX = gridMargin / ElevationGrid::metersPerDegreeX(middleY);
+  const double marginY = gridMargin / ElevationGrid::metersPerDegreeY(middleY);
+
+  return compute(sampler->grid(west - marginX, south - marginY, east + marginX, north + marginY), vertices, observerOffsetZ, targetOffsetZ);
+}
+
+/*!
+  \brief Returns the profile along the polyline through \a vertices over the
+  elevation posts in \a grid.
+
+  Samples are taken every \a sampleSpacing meters, or at the spacing of the
+  posts if it is NaN, and no more than \l MaximumSamples are taken. Only
+  \a grid is read, so this may be called from any thread.
+ */
+TerrainProfile TerrainProfileEngine::compute(const ElevationGrid& grid, const QVector<QPointF>& vertices, double observerOffsetZ,
+                                             double targetOffsetZ, double sampleSpacing)
+{
+  TerrainProfile profile;
+  if (grid.isEmpty() || vertices.isEmpty())
+    return profile;
+
+  if (!(sampleSpacing > 0.0))
+  {
+    const double middleY = grid.originY - grid.spacingY * (grid.height - 1) * 0.5;
+    sampleSpacing = qMin(grid.spacingX * ElevationGrid::metersPerDegreeX(middleY), grid.spacingY * ElevationGrid::metersPerDegreeY(middleY));
+  }
+
+  densify(vertices, sampleSpacing, profile);
+
+  const int count = profile.size();
+  profile.elevation.resize(count);
+
+  const double* x = profile.x.constData();
+  const double* y = profile.y.constData();
+  float* elevation = profile.elevation.data();
+  const int blocks = (count + samplesPerBlock - 1) / samplesPerBlock;
+  parallelFor(0, blocks, [&](int block)
+  {
+    const int first = block * samplesPerBlock;
+    sample(grid, x + first, y + first, elevation + first, qMin(samplesPerBlock, count - first));
+  });
+
+  for (float z : qAsConst(profile.elevation))
+  {
+    if (std::isnan(z))
+      continue;
+
+    profile.minimumElevation = std::isnan(profile.minimumElevation) ? z : qMin(profile.minimumElevation, z);
+    profile.maximumElevation = std::isnan(profile.maximumElevation) ? z : qMax(profile.maximumElevation, z);
+  }
+
+  computeSlope(profile);
+  computeVisibility(profile, vertices.size() == 2, observerOffsetZ, targetOffsetZ);
+
+  return profile;
+}
+
+/*!
+  \brief Replaces \a profile with samples every \a sampleSpacing meters along
+  the polyline through \a vertices.
+
+  Each segment is followed along its great circle and sampled evenly, so
+  every vertex is also a sample. The spacing is widened if the path would
+  otherwise need more than \l MaximumSamples. Only the locations and
+  distances of \a profile are set.
+ */
+void TerrainProfileEngine::densify(const QVector<QPointF>& vertices, double sampleSpacing, TerrainProfile& profile)
+{
+  profile = TerrainProfile();
+  if (vertices.isEmpty() || !(sampleSpacing > 0.0))
+    return;
+
+  const int segmentCount = vertices.size() - 1;
+  QVector<double> angles(segmentCount);
+  double length = 0.0;
+  for (int i = 0; i < segmentCount; ++i)
+  {
+    angles[i] = centralAngle(vertices.at(i), vertices.at(i + 1));
+    length += angles.at(i) * earthRadius;
+  }
+
+  // every segment takes at least one sample, and the last vertex one more
+  sampleSpacing = qMax(sampleSpacing, length / qMax(1, MaximumSamples - vertices.size()));
+
+  QVector<int> firstSamples(segmentCount + 1);
+  QVector<double> startDistances(segmentCount);
+  int count = 0;
+  double distance = 0.0;
+  for (int i = 0; i < segmentCount; ++i)
+  {
+    firstSamples[i] = count;
+    startDistances[i] = distance;
+    const double segmentLength = angles.at(i) * earthRadius;
+    count += qMax(1, static_cast<int>(std::ceil(segmentLength / sampleSpacing)));
+    distance += segmentLength;
+  }
+  firstSamples[segmentCount] = count;
+
+  profile.x.resize(count + 1);
+  profile.y.resize(count + 1);
+  profile.distance.resize(count + 1);
+  profile.length = length;
+
+  double* x = profile.x.data();
+  double* y = profile.y.data();
+  float* distances = profile.distance.data();
+  parallelFor(0, segmentCount, [&](int segment)
+  {
+    const QPointF& from = vertices.at(segment);
+    const QPointF& to = vertices.at(segment + 1);
+    const int first = firstSamples.at(segment);
+    const int steps = firstSamples.at(segment + 1) - first;
+    const double angle = angles.at(segment);
+    const double sinAngle = std::sin(angle);
+
+    const double fromX = std::cos(from.y() * degreesToRadians) * std::cos(from.x() * degreesToRadians);
+    const double fromY = std::cos(from.y() * degreesToRadians) * std::sin(from.x() * degreesToRadians);
+    const double fromZ = std::sin(from.y() * degreesToRadians);
+    const double toX = std::cos(to.y() * degreesToRadians) * std::cos(to.x() * degreesToRadians);
+    const double toY = std::cos(to.y() * degreesToRadians) * std::sin(to.x() * degreesToRadians);
+    const double toZ = std::sin(to.y() * degreesToRadians);
+
+    for (int step = 0; step < steps; ++step)
+    {
+      const double t = static_cast<double>(step) / steps;
+      const int i = first + step;
+      distances[i] = static_cast<float>(startDistances.at(segment) + angle * earthRadius * t);
+
+      // very short segments are as straight in degrees as on the sphere
+      if (sinAngle < 1e-12)
+      {
+        x[i] = from.x() + (to.x() - from.x()) * t;
+        y[i] = from.y() + (to.y() - from.y()) * t;
+        continue;
+      }
+
+      const double a = std::sin((1.0 - t) * angle) / sinAngle;
+      const double b = std::sin(t * angle) / sinAngle;
+      const double pointX = a * fromX + b * toX;
+      const double pointY = a * fromY + b * toY;
+      const double pointZ = a * fromZ + b * toZ;
+      x[i] = std::atan2(pointY, pointX) * radiansToDegrees;
+      y[i] = std::atan2(pointZ, std::hypot(pointX, pointY)) * radiansToDegrees;
+    }
+  });
+
+  x[count] = vertices.last().x();
+  y[count] = vertices.last().y();
+  distances[count] = static_cast<float>(length);
+}
+
+/*!
+  \brief Sets the first \a count of \a elevation to the ground at the
+  locations in \a x and \a y, interpolated from the posts in \a grid.
+
+  Voids are left out of the interpolation as \l ElevationGrid::elevation
+  does, and samples outside the grid are NaN. Only \a grid is read, so this
+  may be called from any thread.
+ */
+void TerrainProfileEngine::sample(const ElevationGrid& grid, const double* x, const double* y, float* elevation, int count)
+{
+  if (grid.isEmpty() || grid.width < 2 || grid.height < 2)
+  {
+    std::fill(elevation, elevation + count, std::numeric_limits<float>::quiet_NaN());
+    return;
+  }
+
+  constexpr int blockSize = 256;
+  float posts[4][blockSize];
+  float masks[4][blockSize];
+  float weightsX[blockSize];
+  float weightsY[blockSize];
+
+  const float* values = grid.values.constData();
+  const double lastColumn = grid.width - 1;
+  const double lastRow = grid.height - 1;
+
+  for (int start = 0; start < count; start += blockSize)
+  {
+    const int size = qMin(blockSize, count - start);
+
+    // gather the four posts around each sample, with voids and samples outside the grid masked out
+    for (int i = 0; i < size; ++i)
+    {
+      const double fx = (x[start + i] - grid.originX) / grid.spacingX;
+      const double fy = (grid.originY - y[start + i]) / grid.spacingY;
+      if (!(fx >= 0.0 && fx <= lastColumn && fy >= 0.0 && fy <= lastRow))
+      {
+        for (int corner = 0; corner < 4; ++corner)
+        {
+          posts[corner][i] = 0.0f;
+          masks[corner][i] = 0.0f;
+        }
+        weightsX[i] = 0.0f;
+        weightsY[i] = 0.0f;
+        continue;
+      }
+
+      const int column = qMin(static_cast<int>(fx), grid.width - 2);
+      const int row = qMin(static_cast<int>(fy), grid.height - 2);
+      weightsX[i] = static_cast<float>(fx - column);
+      weightsY[i] = static_cast<float>(fy - row);
+
+      const float* first = values + row * grid.width + column;
+      const float corners[4] = { first[0], first[1], first[grid.width], first[grid.width + 1] };
+      for (int corner = 0; corner < 4; ++corner)
+      {
+        const bool valid = !std::isnan(corners[corner]);
+        posts[corner][i] = valid ? corners[corner] : 0.0f;
+        masks[corner][i] = valid ? 1.0f : 0.0f;
+      }
+    }
+
+    // interpolate without branches so that the loop vectorizes; with every weight masked out this is 0 / 0, a NaN
+    float* result = elevation + start;
+    for (int i = 0; i < size; ++i)
+    {
+      const float tx = weightsX[i];
+      const float ty = weightsY[i];
+      const float weight0 = (1.0f - tx) * (1.0f - ty) * masks[0][i];
+      const float weight1 = tx * (1.0f - ty) * masks[1][i];
+      const float weight2 = (1.0f - tx) * ty * masks[2][i];
+      const float weight3 = tx * ty * masks[3][i];
+
+      result[i] = (posts[0][i] * weight0 + posts[1][i] * weight1 + posts[2][i] * weight2 + posts[3][i] * weight3) /
+          (weight0 + weight1 + weight2 + weight3);
+    }
+  }
+}
+
+/*!
+  \brief Sets \a west, \a south, \a east and \a north to the WGS84 extent of \a vertices.
+ */
+void TerrainProfileEngine::extent(const QVector<QPointF>& vertices, double& west, double& south, double& east, double& north)
+{
+  west = 180.0;
+  south = 90.0;
+  east = -180.0;
+  north = -90.0;
+
+  for (const QPointF& vertex : vertices)
+  {
+    if (std::isnan(vertex.x() + vertex.y()))
+      continue;
+
+    west = qMin(west, vertex.x());
+    east = qMax(east, vertex.x());
+    south = qMin(south, vertex.y());
+    north = qMax(north, vertex.y());
+  }
+}
+
+/*!
+  \internal
+
+  Sets the slope of each sample in \a profile from the samples either side of it.
+ */
+void TerrainProfileEngine::computeSlope(TerrainProfile& profile)
+{
+  const int count = profile.size();
+  profile.slope.fill(std::numeric_limits<float>::quiet_NaN(), count);
+  if (count < 2)
+    return;
+
+  const float* elevation = profile.elevation.constData();
+  const float* distance = profile.distance.constData();
+  float* slope = profile.slope.data();
+  for (int i = 0; i < count; ++i)
+  {
+    const int previous = qMax(0, i - 1);
+    const int next = qMin(count - 1, i + 1);
+    const float run = distance[next] - distance[previous];
+    if (run > 0.0f)
+      slope[i] = static_cast<float>(std::atan((elevation[next] - elevation[previous]) / run) * radiansToDegrees);
+  }
+}
+
+/*!
+  \internal
+
+  Sets whether the ground at each sample in \a profile can be seen from the
+  first sample.
+
+  This is the horizon test of \l LineOfSightEngine::update, made once along
+  the whole path: a sample is visible when the slope up to it from the
+  observer is no less than the steepest slope to the ground before it. The
+  test only holds where the path runs straight out from the observer, so
+  unless it is \a straight the visibility is left unknown and the visible
+  length NaN.
+ */
+void TerrainProfileEngine::computeVisibility(TerrainProfile& profile, bool straight, double observerOffsetZ, double targetOffsetZ)
+{
+  const int count = profile.size();
+  profile.visibility.fill(LineOfSightEngine::Unknown, count);
+  profile.visibleLength = straight ? 0.0 : NAN;
+  if (!straight || count == 0 || std::isnan(profile.elevation.first()))
+    return;
+
+  const float* elevation = profile.elevation.constData();
+  const float* distance = profile.distance.constData();
+  quint8* visibility = profile.visibility.data();
+
+  const double observerZ = elevation[0] + observerOffsetZ;
+  const double curvature = (1.0 - ViewshedEngine::RefractionCoefficient) / (2.0 * earthRadius);
+  double horizonSlope = -std::numeric_limits<double>::infinity();
+
+  visibility[0] = LineOfSightEngine::Visible;
+  for (int i = 1; i < count; ++i)
+  {
+    if (std::isnan(elevation[i]))
+      continue;
+
+    const double d = distance[i];
+    if (d <= 0.0)
+    {
+      visibility[i] = LineOfSightEngine::Visible;
+      continue;
+    }
+
+    // the earth's bulge is taken off the ground rather than added to the rays
+    const double groundZ = elevation[i] - d * d * curvature;
+    const bool visible = (groundZ + targetOffsetZ - observerZ) / d >= horizonSlope;
+    visibility[i] = visible ? LineOfSightEngine::Visible : LineOfSightEngine::Obstructed;
+    horizonSlope = qMax(horizonSlope, (groundZ - observerZ) / d);
+
+    if (visible)
+      profile.visibleLength += distance[i] - distance[i - 1];
+  }
+}
+
+} // Dsa
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef TERRAINPROFILEENGINE_H
+#define TERRAINPROFILEENGINE_H
+
+// Qt headers
+#include <QPointF>
+#include <QVector>
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+struct ElevationGrid;
+
+struct TerrainProfile
+{
+  bool isEmpty() const;
+  int size() const;
+
+  // the samples along the path in WGS84 degrees
+  QVector<double> x;
+  QVector<double> y;
+
+  // the distance in meters from the start of the path to each sample
+  QVector<float> distance;
+
+  // the ground at each sample in meters; NaN outside the grid or over voids
+  QVector<float> elevation;
+
+  // the slope along the path at each sample in degrees, positive uphill
+  QVector<float> slope;
+
+  // whether the ground at each sample can be seen from the first, as a LineOfSightEngine::Visibility;
+  // only known for a path of a single segment
+  QVector<quint8> visibility;
+
+  double length = 0.0;
+  // NaN where the visibility is not known
+  double visibleLength = 0.0;
+  float minimumElevation = NAN;
+  float maximumElevation = NAN;
+};
+
+class TerrainProfileEngine
+{
+public:
+  static constexpr int MaximumSamples = 65536;
+
+  static TerrainProfile compute(const QVector<QPointF>& vertices, double observerOffsetZ = 2.0, double targetOffsetZ = 0.0);
+  static TerrainProfile compute(const ElevationGrid& grid, const QVector<QPointF>& vertices, double observerOffsetZ = 2.0,
+                                double targetOffsetZ = 0.0, double sampleSpacing = NAN);
+
+  static void densify(const QVector<QPointF>& vertices, double sampleSpacing, TerrainProfile& profile);
+  static void sample(const ElevationGrid& grid, const double* x, const double* y, float* elevation, int count);
+
+  static void extent(const QVector<QPointF>& vertices, double& west, double& south, double& east, double& north);
+
+private:
+  TerrainProfileEngine() = delete;
+
+  static void computeSlope(TerrainProfile& profile);
+  static void computeVisibility(TerrainProfile& profile, bool straight, double observerOffsetZ, double targetOffsetZ);
+};
+
+} // Dsa
+
+#endif // TERRAINPROFILEENGINE_H
@@ -0,0 +1,429 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+// PCH header
+#include "pch.hpp"
+
+#include "ViewshedCache.h"
+
+// example app headers
+#include "ElevationSampler.h"
+
+// Qt headers
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+// STL headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Dsa {
+
+namespace
+{
+const int defaultCacheSizeKb = 128 * 1024;
+const int defaultDiskCacheSizeMb = 512;
+
+const quint32 fileMagic = 0x56534843;
+const quint32 fileVersion = 1;
+const QString fileSuffix = QStringLiteral(".viewshed");
+
+// parameters closer together than these give the same viewshed
+const double locationStep = 1.0e-7;
+const double heightStep = 0.1;
+const double distanceStep = 1.0;
+const double angleStep = 0.1;
+
+qint64 quantize(double value, double step)
+{
+  return std::isnan(value) ? std::numeric_limits<qint64>::min() : std::llround(value / step);
+}
+
+// the paths of the elevation rasters with their sizes and times, so that a raster changed in place is noticed
+QByteArray sourcesStamp(const QStringList& sources)
+{
+  QByteArray bytes;
+  QDataStream stream(&bytes, QIODevice::WriteOnly);
+  for (const QString& source : sources)
+  {
+    const QFileInfo info(source);
+    stream << source << info.size() << info.lastModified().toMSecsSinceEpoch();
+  }
+
+  return bytes;
+}
+}
+
+/*!
+  \class Dsa::ViewshedCache
+  \inmodule Dsa
+  \brief Caches the results of the \l ViewshedEngine.
+
+  Dragging a viewshed about, or returning to the same observation posts,
+  would otherwise compute the same visibility again and again. Results are
+  keyed by the observer moved to the nearest elevation post, so that any
+  location within a post gives the same key, together with the heights,
+  distances and angles rounded to a tenth of a meter or degree and the
+  elevation rasters in use, with their sizes and modification times.
+
+  The full circle is always computed and cached. Any heading and horizontal
+  angle are then cut from it with \l ViewshedRaster::sector, so turning a
+  viewshed never needs the terrain again.
+
+  Results are held in memory up to \l cacheSize, discarding the least
+  recently used. If a \l diskCachePath is set, full circle results are also
+  saved there, compressed, and found again in later sessions; the least
+  recently used files are removed once they reach \l diskCacheSize.
+
+  Viewsheds missing from the cache are computed by the caller, which can do
+  so away from the GUI thread, and then added with \l insert. The cache
+  itself is not thread safe and is meant to be used from the GUI thread.
+ */
+
+/*!
+  \brief Returns the singleton instance of the cache.
+ */
+ViewshedCache* ViewshedCache::instance()
+{
+  static ViewshedCache s_instance;
+
+  return &s_instance;
+}
+
+/*!
+  \internal
+ */
+ViewshedCache::ViewshedCache() :
+  m_rasters(defaultCacheSizeKb),
+  m_diskCacheSize(static_cast<qint64>(defaultDiskCacheSizeMb) * 1024 * 1024)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+ViewshedCache::~ViewshedCache()
+{
+}
+
+/*!
+  \brief Looks up the viewshed for \a parameters.
+
+  Returns \c true and sets \a raster if the viewshed was found in the cache,
+  cutting it from a cached full circle if need be. \a raster is left empty
+  if no local elevation covers the observer.
+
+  Otherwise returns \c false and sets \a fullCircle to the parameters to
+  compute with \l ViewshedEngine::compute. The result should then be given
+  to \l insert, from which the sector for \a parameters can be cut with
+  \l ViewshedRaster::sector.
+ */
+bool ViewshedCache::lookup(const ViewshedParameters& parameters, ViewshedRaster& raster, ViewshedParameters& fullCircle)
+{
+  // the results held in memory no longer apply once the elevation sources change
+  const QStringList sources = ElevationSampler::instance()->filePaths();
+  const QByteArray stamp = sourcesStamp(sources);
+  if (sources != m_sources || stamp != m_sourcesStamp)
+  {
+    m_rasters.clear();
+    m_sources = sources;
+    m_sourcesStamp = stamp;
+  }
+
+  raster = ViewshedRaster();
+  ViewshedParameters snapped = parameters;
+  if (!ElevationSampler::instance()->nearestPost(snapped.x, snapped.y))
+    return true;
+
+  snapped.heading = std::fmod(std::fmod(snapped.heading, 360.0) + 360.0, 360.0);
+  const QByteArray requestKey = key(snapped);
+  if (const ViewshedRaster* cached = find(requestKey, snapped.horizontalAngle >= 360.0))
+  {
+    ++m_hitCount;
+    raster = *cached;
+    return true;
+  }
+
+  fullCircle = snapped;
+  fullCircle.heading = 0.0;
+  fullCircle.horizontalAngle = 360.0;
+
+  const ViewshedRaster* cached = find(key(fullCircle), true);
+  if (!cached)
+  {
+    ++m_missCount;
+    return false;
+  }
+
+  ++m_hitCount;
+  if (snapped.horizontalAngle >= 360.0)
+  {
+    raster = *cached;
+    return true;
+  }
+
+  // a sector is quick to cut again, so it is only kept in memory
+  raster = cached->sector(snapped.x, snapped.y, snapped.heading, snapped.horizontalAngle);
+  insert(requestKey, raster, false);
+  return true;
+}
+
+/*!
+  \brief Adds the full circle \a raster computed for \a fullCircle, as given
+  by \l lookup, to the cache.
+
+  \a sources are the elevation rasters the viewshed was computed from. The
+  raster is dropped if they have changed since, so a viewshed computed away
+  from the GUI thread never outlives the elevation it came from.
+ */
+void ViewshedCache::insert(const ViewshedParameters& fullCircle, const ViewshedRaster& raster, const QStringList& sources)
+{
+  if (raster.isEmpty() || sources != m_sources)
+    return;
+
+  insert(key(fullCircle), raster, true);
+}
+
+/*!
+  \brief Returns the size of the memory cache in kilobytes.
+ */
+int ViewshedCache::cacheSize() const
+{
+  return m_rasters.maxCost();
+}
+
+/*!
+  \brief Sets the size of the memory cache to \a kilobytes.
+
+  The default is 128 MB.
+ */
+void ViewshedCache::setCacheSize(int kilobytes)
+{
+  m_rasters.setMaxCost(qMax(1, kilobytes));
+}
+
+/*!
+  \brief Returns the folder in which results are saved, or an empty string if they are not.
+ */
+QString ViewshedCache::diskCachePath() const
+{
+  return m_diskCachePath;
+}
+
+/*!
+  \brief Saves results in the folder at \a path, which is created if needed.
+
+  An empty \a path, the default, keeps results in memory only.
+ */
+void ViewshedCache::setDiskCachePath(const QString& path)
+{
+  m_diskCachePath = path;
+  if (!m_diskCachePath.isEmpty())
+    QDir().mkpath(m_diskCachePath);
+}
+
+/*!
+  \brief Returns the size of the disk cache in megabytes.
+ */
+int ViewshedCache::diskCacheSize() const
+{
+  return static_cast<int>(m_diskCacheSize / (1024 * 1024));
+}
+
+/*!
+  \brief Sets the size of the disk cache to \a megabytes.
+
+  The default is 512 MB.
+ */
+void ViewshedCache::setDiskCacheSize(int megabytes)
+{
+  m_diskCacheSize = static_cast<qint64>(qMax(1, megabytes)) * 1024 * 1024;
+  trimDiskCache();
+}
+
+/*!
+  \brief Empties the memory cache.
+
+  Saved results are left on disk.
+ */
+void ViewshedCache::clear()
+{
+  m_rasters.clear();
+}
+
+/*!
+  \brief Returns the number of viewsheds that were found in the cache.
+ */
+int ViewshedCache::hitCount() const
+{
+  return m_hitCount;
+}
+
+/*!
+  \brief Returns the number of viewsheds that had to be computed.
+ */
+int ViewshedCache::missCount() const
+{
+  return m_missCount;
+}
+
+/*!
+  \internal
+ */
+QByteArray ViewshedCache::key(const ViewshedParameters& parameters) const
+{
+  QByteArray bytes;
+  QDataStream stream(&bytes, QIODevice::WriteOnly);
+  stream << m_sourcesStamp
+         << quantize(parameters.x, locationStep) << quantize(parameters.y, locationStep)
+         << quantize(parameters.z, heightStep) << quantize(parameters.offsetZ, heightStep)
+         << quantize(parameters.targetOffsetZ, heightStep)
+         << quantize(parameters.minDistance, distanceStep) << quantize(parameters.maxDistance, distanceStep)
+         << quantize(parameters.heading, angleStep) << quantize(parameters.pitch, angleStep)
+         << quantize(parameters.horizontalAngle, angleStep) << quantize(parameters.verticalAngle, angleStep);
+
+  return QCryptographicHash::hash(bytes, QCryptographicHash::Sha1);
+}
+
+/*!
+  \internal
+
+  Returns the raster for \a key from memory, or from disk if \a fromDisk,
+  or \c nullptr. Only full circles are written to disk, so only their keys
+  are worth looking for there.
+ */
+const ViewshedRaster* ViewshedCache::find(const QByteArray& key, bool fromDisk)
+{
+  if (const ViewshedRaster* raster = m_rasters.object(key))
+    return raster;
+
+  if (!fromDisk)
+    return nullptr;
+
+  ViewshedRaster raster;
+  if (!readFromDisk(key, raster))
+    return nullptr;
+
+  insert(key, raster, false);
+  return m_rasters.object(key);
+}
+
+/*!
+  \internal
+ */
+void ViewshedCache::insert(const QByteArray& key, const ViewshedRaster& raster, bool writeToDisk)
+{
+  const int cost = qMax(1, raster.values.size() / 1024);
+  m_rasters.insert(key, new ViewshedRaster(raster), cost);
+
+  if (writeToDisk)
+    this->writeToDisk(key, raster);
+}
+
+/*!
+  \internal
+ */
+QString ViewshedCache::diskFilePath(const QByteArray& key) const
+{
+  return QDir(m_diskCachePath).filePath(QString::fromLatin1(key.toHex()) + fileSuffix);
+}
+
+/*!
+  \internal
+ */
+bool ViewshedCache::readFromDisk(const QByteArray& key, ViewshedRaster& raster) const
+{
+  if (m_diskCachePath.isEmpty())
+    return false;
+
+  QFile file(diskFilePath(key));
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream stream(&file);
+  quint32 magic = 0;
+  quint32 version = 0;
+  QByteArray values;
+  stream >> magic >> version;
+  if (magic != fileMagic || version != fileVersion)
+    return false;
+
+  stream >> raster.width >> raster.height >> raster.originX >> raster.originY >> raster.spacingX >> raster.spacingY >> values;
+  values = qUncompress(values);
+  if (stream.status() != QDataStream::Ok || values.size() != raster.width * raster.height)
+    return false;
+
+  raster.values.resize(values.size());
+  std::copy(values.constBegin(), values.constEnd(), raster.values.begin());
+
+  // the file was used, so it is the last to be removed
+  file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+  return true;
+}
+
+/*!
+  \internal
+ */
+void ViewshedCache::writeToDisk(const QByteArray& key, const ViewshedRaster& raster) const
+{
+  if (m_diskCachePath.isEmpty())
+    return;
+
+  QSaveFile file(diskFilePath(key));
+  if (!file.open(QIODevice::WriteOnly))
+    return;
+
+  // visibility compresses very well, as it comes in long runs
+  const QByteArray values(reinterpret_cast<const char*>(raster.values.constData()), raster.values.size());
+
+  QDataStream stream(&file);
+  stream << fileMagic << fileVersion
+         << raster.width << raster.height << raster.originX << raster.originY << raster.spacingX << raster.spacingY
+         << qCompress(values);
+
+  if (file.commit())
+    trimDiskCache();
+}
+
+/*!
+  \internal
+
+  Removes the least recently used files until the disk cache fits in \l diskCacheSize.
+ */
+void ViewshedCache::trimDiskCache() const
+{
+  if (m_diskCachePath.isEmpty())
+    return;
+
+  const QFileInfoList files = QDir(m_diskCachePath).entryInfoList(QStringList(QStringLiteral("*") + fileSuffix), QDir::Files, QDir::Time);
+
+  qint64 size = 0;
+  for (const QFileInfo& file : files)
+  {
+    size += file.size();
+    if (size > m_diskCacheSize)
+      QFile::remove(file.absoluteFilePath());
+  }
+}
+
+} // Dsa
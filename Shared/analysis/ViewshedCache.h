@@ -0,0 +1,81 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef VIEWSHEDCACHE_H
+#define VIEWSHEDCACHE_H
+
+// example app headers
+#include "ViewshedEngine.h"
+
+// Qt headers
+#include <QByteArray>
+#include <QCache>
+#include <QString>
+#include <QStringList>
+
+namespace Dsa {
+
+class ViewshedCache
+{
+public:
+  static ViewshedCache* instance();
+
+  ~ViewshedCache();
+
+  bool lookup(const ViewshedParameters& parameters, ViewshedRaster& raster, ViewshedParameters& fullCircle);
+  void insert(const ViewshedParameters& fullCircle, const ViewshedRaster& raster, const QStringList& sources);
+
+  int cacheSize() const;
+  void setCacheSize(int kilobytes);
+
+  QString diskCachePath() const;
+  void setDiskCachePath(const QString& path);
+
+  int diskCacheSize() const;
+  void setDiskCacheSize(int megabytes);
+
+  void clear();
+
+  int hitCount() const;
+  int missCount() const;
+
+private:
+  Q_DISABLE_COPY(ViewshedCache)
+
+  ViewshedCache();
+
+  QByteArray key(const ViewshedParameters& parameters) const;
+  const ViewshedRaster* find(const QByteArray& key, bool fromDisk);
+  void insert(const QByteArray& key, const ViewshedRaster& raster, bool writeToDisk);
+
+  QString diskFilePath(const QByteArray& key) const;
+  bool readFromDisk(const QByteArray& key, ViewshedRaster& raster) const;
+  void writeToDisk(const QByteArray& key, const ViewshedRaster& raster) const;
+  void trimDiskCache() const;
+
+  QCache<QByteArray, ViewshedRaster> m_rasters;
+  QStringList m_sources;
+  QByteArray m_sourcesStamp;
+  QString m_diskCachePath;
+  qint64 m_diskCacheSize = 0;
+  int m_hitCount = 0;
+  int m_missCount = 0;
+};
+
+} // Dsa
+
+#endif // VIEWSHEDCACHE_H
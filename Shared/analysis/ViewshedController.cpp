@@ -21,12 +21,17 @@
 #include "ViewshedController.h"
 
 // example app headers
+#include "CumulativeViewshed.h"
 #include "DsaUtility.h"
+#include "ElevationGrid.h"
+#include "ElevationSampler.h"
 #include "GeoElementViewshed360.h"
 #include "GraphicsOverlaysResultsManager.h"
 #include "LocationController.h"
 #include "LocationDisplay3d.h"
 #include "LocationViewshed360.h"
+#include "ViewshedCache.h"
+#include "ViewshedEngine.h"
 #include "ViewshedListModel.h"
 #include "GeoElementUtils.h"
 
@@ -35,16 +40,29 @@
 #include "ToolResourceProvider.h"
 
 // C++ API headers
+#include "Colormap.h"
+#include "ColormapRenderer.h"
 #include "GeoElementViewshed.h"
+#include "GeometryEngine.h"
 #include "GlobeCameraController.h"
 #include "LocationViewshed.h"
 #include "OrbitLocationCameraController.h"
+#include "Raster.h"
+#include "RasterLayer.h"
 #include "SceneQuickView.h"
 #include "SimpleMarkerSceneSymbol.h"
 #include "SimpleRenderer.h"
 
+// Qt headers
+#include <QDateTime>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QRegExp>
+#include <QtConcurrent/QtConcurrentRun>
+
 // STL headers
 #include <cmath>
+#include <memory>
 
 using namespace Esri::ArcGISRuntime;
 
@@ -91,6 +109,9 @@ ViewshedController::ViewshedController(QObject* parent) :
 
   connectMouseSignals();
 
+  // computed viewsheds are kept between sessions
+  ViewshedCache::instance()->setDiskCachePath(DsaUtility::dataPath() + QStringLiteral("/Viewsheds/Cache"));
+
   connect(m_viewsheds, &ViewshedListModel::viewshedRemoved, this, [this](Viewshed360* viewshed)
   {
     std::unique_ptr<Viewshed360> viewshedPtr(viewshed);
@@ -449,6 +470,192 @@ void ViewshedController::finishActiveViewshed()
   m_activeViewshed = nullptr;
 }
 
+/*!
+  \brief Computes the active viewshed on the CPU from the local elevation
+  rasters and adds the result to the operational layers.
+
+  The visibility grid is written to a GeoTIFF in the \c Viewsheds folder of
+  the app's data path and shown as a raster layer, with visible cells in
+  green and hidden cells in red. Results are taken from the
+  \l ViewshedCache where they can be, so that moving a viewshed back, or
+  only turning it, does not compute the visibility again. Unlike the viewshed drawn in the scene, the
+  layer remains once the viewshed is moved or removed.
+
+  The elevation is read here, but the visibility is computed and written on
+  a worker thread; \l viewshedRasterCreated is emitted once the layer has
+  been added.
+
+  Returns \c false if there is no active viewshed, no local elevation covers
+  it, or another viewshed raster is still being created.
+
+  \sa ViewshedEngine, viewshedRasterBusy
+ */
+bool ViewshedController::createActiveViewshedRaster()
+{
+  const QString errorMessage = QStringLiteral("Failed to create viewshed raster");
+  if (m_viewshedRasterBusy)
+  {
+    emit toolErrorOccurred(errorMessage, QStringLiteral("A viewshed raster is already being created"));
+    return false;
+  }
+
+  ViewshedParameters parameters;
+  if (!viewshedParameters(m_activeViewshed, parameters))
+  {
+    emit toolErrorOccurred(errorMessage, QStringLiteral("There is no active viewshed"));
+    return false;
+  }
+
+  const QString noElevation = QStringLiteral("No local elevation data covers the viewshed. Add DTED or GeoTIFF elevation sources first.");
+
+  ViewshedRaster cached;
+  ViewshedParameters fullCircle;
+  ElevationGrid grid;
+  const bool found = ViewshedCache::instance()->lookup(parameters, cached, fullCircle);
+  if (found && cached.isEmpty())
+  {
+    emit toolErrorOccurred(errorMessage, noElevation);
+    return false;
+  }
+
+  if (!found)
+  {
+    double west = 0.0;
+    double south = 0.0;
+    double east = 0.0;
+    double north = 0.0;
+    ViewshedEngine::extent(fullCircle, west, south, east, north);
+    grid = ElevationSampler::instance()->grid(west, south, east, north);
+    if (grid.isEmpty())
+    {
+      emit toolErrorOccurred(errorMessage, noElevation);
+      return false;
+    }
+  }
+
+  const QString name = m_activeViewshed->name();
+  const QString filePath = viewshedRasterPath(name);
+  const QStringList sources = ElevationSampler::instance()->filePaths();
+  auto computed = std::make_shared<ViewshedRaster>();
+
+  runViewshedRasterTask(errorMessage, [cached, grid, fullCircle, parameters, filePath, computed, noElevation]() -> QString
+  {
+    ViewshedRaster raster = cached;
+    if (raster.isEmpty())
+    {
+      *computed = ViewshedEngine::compute(grid, fullCircle);
+      if (computed->isEmpty())
+        return noElevation;
+
+      raster = computed->sector(fullCircle.x, fullCircle.y, parameters.heading, parameters.horizontalAngle);
+    }
+
+    QString errorString;
+    raster.writeGeoTiff(filePath, &errorString);
+    return errorString;
+  },
+  [this, fullCircle, computed, sources, filePath, name]()
+  {
+    ViewshedCache::instance()->insert(fullCircle, *computed, sources);
+    addViewshedRasterLayer(filePath, name, true);
+
+    emit viewshedRasterCreated(filePath);
+  });
+
+  return true;
+}
+
+/*!
+  \brief Counts how many of the viewsheds can see each cell of the terrain
+  and adds the result to the operational layers.
+
+  The counts are computed on the CPU from the local elevation rasters and
+  written to a GeoTIFF in the \c Viewsheds folder of the app's data path,
+  along with a mask of the cells seen by at least \a threshold viewsheds.
+  The mask is shown in green, over red where fewer viewsheds see the ground,
+  and the counts are added as a hidden layer.
+
+  As with \l createActiveViewshedRaster, the counts are computed and written
+  on a worker thread and \l viewshedRasterCreated is emitted once the layers
+  have been added.
+
+  Returns \c false if there are no viewsheds, no local elevation covers them,
+  or another viewshed raster is still being created.
+
+  \sa CumulativeViewshed, viewshedRasterBusy
+ */
+bool ViewshedController::createCumulativeViewshedRaster(int threshold)
+{
+  const QString errorMessage = QStringLiteral("Failed to create cumulative viewshed");
+  if (m_viewshedRasterBusy)
+  {
+    emit toolErrorOccurred(errorMessage, QStringLiteral("A viewshed raster is already being created"));
+    return false;
+  }
+
+  QList<ViewshedParameters> observers;
+  for (int i = 0; i < m_viewsheds->rowCount(); ++i)
+  {
+    ViewshedParameters parameters;
+    if (viewshedParameters(m_viewsheds->at(i), parameters))
+      observers.append(parameters);
+  }
+
+  if (observers.isEmpty())
+  {
+    emit toolErrorOccurred(errorMessage, QStringLiteral("There are no viewsheds"));
+    return false;
+  }
+
+  double west = 0.0;
+  double south = 0.0;
+  double east = 0.0;
+  double north = 0.0;
+  CumulativeViewshed::extent(observers, west, south, east, north);
+  const ElevationGrid grid = ElevationSampler::instance()->grid(west, south, east, north);
+  if (grid.isEmpty())
+  {
+    emit toolErrorOccurred(errorMessage,
+                           QStringLiteral("No local elevation data covers the viewsheds. Add DTED or GeoTIFF elevation sources first."));
+    return false;
+  }
+
+  const QString name = QString("Seen by %1 of %2 viewsheds").arg(QString::number(threshold), QString::number(observers.size()));
+  const QString countPath = viewshedRasterPath(QStringLiteral("Cumulative_viewshed_count"));
+  const QString maskPath = viewshedRasterPath(QString("Cumulative_viewshed_%1").arg(QString::number(threshold)));
+
+  runViewshedRasterTask(errorMessage, [grid, observers, threshold, countPath, maskPath]() -> QString
+  {
+    const CumulativeViewshedRaster raster = CumulativeViewshed::compute(grid, observers);
+
+    QString errorString;
+    if (raster.writeCountGeoTiff(countPath, &errorString))
+      raster.writeMaskGeoTiff(maskPath, threshold, &errorString);
+
+    return errorString;
+  },
+  [this, countPath, maskPath, name]()
+  {
+    addViewshedRasterLayer(countPath, QStringLiteral("Viewshed count"), false);
+    addViewshedRasterLayer(maskPath, name, true);
+
+    emit viewshedRasterCreated(maskPath);
+  });
+
+  return true;
+}
+
+/*!
+  \property ViewshedController::viewshedRasterBusy
+  \brief Returns whether a viewshed raster is being computed.
+
+  Only one viewshed raster is created at a time.
+ */
+bool ViewshedController::isViewshedRasterBusy() const
+{
+  return m_viewshedRasterBusy;
+}
+
 /*!
   \property ViewshedController::activeViewshedEnabled
   \brief Returns whether there is an active viewshed.
@@ -759,6 +966,151 @@ void ViewshedController::updateActiveViewshedSignals()
   m_activeViewshedConns << connect(m_activeViewshed, &Viewshed360::is360ModeChanged, this, &ViewshedController::activeViewshed360ModeChanged);
 }
 
+/*!
+  \internal
+
+  Returns a new GeoTIFF path for a raster called \a name. Each raster gets a
+  new file, as a layer may still be reading an earlier one.
+ */
+QString ViewshedController::viewshedRasterPath(const QString& name)
+{
+  const QDir directory(DsaUtility::dataPath() + QStringLiteral("/Viewsheds"));
+  directory.mkpath(QStringLiteral("."));
+
+  QString fileName = name;
+  fileName.replace(QRegExp(QStringLiteral("[^A-Za-z0-9_-]")), QStringLiteral("_"));
+
+  return directory.filePath(QString("%1_%2.tif").arg(fileName, QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMddhhmmss"))));
+}
+
+/*!
+  \internal
+
+  Adds the raster at \a filePath to the operational layers as \a name. A
+  \a visibility raster is coloured green where visible and red where not;
+  other rasters keep their default renderer and start hidden.
+ */
+void ViewshedController::addViewshedRasterLayer(const QString& filePath, const QString& name, bool visibility)
+{
+  auto operationalLayers = Toolkit::ToolResourceProvider::instance()->operationalLayers();
+  if (!operationalLayers)
+    return;
+
+  RasterLayer* rasterLayer = new RasterLayer(new Raster(filePath, this), this);
+  rasterLayer->setName(name);
+  rasterLayer->setVisible(visibility);
+  connect(rasterLayer, &RasterLayer::errorOccurred, this, [this](const Error& error)
+  {
+    emit toolErrorOccurred(error.message(), error.additionalMessage());
+  });
+
+  if (visibility)
+  {
+    QList<QColor> colors;
+    colors.reserve(256);
+    colors.append(QColor(255, 0, 0, 100));  // not visible
+    colors.append(QColor(0, 255, 0, 120));  // visible
+    while (colors.size() < 256)
+      colors.append(Qt::transparent);
+
+    rasterLayer->setRenderer(new ColormapRenderer(Colormap::create(colors, this), this));
+  }
+
+  operationalLayers->append(rasterLayer);
+}
+
+/*!
+  \internal
+
+  Runs \a task on the global thread pool and then \a finished on the GUI
+  thread. \a task returns an error string, which is reported with
+  \a errorMessage in place of calling \a finished if it is not empty.
+ */
+void ViewshedController::runViewshedRasterTask(const QString& errorMessage, const std::function<QString()>& task, const std::function<void()>& finished)
+{
+  m_viewshedRasterBusy = true;
+  emit viewshedRasterBusyChanged();
+
+  // the watcher is a child of this tool, so the result is dropped if the tool goes first
+  auto watcher = new QFutureWatcher<QString>(this);
+  connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, errorMessage, finished]()
+  {
+    const QString errorString = watcher->result();
+    watcher->deleteLater();
+
+    m_viewshedRasterBusy = false;
+    emit viewshedRasterBusyChanged();
+
+    if (!errorString.isEmpty())
+    {
+      emit toolErrorOccurred(errorMessage, errorString);
+      return;
+    }
+
+    finished();
+  });
+
+  watcher->setFuture(QtConcurrent::run(task));
+}
+
+/*!
+  \internal
+
+  Copies the observer and field of view of \a viewshed into \a parameters.
+ */
+bool ViewshedController::viewshedParameters(Viewshed360* viewshed, ViewshedParameters& parameters)
+{
+  if (!viewshed)
+    return false;
+
+  Point location;
+  double pitch = viewshed->pitch();
+  if (auto locationViewshed = dynamic_cast<LocationViewshed360*>(viewshed))
+  {
+    location = locationViewshed->point();
+  }
+  else if (auto geoElementViewshed = dynamic_cast<GeoElementViewshed360*>(viewshed))
+  {
+    if (!geoElementViewshed->geoElement())
+      return false;
+
+    location = geometry_cast<Point>(geoElementViewshed->geoElement()->geometry());
+
+    // a geoelement is pitched from the horizon, whereas a location viewshed is pitched from straight down
+    constexpr double horizonPitch = 90.0;
+    pitch += horizonPitch;
+  }
+
+  if (location.isEmpty())
+    return false;
+
+  if (location.spatialReference() != SpatialReference::wgs84())
+    location = geometry_cast<Point>(GeometryEngine::project(location, SpatialReference::wgs84()));
+
+  parameters.x = location.x();
+  parameters.y = location.y();
+  parameters.z = location.hasZ() ? location.z() : NAN;
+  parameters.offsetZ = viewshed->offsetZ();
+  parameters.minDistance = viewshed->minDistance();
+  parameters.maxDistance = viewshed->maxDistance();
+
+  // in 360 degree mode the runtime combines several viewsheds to look all around
+  if (viewshed->is360Mode())
+  {
+    parameters.horizontalAngle = 360.0;
+    parameters.verticalAngle = 180.0;
+  }
+  else
+  {
+    parameters.heading = viewshed->heading();
+    parameters.pitch = pitch;
+    parameters.horizontalAngle = viewshed->horizontalAngle();
+    parameters.verticalAngle = viewshed->verticalAngle();
+  }
+
+  return true;
+}
+
 /*!
   \internal
  */
@@ -890,6 +1242,24 @@ void ViewshedController::emitActiveViewshedSignals()
   \brief Signal emitted when currently active viewshed enabled changes.
  */
 
+/*!
+  \fn void ViewshedController::viewshedRasterBusyChanged();
+  \brief Signal emitted when a viewshed raster starts or finishes being computed.
+ */
+
+/*!
+  \fn void ViewshedController::viewshedRasterCreated(const QString& filePath);
+  \brief Signal emitted when a viewshed raster has been written to \a filePath and added as a layer.
+ */
+
+/*!
+  \fn void ViewshedController::toolErrorOccurred(const QString& errorMessage, const QString& additionalMessage);
+  \brief Signal emitted when an error occurs.
+
+  An \a errorMessage and \a additionalMessage are passed through as parameters, describing
+  the error that occurred.
+ */
+
 /*!
   \fn void ViewshedController::activeModeChanged();
   \brief Signal emitted when the active mode changes.
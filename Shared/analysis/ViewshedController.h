@@ -26,6 +26,9 @@
 // Qt headers
 #include <QAbstractListModel>
 
+// STL headers
+#include <functional>
+
 class QMouseEvent;
 
 namespace Esri {
@@ -43,6 +46,7 @@ namespace Dsa {
 
 class ViewshedListModel;
 class Viewshed360;
+struct ViewshedParameters;
 class GeoElementViewshed360;
 
 class ViewshedController : public Esri::ArcGISRuntime::Toolkit::AbstractTool
@@ -68,6 +72,7 @@ class ViewshedController : public Esri::ArcGISRuntime::Toolkit::AbstractTool
   Q_PROPERTY(bool activeViewshedOffsetZEnabled READ isActiveViewshedOffsetZEnabled NOTIFY activeViewshedOffsetZEnabledChanged)
   Q_PROPERTY(bool activeViewshed360Mode READ isActiveViewshed360Mode WRITE setActiveViewshed360Mode NOTIFY activeViewshed360ModeChanged)
   Q_PROPERTY(bool locationDisplayViewshedActive READ isLocationDisplayViewshedActive NOTIFY locationDisplayViewshedActiveChanged)
+  Q_PROPERTY(bool viewshedRasterBusy READ isViewshedRasterBusy NOTIFY viewshedRasterBusyChanged)
 
 signals:
   void activeModeChanged();
@@ -88,6 +93,9 @@ signals:
   void activeViewshedOffsetZEnabledChanged();
   void activeViewshed360ModeChanged();
   void locationDisplayViewshedActiveChanged();
+  void viewshedRasterBusyChanged();
+  void viewshedRasterCreated(const QString& filePath);
+  void toolErrorOccurred(const QString& errorMessage, const QString& additionalMessage);
 
 public:
   enum ViewshedActiveMode
@@ -125,6 +133,9 @@ public:
   Viewshed360* activeViewshed() const;
   Q_INVOKABLE void removeActiveViewshed();
   Q_INVOKABLE void finishActiveViewshed();
+  Q_INVOKABLE bool createActiveViewshedRaster();
+  Q_INVOKABLE bool createCumulativeViewshedRaster(int threshold = 1);
+  bool isViewshedRasterBusy() const;
 
   bool isActiveViewshedEnabled() const;
 
@@ -171,6 +182,11 @@ private:
   void disconnectActiveViewshedSignals();
   void emitActiveViewshedSignals();
 
+  static bool viewshedParameters(Viewshed360* viewshed, ViewshedParameters& parameters);
+  static QString viewshedRasterPath(const QString& name);
+  void addViewshedRasterLayer(const QString& filePath, const QString& name, bool visibility);
+  void runViewshedRasterTask(const QString& errorMessage, const std::function<QString()>& task, const std::function<void()>& finished);
+
   Esri::ArcGISRuntime::SceneView* m_sceneView = nullptr;
 
   Esri::ArcGISRuntime::AnalysisOverlay* m_analysisOverlay = nullptr;
@@ -183,6 +199,7 @@ private:
   GeoElementViewshed360* m_locationDisplayViewshed = nullptr;
 
   ViewshedActiveMode m_activeMode = ViewshedActiveMode::NoActiveMode;
+  bool m_viewshedRasterBusy = false;
 
   Esri::ArcGISRuntime::TaskWatcher m_identifyTaskWatcher;
   QMetaObject::Connection m_identifyConn;
@@ -0,0 +1,416 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+// PCH header
+#include "pch.hpp"
+
+#include "ViewshedEngine.h"
+
+// example app headers
+#include "ElevationGrid.h"
+#include "ElevationSampler.h"
+#include "GeoTiffWriter.h"
+#include "ParallelFor.h"
+
+// Qt headers
+#include <QObject>
+#include <QPair>
+
+// STL headers
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+
+namespace Dsa {
+
+constexpr double ViewshedEngine::RefractionCoefficient;
+
+namespace
+{
+const double earthRadius = 6371008.8;
+const double radiansToDegrees = 180.0 / M_PI;
+
+// rays are handed to the threads in this many runs of neighbouring rays
+const int sectorCount = 256;
+
+double angleDifference(double from, double to)
+{
+  double difference = std::fmod(to - from, 360.0);
+  if (difference < -180.0)
+    difference += 360.0;
+  else if (difference >= 180.0)
+    difference -= 360.0;
+
+  return difference;
+}
+
+// interpolates between two posts, leaving out one that is a void
+double interpolate(float first, float second, double t)
+{
+  if (std::isnan(first))
+    return second;
+
+  if (std::isnan(second))
+    return first;
+
+  return first + (second - first) * t;
+}
+}
+
+/*!
+  \class Dsa::ViewshedParameters
+  \inmodule Dsa
+  \brief The observer and field of view for a \l ViewshedEngine computation.
+
+  The distances, angles, heading and pitch mean the same as they do for
+  \l Viewshed360, so the parameters of an on screen viewshed can be copied
+  across directly. A horizontal angle of 360 and a vertical angle of 180 look
+  in every direction.
+ */
+
+/*!
+  \class Dsa::ViewshedRaster
+  \inmodule Dsa
+  \brief The result of a \l ViewshedEngine computation.
+
+  Each cell holds \c Visible, \c NotVisible, or \c NotAnalyzed for cells
+  outside the field of view, outside the distance range, or without
+  elevation data.
+ */
+
+/*!
+  \brief Returns whether the raster has no cells.
+ */
+bool ViewshedRaster::isEmpty() const
+{
+  return width <= 0 || height <= 0 || values.size() != width * height;
+}
+
+/*!
+  \brief Returns whether the cell at \a x, \a y in WGS84 degrees is visible.
+ */
+bool ViewshedRaster::isVisible(double x, double y) const
+{
+  return value(x, y) == Visible;
+}
+
+/*!
+  \brief Returns the value of the cell at \a x, \a y in WGS84 degrees.
+
+  Locations outside the raster are \c NotAnalyzed.
+ */
+quint8 ViewshedRaster::value(double x, double y) const
+{
+  if (isEmpty())
+    return NotAnalyzed;
+
+  const long column = std::lround((x - originX) / spacingX);
+  const long row = std::lround((originY - y) / spacingY);
+  if (column < 0 || row < 0 || column >= width || row >= height)
+    return NotAnalyzed;
+
+  return values.at(static_cast<int>(row * width + column));
+}
+
+/*!
+  \brief Returns the number of visible cells.
+ */
+int ViewshedRaster::visibleCount() const
+{
+  return static_cast<int>(std::count(values.cbegin(), values.cend(), static_cast<quint8>(Visible)));
+}
+
+/*!
+  \brief Returns a copy of the raster cut down to the \a horizontalAngle
+  degrees centred on \a heading, as seen from \a observerX, \a observerY in
+  WGS84 degrees.
+
+  Cells outside the sector become \c NotAnalyzed. Since the engine decides
+  each cell's visibility without regard to the horizontal angle, cutting a
+  360 degree viewshed gives the same result as computing the sector.
+ */
+ViewshedRaster ViewshedRaster::sector(double observerX, double observerY, double heading, double horizontalAngle) const
+{
+  ViewshedRaster result(*this);
+  if (isEmpty() || horizontalAngle >= 360.0)
+    return result;
+
+  // measured as the engine does, from the post nearest the observer
+  const double cellX = spacingX * ElevationGrid::metersPerDegreeX(observerY);
+  const double cellY = spacingY * ElevationGrid::metersPerDegreeY(observerY);
+  const long observerColumn = std::lround((observerX - originX) / spacingX);
+  const long observerRow = std::lround((originY - observerY) / spacingY);
+  const double halfAngle = horizontalAngle * 0.5;
+
+  quint8* cells = result.values.data();
+  for (int row = 0; row < height; ++row)
+  {
+    const double north = (observerRow - row) * cellY;
+    for (int column = 0; column < width; ++column, ++cells)
+    {
+      if (*cells == NotAnalyzed || (column == observerColumn && row == observerRow))
+        continue;
+
+      const double east = (column - observerColumn) * cellX;
+      if (std::abs(angleDifference(heading, std::atan2(east, north) * radiansToDegrees)) > halfAngle)
+        *cells = NotAnalyzed;
+    }
+  }
+
+  return result;
+}
+
+/*!
+  \brief Writes the raster to the GeoTIFF at \a filePath.
+
+  \c NotAnalyzed cells are marked as having no data. Returns \c false, with
+  the reason in \a errorString if set, if the file could not be written.
+
+  \sa GeoTiffWriter
+ */
+bool ViewshedRaster::writeGeoTiff(const QString& filePath, QString* errorString) const
+{
+  if (isEmpty())
+  {
+    if (errorString)
+      *errorString = QObject::tr("The viewshed is empty");
+
+    return false;
+  }
+
+  return GeoTiffWriter::write(filePath, values.constData(), width, height, GeoTiffWriter::SampleType::UInt8,
+                              originX, originY, spacingX, spacingY, NotAnalyzed, errorString);
+}
+
+/*!
+  \class Dsa::ViewshedEngine
+  \inmodule Dsa
+  \brief Computes viewsheds on the CPU from the local elevation rasters.
+
+  The runtime's \c Viewshed analyses are drawn by the GPU and can only be
+  seen in a scene view. This engine produces a \l ViewshedRaster instead,
+  which can be queried, exported as a GeoTIFF and shown as a raster layer,
+  and which needs no view at all, so it can be used for batch planning.
+
+  Visibility is found with the R2 radial sweep. A ray is cast from the
+  observer to every cell on the edge of the area within \c maxDistance. Along
+  each ray the terrain is interpolated between the two posts either side of
+  it, and a cell is visible if the slope to it is no less than the steepest
+  slope to the terrain before it. Slopes allow for the curvature of the earth
+  and for refraction. Rays are independent, so runs of neighbouring rays,
+  each an angular sector, are traced in parallel. Where several rays cross a
+  cell it is visible if any of them sees it.
+
+  \sa ElevationSampler, Viewshed360
+ */
+
+/*!
+  \brief Returns the viewshed for \a parameters, using elevations from the
+  rasters added to the \l ElevationSampler.
+
+  Returns an empty raster if no raster covers the observer. This must be
+  called from the GUI thread, as the sampler is used to read the elevations.
+ */
+ViewshedRaster ViewshedEngine::compute(const ViewshedParameters& parameters)
+{
+  ElevationSampler* sampler = ElevationSampler::instance();
+  if (!sampler->hasData())
+    return ViewshedRaster();
+
+  double west = 0.0;
+  double south = 0.0;
+  double east = 0.0;
+  double north = 0.0;
+  extent(parameters, west, south, east, north);
+
+  return compute(sampler->grid(west, south, east, north), parameters);
+}
+
+/*!
+  \brief Returns the viewshed for \a parameters over the elevation posts in \a grid.
+
+  The result is lined up with the posts of \a grid and covers the part of it
+  within \c maxDistance of the observer. Returns an empty raster if the grid
+  has no elevation at the observer.
+
+  Only \a grid is read, so this may be called from any thread, and several
+  calls may share one grid.
+ */
+ViewshedRaster ViewshedEngine::compute(const ElevationGrid& grid, const ViewshedParameters& parameters)
+{
+  ViewshedRaster result;
+
+  const double groundZ = grid.elevation(parameters.x, parameters.y);
+  if (std::isnan(groundZ) || !(parameters.maxDistance > 0.0))
+    return result;
+
+  // an observer below the ground is raised up to it
+  const double observerZ = (std::isnan(parameters.z) ? groundZ : qMax(parameters.z, groundZ)) + parameters.offsetZ;
+
+  // the cells are treated as flat rectangles sized at the observer's latitude
+  const double cellX = grid.spacingX * ElevationGrid::metersPerDegreeX(parameters.y);
+  const double cellY = grid.spacingY * ElevationGrid::metersPerDegreeY(parameters.y);
+  const double cellDiagonal = std::hypot(cellX, cellY);
+
+  const int observerColumn = static_cast<int>(std::lround((parameters.x - grid.originX) / grid.spacingX));
+  const int observerRow = static_cast<int>(std::lround((grid.originY - parameters.y) / grid.spacingY));
+  const int radiusX = static_cast<int>(std::ceil(parameters.maxDistance / cellX));
+  const int radiusY = static_cast<int>(std::ceil(parameters.maxDistance / cellY));
+
+  const int firstColumn = qMax(0, observerColumn - radiusX);
+  const int lastColumn = qMin(grid.width - 1, observerColumn + radiusX);
+  const int firstRow = qMax(0, observerRow - radiusY);
+  const int lastRow = qMin(grid.height - 1, observerRow + radiusY);
+
+  result.width = lastColumn - firstColumn + 1;
+  result.height = lastRow - firstRow + 1;
+  result.originX = grid.x(firstColumn);
+  result.originY = grid.y(firstRow);
+  result.spacingX = grid.spacingX;
+  result.spacingY = grid.spacingY;
+
+  const int cellCount = result.width * result.height;
+  std::unique_ptr<std::atomic<quint8>[]> cells(new std::atomic<quint8>[cellCount]);
+  for (int i = 0; i < cellCount; ++i)
+    cells[i].store(ViewshedRaster::NotAnalyzed, std::memory_order_relaxed);
+
+  const double curvature = (1.0 - RefractionCoefficient) / (2.0 * earthRadius);
+  const bool limitHorizontal = parameters.horizontalAngle < 360.0;
+  const double halfHorizontalAngle = parameters.horizontalAngle * 0.5;
+  const bool limitVertical = parameters.verticalAngle < 180.0;
+  const double lowestAngle = parameters.pitch - 90.0 - parameters.verticalAngle * 0.5;
+  const double highestAngle = parameters.pitch - 90.0 + parameters.verticalAngle * 0.5;
+
+  // a cell seen by any ray stays visible
+  auto mark = [&](int column, int row, bool visible)
+  {
+    std::atomic<quint8>& cell = cells[(row - firstRow) * result.width + column - firstColumn];
+    if (visible)
+    {
+      cell.store(ViewshedRaster::Visible, std::memory_order_relaxed);
+    }
+    else
+    {
+      quint8 expected = ViewshedRaster::NotAnalyzed;
+      cell.compare_exchange_strong(expected, ViewshedRaster::NotVisible, std::memory_order_relaxed);
+    }
+  };
+
+  auto traceRay = [&](int targetColumn, int targetRow)
+  {
+    const int deltaColumn = targetColumn - observerColumn;
+    const int deltaRow = targetRow - observerRow;
+    const int steps = qMax(std::abs(deltaColumn), std::abs(deltaRow));
+    const bool alongRows = std::abs(deltaColumn) >= std::abs(deltaRow);
+    double maxSlope = -std::numeric_limits<double>::infinity();
+
+    for (int step = 1; step <= steps; ++step)
+    {
+      const double rayColumn = observerColumn + static_cast<double>(deltaColumn) * step / steps;
+      const double rayRow = observerRow + static_cast<double>(deltaRow) * step / steps;
+      const double rayDistance = std::hypot((rayColumn - observerColumn) * cellX, (rayRow - observerRow) * cellY);
+      if (rayDistance > parameters.maxDistance + cellDiagonal)
+        break;
+
+      // the cell that the ray passes through
+      const int column = static_cast<int>(std::lround(rayColumn));
+      const int row = static_cast<int>(std::lround(rayRow));
+
+      // the terrain under the ray, between the two posts either side of it
+      double terrainZ = NAN;
+      if (alongRows)
+      {
+        const int below = static_cast<int>(std::floor(rayRow));
+        terrainZ = interpolate(grid.value(column, below), grid.value(column, below + 1), rayRow - below);
+      }
+      else
+      {
+        const int left = static_cast<int>(std::floor(rayColumn));
+        terrainZ = interpolate(grid.value(left, row), grid.value(left + 1, row), rayColumn - left);
+      }
+
+      const float cellZ = grid.value(column, row);
+      const double east = (column - observerColumn) * cellX;
+      const double north = (observerRow - row) * cellY;
+      const double distance = std::hypot(east, north);
+
+      if (!std::isnan(cellZ) && distance >= parameters.minDistance && distance <= parameters.maxDistance &&
+          column >= firstColumn && column <= lastColumn && row >= firstRow && row <= lastRow)
+      {
+        const double slope = (cellZ + parameters.targetOffsetZ - distance * distance * curvature - observerZ) / distance;
+        const double elevationAngle = std::atan(slope) * radiansToDegrees;
+        const bool inHorizontal = !limitHorizontal ||
+            std::abs(angleDifference(parameters.heading, std::atan2(east, north) * radiansToDegrees)) <= halfHorizontalAngle;
+        const bool inVertical = !limitVertical || (elevationAngle >= lowestAngle && elevationAngle <= highestAngle);
+
+        if (inHorizontal && inVertical)
+          mark(column, row, slope >= maxSlope);
+      }
+
+      if (!std::isnan(terrainZ))
+        maxSlope = qMax(maxSlope, (terrainZ - rayDistance * rayDistance * curvature - observerZ) / rayDistance);
+    }
+  };
+
+  // the cells around the edge of the area, in order around the observer
+  QVector<QPair<int, int>> perimeter;
+  perimeter.reserve(2 * (result.width + result.height));
+  for (int column = firstColumn; column <= lastColumn; ++column)
+    perimeter.append(qMakePair(column, firstRow));
+  for (int row = firstRow + 1; row <= lastRow; ++row)
+    perimeter.append(qMakePair(lastColumn, row));
+  for (int column = lastColumn - 1; column >= firstColumn && lastRow > firstRow; --column)
+    perimeter.append(qMakePair(column, lastRow));
+  for (int row = lastRow - 1; row > firstRow && lastColumn > firstColumn; --row)
+    perimeter.append(qMakePair(firstColumn, row));
+
+  const int sectors = qMin(sectorCount, perimeter.size());
+  parallelFor(0, sectors, [&](int sector)
+  {
+    const int first = static_cast<int>(static_cast<qint64>(sector) * perimeter.size() / sectors);
+    const int last = static_cast<int>(static_cast<qint64>(sector + 1) * perimeter.size() / sectors);
+    for (int i = first; i < last; ++i)
+      traceRay(perimeter.at(i).first, perimeter.at(i).second);
+  });
+
+  if (parameters.minDistance <= 0.0)
+    mark(observerColumn, observerRow, true);
+
+  result.values.resize(cellCount);
+  for (int i = 0; i < cellCount; ++i)
+    result.values[i] = cells[i].load(std::memory_order_relaxed);
+
+  return result;
+}
+
+/*!
+  \brief Sets \a west, \a south, \a east and \a north to the WGS84 extent
+  that a viewshed for \a parameters can reach.
+ */
+void ViewshedEngine::extent(const ViewshedParameters& parameters, double& west, double& south, double& east, double& north)
+{
+  const double halfWidth = parameters.maxDistance / ElevationGrid::metersPerDegreeX(parameters.y);
+  const double halfHeight = parameters.maxDistance / ElevationGrid::metersPerDegreeY(parameters.y);
+
+  west = parameters.x - halfWidth;
+  east = parameters.x + halfWidth;
+  south = qMax(-90.0, parameters.y - halfHeight);
+  north = qMin(90.0, parameters.y + halfHeight);
+}
+
+} // Dsa
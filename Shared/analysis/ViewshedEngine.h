@@ -0,0 +1,100 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef VIEWSHEDENGINE_H
+#define VIEWSHEDENGINE_H
+
+// Qt headers
+#include <QString>
+#include <QVector>
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+struct ElevationGrid;
+
+struct ViewshedParameters
+{
+  // the observer in WGS84 degrees; a NaN z places the observer on the ground
+  double x = NAN;
+  double y = NAN;
+  double z = NAN;
+
+  // heights in meters added to the observer and to every target
+  double offsetZ = 0.0;
+  double targetOffsetZ = 0.0;
+
+  double minDistance = 0.0;
+  double maxDistance = 1000.0;
+
+  // degrees; a pitch of 90 looks at the horizon
+  double heading = 0.0;
+  double pitch = 90.0;
+  double horizontalAngle = 360.0;
+  double verticalAngle = 180.0;
+};
+
+struct ViewshedRaster
+{
+  enum Value : quint8
+  {
+    NotVisible = 0,
+    Visible = 1,
+    NotAnalyzed = 255
+  };
+
+  bool isEmpty() const;
+  bool isVisible(double x, double y) const;
+  quint8 value(double x, double y) const;
+  int visibleCount() const;
+
+  ViewshedRaster sector(double observerX, double observerY, double heading, double horizontalAngle) const;
+
+  bool writeGeoTiff(const QString& filePath, QString* errorString = nullptr) const;
+
+  int width = 0;
+  int height = 0;
+
+  // the centre of the north-west cell and the cell spacing in WGS84 degrees,
+  // lined up with the posts of the elevation grid
+  double originX = 0.0;
+  double originY = 0.0;
+  double spacingX = 0.0;
+  double spacingY = 0.0;
+
+  QVector<quint8> values;
+};
+
+class ViewshedEngine
+{
+public:
+  static ViewshedRaster compute(const ViewshedParameters& parameters);
+  static ViewshedRaster compute(const ElevationGrid& grid, const ViewshedParameters& parameters);
+
+  static void extent(const ViewshedParameters& parameters, double& west, double& south, double& east, double& north);
+
+  static constexpr double RefractionCoefficient = 0.13;
+
+private:
+  ViewshedEngine() = delete;
+};
+
+} // Dsa
+
+#endif // VIEWSHEDENGINE_H
@@ -33,5 +33,13 @@ const QString MessageFeedConstants::MESSAGE_FEEDS_RENDERER = QStringLiteral("ren
 const QString MessageFeedConstants::MESSAGE_FEEDS_THUMBNAIL = QStringLiteral("thumbnail");
 const QString MessageFeedConstants::MESSAGE_FEEDS_PLACEMENT = QStringLiteral("placement");
 const QString MessageFeedConstants::MESSAGE_FEED_UDP_PORTS_PROPERTYNAME = QStringLiteral("MessageFeedUdpPorts");
+const QString MessageFeedConstants::ENTITY_SIMULATION_CONFIG_PROPERTYNAME = QStringLiteral("EntitySimulationConfig");
+const QString MessageFeedConstants::ENTITY_SIMULATION_CONFIG_ENABLED = QStringLiteral("enabled");
+const QString MessageFeedConstants::ENTITY_SIMULATION_CONFIG_GPX_FILES = QStringLiteral("gpxFiles");
+const QString MessageFeedConstants::ENTITY_SIMULATION_CONFIG_OUTPUT = QStringLiteral("output");
+const QString MessageFeedConstants::ENTITY_SIMULATION_CONFIG_PORT = QStringLiteral("port");
+const QString MessageFeedConstants::ENTITY_SIMULATION_CONFIG_UPDATE_INTERVAL = QStringLiteral("updateInterval");
+const QString MessageFeedConstants::ENTITY_SIMULATION_OUTPUT_INBOUND = QStringLiteral("inbound");
+const QString MessageFeedConstants::ENTITY_SIMULATION_OUTPUT_OUTBOUND = QStringLiteral("outbound");
 
 } // Dsa
@@ -39,6 +39,14 @@ public:
   static const QString MESSAGE_FEEDS_THUMBNAIL;
   static const QString MESSAGE_FEEDS_PLACEMENT;
   static const QString MESSAGE_FEED_UDP_PORTS_PROPERTYNAME;
+  static const QString ENTITY_SIMULATION_CONFIG_PROPERTYNAME;
+  static const QString ENTITY_SIMULATION_CONFIG_ENABLED;
+  static const QString ENTITY_SIMULATION_CONFIG_GPX_FILES;
+  static const QString ENTITY_SIMULATION_CONFIG_OUTPUT;
+  static const QString ENTITY_SIMULATION_CONFIG_PORT;
+  static const QString ENTITY_SIMULATION_CONFIG_UPDATE_INTERVAL;
+  static const QString ENTITY_SIMULATION_OUTPUT_INBOUND;
+  static const QString ENTITY_SIMULATION_OUTPUT_OUTBOUND;
 };
 
 } // Dsa
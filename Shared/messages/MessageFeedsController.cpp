@@ -24,11 +24,16 @@
 #include "AppConstants.h"
 #include "DataListener.h"
 #include "DataSender.h"
+#include "EntitySimulator.h"
+#include "GraphicsUpdateBatcher.h"
 #include "LocationBroadcast.h"
 #include "Message.h"
 #include "MessageFeed.h"
 #include "MessageFeedConstants.h"
 #include "MessageFeedListModel.h"
+#include "MessageLatencyTracker.h"
+#include "MessagePlayer.h"
+#include "MessageRecorder.h"
 #include "MessagesOverlay.h"
 
 // toolkit headers
@@ -42,8 +47,11 @@
 #include "SimpleRenderer.h"
 
 // Qt headers
+#include <QDir>
 #include <QFileInfo>
 #include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QUdpSocket>
 
 using namespace Esri::ArcGISRuntime;
@@ -65,13 +73,36 @@ const QString MessageFeedsController::RESOURCE_DIRECTORY_PROPERTYNAME = "Resourc
 MessageFeedsController::MessageFeedsController(QObject* parent) :
   Toolkit::AbstractTool(parent),
   m_messageFeeds(new MessageFeedListModel(this)),
-  m_locationBroadcast(new LocationBroadcast(this))
+  m_locationBroadcast(new LocationBroadcast(this)),
+  m_recorder(new MessageRecorder(this))
 {
+  connect(m_recorder, &MessageRecorder::recordingChanged, this, &MessageFeedsController::recordingChanged);
+  connect(m_recorder, &MessageRecorder::errorOccurred, this, [this](const QString& error)
+  {
+    emit toolErrorOccurred(QStringLiteral("Message recording failed"), error);
+  });
+
   connect(Toolkit::ToolResourceProvider::instance(), &Toolkit::ToolResourceProvider::geoViewChanged, this, [this]
   {
     setGeoView(Toolkit::ToolResourceProvider::instance()->geoView());
   });
 
+  // message updates reach the graphics, and so the alert conditions, when the batcher commits them
+  GraphicsUpdateBatcher* batcher = GraphicsUpdateBatcher::instance();
+  MessageLatencyTracker* latencyTracker = MessageLatencyTracker::instance();
+  connect(batcher, &GraphicsUpdateBatcher::updateCommitting, this, [latencyTracker](quint64 tag)
+  {
+    latencyTracker->updateCommitting(tag);
+  });
+  connect(batcher, &GraphicsUpdateBatcher::updateCommitted, this, [latencyTracker](quint64 tag)
+  {
+    latencyTracker->updateCommitted(tag);
+  });
+  connect(batcher, &GraphicsUpdateBatcher::updateDropped, this, [latencyTracker](quint64 tag)
+  {
+    latencyTracker->updateDropped(tag);
+  });
+
   Toolkit::ToolManager::instance().addTool(this);
 }
 
@@ -126,23 +157,16 @@ void MessageFeedsController::addDataListener(DataListener* dataListener)
 
   m_dataListeners.append(dataListener);
 
-  connect(dataListener, &DataListener::dataReceived, this, [this](const QByteArray& data)
+  connect(dataListener, &DataListener::dataReceived, this, [this, dataListener](const QByteArray& data)
   {
-    Message m = Message::create(data);
-    if (m.isEmpty())
-      return;
-
-    if (m_locationBroadcast->isEnabled())
-    {
-      if (m_locationBroadcast->message().messageId() == m.messageId()) // do not display our own location broadcast message
-        return;
-    }
-
-    MessageFeed* messageFeed = m_messageFeeds->messageFeedByType(m.messageType());
-    if (!messageFeed)
-      return;
-
-    messageFeed->messagesOverlay()->addMessage(m);
+    // played back messages are not recorded again
+    if (dataListener != m_playerListener)
+      m_recorder->record(data);
+
+    // alert transitions caused by the message happen while it is handled
+    MessageLatencyTracker::instance()->messageReceived(data);
+    handleDataReceived(data);
+    MessageLatencyTracker::instance()->messageFinished();
   });
 }
 
@@ -171,6 +195,158 @@ QString MessageFeedsController::toolName() const
   return QStringLiteral("messages");
 }
 
+/*!
+  \property MessageFeedsController::recording
+  \brief Returns \c true if the messages received are being recorded.
+ */
+bool MessageFeedsController::isRecording() const
+{
+  return m_recorder->isRecording();
+}
+
+/*!
+  \brief Starts recording the raw messages received by every data listener
+  into \a directory. Returns \c false if the recording could not be started.
+
+  \sa MessageRecorder
+ */
+bool MessageFeedsController::startRecording(const QUrl& directory)
+{
+  return m_recorder->start(directory.isLocalFile() ? directory.toLocalFile() : directory.toString());
+}
+
+/*!
+  \brief Stops recording messages.
+ */
+void MessageFeedsController::stopRecording()
+{
+  m_recorder->stop();
+}
+
+/*!
+  \property MessageFeedsController::playingBack
+  \brief Returns \c true if a recording is being played back.
+ */
+bool MessageFeedsController::isPlayingBack() const
+{
+  return m_player != nullptr;
+}
+
+/*!
+  \brief Plays back the recording in \a directory through the message feeds
+  at \a speed times the recorded rate, or as fast as possible if \a speed is 0.
+  Returns \c false if the recording could not be read.
+
+  \sa MessagePlayer
+ */
+bool MessageFeedsController::startPlayback(const QUrl& directory, double speed)
+{
+  stopPlayback();
+
+  m_player = new MessagePlayer(this);
+  connect(m_player, &MessagePlayer::errorOccurred, this, [this](const QString& error)
+  {
+    emit toolErrorOccurred(QStringLiteral("Message playback failed"), error);
+  });
+
+  if (!m_player->load(directory.isLocalFile() ? directory.toLocalFile() : directory.toString()))
+  {
+    delete m_player;
+    m_player = nullptr;
+    return false;
+  }
+
+  // the recording goes through the same path as the live feeds
+  m_playerListener = new DataListener(m_player, this);
+  addDataListener(m_playerListener);
+
+  connect(m_player, &MessagePlayer::finished, this, &MessageFeedsController::stopPlayback, Qt::QueuedConnection);
+
+  m_player->setSpeed(speed);
+  m_player->play();
+
+  emit playingBackChanged();
+  return true;
+}
+
+/*!
+  \brief Stops playing back a recording.
+ */
+void MessageFeedsController::stopPlayback()
+{
+  if (!m_player)
+    return;
+
+  removeDataListener(m_playerListener);
+  delete m_playerListener;
+  m_playerListener = nullptr;
+
+  delete m_player;
+  m_player = nullptr;
+
+  emit playingBackChanged();
+}
+
+/*!
+  \brief Returns the latency statistics of messages tagged by the message simulator as JSON text.
+
+  The report also gives, under \c graphicsUpdates, the number of graphic
+  changes requested through the \l GraphicsUpdateBatcher and the number
+  applied once intermediate states were dropped.
+
+  \sa MessageLatencyTracker::report
+ */
+QString MessageFeedsController::latencyReport() const
+{
+  const GraphicsUpdateBatcher* batcher = GraphicsUpdateBatcher::instance();
+  QJsonObject graphicsUpdates;
+  graphicsUpdates.insert(QStringLiteral("requested"), static_cast<double>(batcher->requestedUpdateCount()));
+  graphicsUpdates.insert(QStringLiteral("committed"), static_cast<double>(batcher->committedUpdateCount()));
+
+  QJsonObject report = MessageLatencyTracker::instance()->report();
+  report.insert(QStringLiteral("graphicsUpdates"), graphicsUpdates);
+
+  return QString::fromUtf8(QJsonDocument(report).toJson());
+}
+
+/*!
+  \brief Clears the latency statistics.
+ */
+void MessageFeedsController::resetLatencyStatistics()
+{
+  MessageLatencyTracker::instance()->reset();
+}
+
+void MessageFeedsController::handleDataReceived(const QByteArray& data)
+{
+  Message m = Message::create(data);
+  if (m.isEmpty())
+    return;
+
+  MessageLatencyTracker::instance()->messageParsed();
+
+  if (m_locationBroadcast->isEnabled())
+  {
+    if (m_locationBroadcast->message().messageId() == m.messageId()) // do not display our own location broadcast message
+      return;
+  }
+
+  MessageFeed* messageFeed = m_messageFeeds->messageFeedByType(m.messageType());
+  if (!messageFeed)
+    return;
+
+  // updates to existing graphics are only drawn, and so only measured, at the next frame
+  MessageLatencyTracker* latencyTracker = MessageLatencyTracker::instance();
+  const quint64 updateTag = latencyTracker->messageQueued();
+  const bool added = messageFeed->messagesOverlay()->addMessage(m, updateTag);
+  if (GraphicsUpdateBatcher::instance()->isPending(updateTag))
+    return;
+
+  latencyTracker->updateDropped(updateTag);
+  if (added)
+    latencyTracker->messageApplied();
+}
+
 void MessageFeedsController::setupFeeds()
 {
   // parse and add message feeds
@@ -259,6 +435,54 @@ void MessageFeedsController::setProperties(const QVariantMap& properties)
     m_locationBroadcast->setMessageType(locationBroadcastConfig.value(MessageFeedConstants::LOCATION_BROADCAST_CONFIG_MESSAGE_TYPE).toString());
     m_locationBroadcast->setUdpPort(locationBroadcastConfig.value(MessageFeedConstants::LOCATION_BROADCAST_CONFIG_PORT).toInt());
   }
+
+  // only start the entity simulation at startup
+  if (!m_entitySimulator)
+    setupEntitySimulation(properties);
+}
+
+/*!
+  \internal
+
+  Starts simulating entities along the GPX tracks given in the entity
+  simulation config, if it is enabled. Inbound messages are handled as if
+  they had been received on a message feed; outbound messages are broadcast
+  for other devices.
+ */
+void MessageFeedsController::setupEntitySimulation(const QVariantMap& properties)
+{
+  const auto entitySimulationConfig = properties[MessageFeedConstants::ENTITY_SIMULATION_CONFIG_PROPERTYNAME].toMap();
+  if (!entitySimulationConfig.value(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_ENABLED).toBool())
+    return;
+
+  m_entitySimulator = new EntitySimulator(this);
+  connect(m_entitySimulator, &EntitySimulator::errorOccurred, this, [this](const QString& error)
+  {
+    emit toolErrorOccurred(QStringLiteral("Entity simulation failed"), error);
+  });
+
+  // relative paths are in the simulation data directory
+  const QDir simulationDirectory(properties[QStringLiteral("SimulationDirectory")].toString());
+  QStringList gpxFiles;
+  const auto gpxFileNames = entitySimulationConfig.value(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_GPX_FILES).toStringList();
+  for (const auto& gpxFileName : gpxFileNames)
+    gpxFiles.append(simulationDirectory.absoluteFilePath(gpxFileName));
+
+  m_entitySimulator->loadGpxFiles(gpxFiles);
+  m_entitySimulator->setUpdateInterval(entitySimulationConfig.value(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_UPDATE_INTERVAL, 1000).toInt());
+
+  if (entitySimulationConfig.value(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_OUTPUT).toString() == MessageFeedConstants::ENTITY_SIMULATION_OUTPUT_OUTBOUND)
+  {
+    m_entitySimulator->setOutput(EntitySimulator::Output::OutboundBroadcast);
+    m_entitySimulator->setUdpPort(entitySimulationConfig.value(MessageFeedConstants::ENTITY_SIMULATION_CONFIG_PORT, -1).toInt());
+  }
+  else
+  {
+    m_entitySimulator->setOutput(EntitySimulator::Output::InboundMessages);
+    m_entitySimulator->setMessageFeedsController(this);
+  }
+
+  m_entitySimulator->start();
 }
 
 /*!
@@ -467,6 +691,16 @@ Renderer* MessageFeedsController::createRenderer(const QString& rendererInfo, QO
   \brief Signal emitted when the \l locationBroadcastInDistress property changes.
  */
 
+/*!
+  \fn void MessageFeedsController::recordingChanged();
+  \brief Signal emitted when the \l recording property changes.
+ */
+
+/*!
+  \fn void MessageFeedsController::playingBackChanged();
+  \brief Signal emitted when the \l playingBack property changes.
+ */
+
 } // Dsa
 
 /*!
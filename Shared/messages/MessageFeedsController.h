@@ -22,6 +22,7 @@
 
 // Qt headers
 #include <QAbstractListModel>
+#include <QUrl>
 #include <QVariantList>
 
 namespace Esri {
@@ -35,8 +36,10 @@ namespace Esri {
 namespace Dsa {
 
 class DataListener;
-
+class EntitySimulator;
 class LocationBroadcast;
+class MessagePlayer;
+class MessageRecorder;
 
 class MessageFeedListModel;
 
@@ -48,6 +51,8 @@ class MessageFeedsController : public Esri::ArcGISRuntime::Toolkit::AbstractTool
   Q_PROPERTY(bool locationBroadcastEnabled READ isLocationBroadcastEnabled WRITE setLocationBroadcastEnabled NOTIFY locationBroadcastEnabledChanged)
   Q_PROPERTY(int locationBroadcastFrequency READ locationBroadcastFrequency WRITE setLocationBroadcastFrequency NOTIFY locationBroadcastFrequencyChanged)
   Q_PROPERTY(bool locationBroadcastInDistress READ isLocationBroadcastInDistress WRITE setLocationBroadcastInDistress NOTIFY locationBroadcastInDistressChanged)
+  Q_PROPERTY(bool recording READ isRecording NOTIFY recordingChanged)
+  Q_PROPERTY(bool playingBack READ isPlayingBack NOTIFY playingBackChanged)
 
 public:
   static const QString RESOURCE_DIRECTORY_PROPERTYNAME;
@@ -80,16 +85,31 @@ public:
   bool isLocationBroadcastInDistress() const;
   void setLocationBroadcastInDistress(bool inDistress);
 
+  bool isRecording() const;
+  Q_INVOKABLE bool startRecording(const QUrl& directory);
+  Q_INVOKABLE void stopRecording();
+
+  bool isPlayingBack() const;
+  Q_INVOKABLE bool startPlayback(const QUrl& directory, double speed = 1.0);
+  Q_INVOKABLE void stopPlayback();
+
+  Q_INVOKABLE QString latencyReport() const;
+  Q_INVOKABLE void resetLatencyStatistics();
+
   static Esri::ArcGISRuntime::SurfacePlacement toSurfacePlacement(const QString& surfacePlacement);
 
 signals:
   void locationBroadcastEnabledChanged();
   void locationBroadcastFrequencyChanged();
   void locationBroadcastInDistressChanged();
+  void recordingChanged();
+  void playingBackChanged();
   void toolErrorOccurred(const QString& errorMessage, const QString& additionalMessage);
 
 private:
   void setupFeeds();
+  void setupEntitySimulation(const QVariantMap& properties);
+  void handleDataReceived(const QByteArray& data);
   Esri::ArcGISRuntime::Renderer* createRenderer(const QString& rendererInfo, QObject* parent = nullptr) const;
 
   Esri::ArcGISRuntime::GeoView* m_geoView = nullptr;
@@ -98,6 +118,10 @@ private:
   QList<DataListener*> m_dataListeners;
   QString m_resourcePath;
   LocationBroadcast* m_locationBroadcast = nullptr;
+  MessageRecorder* m_recorder = nullptr;
+  MessagePlayer* m_player = nullptr;
+  DataListener* m_playerListener = nullptr;
+  EntitySimulator* m_entitySimulator = nullptr;
   QVariantList m_messageFeedProperties;
 };
 
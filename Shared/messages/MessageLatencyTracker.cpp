@@ -0,0 +1,391 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "MessageLatencyTracker.h"
+
+// Qt headers
+#include <QDateTime>
+#include <QJsonArray>
+
+namespace Dsa {
+
+namespace
+{
+// bucket i holds latencies from 2^i up to 2^(i+1) microseconds, so that
+// 32 buckets span everything from a microsecond to over an hour
+const int bucketCount = 32;
+const int stageCount = 5;
+
+const char* const stageNames[stageCount] = { "network", "parse", "overlay", "alert", "endToEnd" };
+
+int bucketIndex(qint64 microseconds)
+{
+  int index = 0;
+  while (microseconds > 1 && index < bucketCount - 1)
+  {
+    microseconds >>= 1;
+    index++;
+  }
+
+  return index;
+}
+
+qint64 tagValue(const QByteArray& tag, const QByteArray& name)
+{
+  const int nameStart = tag.indexOf(' ' + name + "=\"");
+  if (nameStart == -1)
+    return -1;
+
+  const int valueStart = nameStart + name.size() + 3;
+  const int valueEnd = tag.indexOf('"', valueStart);
+  if (valueEnd == -1)
+    return -1;
+
+  bool ok = false;
+  const qint64 value = tag.mid(valueStart, valueEnd - valueStart).toLongLong(&ok);
+  return ok ? value : -1;
+}
+}
+
+/*!
+  \class Dsa::MessageLatencyTracker
+  \inmodule Dsa
+  \brief Measures how long tagged messages take to pass through the app.
+
+  The message simulator can prefix each message with a comment of the form
+  \c {<!--dsa-latency sender="1" seq="42" sent="1539000000000"-->}, giving the
+  sending time in milliseconds since the epoch. For every tagged message the
+  tracker records latency histograms, in microseconds, for these stages:
+
+  \list
+    \li \c network - from sending to receipt. This relies on the sending and
+    receiving clocks agreeing and only has millisecond resolution.
+    \li \c parse - from receipt to a parsed \l Message.
+    \li \c overlay - from the parsed message to its graphic being updated.
+    \li \c alert - from receipt to an alert condition changing state as a
+    direct result of the message.
+    \li \c endToEnd - from sending to the graphic being updated.
+  \endlist
+
+  Changes to existing graphics are applied by the \l GraphicsUpdateBatcher
+  at the next frame, so such a message is given a tag by \l messageQueued
+  and its \c overlay, \c endToEnd and \c alert stages are only recorded
+  once the batcher applies the change with that tag. A message overtaken by
+  a later one for the same graphic before the frame is never drawn and
+  records none of these stages.
+
+  Untagged messages are ignored. The tracker is only used from the
+  thread that processes the message feeds.
+ */
+
+/*!
+  \brief Returns the singleton instance of the tracker.
+ */
+MessageLatencyTracker* MessageLatencyTracker::instance()
+{
+  static MessageLatencyTracker s_instance;
+
+  return &s_instance;
+}
+
+/*!
+  \internal
+ */
+MessageLatencyTracker::MessageLatencyTracker()
+{
+  m_clock.start();
+  reset();
+}
+
+/*!
+  \brief Destructor.
+ */
+MessageLatencyTracker::~MessageLatencyTracker()
+{
+}
+
+/*!
+  \brief Starts tracking the raw message \a data if it carries a latency tag.
+ */
+void MessageLatencyTracker::messageReceived(const QByteArray& data)
+{
+  m_inFlight = false;
+
+  if (!data.startsWith(tagPrefix()))
+    return;
+
+  const int tagEnd = data.indexOf("-->", tagPrefix().size());
+  if (tagEnd == -1)
+    return;
+
+  const QByteArray tag = data.left(tagEnd);
+  const qint64 sender = tagValue(tag, QByteArrayLiteral("sender"));
+  const qint64 sequence = tagValue(tag, QByteArrayLiteral("seq"));
+  const qint64 sentTime = tagValue(tag, QByteArrayLiteral("sent"));
+  if (sentTime < 0)
+    return;
+
+  m_current = Measurement{sentTime, m_clock.nsecsElapsed(), 0, false};
+  m_inFlight = true;
+  m_messagesTracked++;
+
+  record(Stage::Network, (QDateTime::currentMSecsSinceEpoch() - sentTime) * 1000);
+
+  // gaps in the sequence of each sender are counted as lost messages until
+  // they turn up late
+  if (sender < 0 || sequence < 0)
+    return;
+
+  const auto senderId = static_cast<quint32>(sender);
+  const auto lastSequence = m_lastSequences.find(senderId);
+  if (lastSequence == m_lastSequences.end())
+  {
+    m_lastSequences.insert(senderId, sequence);
+  }
+  else if (sequence > lastSequence.value())
+  {
+    m_messagesLost += sequence - lastSequence.value() - 1;
+    lastSequence.value() = sequence;
+  }
+  else
+  {
+    m_messagesOutOfOrder++;
+    if (m_messagesLost > 0)
+      m_messagesLost--;
+  }
+}
+
+/*!
+  \brief Records that the message being tracked has been parsed.
+ */
+void MessageLatencyTracker::messageParsed()
+{
+  if (!m_inFlight)
+    return;
+
+  m_current.parsedNs = m_clock.nsecsElapsed();
+  record(Stage::Parse, (m_current.parsedNs - m_current.receivedNs) / 1000);
+}
+
+/*!
+  \brief Records that the message being tracked has been applied to its
+  overlay straight away, as when it adds or removes a graphic.
+ */
+void MessageLatencyTracker::messageApplied()
+{
+  if (!m_inFlight)
+    return;
+
+  recordApplied();
+}
+
+/*!
+  \brief Returns a tag for the change the message being tracked is about to
+  queue with the \l GraphicsUpdateBatcher, or \c 0 if it is not tracked.
+
+  The remaining stages are recorded once the change with the tag is
+  committed; \l updateDropped must be called if it is never queued.
+ */
+quint64 MessageLatencyTracker::messageQueued()
+{
+  if (!m_inFlight)
+    return 0;
+
+  m_queued.insert(++m_lastTag, m_current);
+  return m_lastTag;
+}
+
+/*!
+  \brief Records that an alert condition changed state.
+
+  Only the first transition caused by the message being tracked is recorded.
+ */
+void MessageLatencyTracker::alertTransition()
+{
+  if (!m_inFlight || m_current.alerted)
+    return;
+
+  m_current.alerted = true;
+  record(Stage::Alert, (m_clock.nsecsElapsed() - m_current.receivedNs) / 1000);
+}
+
+/*!
+  \brief Stops tracking the current message.
+ */
+void MessageLatencyTracker::messageFinished()
+{
+  m_inFlight = false;
+}
+
+/*!
+  \brief Tracks the message queued with \a tag again while its change is
+  committed, so that the alert transitions it causes are recorded.
+
+  \sa GraphicsUpdateBatcher::updateCommitting
+ */
+void MessageLatencyTracker::updateCommitting(quint64 tag)
+{
+  const auto it = m_queued.constFind(tag);
+  if (it == m_queued.constEnd())
+    return;
+
+  // frames are drawn between messages, never while one is being handled
+  m_current = it.value();
+  m_inFlight = true;
+}
+
+/*!
+  \brief Records the \c overlay and \c endToEnd stages of the message
+  queued with \a tag, now that its change has been committed.
+
+  \sa GraphicsUpdateBatcher::updateCommitted
+ */
+void MessageLatencyTracker::updateCommitted(quint64 tag)
+{
+  if (!m_queued.remove(tag) || !m_inFlight)
+    return;
+
+  recordApplied();
+  m_inFlight = false;
+}
+
+/*!
+  \brief Forgets the message queued with \a tag, whose change will never be drawn.
+
+  \sa GraphicsUpdateBatcher::updateDropped
+ */
+void MessageLatencyTracker::updateDropped(quint64 tag)
+{
+  m_queued.remove(tag);
+}
+
+/*!
+  \brief Returns the message counts and a summary of each stage histogram as JSON.
+
+  Each stage reports its count, minimum, mean, 50th, 90th and 99th percentiles
+  and maximum in microseconds, along with the non-empty histogram buckets.
+  Percentiles are resolved to the upper bound of their bucket.
+ */
+QJsonObject MessageLatencyTracker::report() const
+{
+  QJsonObject stages;
+  for (int i = 0; i < stageCount; ++i)
+    stages.insert(QString::fromLatin1(stageNames[i]), toJson(m_histograms.at(i)));
+
+  QJsonObject report;
+  report.insert(QStringLiteral("messages"), static_cast<double>(m_messagesTracked));
+  report.insert(QStringLiteral("lost"), static_cast<double>(m_messagesLost));
+  report.insert(QStringLiteral("outOfOrder"), static_cast<double>(m_messagesOutOfOrder));
+  report.insert(QStringLiteral("stages"), stages);
+
+  return report;
+}
+
+/*!
+  \brief Clears all recorded latencies and message counts.
+ */
+void MessageLatencyTracker::reset()
+{
+  m_histograms = QVector<Histogram>(stageCount, Histogram{QVector<qint64>(bucketCount, 0), 0, 0, 0, 0.0});
+  m_lastSequences.clear();
+  m_messagesTracked = 0;
+  m_messagesLost = 0;
+  m_messagesOutOfOrder = 0;
+  m_inFlight = false;
+  m_queued.clear();
+}
+
+/*!
+  \internal
+ */
+void MessageLatencyTracker::record(Stage stage, qint64 microseconds)
+{
+  // clocks on different machines can disagree; never record a negative latency
+  microseconds = qMax<qint64>(0, microseconds);
+
+  Histogram& histogram = m_histograms[static_cast<int>(stage)];
+  histogram.buckets[bucketIndex(microseconds)]++;
+  histogram.minimum = histogram.count == 0 ? microseconds : qMin(histogram.minimum, microseconds);
+  histogram.maximum = qMax(histogram.maximum, microseconds);
+  histogram.sum += microseconds;
+  histogram.count++;
+}
+
+/*!
+  \internal
+
+  Records the \c overlay and \c endToEnd stages of the current message.
+ */
+void MessageLatencyTracker::recordApplied()
+{
+  record(Stage::Overlay, (m_clock.nsecsElapsed() - m_current.parsedNs) / 1000);
+  record(Stage::EndToEnd, (QDateTime::currentMSecsSinceEpoch() - m_current.sentTime) * 1000);
+}
+
+/*!
+  \internal
+ */
+QJsonObject MessageLatencyTracker::toJson(const Histogram& histogram)
+{
+  QJsonObject json;
+  json.insert(QStringLiteral("count"), static_cast<double>(histogram.count));
+  if (histogram.count == 0)
+    return json;
+
+  json.insert(QStringLiteral("min"), static_cast<double>(histogram.minimum));
+  json.insert(QStringLiteral("mean"), histogram.sum / histogram.count);
+  json.insert(QStringLiteral("p50"), static_cast<double>(percentile(histogram, 0.5)));
+  json.insert(QStringLiteral("p90"), static_cast<double>(percentile(histogram, 0.9)));
+  json.insert(QStringLiteral("p99"), static_cast<double>(percentile(histogram, 0.99)));
+  json.insert(QStringLiteral("max"), static_cast<double>(histogram.maximum));
+
+  QJsonArray buckets;
+  for (int i = 0; i < histogram.buckets.size(); ++i)
+  {
+    if (histogram.buckets.at(i) == 0)
+      continue;
+
+    QJsonObject bucket;
+    bucket.insert(QStringLiteral("upTo"), static_cast<double>(qint64(1) << (i + 1)));
+    bucket.insert(QStringLiteral("count"), static_cast<double>(histogram.buckets.at(i)));
+    buckets.append(bucket);
+  }
+
+  json.insert(QStringLiteral("buckets"), buckets);
+  return json;
+}
+
+/*!
+  \internal
+ */
+qint64 MessageLatencyTracker::percentile(const Histogram& histogram, double fraction)
+{
+  const double target = fraction * histogram.count;
+  qint64 cumulative = 0;
+  for (int i = 0; i < histogram.buckets.size(); ++i)
+  {
+    cumulative += histogram.buckets.at(i);
+    if (cumulative >= target)
+      return qMin(qint64(1) << (i + 1), histogram.maximum);
+  }
+
+  return histogram.maximum;
+}
+
+} // Dsa
@@ -0,0 +1,106 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef MESSAGELATENCYTRACKER_H
+#define MESSAGELATENCYTRACKER_H
+
+// Qt headers
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QVector>
+
+namespace Dsa {
+
+class MessageLatencyTracker
+{
+public:
+  // defined here so that the message simulator, which writes the tags, shares it without linking the tracker
+  static QByteArray tagPrefix() { return QByteArrayLiteral("<!--dsa-latency "); }
+
+  enum class Stage
+  {
+    Network = 0,
+    Parse = 1,
+    Overlay = 2,
+    Alert = 3,
+    EndToEnd = 4
+  };
+
+  static MessageLatencyTracker* instance();
+
+  ~MessageLatencyTracker();
+
+  void messageReceived(const QByteArray& data);
+  void messageParsed();
+  void messageApplied();
+  quint64 messageQueued();
+  void alertTransition();
+  void messageFinished();
+
+  void updateCommitting(quint64 tag);
+  void updateCommitted(quint64 tag);
+  void updateDropped(quint64 tag);
+
+  QJsonObject report() const;
+  void reset();
+
+private:
+  Q_DISABLE_COPY(MessageLatencyTracker)
+  MessageLatencyTracker();
+
+  struct Histogram
+  {
+    QVector<qint64> buckets;
+    qint64 count;
+    qint64 minimum;
+    qint64 maximum;
+    double sum;
+  };
+
+  // the stages of one tagged message still to be recorded
+  struct Measurement
+  {
+    qint64 sentTime;
+    qint64 receivedNs;
+    qint64 parsedNs;
+    bool alerted;
+  };
+
+  void record(Stage stage, qint64 microseconds);
+  void recordApplied();
+  static QJsonObject toJson(const Histogram& histogram);
+  static qint64 percentile(const Histogram& histogram, double fraction);
+
+  QVector<Histogram> m_histograms;
+  QHash<quint32, qint64> m_lastSequences;
+  qint64 m_messagesTracked = 0;
+  qint64 m_messagesLost = 0;
+  qint64 m_messagesOutOfOrder = 0;
+
+  // the message currently being processed, if it carried a latency tag, and
+  // the messages whose graphics are waiting for the next frame
+  QElapsedTimer m_clock;
+  Measurement m_current = Measurement{0, 0, 0, false};
+  bool m_inFlight = false;
+  QHash<quint64, Measurement> m_queued;
+  quint64 m_lastTag = 0;
+};
+
+} // Dsa
+
+#endif // MESSAGELATENCYTRACKER_H
@@ -0,0 +1,363 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "MessagePlayer.h"
+
+// example app headers
+#include "MessageRecorder.h"
+
+// Qt headers
+#include <QDir>
+#include <QtEndian>
+
+// C++ headers
+#include <algorithm>
+
+namespace Dsa {
+
+namespace
+{
+// larger payloads are treated as a damaged recording
+const quint32 maxPayloadSize = 64 * 1024 * 1024;
+
+bool readHeader(QFile& file)
+{
+  uchar header[8];
+  if (file.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header))
+    return false;
+
+  return qFromBigEndian<quint32>(header) == MessageRecorder::FILE_MAGIC &&
+         qFromBigEndian<quint32>(header + 4) == MessageRecorder::FORMAT_VERSION;
+}
+}
+
+/*!
+  \class Dsa::MessagePlayer
+  \inmodule Dsa
+  \inherits MessageFeedDevice
+  \brief Plays back a recording made by \l MessageRecorder.
+
+  The player is a \l MessageFeedDevice that reads its messages from the
+  recording as they fall due, so recorded payloads go through the same
+  ingestion path as live ones. Each payload is delivered at its recorded
+  time scaled by \l speed. A speed of 0 plays the recording as fast as
+  possible.
+
+  \l seekToTime uses the sparse index of the recording to find the
+  position without reading the records before it.
+ */
+
+/*!
+  \brief Constructor taking an optional \a parent.
+ */
+MessagePlayer::MessagePlayer(QObject* parent) :
+  MessageFeedDevice(parent)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+MessagePlayer::~MessagePlayer()
+{
+}
+
+/*!
+  \brief Loads the recording in \a directory and opens the device at its first record.
+
+  Returns \c false if the recording cannot be read.
+ */
+bool MessagePlayer::load(const QString& directory)
+{
+  close();
+
+  m_directory = directory;
+
+  if (!loadIndex())
+    return false;
+
+  if (!openSegment(0, MessageRecorder::FILE_HEADER_SIZE) || !readRecord())
+  {
+    emit errorOccurred(QString("%1 contains no messages").arg(m_directory));
+    return false;
+  }
+
+  return open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+/*!
+  \brief Returns the directory of the loaded recording.
+ */
+QString MessagePlayer::directory() const
+{
+  return m_directory;
+}
+
+/*!
+  \brief Returns the receive time of the first record, in milliseconds since
+  the epoch, or -1 if no recording is loaded.
+ */
+qint64 MessagePlayer::startTime() const
+{
+  return m_index.isEmpty() ? -1 : m_index.first().time;
+}
+
+/*!
+  \brief Returns the playback speed relative to the recorded times.
+ */
+double MessagePlayer::speed() const
+{
+  return m_speed;
+}
+
+/*!
+  \brief Sets the playback \a speed relative to the recorded times.
+
+  A speed of 0 plays the recording as fast as possible.
+ */
+void MessagePlayer::setSpeed(double speed)
+{
+  m_speed = qMax(0.0, speed);
+
+  // continue from the next record at the new speed
+  if (isRunning())
+    restartClock();
+}
+
+/*!
+  \brief Starts or resumes playback from the next record.
+ */
+void MessagePlayer::play()
+{
+  if (!m_hasRecord)
+    return;
+
+  restartClock();
+}
+
+/*!
+  \brief Pauses playback.
+ */
+void MessagePlayer::pause()
+{
+  stop();
+}
+
+/*!
+  \brief Moves playback to the first record received at or after \a time,
+  in milliseconds since the epoch. Returns \c false if there is no such record.
+ */
+bool MessagePlayer::seekToTime(qint64 time)
+{
+  if (m_index.isEmpty())
+    return false;
+
+  // start from the last indexed record before the requested time
+  auto entry = std::upper_bound(m_index.cbegin(), m_index.cend(), time, [](qint64 t, const IndexEntry& e)
+  {
+    return t < e.time;
+  });
+
+  const bool found = entry == m_index.cbegin() ?
+                       openSegment(0, MessageRecorder::FILE_HEADER_SIZE) :
+                       openSegment((entry - 1)->segment, (entry - 1)->offset);
+
+  if (!found)
+    return false;
+
+  while (readRecord() && m_recordTime < time)
+    ;
+
+  if (m_hasRecord && isRunning())
+    restartClock();
+
+  return m_hasRecord;
+}
+
+/*!
+  \reimp
+ */
+void MessagePlayer::close()
+{
+  m_segment.close();
+  m_segmentNumber = -1;
+  m_index.clear();
+  m_hasRecord = false;
+  m_record.clear();
+
+  MessageFeedDevice::close();
+}
+
+/*!
+  \reimp
+ */
+qint64 MessagePlayer::writeData(const char* /*data*/, qint64 /*maxSize*/)
+{
+  return -1;
+}
+
+/*!
+  \reimp
+ */
+bool MessagePlayer::hasNextMessage() const
+{
+  return m_hasRecord;
+}
+
+/*!
+  \reimp
+
+  The recorded time of the next record is converted to wall clock time at
+  the current \l speed.
+ */
+qint64 MessagePlayer::nextMessageTime() const
+{
+  if (m_speed <= 0.0)
+    return -1;
+
+  return static_cast<qint64>((m_recordTime - m_clockStartTime) / m_speed);
+}
+
+/*!
+  \reimp
+ */
+QByteArray MessagePlayer::takeNextMessage()
+{
+  const QByteArray record = m_record;
+  readRecord();
+  return record;
+}
+
+/*!
+  \reimp
+
+  A recording is always played once.
+ */
+bool MessagePlayer::rewind()
+{
+  return false;
+}
+
+/*!
+  \internal
+ */
+bool MessagePlayer::loadIndex()
+{
+  QFile indexFile(QDir(m_directory).filePath(MessageRecorder::INDEX_FILE_NAME));
+  if (!indexFile.open(QFile::ReadOnly) || !readHeader(indexFile))
+  {
+    emit errorOccurred(QString("%1 is not a message recording").arg(m_directory));
+    return false;
+  }
+
+  // a partly written last entry is ignored
+  const QByteArray entries = indexFile.readAll();
+  const int entryCount = entries.size() / MessageRecorder::INDEX_ENTRY_SIZE;
+  m_index.reserve(entryCount);
+
+  for (int i = 0; i < entryCount; ++i)
+  {
+    const uchar* entry = reinterpret_cast<const uchar*>(entries.constData()) + i * MessageRecorder::INDEX_ENTRY_SIZE;
+    m_index.append(IndexEntry{qFromBigEndian<qint64>(entry),
+                              static_cast<int>(qFromBigEndian<quint32>(entry + 8)),
+                              qFromBigEndian<qint64>(entry + 12)});
+  }
+
+  return true;
+}
+
+/*!
+  \internal
+ */
+bool MessagePlayer::openSegment(int segmentNumber, qint64 offset)
+{
+  m_hasRecord = false;
+
+  if (m_segmentNumber != segmentNumber || !m_segment.isOpen())
+  {
+    m_segment.close();
+    m_segment.setFileName(QDir(m_directory).filePath(MessageRecorder::segmentFileName(segmentNumber)));
+    if (!m_segment.open(QFile::ReadOnly))
+      return false;
+
+    if (!readHeader(m_segment))
+    {
+      emit errorOccurred(QString("%1 is not a message recording segment").arg(m_segment.fileName()));
+      m_segment.close();
+      return false;
+    }
+
+    m_segmentNumber = segmentNumber;
+  }
+
+  return m_segment.seek(offset);
+}
+
+/*!
+  \internal
+ */
+bool MessagePlayer::readRecord()
+{
+  m_hasRecord = false;
+
+  if (!m_segment.isOpen())
+    return false;
+
+  // continue into the next segment, if there is one
+  if (m_segment.atEnd() && !openSegment(m_segmentNumber + 1, MessageRecorder::FILE_HEADER_SIZE))
+    return false;
+
+  uchar header[12];
+  if (m_segment.read(reinterpret_cast<char*>(header), sizeof(header)) != sizeof(header))
+    return false;
+
+  const quint32 payloadSize = qFromBigEndian<quint32>(header + 8);
+  if (payloadSize > maxPayloadSize)
+  {
+    emit errorOccurred(QString("%1 is damaged").arg(m_segment.fileName()));
+    return false;
+  }
+
+  // a record cut short by the app stopping ends the recording
+  m_record = m_segment.read(payloadSize);
+  if (static_cast<quint32>(m_record.size()) != payloadSize)
+    return false;
+
+  m_recordTime = qFromBigEndian<qint64>(header);
+  m_hasRecord = true;
+  return true;
+}
+
+/*!
+  \internal
+ */
+void MessagePlayer::restartClock()
+{
+  // the recording continues from the next record's time
+  m_clockStartTime = m_recordTime;
+  resume();
+}
+
+} // Dsa
+
+// Signal Documentation
+/*!
+  \fn void MessagePlayer::errorOccurred(const QString& error);
+  \brief Signal emitted when an \a error occurs.
+ */
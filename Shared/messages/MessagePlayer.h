@@ -0,0 +1,93 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef MESSAGEPLAYER_H
+#define MESSAGEPLAYER_H
+
+// example app headers
+#include "MessageFeedDevice.h"
+
+// Qt headers
+#include <QFile>
+#include <QVector>
+
+namespace Dsa {
+
+class MessagePlayer : public MessageFeedDevice
+{
+  Q_OBJECT
+
+public:
+  explicit MessagePlayer(QObject* parent = nullptr);
+  ~MessagePlayer();
+
+  bool load(const QString& directory);
+  QString directory() const;
+
+  qint64 startTime() const;
+
+  double speed() const;
+  void setSpeed(double speed);
+
+  void play();
+  void pause();
+  bool seekToTime(qint64 time);
+
+  void close() override;
+
+signals:
+  void errorOccurred(const QString& error);
+
+protected:
+  qint64 writeData(const char* data, qint64 maxSize) override;
+
+  bool hasNextMessage() const override;
+  qint64 nextMessageTime() const override;
+  QByteArray takeNextMessage() override;
+  bool rewind() override;
+
+private:
+  Q_DISABLE_COPY(MessagePlayer)
+
+  struct IndexEntry
+  {
+    qint64 time;
+    int segment;
+    qint64 offset;
+  };
+
+  bool loadIndex();
+  bool openSegment(int segmentNumber, qint64 offset);
+  bool readRecord();
+  void restartClock();
+
+  QString m_directory;
+  QVector<IndexEntry> m_index;
+  QFile m_segment;
+  int m_segmentNumber = -1;
+
+  // the next record to deliver
+  bool m_hasRecord = false;
+  qint64 m_recordTime = 0;
+  QByteArray m_record;
+
+  double m_speed = 1.0;
+  qint64 m_clockStartTime = 0;
+};
+
+} // Dsa
+
+#endif // MESSAGEPLAYER_H
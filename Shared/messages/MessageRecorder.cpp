@@ -0,0 +1,242 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "MessageRecorder.h"
+
+// example app headers
+#include "MessageRecordingWriter.h"
+
+// Qt headers
+#include <QDateTime>
+#include <QDir>
+#include <QtEndian>
+
+namespace Dsa {
+
+const quint32 MessageRecorder::FILE_MAGIC = 0x4453414D; // "DSAM"
+const quint32 MessageRecorder::FORMAT_VERSION = 1;
+const int MessageRecorder::FILE_HEADER_SIZE = 8;
+const int MessageRecorder::RECORD_HEADER_SIZE = 12;
+const int MessageRecorder::INDEX_ENTRY_SIZE = 20;
+const qint64 MessageRecorder::INDEX_INTERVAL_MS = 1000;
+const qint64 MessageRecorder::DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+const QString MessageRecorder::INDEX_FILE_NAME = QStringLiteral("index.dsaidx");
+
+namespace
+{
+// buffered records are handed to the writer thread at least this often
+const int flushIntervalMs = 250;
+
+// or as soon as this many bytes are waiting
+const int flushSize = 1024 * 1024;
+}
+
+/*!
+  \class Dsa::MessageRecorder
+  \inmodule Dsa
+  \inherits QObject
+  \brief Records raw inbound message payloads with their receive times.
+
+  A recording is a directory of segment files and one index file. All
+  integers are big-endian.
+
+  \list
+    \li Each segment file, \c segment-NNNNNN.dsamsg, starts with the magic
+    number and format version (4 bytes each), followed by records. A record
+    is the receive time in milliseconds since the epoch (8 bytes), the
+    payload length (4 bytes) and the payload. A new segment is started once
+    a segment reaches \l segmentSize.
+    \li The index file, \c index.dsaidx, starts with the same header and
+    holds a sparse index of entries: a receive time (8 bytes), a segment
+    number (4 bytes) and the offset of the record in that segment
+    (8 bytes). An entry is written for the first record received after
+    every second.
+  \endlist
+
+  Records are buffered and written on a background thread.
+
+  \sa MessagePlayer
+ */
+
+/*!
+  \brief Constructor taking an optional \a parent.
+ */
+MessageRecorder::MessageRecorder(QObject* parent) :
+  QObject(parent),
+  m_writer(new MessageRecordingWriter()),
+  m_segmentSize(DEFAULT_SEGMENT_SIZE)
+{
+  m_writer->moveToThread(&m_writerThread);
+  connect(&m_writerThread, &QThread::finished, m_writer, &QObject::deleteLater);
+  connect(m_writer, &MessageRecordingWriter::errorOccurred, this, &MessageRecorder::errorOccurred);
+  m_writerThread.start();
+
+  m_flushTimer.setInterval(flushIntervalMs);
+  connect(&m_flushTimer, &QTimer::timeout, this, &MessageRecorder::flush);
+}
+
+/*!
+  \brief Destructor.
+ */
+MessageRecorder::~MessageRecorder()
+{
+  stop();
+
+  m_writerThread.quit();
+  m_writerThread.wait();
+}
+
+/*!
+  \brief Returns the name of the segment file numbered \a segmentNumber.
+ */
+QString MessageRecorder::segmentFileName(int segmentNumber)
+{
+  return QString("segment-%1.dsamsg").arg(segmentNumber, 6, 10, QLatin1Char('0'));
+}
+
+/*!
+  \property MessageRecorder::recording
+  \brief Returns whether messages are being recorded.
+ */
+bool MessageRecorder::isRecording() const
+{
+  return m_recording;
+}
+
+/*!
+  \brief Returns the directory of the current or last recording.
+ */
+QString MessageRecorder::directory() const
+{
+  return m_directory;
+}
+
+/*!
+  \brief Returns the size in bytes at which a new segment file is started.
+ */
+qint64 MessageRecorder::segmentSize() const
+{
+  return m_segmentSize;
+}
+
+/*!
+  \brief Sets the size in bytes at which a new segment file is started to \a segmentSize.
+
+  Takes effect when the next recording is started.
+ */
+void MessageRecorder::setSegmentSize(qint64 segmentSize)
+{
+  m_segmentSize = qMax<qint64>(FILE_HEADER_SIZE + RECORD_HEADER_SIZE, segmentSize);
+}
+
+/*!
+  \brief Starts a recording in \a directory, which is created if needed.
+
+  Returns \c false if the directory cannot be created or already holds a recording.
+ */
+bool MessageRecorder::start(const QString& directory)
+{
+  stop();
+
+  const QDir recordingDir(directory);
+  if (!QDir().mkpath(directory))
+  {
+    emit errorOccurred(QString("Failed to create %1").arg(directory));
+    return false;
+  }
+
+  if (recordingDir.exists(INDEX_FILE_NAME))
+  {
+    emit errorOccurred(QString("%1 already contains a recording").arg(directory));
+    return false;
+  }
+
+  m_directory = directory;
+  QMetaObject::invokeMethod(m_writer, "open", Qt::QueuedConnection,
+                            Q_ARG(QString, m_directory),
+                            Q_ARG(qint64, m_segmentSize));
+
+  m_recording = true;
+  m_flushTimer.start();
+
+  emit recordingChanged();
+  return true;
+}
+
+/*!
+  \brief Stops recording, returning once everything received has been written.
+ */
+void MessageRecorder::stop()
+{
+  if (!m_recording)
+    return;
+
+  m_recording = false;
+  m_flushTimer.stop();
+  flush();
+
+  QMetaObject::invokeMethod(m_writer, "close", Qt::BlockingQueuedConnection);
+
+  emit recordingChanged();
+}
+
+/*!
+  \brief Records the message payload \a data, received now.
+ */
+void MessageRecorder::record(const QByteArray& data)
+{
+  if (!m_recording)
+    return;
+
+  // only the encoding is done here; the file writes happen on the writer thread
+  uchar header[RECORD_HEADER_SIZE];
+  qToBigEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header);
+  qToBigEndian<quint32>(static_cast<quint32>(data.size()), header + 8);
+
+  m_buffer.append(reinterpret_cast<const char*>(header), RECORD_HEADER_SIZE);
+  m_buffer.append(data);
+
+  if (m_buffer.size() >= flushSize)
+    flush();
+}
+
+/*!
+  \internal
+ */
+void MessageRecorder::flush()
+{
+  if (m_buffer.isEmpty())
+    return;
+
+  QMetaObject::invokeMethod(m_writer, "write", Qt::QueuedConnection, Q_ARG(QByteArray, m_buffer));
+  m_buffer.clear();
+}
+
+} // Dsa
+
+// Signal Documentation
+/*!
+  \fn void MessageRecorder::recordingChanged();
+  \brief Signal emitted when the \l recording property changes.
+ */
+
+/*!
+  \fn void MessageRecorder::errorOccurred(const QString& error);
+  \brief Signal emitted when an \a error occurs.
+ */
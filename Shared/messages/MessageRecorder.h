@@ -0,0 +1,83 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef MESSAGERECORDER_H
+#define MESSAGERECORDER_H
+
+// Qt headers
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+
+namespace Dsa {
+
+class MessageRecordingWriter;
+
+class MessageRecorder : public QObject
+{
+  Q_OBJECT
+
+  Q_PROPERTY(bool recording READ isRecording NOTIFY recordingChanged)
+
+public:
+  static const quint32 FILE_MAGIC;
+  static const quint32 FORMAT_VERSION;
+  static const int FILE_HEADER_SIZE;
+  static const int RECORD_HEADER_SIZE;
+  static const int INDEX_ENTRY_SIZE;
+  static const qint64 INDEX_INTERVAL_MS;
+  static const qint64 DEFAULT_SEGMENT_SIZE;
+  static const QString INDEX_FILE_NAME;
+
+  explicit MessageRecorder(QObject* parent = nullptr);
+  ~MessageRecorder();
+
+  static QString segmentFileName(int segmentNumber);
+
+  bool isRecording() const;
+  QString directory() const;
+
+  qint64 segmentSize() const;
+  void setSegmentSize(qint64 segmentSize);
+
+  bool start(const QString& directory);
+  void stop();
+
+  void record(const QByteArray& data);
+
+signals:
+  void recordingChanged();
+  void errorOccurred(const QString& error);
+
+private:
+  Q_DISABLE_COPY(MessageRecorder)
+
+  void flush();
+
+  QThread m_writerThread;
+  MessageRecordingWriter* m_writer = nullptr;
+  QByteArray m_buffer;
+  QTimer m_flushTimer;
+  QString m_directory;
+  qint64 m_segmentSize;
+  bool m_recording = false;
+};
+
+} // Dsa
+
+#endif // MESSAGERECORDER_H
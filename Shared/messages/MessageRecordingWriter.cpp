@@ -0,0 +1,180 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "MessageRecordingWriter.h"
+
+// example app headers
+#include "MessageRecorder.h"
+
+// Qt headers
+#include <QDir>
+#include <QtEndian>
+
+namespace Dsa {
+
+namespace
+{
+bool writeHeader(QFile& file)
+{
+  uchar header[8];
+  qToBigEndian<quint32>(MessageRecorder::FILE_MAGIC, header);
+  qToBigEndian<quint32>(MessageRecorder::FORMAT_VERSION, header + 4);
+  return file.write(reinterpret_cast<const char*>(header), sizeof(header)) == sizeof(header);
+}
+}
+
+/*!
+  \class Dsa::MessageRecordingWriter
+  \inmodule Dsa
+  \inherits QObject
+  \brief Writes the records of a \l MessageRecorder to disk on the recorder's thread.
+ */
+
+/*!
+  \brief Constructor taking an optional \a parent.
+ */
+MessageRecordingWriter::MessageRecordingWriter(QObject* parent) :
+  QObject(parent)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+MessageRecordingWriter::~MessageRecordingWriter()
+{
+  close();
+}
+
+/*!
+  \brief Starts writing a recording to \a directory, with segments of at most \a segmentSize bytes.
+ */
+void MessageRecordingWriter::open(const QString& directory, qint64 segmentSize)
+{
+  close();
+
+  m_directory = directory;
+  m_segmentSize = segmentSize;
+  m_lastIndexedTime = -1;
+
+  m_index.setFileName(QDir(m_directory).filePath(MessageRecorder::INDEX_FILE_NAME));
+  if (!m_index.open(QFile::WriteOnly) || !writeHeader(m_index))
+  {
+    emit errorOccurred(QString("Failed to create %1").arg(m_index.fileName()));
+    m_index.close();
+    return;
+  }
+
+  openSegment(0);
+}
+
+/*!
+  \brief Appends the encoded \a records to the recording.
+ */
+void MessageRecordingWriter::write(const QByteArray& records)
+{
+  if (!m_segment.isOpen())
+    return;
+
+  const int headerSize = MessageRecorder::RECORD_HEADER_SIZE;
+  int position = 0;
+  while (position + headerSize <= records.size())
+  {
+    const uchar* header = reinterpret_cast<const uchar*>(records.constData() + position);
+    const qint64 time = qFromBigEndian<qint64>(header);
+    const int recordSize = headerSize + static_cast<int>(qFromBigEndian<quint32>(header + 8));
+
+    // records are never split across segments
+    if (m_segment.pos() > MessageRecorder::FILE_HEADER_SIZE && m_segment.pos() + recordSize > m_segmentSize)
+    {
+      if (!openSegment(m_segmentNumber + 1))
+        return;
+    }
+
+    if (m_lastIndexedTime < 0 || time - m_lastIndexedTime >= MessageRecorder::INDEX_INTERVAL_MS)
+      writeIndexEntry(time);
+
+    if (m_segment.write(records.constData() + position, recordSize) != recordSize)
+    {
+      emit errorOccurred(QString("Failed to write to %1").arg(m_segment.fileName()));
+      close();
+      return;
+    }
+
+    position += recordSize;
+  }
+
+  // keep what has been written recoverable if the app stops unexpectedly
+  m_segment.flush();
+  m_index.flush();
+}
+
+/*!
+  \brief Finishes the recording.
+ */
+void MessageRecordingWriter::close()
+{
+  if (m_segment.isOpen())
+    m_segment.close();
+
+  if (m_index.isOpen())
+    m_index.close();
+}
+
+/*!
+  \internal
+ */
+bool MessageRecordingWriter::openSegment(int segmentNumber)
+{
+  if (m_segment.isOpen())
+    m_segment.close();
+
+  m_segmentNumber = segmentNumber;
+  m_segment.setFileName(QDir(m_directory).filePath(MessageRecorder::segmentFileName(m_segmentNumber)));
+  if (!m_segment.open(QFile::WriteOnly) || !writeHeader(m_segment))
+  {
+    emit errorOccurred(QString("Failed to create %1").arg(m_segment.fileName()));
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+/*!
+  \internal
+ */
+void MessageRecordingWriter::writeIndexEntry(qint64 time)
+{
+  uchar entry[20];
+  qToBigEndian<qint64>(time, entry);
+  qToBigEndian<quint32>(static_cast<quint32>(m_segmentNumber), entry + 8);
+  qToBigEndian<qint64>(m_segment.pos(), entry + 12);
+  m_index.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+
+  m_lastIndexedTime = time;
+}
+
+} // Dsa
+
+// Signal Documentation
+/*!
+  \fn void MessageRecordingWriter::errorOccurred(const QString& error);
+  \brief Signal emitted when an \a error occurs.
+ */
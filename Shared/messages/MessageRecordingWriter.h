@@ -0,0 +1,58 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef MESSAGERECORDINGWRITER_H
+#define MESSAGERECORDINGWRITER_H
+
+// Qt headers
+#include <QFile>
+#include <QObject>
+
+namespace Dsa {
+
+class MessageRecordingWriter : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit MessageRecordingWriter(QObject* parent = nullptr);
+  ~MessageRecordingWriter();
+
+public slots:
+  void open(const QString& directory, qint64 segmentSize);
+  void write(const QByteArray& records);
+  void close();
+
+signals:
+  void errorOccurred(const QString& error);
+
+private:
+  Q_DISABLE_COPY(MessageRecordingWriter)
+
+  bool openSegment(int segmentNumber);
+  void writeIndexEntry(qint64 time);
+
+  QString m_directory;
+  qint64 m_segmentSize = 0;
+  int m_segmentNumber = -1;
+  QFile m_segment;
+  QFile m_index;
+  qint64 m_lastIndexedTime = -1;
+};
+
+} // Dsa
+
+#endif // MESSAGERECORDINGWRITER_H
@@ -20,6 +20,7 @@
 #include "MessagesOverlay.h"
 
 // example app headers
+#include "GraphicsUpdateBatcher.h"
 #include "Message.h"
 
 // C++ API headers
@@ -155,8 +156,11 @@ GeoView* MessagesOverlay::geoView() const
 
 /*!
   \brief Adds the \l Message \a message to the overlay. Returns whether adding was successful.
+
+  Updates to an existing graphic are applied at the next frame by the
+  \l GraphicsUpdateBatcher, which reports them with \a updateTag.
  */
-bool MessagesOverlay::addMessage(const Message& message)
+bool MessagesOverlay::addMessage(const Message& message, quint64 updateTag)
 {
   const auto messageId = message.messageId();
   if (messageId.isEmpty())
@@ -212,10 +216,10 @@ bool MessagesOverlay::addMessage(const Message& message)
       if (geom.geometryType() != geometry.geometryType())
         return false;
 
-      if (!(geom == geometry))
-        graphic->setGeometry(geometry);
+      // peers can report many times a frame, so only the latest state is drawn
+      GraphicsUpdateBatcher::instance()->setGeometry(graphic, geometry, updateTag);
 
-      graphic->attributes()->setAttributesMap(message.attributes());
+      GraphicsUpdateBatcher::instance()->setAttributes(graphic, message.attributes(), updateTag);
 
       if (messageAction == Message::MessageAction::Select)
       {
@@ -230,6 +234,7 @@ bool MessagesOverlay::addMessage(const Message& message)
     }
     case Message::MessageAction::Remove:
     {
+      GraphicsUpdateBatcher::instance()->cancel(graphic);
       m_graphicsOverlay->graphics()->removeOne(graphic);
       break;
     }
@@ -61,7 +61,7 @@ public:
 
   Esri::ArcGISRuntime::GeoView* geoView() const;
 
-  bool addMessage(const Message& message);
+  bool addMessage(const Message& message, quint64 updateTag = 0);
 
   bool isVisible() const;
   void setVisible(bool visible);
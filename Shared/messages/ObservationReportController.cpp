@@ -23,6 +23,7 @@
 // example app headers
 #include "AppConstants.h"
 #include "DataSender.h"
+#include "ElevationSampler.h"
 #include "Message.h"
 #include "MessageFeedConstants.h"
 #include "PointHighlighter.h"
@@ -42,6 +43,9 @@
 #include <QHostInfo>
 #include <QUdpSocket>
 
+// STL headers
+#include <cmath>
+
 using namespace Esri::ArcGISRuntime;
 
 namespace Dsa {
@@ -160,6 +164,14 @@ void ObservationReportController::setControlPoint(const Point& controlPoint)
     return;
 
   m_controlPoint = controlPoint;
+
+  // points picked from a map have no elevation, so take it from the local rasters when they cover the point
+  if (!m_controlPoint.isEmpty() && !m_controlPoint.hasZ())
+  {
+    const double elevation = ElevationSampler::instance()->elevation(m_controlPoint);
+    if (!std::isnan(elevation))
+      m_controlPoint = Point(m_controlPoint.x(), m_controlPoint.y(), elevation, m_controlPoint.spatialReference());
+  }
   m_controlPointSet = true;
 
   emit controlPointChanged();
@@ -125,6 +125,28 @@ DsaPanel {
             }
         }
 
+        CheckBox {
+            id: terrainCheckbox
+            text: "Add as terrain product"
+            checked: false
+            visible: !elevationCheckbox.checked && (filter.currentText.indexOf("Raster") !== -1 || filter.currentText.indexOf("All")  !== -1)
+            contentItem: Label {
+                text: terrainCheckbox.text
+                font: terrainCheckbox.font
+                verticalAlignment: Text.AlignVCenter
+                horizontalAlignment: Text.AlignHCenter
+                color: Material.foreground
+                leftPadding: terrainCheckbox.indicator.width + terrainCheckbox.spacing
+            }
+        }
+
+        ComboBox {
+            id: terrainProduct
+            model: toolController.terrainProductList
+            width: parent.width
+            visible: terrainCheckbox.visible && terrainCheckbox.checked
+        }
+
         // When this button is clicked, all checked items will be added as layers/elevation sources
         Button {
             id: addButton
@@ -143,6 +165,8 @@ DsaPanel {
             onClicked: {
                 if (elevationCheckbox.checked && elevationCheckbox.visible)
                     toolController.addItemAsElevationSource(selectedItems);
+                else if (terrainCheckbox.checked && terrainCheckbox.visible)
+                    toolController.addItemAsTerrainLayer(selectedItems, terrainProduct.currentIndex);
                 else
                     toolController.addItemAsLayer(selectedItems);
                 selectedItems = []; // clear so we don't add again next time
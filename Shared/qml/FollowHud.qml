@@ -36,6 +36,14 @@ Item {
         }
     }
 
+    // print how often location fixes arrive and the camera moves while following
+    Shortcut {
+        sequence: "Ctrl+Shift+F"
+        onActivated: console.log("Follow: %1 fixes/s, %2 camera updates/s"
+                                 .arg(followPositionController.fixRate.toFixed(1))
+                                 .arg(followPositionController.cameraUpdateRate.toFixed(1)))
+    }
+
     state: disableLocation.name
     states: [
         State {
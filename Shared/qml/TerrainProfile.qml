@@ -0,0 +1,103 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+import QtQuick 2.9
+import QtQuick.Controls 2.2
+import QtQuick.Controls.Material 2.2
+import QtGraphicalEffects 1.0
+import QtQuick.Window 2.2
+import Esri.DSA 1.0
+
+Item {
+    id: rootTerrainProfile
+    property real scaleFactor: (Screen.logicalPixelDensity * 25.4) / (Qt.platform.os === "windows" || Qt.platform.os === "linux" ? 96 : 72)
+
+    visible: toolController.profileAvailable
+    height: 160 * scaleFactor
+
+    TerrainProfileController {
+        id: toolController
+    }
+
+    DropShadow {
+        anchors.fill: fill
+        horizontalOffset: -1 * scaleFactor
+        verticalOffset: 1 * scaleFactor
+        radius: 8 * scaleFactor
+        smooth: true
+        samples: 16
+        color: "#80000000"
+        source: fill
+    }
+
+    Rectangle {
+        id: fill
+        anchors.fill: parent
+        color: Material.background
+        opacity: 0.9
+    }
+
+    Text {
+        id: summary
+        height: 32 * scaleFactor
+        anchors {
+            top: parent.top
+            left: parent.left
+            right: clearButton.left
+            margins: 5 * scaleFactor
+        }
+
+        font {
+            family: DsaStyles.fontFamily
+            pixelSize: DsaStyles.secondaryTitleFontPixelSize * scaleFactor
+        }
+        color: Material.foreground
+        verticalAlignment: Text.AlignVCenter
+        elide: Text.ElideRight
+
+        text: (toolController.length / 1000).toFixed(2) + " km, " +
+              toolController.minimumElevation.toFixed(0) + " to " + toolController.maximumElevation.toFixed(0) + " m, " +
+              "max slope " + toolController.maximumSlope.toFixed(0) + "°" +
+              (isNaN(toolController.visibleLength) ? "" :
+                   ", <b>" + (toolController.length > 0 ? (100 * toolController.visibleLength / toolController.length).toFixed(0) : 0) + "%</b> visible")
+    }
+
+    OverlayButton {
+        id: clearButton
+        height: summary.height
+        width: height
+        anchors {
+            verticalCenter: summary.verticalCenter
+            right: parent.right
+            margins: 5 * scaleFactor
+        }
+        iconUrl: DsaResources.iconClose
+
+        onClicked: toolController.clearProfile();
+    }
+
+    TerrainProfileChart {
+        anchors {
+            top: summary.bottom
+            bottom: parent.bottom
+            left: parent.left
+            right: parent.right
+            margins: 5 * scaleFactor
+        }
+        controller: toolController
+        lineColor: Material.foreground
+    }
+}
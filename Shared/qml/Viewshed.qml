@@ -60,7 +60,8 @@ Item {
         id: fill
         anchors {
             top: parent.top
-            bottom: finishToolbar.visible ? finishToolbar.bottom : viewshedTypeToolbar.bottom
+            bottom: cumulativeToolbar.visible ? cumulativeToolbar.bottom :
+                                                finishToolbar.visible ? finishToolbar.bottom : viewshedTypeToolbar.bottom
             left: parent.left
             right: parent.right
         }
@@ -480,6 +481,15 @@ Item {
             }
         }
 
+        ToolIcon {
+            anchors.verticalCenter: parent.verticalCenter
+            iconSource: DsaResources.iconRaster
+            toolName: "Raster"
+            enabled: !toolController.viewshedRasterBusy
+            opacity: enabled ? 1 : 0.5
+            onToolSelected: toolController.createActiveViewshedRaster();
+        }
+
         ToolIcon {
             anchors.verticalCenter: parent.verticalCenter
             iconSource: DsaResources.iconClose
@@ -490,4 +500,50 @@ Item {
             }
         }
     }
+
+    Row {
+        id: cumulativeToolbar
+        visible: toolController.viewsheds.count > 0
+
+        anchors {
+            top: finishToolbar.visible ? finishToolbar.bottom : viewshedTypeToolbar.bottom
+            left: parent.left
+            right: parent.right
+            margins: 8 * scaleFactor
+        }
+
+        spacing: 8 * scaleFactor
+        height: cumulativeIcon.height + (anchors.margins * 2)
+
+        Text {
+            anchors.verticalCenter: parent.verticalCenter
+            text: qsTr("Seen by at least")
+            color: Material.foreground
+            font {
+                family: DsaStyles.fontFamily
+                pixelSize: DsaStyles.toolFontPixelSize * scaleFactor
+            }
+        }
+
+        SpinBox {
+            id: thresholdSpinBox
+            anchors.verticalCenter: parent.verticalCenter
+            font.pixelSize: DsaStyles.toolFontPixelSize * scaleFactor
+            width: 112 * scaleFactor
+            editable: true
+            value: 1
+            from: 1
+            to: Math.max(1, toolController.viewsheds.count)
+        }
+
+        ToolIcon {
+            id: cumulativeIcon
+            anchors.verticalCenter: parent.verticalCenter
+            iconSource: DsaResources.iconViewshed
+            toolName: "Cumulative"
+            enabled: !toolController.viewshedRasterBusy
+            opacity: enabled ? 1 : 0.5
+            onToolSelected: toolController.createCumulativeViewshedRaster(thresholdSpinBox.value);
+        }
+    }
 }
@@ -0,0 +1,527 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "CoordinateNotation.h"
+
+// C++ API headers
+#include "GeometryEngine.h"
+#include "Point.h"
+
+// Qt headers
+#include <QtDebug>
+
+// STL headers
+#include <algorithm>
+#include <cmath>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace Dsa {
+
+namespace
+{
+const double pi = 3.14159265358979323846;
+const double degreesToRadians = pi / 180.0;
+
+// WGS84 ellipsoid and the UTM and UPS scale factors
+const double semiMajorAxis = 6378137.0;
+const double flattening = 1.0 / 298.257223563;
+const double utmScale = 0.9996;
+const double upsScale = 0.994;
+const double utmFalseEasting = 500000.0;
+const double utmFalseNorthing = 10000000.0;
+const double upsFalseOrigin = 2000000.0;
+
+// MGRS lettering (the AA scheme used for WGS84), indexed as in the grid specification
+const char latitudeBands[] = "CDEFGHJKLMNPQRSTUVWXX";
+const char* const utmColumnLetters[3] = { "ABCDEFGH", "JKLMNPQR", "STUVWXYZ" };
+const char utmRowLetters[] = "ABCDEFGHJKLMNPQRSTUV";
+const char upsBands[] = "ABYZ";
+const char* const upsColumnLetters[4] = { "JKLPQRSTUXYZ", "ABCFGHJKLPQR", "RSTUXYZ", "ABCFGHJ" };
+const int upsColumnLetterCounts[4] = { 12, 12, 7, 7 };
+const int upsFirstColumns[4] = { 8, 20, 13, 20 };
+const char* const upsRowLetters[2] = { "ABCDEFGHJKLMNPQRSTUVWXYZ", "ABCDEFGHJKLMNP" };
+const int upsRowLetterCounts[2] = { 24, 14 };
+const int upsFirstRows[2] = { 8, 13 };
+
+// GARS 30 minute latitude bands are named by two letters
+const char garsFirstLetters[] = "ABCDEFGHJKLMNPQ";
+const char garsSecondLetters[] = "ABCDEFGHJKLMNPQRSTUVWXYZ";
+
+const qint64 powersOfTen[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+// the series coefficients and per zone constants, computed once on first use
+struct ProjectionTables
+{
+  ProjectionTables();
+
+  double eccentricity = 0.0;
+  double utmRadius = 0.0; // k0 times the rectifying radius
+  double alpha[6];
+  double upsRadius = 0.0;
+  double centralMeridians[61]; // radians, indexed by zone
+};
+
+ProjectionTables::ProjectionTables()
+{
+  eccentricity = std::sqrt(flattening * (2.0 - flattening));
+
+  // Krüger's series in the third flattening, to sixth order
+  const double n = flattening / (2.0 - flattening);
+  const double n2 = n * n;
+  const double n3 = n2 * n;
+  const double n4 = n3 * n;
+  const double n5 = n4 * n;
+  const double n6 = n5 * n;
+
+  utmRadius = utmScale * semiMajorAxis / (1.0 + n) * (1.0 + n2 / 4.0 + n4 / 64.0 + n6 / 256.0);
+
+  alpha[0] = n / 2.0 - 2.0 / 3.0 * n2 + 5.0 / 16.0 * n3 + 41.0 / 180.0 * n4 - 127.0 / 288.0 * n5 + 7891.0 / 37800.0 * n6;
+  alpha[1] = 13.0 / 48.0 * n2 - 3.0 / 5.0 * n3 + 557.0 / 1440.0 * n4 + 281.0 / 630.0 * n5 - 1983433.0 / 1935360.0 * n6;
+  alpha[2] = 61.0 / 240.0 * n3 - 103.0 / 140.0 * n4 + 15061.0 / 26880.0 * n5 + 167603.0 / 181440.0 * n6;
+  alpha[3] = 49561.0 / 161280.0 * n4 - 179.0 / 168.0 * n5 + 6601661.0 / 7257600.0 * n6;
+  alpha[4] = 34729.0 / 80640.0 * n5 - 3418889.0 / 1995840.0 * n6;
+  alpha[5] = 212378941.0 / 319334400.0 * n6;
+
+  const double e = eccentricity;
+  upsRadius = 2.0 * semiMajorAxis * upsScale / std::sqrt(std::pow(1.0 + e, 1.0 + e) * std::pow(1.0 - e, 1.0 - e));
+
+  centralMeridians[0] = 0.0;
+  for (int zone = 1; zone <= 60; ++zone)
+    centralMeridians[zone] = (zone * 6 - 183) * degreesToRadians;
+}
+
+const ProjectionTables& projectionTables()
+{
+  static const ProjectionTables s_tables;
+
+  return s_tables;
+}
+
+int defaultPrecision(CoordinateNotation::Format format)
+{
+  switch (format)
+  {
+  case CoordinateNotation::Format::DegreesMinutesSeconds:
+    return 3;
+  case CoordinateNotation::Format::Utm:
+  case CoordinateNotation::Format::Gars:
+    return 0;
+  default:
+    return 5;
+  }
+}
+
+// the largest precision for which the longest string still fits in MaximumLength
+int maximumPrecision(CoordinateNotation::Format format)
+{
+  switch (format)
+  {
+  case CoordinateNotation::Format::DecimalDegrees:
+    return 8;
+  case CoordinateNotation::Format::DegreesDecimalMinutes:
+    return 6;
+  case CoordinateNotation::Format::DegreesMinutesSeconds:
+    return 4;
+  case CoordinateNotation::Format::Mgrs:
+  case CoordinateNotation::Format::Usng:
+    return 5;
+  default:
+    return 0;
+  }
+}
+
+char* writeDigits(char* out, qint64 value, int width)
+{
+  char digits[20];
+  int count = 0;
+  do
+  {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  while (value > 0);
+
+  while (count < width)
+    digits[count++] = '0';
+
+  while (count > 0)
+    *out++ = digits[--count];
+
+  return out;
+}
+
+// rounds at the last written place first, so that 59.9999 seconds carries into the minutes
+char* writeAngle(char* out, double degrees, CoordinateNotation::Format format, int precision, char positive, char negative)
+{
+  const qint64 scale = powersOfTen[precision];
+  const double magnitude = std::fabs(degrees);
+
+  qint64 units = 0;
+  if (format == CoordinateNotation::Format::DegreesMinutesSeconds)
+    units = std::llround(magnitude * 3600.0 * scale);
+  else if (format == CoordinateNotation::Format::DegreesDecimalMinutes)
+    units = std::llround(magnitude * 60.0 * scale);
+  else
+    units = std::llround(magnitude * scale);
+
+  const qint64 fraction = units % scale;
+  qint64 whole = units / scale;
+
+  if (format == CoordinateNotation::Format::DegreesMinutesSeconds)
+  {
+    const qint64 seconds = whole % 60;
+    whole /= 60;
+    const qint64 minutes = whole % 60;
+    out = writeDigits(out, whole / 60, 1);
+    *out++ = ' ';
+    out = writeDigits(out, minutes, 2);
+    *out++ = ' ';
+    out = writeDigits(out, seconds, 2);
+  }
+  else if (format == CoordinateNotation::Format::DegreesDecimalMinutes)
+  {
+    out = writeDigits(out, whole / 60, 1);
+    *out++ = ' ';
+    out = writeDigits(out, whole % 60, 2);
+  }
+  else
+  {
+    out = writeDigits(out, whole, 1);
+  }
+
+  if (precision > 0)
+  {
+    *out++ = '.';
+    out = writeDigits(out, fraction, precision);
+  }
+
+  *out++ = degrees < 0.0 ? negative : positive;
+  return out;
+}
+
+int utmZone(double x, double y)
+{
+  const int zone = std::min(static_cast<int>((x + 180.0) / 6.0) + 1, 60);
+
+  // the Norway and Svalbard exceptions
+  if (y >= 56.0 && y < 64.0 && x >= 3.0 && x < 12.0)
+    return 32;
+
+  if (y >= 72.0 && x >= 0.0 && x < 42.0)
+  {
+    if (x < 9.0)
+      return 31;
+    if (x < 21.0)
+      return 33;
+    if (x < 33.0)
+      return 35;
+    return 37;
+  }
+
+  return zone;
+}
+
+void projectUtm(const ProjectionTables& tables, double x, double y, int zone, double& easting, double& northing)
+{
+  const double phi = y * degreesToRadians;
+  const double lambda = x * degreesToRadians - tables.centralMeridians[zone];
+  const double cosLambda = std::cos(lambda);
+  const double sinLambda = std::sin(lambda);
+  const double e = tables.eccentricity;
+
+  // conformal latitude, then the Gauss-Schreiber transverse Mercator
+  const double tau = std::tan(phi);
+  const double secant = std::sqrt(1.0 + tau * tau);
+  const double sigma = std::sinh(e * std::atanh(e * tau / secant));
+  const double tauPrime = tau * std::sqrt(1.0 + sigma * sigma) - sigma * secant;
+  const double xiPrime = std::atan2(tauPrime, cosLambda);
+  const double etaPrime = std::asinh(sinLambda / std::sqrt(tauPrime * tauPrime + cosLambda * cosLambda));
+
+  double xi = xiPrime;
+  double eta = etaPrime;
+  for (int j = 1; j <= 6; ++j)
+  {
+    const double alpha = tables.alpha[j - 1];
+    xi += alpha * std::sin(2 * j * xiPrime) * std::cosh(2 * j * etaPrime);
+    eta += alpha * std::cos(2 * j * xiPrime) * std::sinh(2 * j * etaPrime);
+  }
+
+  easting = utmFalseEasting + tables.utmRadius * eta;
+  northing = tables.utmRadius * xi + (y < 0.0 ? utmFalseNorthing : 0.0);
+}
+
+void projectUps(const ProjectionTables& tables, double x, double y, double& easting, double& northing)
+{
+  const double e = tables.eccentricity;
+  const double phi = std::fabs(y) * degreesToRadians;
+  const double sinPhi = std::sin(phi);
+  const double t = std::tan(pi / 4.0 - phi / 2.0) / std::pow((1.0 - e * sinPhi) / (1.0 + e * sinPhi), e / 2.0);
+  const double rho = tables.upsRadius * t;
+  const double lambda = x * degreesToRadians;
+
+  easting = upsFalseOrigin + rho * std::sin(lambda);
+  northing = y > 0.0 ? upsFalseOrigin - rho * std::cos(lambda) : upsFalseOrigin + rho * std::cos(lambda);
+}
+
+char* writeGridDigits(char* out, qint64 easting, qint64 northing, int precision)
+{
+  if (precision == 0)
+    return out;
+
+  const qint64 divisor = powersOfTen[5 - precision];
+  *out++ = ' ';
+  out = writeDigits(out, (easting % 100000) / divisor, precision);
+  *out++ = ' ';
+  return writeDigits(out, (northing % 100000) / divisor, precision);
+}
+
+// MGRS and USNG share the same grid; coordinates are truncated, not rounded, as the grid requires
+char* writeMgrs(const ProjectionTables& tables, char* out, double x, double y, int precision)
+{
+  double easting = 0.0;
+  double northing = 0.0;
+
+  if (y < -80.0 || y >= 84.0)
+  {
+    const bool north = y > 0.0;
+    projectUps(tables, x, y, easting, northing);
+    const qint64 e = static_cast<qint64>(std::floor(easting));
+    const qint64 n = static_cast<qint64>(std::floor(northing));
+    const int band = (north ? 2 : 0) + (easting >= upsFalseOrigin ? 1 : 0);
+    const int column = static_cast<int>(e / 100000) - upsFirstColumns[band];
+    const int row = static_cast<int>(n / 100000) - upsFirstRows[north];
+    if (column < 0 || column >= upsColumnLetterCounts[band] || row < 0 || row >= upsRowLetterCounts[north])
+      return nullptr;
+
+    *out++ = upsBands[band];
+    *out++ = ' ';
+    *out++ = upsColumnLetters[band][column];
+    *out++ = upsRowLetters[north][row];
+    return writeGridDigits(out, e, n, precision);
+  }
+
+  const int zone = utmZone(x, y);
+  projectUtm(tables, x, y, zone, easting, northing);
+  const qint64 e = static_cast<qint64>(std::floor(easting));
+  const qint64 n = static_cast<qint64>(std::floor(northing));
+  const int column = static_cast<int>(e / 100000) - 1;
+  if (column < 0 || column > 7)
+    return nullptr;
+
+  const int band = std::min(static_cast<int>((y + 80.0) / 8.0), 20);
+  const int row = (static_cast<int>(n / 100000) + (zone % 2 == 0 ? 5 : 0)) % 20;
+
+  out = writeDigits(out, zone, 1);
+  *out++ = latitudeBands[band];
+  *out++ = ' ';
+  *out++ = utmColumnLetters[(zone - 1) % 3][column];
+  *out++ = utmRowLetters[row];
+  return writeGridDigits(out, e, n, precision);
+}
+
+char* writeUtm(const ProjectionTables& tables, char* out, double x, double y)
+{
+  if (y < -80.0 || y > 84.0)
+    return nullptr;
+
+  double easting = 0.0;
+  double northing = 0.0;
+  const int zone = utmZone(x, y);
+  projectUtm(tables, x, y, zone, easting, northing);
+
+  out = writeDigits(out, zone, 1);
+  *out++ = y < 0.0 ? 'S' : 'N';
+  *out++ = ' ';
+  out = writeDigits(out, std::llround(easting), 1);
+  *out++ = ' ';
+  return writeDigits(out, std::llround(northing), 1);
+}
+
+char* writeGars(char* out, double x, double y)
+{
+  const double shiftedX = x + 180.0;
+  const double shiftedY = y + 90.0;
+
+  // 30 minute cell, then the 15 minute quadrant and 5 minute keypad area within it
+  const int cellX = std::min(static_cast<int>(shiftedX * 2.0), 719);
+  const int cellY = std::min(static_cast<int>(shiftedY * 2.0), 359);
+  const int areaX = std::min(static_cast<int>(shiftedX * 12.0), 4319) - cellX * 6;
+  const int areaY = std::min(static_cast<int>(shiftedY * 12.0), 2159) - cellY * 6;
+
+  out = writeDigits(out, cellX + 1, 3);
+  *out++ = garsFirstLetters[cellY / 24];
+  *out++ = garsSecondLetters[cellY % 24];
+  *out++ = static_cast<char>('0' + (areaY >= 3 ? 1 : 3) + (areaX >= 3 ? 1 : 0));
+  *out++ = static_cast<char>('0' + (2 - areaY % 3) * 3 + areaX % 3 + 1);
+  return out;
+}
+
+int formatPoint(const ProjectionTables& tables, CoordinateNotation::Format format, double x, double y, int precision, char* buffer)
+{
+  if (std::isnan(x) || std::isnan(y) || y < -90.0 || y > 90.0)
+  {
+    buffer[0] = '\0';
+    return 0;
+  }
+
+  if (x < -180.0 || x >= 180.0)
+  {
+    x = std::fmod(x + 180.0, 360.0);
+    x = (x < 0.0 ? x + 360.0 : x) - 180.0;
+  }
+
+  char* end = buffer;
+  switch (format)
+  {
+  case CoordinateNotation::Format::DecimalDegrees:
+  case CoordinateNotation::Format::DegreesDecimalMinutes:
+  case CoordinateNotation::Format::DegreesMinutesSeconds:
+    end = writeAngle(end, y, format, precision, 'N', 'S');
+    *end++ = ' ';
+    end = writeAngle(end, x, format, precision, 'E', 'W');
+    break;
+  case CoordinateNotation::Format::Utm:
+    end = writeUtm(tables, end, x, y);
+    break;
+  case CoordinateNotation::Format::Mgrs:
+  case CoordinateNotation::Format::Usng:
+    end = writeMgrs(tables, end, x, y, precision);
+    break;
+  case CoordinateNotation::Format::Gars:
+    end = writeGars(end, x, y);
+    break;
+  }
+
+  if (!end)
+  {
+    buffer[0] = '\0';
+    return 0;
+  }
+
+  *end = '\0';
+  return static_cast<int>(end - buffer);
+}
+}
+
+/*!
+  \class Dsa::CoordinateNotation
+  \inmodule Dsa
+  \brief Converts WGS84 locations to coordinate notation strings in bulk.
+
+  \c CoordinateFormatter converts one \c Point at a time and returns a new
+  \c QString each time, which is too slow for grid references on every track
+  in a list. \l format converts arrays of longitudes and latitudes straight
+  into a caller-owned character buffer, using projection constants and zone
+  tables computed once.
+
+  The output matches the \c CoordinateFormatter calls made by
+  \c LocationTextController; the \c --check-coordinates option of the
+  benchmarks app compares the two on random points.
+ */
+
+/*!
+  \brief Formats \a count locations, \a x longitudes and \a y latitudes in
+  WGS84 degrees, as \a format strings into \a buffer.
+
+  Each string is null terminated and written \a stride characters after the
+  previous one; \a stride must be at least \l MaximumLength. \a precision is
+  the number of decimal places for the latitude and longitude formats, or
+  the number of digits for MGRS and USNG; \c -1 uses the precision of
+  \c LocationTextController. Locations that cannot be expressed in
+  \a format, such as UTM near the poles, are written as empty strings.
+
+  Returns the number of locations that were formatted.
+ */
+int CoordinateNotation::format(Format format, const double* x, const double* y, int count,
+                               char* buffer, int stride, int precision)
+{
+  if (stride < MaximumLength)
+  {
+    qWarning() << "CoordinateNotation stride" << stride << "is shorter than" << MaximumLength;
+    return 0;
+  }
+
+  precision = precision < 0 ? defaultPrecision(format) : std::min(precision, maximumPrecision(format));
+
+  const ProjectionTables& tables = projectionTables();
+  int formatted = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    if (formatPoint(tables, format, x[i], y[i], precision, buffer + static_cast<qint64>(i) * stride) > 0)
+      ++formatted;
+  }
+
+  return formatted;
+}
+
+/*!
+  \brief Returns the \a format string for longitude \a x and latitude \a y in
+  WGS84 degrees, with \a precision as for \l format.
+ */
+QString CoordinateNotation::toString(Format format, double x, double y, int precision)
+{
+  char buffer[MaximumLength];
+  CoordinateNotation::format(format, &x, &y, 1, buffer, MaximumLength, precision);
+
+  return QString::fromLatin1(buffer);
+}
+
+/*!
+  \brief Returns the \a format string for \a point, with \a precision as for \l format.
+ */
+QString CoordinateNotation::toString(Format format, const Point& point, int precision)
+{
+  if (point.isEmpty())
+    return QString();
+
+  if (point.spatialReference() == SpatialReference::wgs84())
+    return toString(format, point.x(), point.y(), precision);
+
+  const Point projected = geometry_cast<Point>(GeometryEngine::project(point, SpatialReference::wgs84()));
+  return toString(format, projected.x(), projected.y(), precision);
+}
+
+/*!
+  \brief Returns the short name of \a format, as used in the coordinate format options.
+ */
+QString CoordinateNotation::formatName(Format format)
+{
+  switch (format)
+  {
+  case Format::DecimalDegrees:
+    return QStringLiteral("DD");
+  case Format::DegreesDecimalMinutes:
+    return QStringLiteral("DDM");
+  case Format::DegreesMinutesSeconds:
+    return QStringLiteral("DMS");
+  case Format::Utm:
+    return QStringLiteral("UTM");
+  case Format::Mgrs:
+    return QStringLiteral("MGRS");
+  case Format::Usng:
+    return QStringLiteral("USNG");
+  case Format::Gars:
+    return QStringLiteral("GARS");
+  }
+
+  return QString();
+}
+
+} // Dsa
@@ -0,0 +1,63 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef COORDINATENOTATION_H
+#define COORDINATENOTATION_H
+
+// Qt headers
+#include <QString>
+
+namespace Esri {
+namespace ArcGISRuntime {
+class Point;
+}
+}
+
+namespace Dsa {
+
+class CoordinateNotation
+{
+public:
+  enum class Format
+  {
+    DecimalDegrees,
+    DegreesDecimalMinutes,
+    DegreesMinutesSeconds,
+    Utm,
+    Mgrs,
+    Usng,
+    Gars
+  };
+
+  // every notation, including its terminating null, fits in this many characters
+  static const int MaximumLength = 32;
+
+  static int format(Format format, const double* x, const double* y, int count,
+                    char* buffer, int stride = MaximumLength, int precision = -1);
+
+  static QString toString(Format format, double x, double y, int precision = -1);
+  static QString toString(Format format, const Esri::ArcGISRuntime::Point& point, int precision = -1);
+
+  static QString formatName(Format format);
+
+private:
+  CoordinateNotation() = delete;
+};
+
+} // Dsa
+
+#endif // COORDINATENOTATION_H
@@ -0,0 +1,193 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "DemRaster.h"
+
+// example app headers
+#include "DtedRaster.h"
+#include "GeoTiffRaster.h"
+
+// Qt headers
+#include <QFileInfo>
+
+namespace Dsa {
+
+/*!
+  \class Dsa::DemRaster
+  \inmodule Dsa
+  \brief Base class for reading elevation posts from a local raster file.
+
+  Posts are read a tile at a time so that only the part of a raster around
+  the sampled locations has to be held in memory.
+
+  \sa ElevationSampler
+ */
+
+/*!
+  \brief Opens the DTED or GeoTIFF file at \a filePath, chosen by its suffix.
+
+  Returns \c nullptr if the file cannot be read, in which case
+  \a errorString, if set, receives the reason.
+ */
+DemRaster* DemRaster::open(const QString& filePath, QString* errorString)
+{
+  const QString suffix = QFileInfo(filePath).suffix().toLower();
+
+  DemRaster* raster = nullptr;
+  if (suffix == QStringLiteral("dt0") || suffix == QStringLiteral("dt1") || suffix == QStringLiteral("dt2"))
+    raster = new DtedRaster(filePath);
+  else if (suffix == QStringLiteral("tif") || suffix == QStringLiteral("tiff"))
+    raster = new GeoTiffRaster(filePath);
+
+  if (!raster)
+  {
+    if (errorString)
+      *errorString = QObject::tr("Unsupported elevation raster ") + filePath;
+
+    return nullptr;
+  }
+
+  QString readError;
+  const bool opened = raster->readHeader(readError);
+
+  if (!opened)
+  {
+    if (errorString)
+      *errorString = filePath + QStringLiteral(": ") + readError;
+
+    delete raster;
+    return nullptr;
+  }
+
+  return raster;
+}
+
+/*!
+  \internal
+ */
+DemRaster::DemRaster(const QString& filePath) :
+  m_file(filePath)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+DemRaster::~DemRaster()
+{
+}
+
+/*!
+  \brief Returns the path of the raster file.
+ */
+QString DemRaster::filePath() const
+{
+  return m_file.fileName();
+}
+
+/*!
+  \brief Returns the number of posts in each row.
+ */
+int DemRaster::width() const
+{
+  return m_width;
+}
+
+/*!
+  \brief Returns the number of rows of posts.
+ */
+int DemRaster::height() const
+{
+  return m_height;
+}
+
+/*!
+  \brief Returns the longitude of the north-west post.
+ */
+double DemRaster::originX() const
+{
+  return m_originX;
+}
+
+/*!
+  \brief Returns the latitude of the north-west post.
+ */
+double DemRaster::originY() const
+{
+  return m_originY;
+}
+
+/*!
+  \brief Returns the spacing between posts from west to east in degrees.
+ */
+double DemRaster::postSpacingX() const
+{
+  return m_postSpacingX;
+}
+
+/*!
+  \brief Returns the spacing between posts from north to south in degrees.
+ */
+double DemRaster::postSpacingY() const
+{
+  return m_postSpacingY;
+}
+
+/*!
+  \brief Returns whether the location \a x, \a y in WGS84 degrees lies between the posts of the raster.
+ */
+bool DemRaster::contains(double x, double y) const
+{
+  return x >= m_originX && x <= m_originX + (m_width - 1) * m_postSpacingX &&
+         y <= m_originY && y >= m_originY - (m_height - 1) * m_postSpacingY;
+}
+
+/*!
+  \brief Returns the number of posts in each row of a tile.
+ */
+int DemRaster::tileWidth() const
+{
+  return m_tileWidth;
+}
+
+/*!
+  \brief Returns the number of rows in a tile.
+ */
+int DemRaster::tileHeight() const
+{
+  return m_tileHeight;
+}
+
+/*!
+  \brief Returns the number of tiles in each row of tiles.
+ */
+int DemRaster::tilesAcross() const
+{
+  return (m_width + m_tileWidth - 1) / m_tileWidth;
+}
+
+/*!
+  \brief Returns the number of rows of tiles.
+ */
+int DemRaster::tilesDown() const
+{
+  return (m_height + m_tileHeight - 1) / m_tileHeight;
+}
+
+} // Dsa
@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef DEMRASTER_H
+#define DEMRASTER_H
+
+// Qt headers
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+namespace Dsa {
+
+class DemRaster
+{
+public:
+  virtual ~DemRaster();
+
+  static DemRaster* open(const QString& filePath, QString* errorString = nullptr);
+
+  QString filePath() const;
+
+  int width() const;
+  int height() const;
+
+  // the location of the first post, at the north-west corner, in WGS84 degrees
+  double originX() const;
+  double originY() const;
+
+  // the spacing between posts in degrees, positive towards the south and east
+  double postSpacingX() const;
+  double postSpacingY() const;
+
+  bool contains(double x, double y) const;
+
+  int tileWidth() const;
+  int tileHeight() const;
+  int tilesAcross() const;
+  int tilesDown() const;
+
+  // reads a tile of tileWidth x tileHeight values in row order from north to
+  // south; posts outside the raster and voids are NaN
+  virtual bool readTile(int tileX, int tileY, QVector<float>& values) = 0;
+
+protected:
+  explicit DemRaster(const QString& filePath);
+
+  virtual bool readHeader(QString& errorString) = 0;
+
+  QFile m_file;
+  int m_width = 0;
+  int m_height = 0;
+  double m_originX = 0.0;
+  double m_originY = 0.0;
+  double m_postSpacingX = 0.0;
+  double m_postSpacingY = 0.0;
+  int m_tileWidth = 0;
+  int m_tileHeight = 0;
+
+private:
+  Q_DISABLE_COPY(DemRaster)
+};
+
+} // Dsa
+
+#endif // DEMRASTER_H
@@ -0,0 +1,171 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "DtedRaster.h"
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+namespace
+{
+// the user header, data set identification and accuracy records
+// come before the first elevation record
+const qint64 uhlSize = 80;
+const qint64 dataOffset = 3428;
+
+// each record holds one line of longitude, framed by an
+// 8 byte header and a 4 byte checksum
+const qint64 recordHeaderSize = 8;
+const qint64 recordTrailerSize = 4;
+
+// lines of longitude read into one tile
+const int columnsPerTile = 64;
+
+const quint16 voidValue = 0xFFFF;
+
+double parseAngle(const QByteArray& field)
+{
+  // DDDMMSSH, e.g. 1170000W
+  const double degrees = field.mid(0, 3).toDouble();
+  const double minutes = field.mid(3, 2).toDouble();
+  const double seconds = field.mid(5, 2).toDouble();
+  const double angle = degrees + minutes / 60.0 + seconds / 3600.0;
+  const char hemisphere = field.at(7);
+
+  return (hemisphere == 'W' || hemisphere == 'S') ? -angle : angle;
+}
+}
+
+/*!
+  \class Dsa::DtedRaster
+  \inmodule Dsa
+  \inherits DemRaster
+  \brief Reads elevation posts from a DTED level 0, 1 or 2 cell.
+
+  A tile holds a band of lines of longitude over the full height of the cell,
+  matching the order in which DTED stores its posts.
+ */
+
+/*!
+  \brief Constructor taking the \a filePath of the cell.
+ */
+DtedRaster::DtedRaster(const QString& filePath) :
+  DemRaster(filePath)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+DtedRaster::~DtedRaster()
+{
+}
+
+/*!
+  \internal
+ */
+bool DtedRaster::readHeader(QString& errorString)
+{
+  if (!m_file.open(QFile::ReadOnly))
+  {
+    errorString = m_file.errorString();
+    return false;
+  }
+
+  const QByteArray uhl = m_file.read(uhlSize);
+  if (uhl.size() != uhlSize || !uhl.startsWith("UHL"))
+  {
+    errorString = QObject::tr("Not a DTED file");
+    return false;
+  }
+
+  const double originLongitude = parseAngle(uhl.mid(4, 8));
+  const double originLatitude = parseAngle(uhl.mid(12, 8));
+  const double longitudeInterval = uhl.mid(20, 4).toDouble() / 36000.0; // tenths of arc seconds
+  const double latitudeInterval = uhl.mid(24, 4).toDouble() / 36000.0;
+  m_width = uhl.mid(47, 4).toInt();
+  m_height = uhl.mid(51, 4).toInt();
+
+  if (m_width < 2 || m_height < 2 || longitudeInterval <= 0.0 || latitudeInterval <= 0.0)
+  {
+    errorString = QObject::tr("Invalid DTED header");
+    return false;
+  }
+
+  m_recordSize = recordHeaderSize + m_height * 2 + recordTrailerSize;
+  if (m_file.size() < dataOffset + m_width * m_recordSize)
+  {
+    errorString = QObject::tr("DTED file is truncated");
+    return false;
+  }
+
+  // the origin in the header is the south-west post
+  m_postSpacingX = longitudeInterval;
+  m_postSpacingY = latitudeInterval;
+  m_originX = originLongitude;
+  m_originY = originLatitude + (m_height - 1) * latitudeInterval;
+  m_tileWidth = qMin(columnsPerTile, m_width);
+  m_tileHeight = m_height;
+
+  return true;
+}
+
+/*!
+  \reimp
+ */
+bool DtedRaster::readTile(int tileX, int tileY, QVector<float>& values)
+{
+  if (tileY != 0 || tileX < 0 || tileX >= tilesAcross())
+    return false;
+
+  const int firstColumn = tileX * m_tileWidth;
+  const int columnCount = qMin(m_tileWidth, m_width - firstColumn);
+
+  if (!m_file.seek(dataOffset + firstColumn * m_recordSize))
+    return false;
+
+  const QByteArray records = m_file.read(columnCount * m_recordSize);
+  if (records.size() != columnCount * m_recordSize)
+    return false;
+
+  values.fill(NAN, m_tileWidth * m_tileHeight);
+
+  const uchar* data = reinterpret_cast<const uchar*>(records.constData());
+  for (int column = 0; column < columnCount; ++column)
+  {
+    const uchar* posts = data + column * m_recordSize + recordHeaderSize;
+
+    // posts run from south to north, as signed magnitude big-endian values
+    for (int i = 0; i < m_height; ++i)
+    {
+      const quint16 raw = static_cast<quint16>((posts[2 * i] << 8) | posts[2 * i + 1]);
+      if (raw == voidValue)
+        continue;
+
+      const int magnitude = raw & 0x7FFF;
+      values[(m_height - 1 - i) * m_tileWidth + column] = static_cast<float>((raw & 0x8000) ? -magnitude : magnitude);
+    }
+  }
+
+  return true;
+}
+
+} // Dsa
@@ -0,0 +1,41 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef DTEDRASTER_H
+#define DTEDRASTER_H
+
+#include "DemRaster.h"
+
+namespace Dsa {
+
+class DtedRaster : public DemRaster
+{
+public:
+  explicit DtedRaster(const QString& filePath);
+  ~DtedRaster();
+
+  bool readTile(int tileX, int tileY, QVector<float>& values) override;
+
+protected:
+  bool readHeader(QString& errorString) override;
+
+private:
+  qint64 m_recordSize = 0;
+};
+
+} // Dsa
+
+#endif // DTEDRASTER_H
@@ -0,0 +1,151 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+// PCH header
+#include "pch.hpp"
+
+#include "ElevationGrid.h"
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+namespace
+{
+const double semiMajorAxis = 6378137.0;
+const double eccentricitySquared = 0.00669437999014;
+const double degreesToRadians = M_PI / 180.0;
+}
+
+/*!
+  \class Dsa::ElevationGrid
+  \inmodule Dsa
+  \brief A regular grid of elevation posts held in memory.
+
+  Grids are cut from the local rasters by \l ElevationSampler::grid. Once
+  built a grid is only read, so the analysis engines share one between
+  threads without locking.
+ */
+
+/*!
+  \brief Returns whether the grid has no posts.
+ */
+bool ElevationGrid::isEmpty() const
+{
+  return width <= 0 || height <= 0 || values.size() != width * height;
+}
+
+/*!
+  \brief Returns whether \a x, \a y in WGS84 degrees lies within the grid.
+ */
+bool ElevationGrid::contains(double x, double y) const
+{
+  if (isEmpty())
+    return false;
+
+  return x >= originX && x <= originX + (width - 1) * spacingX &&
+         y <= originY && y >= originY - (height - 1) * spacingY;
+}
+
+/*!
+  \brief Returns the longitude of the posts in \a column.
+ */
+double ElevationGrid::x(int column) const
+{
+  return originX + column * spacingX;
+}
+
+/*!
+  \brief Returns the latitude of the posts in \a row.
+ */
+double ElevationGrid::y(int row) const
+{
+  return originY - row * spacingY;
+}
+
+/*!
+  \brief Returns the post at \a column, \a row, or NaN if it is a void or outside the grid.
+ */
+float ElevationGrid::value(int column, int row) const
+{
+  if (column < 0 || row < 0 || column >= width || row >= height)
+    return NAN;
+
+  return values.at(row * width + column);
+}
+
+/*!
+  \brief Returns the elevation at \a x, \a y in WGS84 degrees, or NaN if it is outside the grid.
+
+  The value is interpolated as \l ElevationSampler::elevation does.
+ */
+double ElevationGrid::elevation(double x, double y) const
+{
+  if (!contains(x, y) || width < 2 || height < 2)
+    return NAN;
+
+  const double fx = (x - originX) / spacingX;
+  const double fy = (originY - y) / spacingY;
+  const int column = qBound(0, static_cast<int>(fx), width - 2);
+  const int row = qBound(0, static_cast<int>(fy), height - 2);
+  const double tx = fx - column;
+  const double ty = fy - row;
+
+  const float* first = values.constData() + row * width + column;
+  const float posts[4] = { first[0], first[1], first[width], first[width + 1] };
+  const double weights[4] = { (1.0 - tx) * (1.0 - ty), tx * (1.0 - ty), (1.0 - tx) * ty, tx * ty };
+
+  double sum = 0.0;
+  double weightSum = 0.0;
+  for (int i = 0; i < 4; ++i)
+  {
+    if (std::isnan(posts[i]))
+      continue;
+
+    sum += posts[i] * weights[i];
+    weightSum += weights[i];
+  }
+
+  return weightSum > 0.0 ? sum / weightSum : NAN;
+}
+
+/*!
+  \brief Returns the length in meters of a degree of longitude at \a latitude.
+ */
+double ElevationGrid::metersPerDegreeX(double latitude)
+{
+  const double phi = latitude * degreesToRadians;
+  const double sinPhi = std::sin(phi);
+  const double primeVerticalRadius = semiMajorAxis / std::sqrt(1.0 - eccentricitySquared * sinPhi * sinPhi);
+
+  return primeVerticalRadius * std::cos(phi) * degreesToRadians;
+}
+
+/*!
+  \brief Returns the length in meters of a degree of latitude at \a latitude.
+ */
+double ElevationGrid::metersPerDegreeY(double latitude)
+{
+  const double sinPhi = std::sin(latitude * degreesToRadians);
+  const double w = std::sqrt(1.0 - eccentricitySquared * sinPhi * sinPhi);
+  const double meridionalRadius = semiMajorAxis * (1.0 - eccentricitySquared) / (w * w * w);
+
+  return meridionalRadius * degreesToRadians;
+}
+
+} // Dsa
@@ -0,0 +1,60 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef ELEVATIONGRID_H
+#define ELEVATIONGRID_H
+
+// Qt headers
+#include <QVector>
+
+namespace Dsa {
+
+struct ElevationGrid
+{
+  bool isEmpty() const;
+
+  bool contains(double x, double y) const;
+
+  // the location of the post at column, row in WGS84 degrees
+  double x(int column) const;
+  double y(int row) const;
+
+  float value(int column, int row) const;
+  double elevation(double x, double y) const;
+
+  // the length in meters of a degree of longitude and of latitude on the WGS84 ellipsoid
+  static double metersPerDegreeX(double latitude);
+  static double metersPerDegreeY(double latitude);
+
+  int width = 0;
+  int height = 0;
+
+  // the location of the first post, at the north-west corner, in WGS84 degrees
+  double originX = 0.0;
+  double originY = 0.0;
+
+  // the spacing between posts in degrees, positive towards the south and east
+  double spacingX = 0.0;
+  double spacingY = 0.0;
+
+  // posts in row order from north to south; voids are NaN
+  QVector<float> values;
+};
+
+} // Dsa
+
+#endif // ELEVATIONGRID_H
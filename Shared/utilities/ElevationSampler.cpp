@@ -0,0 +1,422 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "ElevationSampler.h"
+
+// example app headers
+#include "DemRaster.h"
+
+// C++ API headers
+#include "GeometryEngine.h"
+#include "Point.h"
+
+// Qt headers
+#include <QMutexLocker>
+
+// STL headers
+#include <cmath>
+
+using namespace Esri::ArcGISRuntime;
+
+namespace Dsa {
+
+namespace
+{
+const int defaultCacheSizeKb = 64 * 1024;
+
+quint64 tileKey(int raster, int tileX, int tileY)
+{
+  return (static_cast<quint64>(raster) << 48) | (static_cast<quint64>(tileY) << 24) | static_cast<quint64>(tileX);
+}
+}
+
+/*!
+  \class Dsa::ElevationSampler
+  \inmodule Dsa
+  \brief Samples elevations from local DTED and GeoTIFF rasters on the CPU.
+
+  Unlike \c Surface::locationToElevation, which is an asynchronous query whose
+  results can arrive out of order, the sampler answers straight away by
+  bilinear interpolation between the four surrounding posts. Posts are read a
+  tile at a time into a cache that discards the least recently used tiles once
+  it reaches \l cacheSize.
+
+  The rasters and the cache are guarded by a mutex, so the sampler may be
+  used from any thread, for example to read a grid on a worker thread.
+
+  \sa DemRaster
+ */
+
+/*!
+  \brief Returns the singleton instance of the sampler.
+ */
+ElevationSampler* ElevationSampler::instance()
+{
+  static ElevationSampler s_instance;
+
+  return &s_instance;
+}
+
+/*!
+  \internal
+ */
+ElevationSampler::ElevationSampler() :
+  m_tiles(defaultCacheSizeKb)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+ElevationSampler::~ElevationSampler()
+{
+  clear();
+}
+
+/*!
+  \brief Adds the DTED and GeoTIFF rasters at \a filePaths.
+
+  Other rasters, and files that cannot be read, are skipped. Returns \c true
+  if every file was added; otherwise \a errorString, if set, receives the
+  reasons.
+ */
+bool ElevationSampler::addRasters(const QStringList& filePaths, QString* errorString)
+{
+  QMutexLocker locker(&m_mutex);
+
+  QStringList errors;
+  const QStringList existing = this->filePaths();
+
+  for (const QString& filePath : filePaths)
+  {
+    if (existing.contains(filePath))
+      continue;
+
+    QString error;
+    DemRaster* raster = DemRaster::open(filePath, &error);
+    if (!raster)
+    {
+      errors.append(error);
+      continue;
+    }
+
+    m_rasters.append(raster);
+  }
+
+  if (errorString)
+    *errorString = errors.join(QStringLiteral("\n"));
+
+  return errors.isEmpty();
+}
+
+/*!
+  \brief Removes every raster and empties the cache.
+ */
+void ElevationSampler::clear()
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_tiles.clear();
+  m_lastTile = nullptr;
+  m_lastRaster = -1;
+
+  qDeleteAll(m_rasters);
+  m_rasters.clear();
+}
+
+/*!
+  \brief Returns whether any rasters have been added.
+ */
+bool ElevationSampler::hasData() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  return !m_rasters.isEmpty();
+}
+
+/*!
+  \brief Returns the paths of the rasters that have been added.
+ */
+QStringList ElevationSampler::filePaths() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  QStringList paths;
+  for (const DemRaster* raster : m_rasters)
+    paths.append(raster->filePath());
+
+  return paths;
+}
+
+/*!
+  \brief Returns whether a raster covers \a x, \a y in WGS84 degrees.
+ */
+bool ElevationSampler::contains(double x, double y)
+{
+  QMutexLocker locker(&m_mutex);
+
+  return rasterAt(x, y) != -1;
+}
+
+/*!
+  \brief Moves \a x, \a y in WGS84 degrees to the nearest post of the raster covering it.
+
+  Returns \c false, leaving them unchanged, if no raster covers it.
+ */
+bool ElevationSampler::nearestPost(double& x, double& y)
+{
+  QMutexLocker locker(&m_mutex);
+
+  const int raster = rasterAt(x, y);
+  if (raster == -1)
+    return false;
+
+  const DemRaster* r = m_rasters.at(raster);
+  x = r->originX() + std::round((x - r->originX()) / r->postSpacingX()) * r->postSpacingX();
+  y = r->originY() - std::round((r->originY() - y) / r->postSpacingY()) * r->postSpacingY();
+  return true;
+}
+
+/*!
+  \brief Returns the size of the tile cache in kilobytes.
+ */
+int ElevationSampler::cacheSize() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  return m_tiles.maxCost();
+}
+
+/*!
+  \brief Sets the size of the tile cache to \a kilobytes.
+
+  The default is 64 MB.
+ */
+void ElevationSampler::setCacheSize(int kilobytes)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_tiles.setMaxCost(qMax(1, kilobytes));
+  m_lastTile = nullptr;
+}
+
+/*!
+  \brief Returns the elevation at \a x, \a y in WGS84 degrees, or NaN if no raster covers it.
+ */
+double ElevationSampler::elevation(double x, double y)
+{
+  QMutexLocker locker(&m_mutex);
+
+  const int raster = rasterAt(x, y);
+  if (raster == -1)
+    return NAN;
+
+  const DemRaster* r = m_rasters.at(raster);
+  const double fx = (x - r->originX()) / r->postSpacingX();
+  const double fy = (r->originY() - y) / r->postSpacingY();
+  const int column = qBound(0, static_cast<int>(fx), r->width() - 2);
+  const int row = qBound(0, static_cast<int>(fy), r->height() - 2);
+  const double tx = fx - column;
+  const double ty = fy - row;
+
+  const float posts[4] = { post(raster, column, row), post(raster, column + 1, row),
+                           post(raster, column, row + 1), post(raster, column + 1, row + 1) };
+  const double weights[4] = { (1.0 - tx) * (1.0 - ty), tx * (1.0 - ty), (1.0 - tx) * ty, tx * ty };
+
+  // voids are left out and the remaining posts weighted up to make up for them
+  double sum = 0.0;
+  double weightSum = 0.0;
+  for (int i = 0; i < 4; ++i)
+  {
+    if (std::isnan(posts[i]))
+      continue;
+
+    sum += posts[i] * weights[i];
+    weightSum += weights[i];
+  }
+
+  return weightSum > 0.0 ? sum / weightSum : NAN;
+}
+
+/*!
+  \brief Returns the elevation at \a point, or NaN if no raster covers it.
+ */
+double ElevationSampler::elevation(const Point& point)
+{
+  if (point.isEmpty())
+    return NAN;
+
+  if (point.spatialReference() == SpatialReference::wgs84())
+    return elevation(point.x(), point.y());
+
+  const Point projected = geometry_cast<Point>(GeometryEngine::project(point, SpatialReference::wgs84()));
+  return elevation(projected.x(), projected.y());
+}
+
+/*!
+  \brief Samples \a count elevations at the WGS84 locations \a x, \a y into \a elevations.
+ */
+void ElevationSampler::elevations(const double* x, const double* y, double* elevations, int count)
+{
+  for (int i = 0; i < count; ++i)
+    elevations[i] = elevation(x[i], y[i]);
+}
+
+/*!
+  \brief Returns the elevations at \a points, with NaN for points that no raster covers.
+ */
+QVector<double> ElevationSampler::elevations(const QList<Point>& points)
+{
+  QVector<double> results;
+  results.reserve(points.size());
+
+  for (const Point& point : points)
+    results.append(elevation(point));
+
+  return results;
+}
+
+/*!
+  \brief Returns a grid of the posts between \a west, \a south, \a east and
+  \a north in WGS84 degrees.
+
+  The grid takes the post spacing of the raster covering the middle of the
+  area, or of the first raster if none does, and lines up with that raster's
+  posts so that no interpolation is needed within it. Posts beyond it are
+  interpolated from whichever raster covers them and are NaN where none does.
+  If the area would need more than \a maximumPosts posts the spacing is
+  widened by a whole number of posts until it fits.
+
+  Returns an empty grid if no rasters have been added.
+ */
+ElevationGrid ElevationSampler::grid(double west, double south, double east, double north, int maximumPosts)
+{
+  QMutexLocker locker(&m_mutex);
+
+  ElevationGrid result;
+  if (m_rasters.isEmpty() || east < west || north < south)
+    return result;
+
+  int raster = rasterAt((west + east) * 0.5, (south + north) * 0.5);
+  if (raster == -1)
+    raster = 0;
+
+  const DemRaster* r = m_rasters.at(raster);
+
+  // snap outwards to the raster's posts
+  const int firstColumn = static_cast<int>(std::floor((west - r->originX()) / r->postSpacingX()));
+  const int lastColumn = static_cast<int>(std::ceil((east - r->originX()) / r->postSpacingX()));
+  const int firstRow = static_cast<int>(std::floor((r->originY() - north) / r->postSpacingY()));
+  const int lastRow = static_cast<int>(std::ceil((r->originY() - south) / r->postSpacingY()));
+
+  const qint64 columns = lastColumn - firstColumn + 1;
+  const qint64 rows = lastRow - firstRow + 1;
+  int step = 1;
+  while (((columns + step - 1) / step) * ((rows + step - 1) / step) > qMax(1, maximumPosts))
+    ++step;
+
+  result.width = static_cast<int>((columns + step - 1) / step);
+  result.height = static_cast<int>((rows + step - 1) / step);
+  result.spacingX = r->postSpacingX() * step;
+  result.spacingY = r->postSpacingY() * step;
+  result.originX = r->originX() + firstColumn * r->postSpacingX();
+  result.originY = r->originY() - firstRow * r->postSpacingY();
+  result.values.resize(result.width * result.height);
+
+  float* values = result.values.data();
+  for (int row = 0; row < result.height; ++row)
+  {
+    const int rasterRow = firstRow + row * step;
+    for (int column = 0; column < result.width; ++column)
+    {
+      const int rasterColumn = firstColumn + column * step;
+      if (rasterColumn >= 0 && rasterRow >= 0 && rasterColumn < r->width() && rasterRow < r->height())
+        *values++ = post(raster, rasterColumn, rasterRow);
+      else
+        *values++ = static_cast<float>(elevation(result.x(column), result.y(row)));
+    }
+  }
+
+  return result;
+}
+
+/*!
+  \internal
+ */
+int ElevationSampler::rasterAt(double x, double y)
+{
+  // successive samples usually fall in the same raster
+  if (m_lastRaster != -1 && m_lastRaster < m_rasters.size() && m_rasters.at(m_lastRaster)->contains(x, y))
+    return m_lastRaster;
+
+  for (int i = 0; i < m_rasters.size(); ++i)
+  {
+    if (m_rasters.at(i)->contains(x, y))
+    {
+      m_lastRaster = i;
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+/*!
+  \internal
+ */
+const ElevationSampler::Tile* ElevationSampler::tile(int raster, int tileX, int tileY)
+{
+  const quint64 key = tileKey(raster, tileX, tileY);
+  if (m_lastTile && key == m_lastTileKey)
+    return m_lastTile;
+
+  Tile* t = m_tiles.object(key);
+  if (!t)
+  {
+    // a tile that cannot be read is cached empty so that it is not read again
+    t = new Tile;
+    if (!m_rasters.at(raster)->readTile(tileX, tileY, t->values))
+      t->values.clear();
+
+    const int cost = qMax(1, static_cast<int>(t->values.size() * sizeof(float) / 1024));
+    m_tiles.insert(key, t, cost);
+
+    // the cache deletes a tile that is larger than the whole cache
+    t = m_tiles.object(key);
+  }
+
+  m_lastTileKey = key;
+  m_lastTile = t;
+  return t;
+}
+
+/*!
+  \internal
+ */
+float ElevationSampler::post(int raster, int column, int row)
+{
+  const DemRaster* r = m_rasters.at(raster);
+  const Tile* t = tile(raster, column / r->tileWidth(), row / r->tileHeight());
+  if (!t || t->values.isEmpty())
+    return NAN;
+
+  return t->values.at((row % r->tileHeight()) * r->tileWidth() + column % r->tileWidth());
+}
+
+} // Dsa
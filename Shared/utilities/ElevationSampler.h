@@ -0,0 +1,90 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef ELEVATIONSAMPLER_H
+#define ELEVATIONSAMPLER_H
+
+// example app headers
+#include "ElevationGrid.h"
+
+// Qt headers
+#include <QCache>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+
+namespace Esri {
+namespace ArcGISRuntime {
+class Point;
+}
+}
+
+namespace Dsa {
+
+class DemRaster;
+
+class ElevationSampler
+{
+public:
+  static ElevationSampler* instance();
+
+  ~ElevationSampler();
+
+  bool addRasters(const QStringList& filePaths, QString* errorString = nullptr);
+  void clear();
+
+  bool hasData() const;
+  QStringList filePaths() const;
+  bool contains(double x, double y);
+  bool nearestPost(double& x, double& y);
+
+  int cacheSize() const;
+  void setCacheSize(int kilobytes);
+
+  double elevation(double x, double y);
+  double elevation(const Esri::ArcGISRuntime::Point& point);
+  void elevations(const double* x, const double* y, double* elevations, int count);
+  QVector<double> elevations(const QList<Esri::ArcGISRuntime::Point>& points);
+
+  static constexpr int DefaultMaximumGridPosts = 4096 * 4096;
+  ElevationGrid grid(double west, double south, double east, double north, int maximumPosts = DefaultMaximumGridPosts);
+
+private:
+  Q_DISABLE_COPY(ElevationSampler)
+
+  ElevationSampler();
+
+  struct Tile
+  {
+    QVector<float> values;
+  };
+
+  int rasterAt(double x, double y);
+  const Tile* tile(int raster, int tileX, int tileY);
+  float post(int raster, int column, int row);
+
+  mutable QMutex m_mutex{QMutex::Recursive};
+  QList<DemRaster*> m_rasters;
+  QCache<quint64, Tile> m_tiles;
+  int m_lastRaster = -1;
+  quint64 m_lastTileKey = 0;
+  const Tile* m_lastTile = nullptr;
+};
+
+} // Dsa
+
+#endif // ELEVATIONSAMPLER_H
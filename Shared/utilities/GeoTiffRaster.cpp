@@ -0,0 +1,470 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "GeoTiffRaster.h"
+
+// example app headers
+#include "TiffTags.h"
+
+// Qt headers
+#include <QHash>
+#include <QtEndian>
+
+// STL headers
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace Dsa {
+
+using namespace TiffTags;
+
+namespace
+{
+const int typeSizes[] = { 0, 1, 1, 2, 4, 8, 1, 1, 2, 4, 8, 4, 8 };
+
+template <typename T>
+T readSample(const uchar* data, bool bigEndian)
+{
+  // floating point samples are swapped as integers of the same size
+  using Bits = typename std::conditional<sizeof(T) == 1, quint8,
+               typename std::conditional<sizeof(T) == 2, quint16,
+               typename std::conditional<sizeof(T) == 4, quint32, quint64>::type>::type>::type;
+
+  Bits bits;
+  std::memcpy(&bits, data, sizeof(Bits));
+  bits = bigEndian ? qFromBigEndian(bits) : qFromLittleEndian(bits);
+
+  T value;
+  std::memcpy(&value, &bits, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void decodeRow(const uchar* row, int count, bool bigEndian, bool predictor, bool hasNoData, double noData, float* out)
+{
+  T previous = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    T value = readSample<T>(row + i * sizeof(T), bigEndian);
+
+    // horizontal differencing stores each sample as the change from the one before
+    if (predictor)
+    {
+      value = static_cast<T>(previous + value);
+      previous = value;
+    }
+
+    out[i] = (hasNoData && static_cast<double>(value) == noData) ? NAN : static_cast<float>(value);
+  }
+}
+}
+
+/*!
+  \class Dsa::GeoTiffRaster
+  \inmodule Dsa
+  \inherits DemRaster
+  \brief Reads elevation posts from a single band GeoTIFF in geographic coordinates.
+
+  Stripped and tiled images are supported, either uncompressed or compressed
+  with Deflate and optionally the horizontal predictor. A tile is a TIFF tile
+  or, for stripped images, a strip.
+ */
+
+/*!
+  \brief Constructor taking the \a filePath of the GeoTIFF.
+ */
+GeoTiffRaster::GeoTiffRaster(const QString& filePath) :
+  DemRaster(filePath)
+{
+}
+
+/*!
+  \brief Destructor.
+ */
+GeoTiffRaster::~GeoTiffRaster()
+{
+}
+
+/*!
+  \internal
+ */
+bool GeoTiffRaster::readHeader(QString& errorString)
+{
+  if (!m_file.open(QFile::ReadOnly))
+  {
+    errorString = m_file.errorString();
+    return false;
+  }
+
+  const QByteArray header = m_file.read(8);
+  if (header.size() != 8 || (!header.startsWith("II") && !header.startsWith("MM")))
+  {
+    errorString = QObject::tr("Not a TIFF file");
+    return false;
+  }
+
+  m_bigEndian = header.startsWith("MM");
+  const uchar* headerData = reinterpret_cast<const uchar*>(header.constData());
+  if (toUInt16(headerData + 2) != 42)
+  {
+    errorString = QObject::tr("BigTIFF files are not supported");
+    return false;
+  }
+
+  // only the first image of the file is read
+  if (!m_file.seek(toUInt32(headerData + 4)))
+  {
+    errorString = QObject::tr("Invalid TIFF header");
+    return false;
+  }
+
+  const QByteArray countData = m_file.read(2);
+  if (countData.size() != 2)
+  {
+    errorString = QObject::tr("Invalid TIFF directory");
+    return false;
+  }
+
+  const int entryCount = toUInt16(reinterpret_cast<const uchar*>(countData.constData()));
+  const QByteArray entryData = m_file.read(entryCount * 12);
+  if (entryData.size() != entryCount * 12)
+  {
+    errorString = QObject::tr("Invalid TIFF directory");
+    return false;
+  }
+
+  QHash<quint16, Entry> entries;
+  for (int i = 0; i < entryCount; ++i)
+  {
+    const uchar* e = reinterpret_cast<const uchar*>(entryData.constData()) + i * 12;
+    Entry entry{toUInt16(e), toUInt16(e + 2), toUInt32(e + 4), entryData.mid(i * 12 + 8, 4)};
+    entries.insert(entry.tag, entry);
+  }
+
+  const auto value = [this, &entries](quint16 tag, double defaultValue)
+  {
+    const QVector<double> values = entries.contains(tag) ? readValues(entries.value(tag)) : QVector<double>();
+    return values.isEmpty() ? defaultValue : values.first();
+  };
+
+  m_width = static_cast<int>(value(imageWidthTag, 0));
+  m_height = static_cast<int>(value(imageLengthTag, 0));
+  const int bitsPerSample = static_cast<int>(value(bitsPerSampleTag, 1));
+  const int sampleFormat = static_cast<int>(value(sampleFormatTag, 1));
+  const int compression = static_cast<int>(value(compressionTag, compressionNone));
+  const int predictor = static_cast<int>(value(predictorTag, 1));
+
+  if (m_width < 2 || m_height < 2 || value(samplesPerPixelTag, 1) != 1)
+  {
+    errorString = QObject::tr("Only single band images are supported");
+    return false;
+  }
+
+  if (sampleFormat == 1 && bitsPerSample == 8)
+    m_sampleType = SampleType::UInt8;
+  else if (sampleFormat == 1 && bitsPerSample == 16)
+    m_sampleType = SampleType::UInt16;
+  else if (sampleFormat == 2 && bitsPerSample == 16)
+    m_sampleType = SampleType::Int16;
+  else if (sampleFormat == 1 && bitsPerSample == 32)
+    m_sampleType = SampleType::UInt32;
+  else if (sampleFormat == 2 && bitsPerSample == 32)
+    m_sampleType = SampleType::Int32;
+  else if (sampleFormat == 3 && bitsPerSample == 32)
+    m_sampleType = SampleType::Float32;
+  else if (sampleFormat == 3 && bitsPerSample == 64)
+    m_sampleType = SampleType::Float64;
+  else
+  {
+    errorString = QObject::tr("Unsupported sample format");
+    return false;
+  }
+
+  m_bytesPerSample = bitsPerSample / 8;
+
+  if (compression != compressionNone && compression != compressionDeflate && compression != compressionAdobeDeflate)
+  {
+    errorString = QObject::tr("Unsupported compression");
+    return false;
+  }
+
+  m_deflate = compression != compressionNone;
+
+  if (predictor > 2 || (predictor == 2 && sampleFormat == 3))
+  {
+    errorString = QObject::tr("Unsupported predictor");
+    return false;
+  }
+
+  m_horizontalPredictor = predictor == 2;
+
+  m_tiled = entries.contains(tileOffsetsTag);
+  if (m_tiled)
+  {
+    m_tileWidth = static_cast<int>(value(tileWidthTag, 0));
+    m_tileHeight = static_cast<int>(value(tileLengthTag, 0));
+    m_offsets = readValues(entries.value(tileOffsetsTag));
+    m_byteCounts = readValues(entries.value(tileByteCountsTag));
+  }
+  else
+  {
+    m_tileWidth = m_width;
+    m_tileHeight = qMin(m_height, static_cast<int>(value(rowsPerStripTag, m_height)));
+    m_offsets = readValues(entries.value(stripOffsetsTag));
+    m_byteCounts = readValues(entries.value(stripByteCountsTag));
+  }
+
+  if (m_tileWidth <= 0 || m_tileHeight <= 0 ||
+      m_offsets.size() < tilesAcross() * tilesDown() || m_byteCounts.size() < m_offsets.size())
+  {
+    errorString = QObject::tr("Invalid image layout");
+    return false;
+  }
+
+  // georeferencing
+  const QVector<double> scale = entries.contains(modelPixelScaleTag) ? readValues(entries.value(modelPixelScaleTag)) : QVector<double>();
+  const QVector<double> tiepoint = entries.contains(modelTiepointTag) ? readValues(entries.value(modelTiepointTag)) : QVector<double>();
+  if (scale.size() < 2 || tiepoint.size() < 6 || scale.at(0) <= 0.0 || scale.at(1) <= 0.0)
+  {
+    errorString = QObject::tr("The image is not georeferenced");
+    return false;
+  }
+
+  int modelType = modelTypeGeographic;
+  int rasterType = 1;
+  const QVector<double> keys = entries.contains(geoKeyDirectoryTag) ? readValues(entries.value(geoKeyDirectoryTag)) : QVector<double>();
+  for (int i = 4; i + 3 < keys.size(); i += 4)
+  {
+    // only keys stored directly in the directory are needed
+    if (keys.at(i + 1) != 0)
+      continue;
+
+    if (keys.at(i) == modelTypeKey)
+      modelType = static_cast<int>(keys.at(i + 3));
+    else if (keys.at(i) == rasterTypeKey)
+      rasterType = static_cast<int>(keys.at(i + 3));
+  }
+
+  if (modelType != modelTypeGeographic)
+  {
+    errorString = QObject::tr("Only geographic coordinates are supported");
+    return false;
+  }
+
+  m_postSpacingX = scale.at(0);
+  m_postSpacingY = scale.at(1);
+  m_originX = tiepoint.at(3) - tiepoint.at(0) * m_postSpacingX;
+  m_originY = tiepoint.at(4) + tiepoint.at(1) * m_postSpacingY;
+
+  // an area pixel's post is at its centre
+  if (rasterType != rasterPixelIsPoint)
+  {
+    m_originX += m_postSpacingX / 2.0;
+    m_originY -= m_postSpacingY / 2.0;
+  }
+
+  if (entries.contains(gdalNoDataTag))
+  {
+    const Entry entry = entries.value(gdalNoDataTag);
+    QByteArray text = entry.count <= 4 ? entry.value.left(static_cast<int>(entry.count)) : QByteArray();
+    if (entry.count > 4 && m_file.seek(toUInt32(reinterpret_cast<const uchar*>(entry.value.constData()))))
+      text = m_file.read(entry.count);
+
+    bool ok = false;
+    m_noData = text.trimmed().replace('\0', "").toDouble(&ok);
+    m_hasNoData = ok;
+  }
+
+  return true;
+}
+
+/*!
+  \reimp
+ */
+bool GeoTiffRaster::readTile(int tileX, int tileY, QVector<float>& values)
+{
+  if (tileX < 0 || tileY < 0 || tileX >= tilesAcross() || tileY >= tilesDown())
+    return false;
+
+  const int index = tileY * tilesAcross() + tileX;
+  if (!m_file.seek(static_cast<qint64>(m_offsets.at(index))))
+    return false;
+
+  QByteArray data = m_file.read(static_cast<qint64>(m_byteCounts.at(index)));
+  if (data.isEmpty())
+    return false;
+
+  const int expectedSize = m_tileWidth * m_tileHeight * m_bytesPerSample;
+  if (m_deflate)
+  {
+    // qUncompress expects the zlib stream to follow its size as 4 big-endian bytes
+    QByteArray stream(4, '\0');
+    qToBigEndian(static_cast<quint32>(expectedSize), reinterpret_cast<uchar*>(stream.data()));
+    data = qUncompress(stream + data);
+  }
+
+  // a final strip may be shorter than the others
+  const int rowLength = m_tileWidth * m_bytesPerSample;
+  const int rowCount = qMin(m_tileHeight, data.size() / rowLength);
+
+  values.fill(NAN, m_tileWidth * m_tileHeight);
+  decodeRows(data, rowCount, m_tileWidth, values);
+
+  // tiles at the right and bottom edges are padded beyond the image
+  const int validColumns = qMin(m_tileWidth, m_width - tileX * m_tileWidth);
+  const int validRows = qMin(rowCount, m_height - tileY * m_tileHeight);
+  for (int row = 0; row < m_tileHeight; ++row)
+  {
+    for (int column = (row < validRows ? validColumns : 0); column < m_tileWidth; ++column)
+      values[row * m_tileWidth + column] = NAN;
+  }
+
+  return true;
+}
+
+/*!
+  \internal
+ */
+quint16 GeoTiffRaster::toUInt16(const uchar* data) const
+{
+  return m_bigEndian ? qFromBigEndian<quint16>(data) : qFromLittleEndian<quint16>(data);
+}
+
+/*!
+  \internal
+ */
+quint32 GeoTiffRaster::toUInt32(const uchar* data) const
+{
+  return m_bigEndian ? qFromBigEndian<quint32>(data) : qFromLittleEndian<quint32>(data);
+}
+
+/*!
+  \internal
+
+  Returns the numeric values of \a entry, reading them from the file if they
+  do not fit in the entry itself.
+ */
+QVector<double> GeoTiffRaster::readValues(const Entry& entry)
+{
+  QVector<double> values;
+  if (entry.type == 0 || entry.type >= sizeof(typeSizes) / sizeof(typeSizes[0]))
+    return values;
+
+  const int typeSize = typeSizes[entry.type];
+  const qint64 size = static_cast<qint64>(entry.count) * typeSize;
+
+  QByteArray data = entry.value;
+  if (size > 4)
+  {
+    if (!m_file.seek(toUInt32(reinterpret_cast<const uchar*>(entry.value.constData()))))
+      return values;
+
+    data = m_file.read(size);
+    if (data.size() != size)
+      return values;
+  }
+
+  const uchar* d = reinterpret_cast<const uchar*>(data.constData());
+  values.reserve(static_cast<int>(entry.count));
+  for (quint32 i = 0; i < entry.count; ++i)
+  {
+    const uchar* p = d + i * typeSize;
+    switch (entry.type)
+    {
+    case 1: // BYTE
+    case 7: // UNDEFINED
+      values.append(*p);
+      break;
+    case 6: // SBYTE
+      values.append(static_cast<qint8>(*p));
+      break;
+    case 3: // SHORT
+      values.append(toUInt16(p));
+      break;
+    case 8: // SSHORT
+      values.append(static_cast<qint16>(toUInt16(p)));
+      break;
+    case 4: // LONG
+      values.append(toUInt32(p));
+      break;
+    case 9: // SLONG
+      values.append(static_cast<qint32>(toUInt32(p)));
+      break;
+    case 5: // RATIONAL
+      values.append(static_cast<double>(toUInt32(p)) / qMax<quint32>(1, toUInt32(p + 4)));
+      break;
+    case 10: // SRATIONAL
+      values.append(static_cast<double>(static_cast<qint32>(toUInt32(p))) / qMax(1, static_cast<qint32>(toUInt32(p + 4))));
+      break;
+    case 11: // FLOAT
+      values.append(readSample<float>(p, m_bigEndian));
+      break;
+    case 12: // DOUBLE
+      values.append(readSample<double>(p, m_bigEndian));
+      break;
+    default:
+      return QVector<double>();
+    }
+  }
+
+  return values;
+}
+
+/*!
+  \internal
+ */
+void GeoTiffRaster::decodeRows(const QByteArray& data, int rowCount, int rowLength, QVector<float>& values) const
+{
+  const uchar* d = reinterpret_cast<const uchar*>(data.constData());
+  const int rowBytes = rowLength * m_bytesPerSample;
+
+  for (int row = 0; row < rowCount; ++row)
+  {
+    const uchar* in = d + row * rowBytes;
+    float* out = values.data() + row * rowLength;
+
+    switch (m_sampleType)
+    {
+    case SampleType::UInt8:
+      decodeRow<quint8>(in, rowLength, m_bigEndian, m_horizontalPredictor, m_hasNoData, m_noData, out);
+      break;
+    case SampleType::UInt16:
+      decodeRow<quint16>(in, rowLength, m_bigEndian, m_horizontalPredictor, m_hasNoData, m_noData, out);
+      break;
+    case SampleType::Int16:
+      decodeRow<qint16>(in, rowLength, m_bigEndian, m_horizontalPredictor, m_hasNoData, m_noData, out);
+      break;
+    case SampleType::UInt32:
+      decodeRow<quint32>(in, rowLength, m_bigEndian, m_horizontalPredictor, m_hasNoData, m_noData, out);
+      break;
+    case SampleType::Int32:
+      decodeRow<qint32>(in, rowLength, m_bigEndian, m_horizontalPredictor, m_hasNoData, m_noData, out);
+      break;
+    case SampleType::Float32:
+      decodeRow<float>(in, rowLength, m_bigEndian, false, m_hasNoData, m_noData, out);
+      break;
+    case SampleType::Float64:
+      decodeRow<double>(in, rowLength, m_bigEndian, false, m_hasNoData, m_noData, out);
+      break;
+    }
+  }
+}
+
+} // Dsa
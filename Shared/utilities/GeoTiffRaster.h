@@ -0,0 +1,74 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef GEOTIFFRASTER_H
+#define GEOTIFFRASTER_H
+
+#include "DemRaster.h"
+
+namespace Dsa {
+
+class GeoTiffRaster : public DemRaster
+{
+public:
+  explicit GeoTiffRaster(const QString& filePath);
+  ~GeoTiffRaster();
+
+  bool readTile(int tileX, int tileY, QVector<float>& values) override;
+
+protected:
+  bool readHeader(QString& errorString) override;
+
+private:
+  enum class SampleType
+  {
+    UInt8,
+    UInt16,
+    Int16,
+    UInt32,
+    Int32,
+    Float32,
+    Float64
+  };
+
+  struct Entry
+  {
+    quint16 tag;
+    quint16 type;
+    quint32 count;
+    QByteArray value; // the 4 byte value or offset field
+  };
+
+  quint16 toUInt16(const uchar* data) const;
+  quint32 toUInt32(const uchar* data) const;
+  QVector<double> readValues(const Entry& entry);
+  void decodeRows(const QByteArray& data, int rowCount, int rowLength, QVector<float>& values) const;
+
+  bool m_bigEndian = false;
+  SampleType m_sampleType = SampleType::Int16;
+  int m_bytesPerSample = 2;
+  bool m_deflate = false;
+  bool m_horizontalPredictor = false;
+  bool m_tiled = false;
+  bool m_hasNoData = false;
+  double m_noData = 0.0;
+  QVector<double> m_offsets;
+  QVector<double> m_byteCounts;
+};
+
+} // Dsa
+
+#endif // GEOTIFFRASTER_H
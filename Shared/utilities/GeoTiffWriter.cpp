@@ -0,0 +1,473 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+// PCH header
+#include "pch.hpp"
+
+#include "GeoTiffWriter.h"
+
+// example app headers
+#include "TiffTags.h"
+
+// Qt headers
+#include <QByteArray>
+#include <QMutexLocker>
+#include <QObject>
+#include <QSysInfo>
+
+// STL headers
+#include <cstring>
+#include <limits>
+
+namespace Dsa {
+
+constexpr int GeoTiffWriter::TileSize;
+
+using namespace TiffTags;
+
+namespace
+{
+class DirectoryBuilder
+{
+public:
+  explicit DirectoryBuilder(quint32 offset) :
+    m_offset(offset)
+  {
+  }
+
+  void addShorts(quint16 tag, const QVector<quint16>& values)
+  {
+    add(tag, shortType, values.size(), values.constData(), values.size() * sizeof(quint16));
+  }
+
+  void addLongs(quint16 tag, const QVector<quint32>& values)
+  {
+    add(tag, longType, values.size(), values.constData(), values.size() * sizeof(quint32));
+  }
+
+  void addDoubles(quint16 tag, const QVector<double>& values)
+  {
+    add(tag, doubleType, values.size(), values.constData(), values.size() * sizeof(double));
+  }
+
+  void addAscii(quint16 tag, const QByteArray& value)
+  {
+    const QByteArray terminated = value + '\0';
+    add(tag, asciiType, terminated.size(), terminated.constData(), terminated.size());
+  }
+
+  // entries must be added in ascending tag order
+  QByteArray build() const
+  {
+    const quint16 count = static_cast<quint16>(m_entries.size());
+    const quint32 dataOffset = m_offset + 2 + count * 12 + 4;
+
+    QByteArray directory;
+    append(directory, count);
+    for (const Entry& entry : m_entries)
+    {
+      append(directory, entry.tag);
+      append(directory, entry.type);
+      append(directory, entry.count);
+
+      // values of up to four bytes are held in the entry itself
+      if (entry.value.size() <= 4)
+        directory.append(entry.value.leftJustified(4, '\0'));
+      else
+        append(directory, static_cast<quint32>(dataOffset + entry.dataOffset));
+    }
+
+    append(directory, quint32(0));
+    directory.append(m_data);
+    return directory;
+  }
+
+private:
+  struct Entry
+  {
+    quint16 tag;
+    quint16 type;
+    quint32 count;
+    QByteArray value;
+    int dataOffset;
+  };
+
+  template <typename T>
+  static void append(QByteArray& bytes, T value)
+  {
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void add(quint16 tag, quint16 type, int count, const void* data, int size)
+  {
+    Entry entry{ tag, type, static_cast<quint32>(count), QByteArray(static_cast<const char*>(data), size), -1 };
+    if (size > 4)
+    {
+      // out of line values start on a word boundary
+      if (m_data.size() % 2)
+        m_data.append('\0');
+
+      entry.dataOffset = m_data.size();
+      m_data.append(entry.value);
+    }
+
+    m_entries.append(entry);
+  }
+
+  quint32 m_offset = 0;
+  QList<Entry> m_entries;
+  QByteArray m_data;
+};
+}
+
+/*!
+  \class Dsa::GeoTiffWriter
+  \inmodule Dsa
+  \brief Streams a single band raster to an uncompressed, tiled GeoTIFF.
+
+  The raster is georeferenced in WGS84 degrees and can be opened as a
+  \c RasterLayer, or by \l GeoTiffRaster. Tiles of \c TileSize square may be
+  written in any order, from any thread, as they are produced, so a large
+  result never has to be held in memory at once. The image directory is
+  written by \l close, which fills any tiles that were not written with the
+  no data value.
+ */
+
+/*!
+  \brief Constructor.
+ */
+GeoTiffWriter::GeoTiffWriter()
+{
+}
+
+/*!
+  \brief Destructor.
+
+  A file that was not closed is removed.
+ */
+GeoTiffWriter::~GeoTiffWriter()
+{
+  cancel();
+}
+
+/*!
+  \brief Creates the GeoTIFF at \a filePath for a raster of \a width by
+  \a height samples of \a sampleType.
+
+  The centre of the north-west pixel is at \a originX, \a originY and the
+  pixels are \a spacingX by \a spacingY degrees. Returns \c false if the file
+  cannot be created.
+ */
+bool GeoTiffWriter::open(const QString& filePath, int width, int height, SampleType sampleType,
+                         double originX, double originY, double spacingX, double spacingY)
+{
+  cancel();
+
+  m_errorString.clear();
+  if (width <= 0 || height <= 0)
+    return fail(QObject::tr("The raster is empty"));
+
+  m_file.setFileName(filePath);
+  if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    return fail(filePath + QStringLiteral(": ") + m_file.errorString());
+
+  m_width = width;
+  m_height = height;
+  m_sampleType = sampleType;
+  m_originX = originX;
+  m_originY = originY;
+  m_spacingX = spacingX;
+  m_spacingY = spacingY;
+  m_tileOffsets.fill(0, tilesAcross() * tilesDown());
+
+  // the header is written in the byte order of this machine, and so are the samples
+  const bool littleEndian = QSysInfo::ByteOrder == QSysInfo::LittleEndian;
+  QByteArray header(littleEndian ? "II" : "MM");
+  const quint16 magic = 42;
+  const quint32 directoryOffset = 0;
+  header.append(reinterpret_cast<const char*>(&magic), sizeof(magic));
+  header.append(reinterpret_cast<const char*>(&directoryOffset), sizeof(directoryOffset));
+
+  if (m_file.write(header) != header.size())
+    return fail(filePath + QStringLiteral(": ") + m_file.errorString());
+
+  return true;
+}
+
+/*!
+  \brief Returns whether a file is open for writing.
+ */
+bool GeoTiffWriter::isOpen() const
+{
+  return m_file.isOpen();
+}
+
+/*!
+  \brief Sets the value that marks pixels with no data to \a noData.
+
+  The default, NaN, means that no value is marked.
+ */
+void GeoTiffWriter::setNoData(double noData)
+{
+  m_noData = noData;
+}
+
+/*!
+  \brief Returns the number of tiles across the raster.
+ */
+int GeoTiffWriter::tilesAcross() const
+{
+  return (m_width + TileSize - 1) / TileSize;
+}
+
+/*!
+  \brief Returns the number of tiles down the raster.
+ */
+int GeoTiffWriter::tilesDown() const
+{
+  return (m_height + TileSize - 1) / TileSize;
+}
+
+/*!
+  \brief Returns the size of each sample in bytes.
+ */
+int GeoTiffWriter::bytesPerSample() const
+{
+  switch (m_sampleType)
+  {
+  case SampleType::UInt8:
+    return 1;
+  case SampleType::UInt16:
+    return 2;
+  case SampleType::Float32:
+    return 4;
+  }
+
+  return 1;
+}
+
+/*!
+  \brief Writes the tile at \a tileX, \a tileY from \a data, which holds
+  \c TileSize by \c TileSize samples in row order.
+
+  Samples beyond the edge of the raster are written but never read. This may
+  be called from several threads at once.
+ */
+bool GeoTiffWriter::writeTile(int tileX, int tileY, const void* data)
+{
+  QMutexLocker locker(&m_mutex);
+
+  if (!m_file.isOpen() || tileX < 0 || tileY < 0 || tileX >= tilesAcross() || tileY >= tilesDown())
+    return false;
+
+  const qint64 size = static_cast<qint64>(TileSize) * TileSize * bytesPerSample();
+  const qint64 offset = m_file.size();
+  if (offset + size > std::numeric_limits<quint32>::max())
+    return fail(QObject::tr("The raster is too large for a GeoTIFF"));
+
+  if (!m_file.seek(offset) || m_file.write(static_cast<const char*>(data), size) != size)
+    return fail(m_file.fileName() + QStringLiteral(": ") + m_file.errorString());
+
+  m_tileOffsets[tileY * tilesAcross() + tileX] = static_cast<quint32>(offset);
+  return true;
+}
+
+/*!
+  \brief Writes the image directory and closes the file.
+
+  Returns \c false, and removes the file, if it could not be completed.
+ */
+bool GeoTiffWriter::close()
+{
+  QMutexLocker locker(&m_mutex);
+
+  if (!m_file.isOpen())
+    return false;
+
+  if (!m_errorString.isEmpty() || !writeDirectory())
+  {
+    m_file.remove();
+    return false;
+  }
+
+  m_file.close();
+  return true;
+}
+
+/*!
+  \brief Abandons the file being written and removes it.
+ */
+void GeoTiffWriter::cancel()
+{
+  QMutexLocker locker(&m_mutex);
+
+  if (m_file.isOpen())
+    m_file.remove();
+}
+
+/*!
+  \brief Returns a description of the last error.
+ */
+QString GeoTiffWriter::errorString() const
+{
+  return m_errorString;
+}
+
+/*!
+  \brief Writes the \a width by \a height samples of \a sampleType in \a data,
+  in row order from north to south, to the GeoTIFF at \a filePath.
+
+  \a originX, \a originY, \a spacingX and \a spacingY place the raster as for
+  \l open and \a noData marks pixels with no data. Returns \c false, with the
+  reason in \a errorString if set, if the file could not be written.
+ */
+bool GeoTiffWriter::write(const QString& filePath, const void* data, int width, int height, SampleType sampleType,
+                          double originX, double originY, double spacingX, double spacingY,
+                          double noData, QString* errorString)
+{
+  GeoTiffWriter writer;
+  bool written = writer.open(filePath, width, height, sampleType, originX, originY, spacingX, spacingY);
+  writer.setNoData(noData);
+
+  const int bytes = writer.bytesPerSample();
+  const char* source = static_cast<const char*>(data);
+  QByteArray tile(TileSize * TileSize * bytes, '\0');
+
+  for (int tileY = 0; written && tileY < writer.tilesDown(); ++tileY)
+  {
+    for (int tileX = 0; written && tileX < writer.tilesAcross(); ++tileX)
+    {
+      const int columns = qMin(TileSize, width - tileX * TileSize);
+      const int rows = qMin(TileSize, height - tileY * TileSize);
+      for (int row = 0; row < rows; ++row)
+      {
+        const qint64 sourceOffset = (static_cast<qint64>(tileY * TileSize + row) * width + tileX * TileSize) * bytes;
+        std::memcpy(tile.data() + row * TileSize * bytes, source + sourceOffset, columns * bytes);
+      }
+
+      written = writer.writeTile(tileX, tileY, tile.constData());
+    }
+  }
+
+  written = written && writer.close();
+  if (errorString)
+    *errorString = writer.errorString();
+
+  return written;
+}
+
+/*!
+  \internal
+ */
+bool GeoTiffWriter::writeDirectory()
+{
+  const int bytes = bytesPerSample();
+  const quint32 tileBytes = TileSize * TileSize * bytes;
+
+  // tiles that were never written are filled with no data
+  QByteArray emptyTile(static_cast<int>(tileBytes), '\0');
+  if (!std::isnan(m_noData))
+  {
+    for (int i = 0; i < TileSize * TileSize; ++i)
+    {
+      char* sample = emptyTile.data() + i * bytes;
+      switch (m_sampleType)
+      {
+      case SampleType::UInt8:
+        *reinterpret_cast<quint8*>(sample) = static_cast<quint8>(m_noData);
+        break;
+      case SampleType::UInt16:
+        *reinterpret_cast<quint16*>(sample) = static_cast<quint16>(m_noData);
+        break;
+      case SampleType::Float32:
+        *reinterpret_cast<float*>(sample) = static_cast<float>(m_noData);
+        break;
+      }
+    }
+  }
+
+  for (quint32& offset : m_tileOffsets)
+  {
+    if (offset != 0)
+      continue;
+
+    offset = static_cast<quint32>(m_file.size());
+    if (!m_file.seek(offset) || m_file.write(emptyTile) != emptyTile.size())
+      return fail(m_file.fileName() + QStringLiteral(": ") + m_file.errorString());
+  }
+
+  // the directory starts on a word boundary after the tiles
+  quint32 directoryOffset = static_cast<quint32>(m_file.size());
+  if (directoryOffset % 2)
+  {
+    m_file.seek(directoryOffset);
+    m_file.write("\0", 1);
+    ++directoryOffset;
+  }
+
+  const quint16 bitsPerSample = static_cast<quint16>(bytes * 8);
+  const quint16 sampleFormat = m_sampleType == SampleType::Float32 ? 3 : 1;
+
+  DirectoryBuilder directory(directoryOffset);
+  directory.addLongs(imageWidthTag, { static_cast<quint32>(m_width) });
+  directory.addLongs(imageLengthTag, { static_cast<quint32>(m_height) });
+  directory.addShorts(bitsPerSampleTag, { bitsPerSample });
+  directory.addShorts(compressionTag, { compressionNone });
+  directory.addShorts(photometricTag, { 1 });
+  directory.addShorts(samplesPerPixelTag, { 1 });
+  directory.addShorts(planarConfigurationTag, { 1 });
+  directory.addShorts(tileWidthTag, { TileSize });
+  directory.addShorts(tileLengthTag, { TileSize });
+  directory.addLongs(tileOffsetsTag, m_tileOffsets);
+  directory.addLongs(tileByteCountsTag, QVector<quint32>(m_tileOffsets.size(), tileBytes));
+  directory.addShorts(sampleFormatTag, { sampleFormat });
+
+  // the tie point is the north-west corner of the first pixel
+  directory.addDoubles(modelPixelScaleTag, { m_spacingX, m_spacingY, 0.0 });
+  directory.addDoubles(modelTiepointTag, { 0.0, 0.0, 0.0, m_originX - m_spacingX * 0.5, m_originY + m_spacingY * 0.5, 0.0 });
+
+  // geographic WGS84 with pixels that cover an area
+  directory.addShorts(geoKeyDirectoryTag, { 1, 1, 0, 3,
+                                            modelTypeKey, 0, 1, modelTypeGeographic,
+                                            rasterTypeKey, 0, 1, rasterPixelIsArea,
+                                            geographicTypeKey, 0, 1, geographicWgs84 });
+
+  if (!std::isnan(m_noData))
+    directory.addAscii(gdalNoDataTag, QByteArray::number(m_noData, 'g', 9));
+
+  const QByteArray bytesOut = directory.build();
+  if (!m_file.seek(directoryOffset) || m_file.write(bytesOut) != bytesOut.size() ||
+      !m_file.seek(4) || m_file.write(reinterpret_cast<const char*>(&directoryOffset), sizeof(directoryOffset)) != sizeof(directoryOffset))
+  {
+    return fail(m_file.fileName() + QStringLiteral(": ") + m_file.errorString());
+  }
+
+  return true;
+}
+
+/*!
+  \internal
+ */
+bool GeoTiffWriter::fail(const QString& error)
+{
+  if (m_errorString.isEmpty())
+    m_errorString = error;
+
+  return false;
+}
+
+} // Dsa
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+#ifndef GEOTIFFWRITER_H
+#define GEOTIFFWRITER_H
+
+// Qt headers
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+// STL headers
+#include <cmath>
+
+namespace Dsa {
+
+class GeoTiffWriter
+{
+public:
+  enum class SampleType
+  {
+    UInt8,
+    UInt16,
+    Float32
+  };
+
+  static constexpr int TileSize = 256;
+
+  GeoTiffWriter();
+  ~GeoTiffWriter();
+
+  // originX and originY locate the centre of the north-west pixel in WGS84
+  // degrees; the spacing is positive towards the south and east
+  bool open(const QString& filePath, int width, int height, SampleType sampleType,
+            double originX, double originY, double spacingX, double spacingY);
+  bool isOpen() const;
+
+  void setNoData(double noData);
+
+  int tilesAcross() const;
+  int tilesDown() const;
+  int bytesPerSample() const;
+
+  // writes TileSize x TileSize samples in row order; thread safe
+  bool writeTile(int tileX, int tileY, const void* data);
+
+  bool close();
+  void cancel();
+
+  QString errorString() const;
+
+  static bool write(const QString& filePath, const void* data, int width, int height, SampleType sampleType,
+                    double originX, double originY, double spacingX, double spacingY,
+                    double noData = NAN, QString* errorString = nullptr);
+
+private:
+  Q_DISABLE_COPY(GeoTiffWriter)
+
+  bool writeDirectory();
+  bool fail(const QString& error);
+
+  QFile m_file;
+  QMutex m_mutex;
+  QString m_errorString;
+  SampleType m_sampleType = SampleType::UInt8;
+  int m_width = 0;
+  int m_height = 0;
+  double m_originX = 0.0;
+  double m_originY = 0.0;
+  double m_spacingX = 0.0;
+  double m_spacingY = 0.0;
+  double m_noData = NAN;
+  QVector<quint32> m_tileOffsets;
+};
+
+} // Dsa
+
+#endif // GEOTIFFWRITER_H
@@ -0,0 +1,398 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+// PCH header
+#include "pch.hpp"
+
+#include "MessageFeedDevice.h"
+
+// C++ headers
+#include <cstring>
+
+namespace Dsa {
+
+/*!
+  \class Dsa::MessageFeedDevice
+  \inmodule Dsa
+  \inherits QIODevice
+  \brief An in-process source of messages for a \l DataListener.
+
+  The device delivers a pre-generated list of messages without going through
+  a socket, so that ingestion can be benchmarked deterministically. Each
+  message is made available on its own and announced with
+  \l QIODevice::readyRead, which a \l DataListener handles straight away.
+
+  Messages are delivered in batches as fast as the event loop allows, or at
+  the times given by a \l schedule. \l deliverAll delivers every remaining
+  message at once without returning to the event loop.
+
+  Writing to the device appends a message to the feed.
+
+  Subclasses can deliver messages from another source, such as a file, by
+  reimplementing \l hasNextMessage, \l nextMessageTime, \l takeNextMessage
+  and \l rewind.
+ */
+
+/*!
+  \brief Constructor taking an optional \a parent.
+ */
+MessageFeedDevice::MessageFeedDevice(QObject* parent) :
+  QIODevice(parent)
+{
+  m_timer.setSingleShot(true);
+  m_timer.setTimerType(Qt::PreciseTimer);
+  connect(&m_timer, &QTimer::timeout, this, &MessageFeedDevice::deliverDue);
+}
+
+/*!
+  \brief Constructor taking a list of \a messages and an optional \a parent.
+ */
+MessageFeedDevice::MessageFeedDevice(const QList<QByteArray>& messages, QObject* parent) :
+  MessageFeedDevice(parent)
+{
+  m_messages = messages;
+}
+
+/*!
+  \brief Destructor.
+ */
+MessageFeedDevice::~MessageFeedDevice()
+{
+}
+
+/*!
+  \brief Returns the messages delivered by the device.
+ */
+QList<QByteArray> MessageFeedDevice::messages() const
+{
+  return m_messages;
+}
+
+/*!
+  \brief Sets the \a messages delivered by the device and rewinds it to the first message.
+ */
+void MessageFeedDevice::setMessages(const QList<QByteArray>& messages)
+{
+  m_messages = messages;
+  m_nextMessage = 0;
+}
+
+/*!
+  \brief Returns the delivery schedule.
+ */
+QVector<qint64> MessageFeedDevice::schedule() const
+{
+  return m_schedule;
+}
+
+/*!
+  \brief Sets the delivery \a schedule.
+
+  The schedule holds one time per message, in milliseconds from \l start,
+  in non-decreasing order. Messages beyond the end of the schedule are
+  delivered straight after the last scheduled message. An empty schedule,
+  the default, delivers messages as fast as possible.
+ */
+void MessageFeedDevice::setSchedule(const QVector<qint64>& schedule)
+{
+  m_schedule = schedule;
+}
+
+/*!
+  \brief Returns the number of messages delivered on each pass of the event
+  loop when there is no schedule.
+ */
+int MessageFeedDevice::batchSize() const
+{
+  return m_batchSize;
+}
+
+/*!
+  \brief Sets the number of messages delivered on each pass of the event loop
+  when there is no schedule to \a batchSize.
+ */
+void MessageFeedDevice::setBatchSize(int batchSize)
+{
+  m_batchSize = qMax(1, batchSize);
+}
+
+/*!
+  \brief Returns whether the device starts over after the last message.
+ */
+bool MessageFeedDevice::isLooped() const
+{
+  return m_looped;
+}
+
+/*!
+  \brief Sets whether the device starts over after the last message to \a looped.
+
+  A looped schedule starts over from the time the last message was delivered.
+ */
+void MessageFeedDevice::setLooped(bool looped)
+{
+  m_looped = looped;
+}
+
+/*!
+  \brief Returns whether the device is delivering messages.
+ */
+bool MessageFeedDevice::isRunning() const
+{
+  return m_timer.isActive();
+}
+
+/*!
+  \brief Returns the number of messages delivered since the device was last started.
+ */
+qint64 MessageFeedDevice::messagesDelivered() const
+{
+  return m_messagesDelivered;
+}
+
+/*!
+  \brief Starts delivering messages from the first one, opening the device if needed.
+ */
+void MessageFeedDevice::start()
+{
+  if (!isOpen())
+    open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+
+  m_nextMessage = 0;
+  m_loopOffsetMs = 0;
+  m_messagesDelivered = 0;
+
+  resume();
+}
+
+/*!
+  \brief Stops delivering messages.
+ */
+void MessageFeedDevice::stop()
+{
+  m_timer.stop();
+}
+
+/*!
+  \brief Delivers every remaining message immediately, ignoring the schedule,
+  and returns how many were delivered.
+ */
+qint64 MessageFeedDevice::deliverAll()
+{
+  if (!isOpen())
+    open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+
+  m_timer.stop();
+
+  qint64 delivered = 0;
+  while (deliverNext())
+    delivered++;
+
+  return delivered;
+}
+
+/*!
+  \reimp
+ */
+bool MessageFeedDevice::isSequential() const
+{
+  return true;
+}
+
+/*!
+  \reimp
+ */
+qint64 MessageFeedDevice::bytesAvailable() const
+{
+  return m_pending.size() - m_pendingPosition + QIODevice::bytesAvailable();
+}
+
+/*!
+  \reimp
+ */
+void MessageFeedDevice::close()
+{
+  m_timer.stop();
+  m_pending.clear();
+  m_pendingPosition = 0;
+
+  QIODevice::close();
+}
+
+/*!
+  \reimp
+ */
+qint64 MessageFeedDevice::readData(char* data, qint64 maxSize)
+{
+  const qint64 size = qMin(maxSize, m_pending.size() - m_pendingPosition);
+  if (size <= 0)
+    return 0;
+
+  std::memcpy(data, m_pending.constData() + m_pendingPosition, static_cast<size_t>(size));
+  m_pendingPosition += size;
+
+  if (m_pendingPosition == m_pending.size())
+  {
+    m_pending.clear();
+    m_pendingPosition = 0;
+  }
+
+  return size;
+}
+
+/*!
+  \reimp
+
+  Each write appends one message to the feed.
+ */
+qint64 MessageFeedDevice::writeData(const char* data, qint64 maxSize)
+{
+  m_messages.append(QByteArray(data, static_cast<int>(maxSize)));
+  return maxSize;
+}
+
+/*!
+  \brief Returns whether there is another message to deliver.
+ */
+bool MessageFeedDevice::hasNextMessage() const
+{
+  return m_nextMessage < m_messages.size();
+}
+
+/*!
+  \brief Returns the time the next message is due, in milliseconds from the
+  last call to \l resume, or -1 to deliver messages as fast as possible.
+ */
+qint64 MessageFeedDevice::nextMessageTime() const
+{
+  if (m_schedule.isEmpty())
+    return -1;
+
+  return m_loopOffsetMs + m_schedule.value(m_nextMessage, m_schedule.last());
+}
+
+/*!
+  \brief Removes the next message from the feed and returns it.
+ */
+QByteArray MessageFeedDevice::takeNextMessage()
+{
+  return m_messages.at(m_nextMessage++);
+}
+
+/*!
+  \brief Starts the feed over after the last message. Returns \c false if
+  the device is finished instead.
+ */
+bool MessageFeedDevice::rewind()
+{
+  if (!m_looped || m_messages.isEmpty())
+    return false;
+
+  // start over from the time the last message was delivered
+  m_nextMessage = 0;
+  m_loopOffsetMs = m_clock.elapsed();
+  return true;
+}
+
+/*!
+  \brief Restarts the clock that \l nextMessageTime is measured from and
+  continues delivering from the next message.
+ */
+void MessageFeedDevice::resume()
+{
+  m_clock.start();
+  scheduleNext();
+}
+
+/*!
+  \internal
+ */
+void MessageFeedDevice::deliverDue()
+{
+  if (nextMessageTime() < 0)
+  {
+    for (int i = 0; i < m_batchSize; ++i)
+    {
+      if (!deliverNext())
+        break;
+    }
+  }
+  else
+  {
+    // deliver everything that has fallen due since the last tick
+    const qint64 elapsedMs = m_clock.elapsed();
+    while (hasNextMessage() && nextMessageTime() <= elapsedMs)
+    {
+      if (!deliverNext())
+        break;
+    }
+  }
+
+  scheduleNext();
+}
+
+/*!
+  \internal
+ */
+bool MessageFeedDevice::deliverNext()
+{
+  if (!hasNextMessage())
+    return false;
+
+  // a reader that did not consume the previous message receives it
+  // together with this one
+  if (m_pendingPosition > 0)
+  {
+    m_pending.remove(0, static_cast<int>(m_pendingPosition));
+    m_pendingPosition = 0;
+  }
+
+  m_pending.append(takeNextMessage());
+  m_messagesDelivered++;
+
+  emit readyRead();
+  return true;
+}
+
+/*!
+  \internal
+ */
+void MessageFeedDevice::scheduleNext()
+{
+  if (!hasNextMessage() && !rewind())
+  {
+    m_timer.stop();
+    emit finished();
+    return;
+  }
+
+  const qint64 dueMs = nextMessageTime();
+  if (dueMs < 0)
+  {
+    m_timer.start(0);
+    return;
+  }
+
+  m_timer.start(static_cast<int>(qMax<qint64>(0, dueMs - m_clock.elapsed())));
+}
+
+} // Dsa
+
+// Signal Documentation
+/*!
+  \fn void MessageFeedDevice::finished();
+  \brief Signal emitted when the last message has been delivered and the device is not looped.
+ */
@@ -0,0 +1,99 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef MESSAGEFEEDDEVICE_H
+#define MESSAGEFEEDDEVICE_H
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QList>
+#include <QTimer>
+#include <QVector>
+
+namespace Dsa {
+
+class MessageFeedDevice : public QIODevice
+{
+  Q_OBJECT
+
+public:
+  explicit MessageFeedDevice(QObject* parent = nullptr);
+  explicit MessageFeedDevice(const QList<QByteArray>& messages, QObject* parent = nullptr);
+  ~MessageFeedDevice();
+
+  QList<QByteArray> messages() const;
+  void setMessages(const QList<QByteArray>& messages);
+
+  QVector<qint64> schedule() const;
+  void setSchedule(const QVector<qint64>& schedule);
+
+  int batchSize() const;
+  void setBatchSize(int batchSize);
+
+  bool isLooped() const;
+  void setLooped(bool looped);
+
+  bool isRunning() const;
+  qint64 messagesDelivered() const;
+
+  void start();
+  void stop();
+  qint64 deliverAll();
+
+  bool isSequential() const override;
+  qint64 bytesAvailable() const override;
+  void close() override;
+
+signals:
+  void finished();
+
+protected:
+  qint64 readData(char* data, qint64 maxSize) override;
+  qint64 writeData(const char* data, qint64 maxSize) override;
+
+  virtual bool hasNextMessage() const;
+  virtual qint64 nextMessageTime() const;
+  virtual QByteArray takeNextMessage();
+  virtual bool rewind();
+
+  void resume();
+
+private:
+  Q_DISABLE_COPY(MessageFeedDevice)
+
+  void deliverDue();
+  bool deliverNext();
+  void scheduleNext();
+
+  QList<QByteArray> m_messages;
+  QVector<qint64> m_schedule;
+  int m_batchSize = 100;
+  bool m_looped = false;
+
+  int m_nextMessage = 0;
+  qint64 m_loopOffsetMs = 0;
+  qint64 m_messagesDelivered = 0;
+  QByteArray m_pending;
+  qint64 m_pendingPosition = 0;
+
+  QTimer m_timer;
+  QElapsedTimer m_clock;
+};
+
+} // Dsa
+
+#endif // MESSAGEFEEDDEVICE_H
@@ -0,0 +1,124 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+
+// PCH header
+#include "pch.hpp"
+
+#include "ParallelFor.h"
+
+// Qt headers
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+// STL headers
+#include <atomic>
+
+namespace Dsa {
+
+namespace
+{
+struct ParallelForState
+{
+  ParallelForState(int begin, int end, const std::function<void(int)>& body) :
+    next(begin),
+    end(end),
+    body(body)
+  {
+  }
+
+  // every thread, including the caller, takes the next index until none are left
+  void run()
+  {
+    for (int index = next++; index < end; index = next++)
+      body(index);
+  }
+
+  std::atomic<int> next;
+  const int end;
+  const std::function<void(int)>& body;
+  QSemaphore finished;
+};
+
+class ParallelForRunnable : public QRunnable
+{
+public:
+  explicit ParallelForRunnable(ParallelForState* state) :
+    m_state(state)
+  {
+  }
+
+  void run() override
+  {
+    m_state->run();
+    m_state->finished.release();
+  }
+
+private:
+  ParallelForState* m_state = nullptr;
+};
+}
+
+/*!
+  \fn void Dsa::parallelFor(int begin, int end, const std::function<void(int)>& body)
+  \inmodule Dsa
+  \brief Calls \a body for every index from \a begin up to, but not including,
+  \a end, spread across the global \c QThreadPool.
+
+  Indices are handed out one at a time, so a slow index does not hold up the
+  others and the work balances itself however uneven it is. The calling
+  thread takes indices too and the function returns once every index has been
+  processed, so \a body may safely refer to the caller's locals. \a body must
+  be safe to call from several threads at once.
+ */
+void parallelFor(int begin, int end, const std::function<void(int)>& body)
+{
+  const int count = end - begin;
+  if (count <= 0)
+    return;
+
+  QThreadPool* pool = QThreadPool::globalInstance();
+  const int helpers = qMin(count, pool->maxThreadCount()) - 1;
+  if (helpers <= 0)
+  {
+    for (int index = begin; index < end; ++index)
+      body(index);
+
+    return;
+  }
+
+  ParallelForState state(begin, end, body);
+
+  // a helper that the pool cannot start straight away is run by this thread
+  int started = 0;
+  for (int i = 0; i < helpers; ++i)
+  {
+    auto runnable = new ParallelForRunnable(&state);
+    if (!pool->tryStart(runnable))
+    {
+      delete runnable;
+      break;
+    }
+
+    ++started;
+  }
+
+  state.run();
+  state.finished.acquire(started);
+}
+
+} // Dsa
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ *  Copyright 2012-2018 Esri
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ ******************************************************************************/
+
+#ifndef TIFFTAGS_H
+#define TIFFTAGS_H
+
+// Qt headers
+#include <QtGlobal>
+
+namespace Dsa {
+
+// the TIFF and GeoTIFF values read by GeoTiffRaster and written by GeoTiffWriter
+namespace TiffTags {
+
+// TIFF tags
+const quint16 imageWidthTag = 256;
+const quint16 imageLengthTag = 257;
+const quint16 bitsPerSampleTag = 258;
+const quint16 compressionTag = 259;
+const quint16 photometricTag = 262;
+const quint16 stripOffsetsTag = 273;
+const quint16 samplesPerPixelTag = 277;
+const quint16 rowsPerStripTag = 278;
+const quint16 stripByteCountsTag = 279;
+const quint16 planarConfigurationTag = 284;
+const quint16 predictorTag = 317;
+const quint16 tileWidthTag = 322;
+const quint16 tileLengthTag = 323;
+const quint16 tileOffsetsTag = 324;
+const quint16 tileByteCountsTag = 325;
+const quint16 sampleFormatTag = 339;
+
+// GeoTIFF and GDAL tags
+const quint16 modelPixelScaleTag = 33550;
+const quint16 modelTiepointTag = 33922;
+const quint16 geoKeyDirectoryTag = 34735;
+const quint16 gdalNoDataTag = 42113;
+
+// TIFF field types
+const quint16 asciiType = 2;
+const quint16 shortType = 3;
+const quint16 longType = 4;
+const quint16 doubleType = 12;
+
+// GeoTIFF keys and their values
+const quint16 modelTypeKey = 1024;
+const quint16 rasterTypeKey = 1025;
+const quint16 geographicTypeKey = 2048;
+const quint16 modelTypeGeographic = 2;
+const quint16 rasterPixelIsArea = 1;
+const quint16 rasterPixelIsPoint = 2;
+const quint16 geographicWgs84 = 4326;
+
+// compression schemes
+const quint16 compressionNone = 1;
+const quint16 compressionDeflate = 8;
+const quint16 compressionAdobeDeflate = 32946;
+
+} // TiffTags
+
+} // Dsa
+
+#endif // TIFFTAGS_H
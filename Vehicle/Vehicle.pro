@@ -17,7 +17,13 @@
 TARGET = DSA_Vehicle_Qt
 TEMPLATE = app
 
-QT += core gui opengl network positioning sensors qml quick xml
+QT += core gui opengl network positioning sensors qml quick xml concurrent
+
+# NMEA receivers on serial ports are only supported on the desktop platforms
+!ios:!android {
+  QT += serialport
+}
+
 CONFIG += c++11
 
 ARCGIS_RUNTIME_VERSION = 100.4
@@ -306,6 +306,15 @@ Vehicle {
             visible: false
         }
 
+        TerrainProfile {
+            id: terrainProfile
+            anchors {
+                left: parent.left
+                right: parent.right
+                bottom: sceneView.attributionTop
+            }
+        }
+
         AnalysisList {
             id: analysisListTool
             anchors {
@@ -498,6 +507,13 @@ Vehicle {
         onActivated: Qt.quit()
     }
 
+    // print the latency statistics of messages tagged by the message simulator
+    // and how many graphic changes were batched into each frame
+    Shortcut {
+        sequence: "Ctrl+Shift+L"
+        onActivated: console.log(messageFeeds.controller.latencyReport())
+    }
+
     DsaMessageDialog {
         id: clearDialog
         standardButtons: Dialog.Ok | Dialog.Cancel